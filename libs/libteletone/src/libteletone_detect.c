@@ -100,6 +100,16 @@
 #include <time.h>
 #include <fcntl.h>
 
+#if !defined(TELETONE_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TELETONE_HAVE_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TELETONE_HAVE_NEON 1
+#endif
+#endif
+
 #define LOW_ENG 10000000
 #define ZC 2
 static teletone_detection_descriptor_t dtmf_detect_row[GRID_FACTOR];
@@ -130,6 +140,237 @@ TELETONE_API(void) teletone_goertzel_update(teletone_goertzel_state_t *goertzel_
 		goertzel_state->v3 = (float)(goertzel_state->fac*goertzel_state->v2 - v1 + sample_buffer[i]);
 	}
 }
+
+/* Goertzel bank
+ *
+ * The detectors run every filter over the same samples, so instead of stepping the filters one
+ * after the other for each sample the bank runs groups of GOERTZEL_GROUP filters side by side
+ * over the whole run of samples.  A group only spans as many vectors as it has filters, the
+ * unused lanes of its last vector get a zero coefficient and are dropped.  A single filter
+ * gains nothing from the bank and runs the plain loop.
+ *
+ * The exact kernel does the math of the scalar update in double, two filters per vector, and
+ * rounds to float after every step so the state matches the scalar loop to the bit.  The fast
+ * kernel stays in single precision, four filters per vector, and the energies differ in the
+ * last bits only.  DTMF takes the fast one; the multi-tone harmonic test compares a double
+ * energy against its own float rounding, so that detector keeps the exact one.
+ */
+#define GOERTZEL_GROUP 16
+#define GOERTZEL_BANK_MAX 32
+#define GOERTZEL_BANK_MIN 2
+
+static void goertzel_group_update_exact(double *fac, double *v2, double *v3, int lanes, const int16_t *sample_buffer, int samples)
+{
+	int i, k;
+
+#if defined(TELETONE_HAVE_SSE2)
+	__m128d f[GOERTZEL_GROUP / 2], a[GOERTZEL_GROUP / 2], b[GOERTZEL_GROUP / 2];
+
+	for (k = 0; k < lanes / 2; k++) {
+		f[k] = _mm_loadu_pd(fac + k * 2);
+		a[k] = _mm_loadu_pd(v2 + k * 2);
+		b[k] = _mm_loadu_pd(v3 + k * 2);
+	}
+
+	for (i = 0; i < samples; i++) {
+		__m128d x = _mm_set1_pd((double) sample_buffer[i]);
+
+		for (k = 0; k < lanes / 2; k++) {
+			__m128d v1 = a[k];
+
+			a[k] = b[k];
+			b[k] = _mm_cvtps_pd(_mm_cvtpd_ps(_mm_add_pd(_mm_sub_pd(_mm_mul_pd(f[k], a[k]), v1), x)));
+		}
+	}
+
+	for (k = 0; k < lanes / 2; k++) {
+		_mm_storeu_pd(v2 + k * 2, a[k]);
+		_mm_storeu_pd(v3 + k * 2, b[k]);
+	}
+#elif defined(TELETONE_HAVE_NEON)
+	float64x2_t f[GOERTZEL_GROUP / 2], a[GOERTZEL_GROUP / 2], b[GOERTZEL_GROUP / 2];
+
+	for (k = 0; k < lanes / 2; k++) {
+		f[k] = vld1q_f64(fac + k * 2);
+		a[k] = vld1q_f64(v2 + k * 2);
+		b[k] = vld1q_f64(v3 + k * 2);
+	}
+
+	for (i = 0; i < samples; i++) {
+		float64x2_t x = vdupq_n_f64((double) sample_buffer[i]);
+
+		for (k = 0; k < lanes / 2; k++) {
+			float64x2_t v1 = a[k];
+
+			a[k] = b[k];
+			b[k] = vcvt_f64_f32(vcvt_f32_f64(vaddq_f64(vsubq_f64(vmulq_f64(f[k], a[k]), v1), x)));
+		}
+	}
+
+	for (k = 0; k < lanes / 2; k++) {
+		vst1q_f64(v2 + k * 2, a[k]);
+		vst1q_f64(v3 + k * 2, b[k]);
+	}
+#else
+	double a[GOERTZEL_GROUP], b[GOERTZEL_GROUP], v1;
+
+	for (k = 0; k < lanes; k++) {
+		a[k] = v2[k];
+		b[k] = v3[k];
+	}
+
+	for (i = 0; i < samples; i++) {
+		double x = sample_buffer[i];
+
+		for (k = 0; k < lanes; k++) {
+			v1 = a[k];
+			a[k] = b[k];
+			b[k] = (float)(fac[k] * a[k] - v1 + x);
+		}
+	}
+
+	for (k = 0; k < lanes; k++) {
+		v2[k] = a[k];
+		v3[k] = b[k];
+	}
+#endif
+}
+
+#if defined(TELETONE_HAVE_SSE2) || defined(TELETONE_HAVE_NEON)
+static void goertzel_group_update_fast(float *fac, float *v2, float *v3, int lanes, const int16_t *sample_buffer, int samples)
+{
+	int i, k;
+
+#if defined(TELETONE_HAVE_SSE2)
+	__m128 f[GOERTZEL_GROUP / 4], a[GOERTZEL_GROUP / 4], b[GOERTZEL_GROUP / 4];
+
+	for (k = 0; k < lanes / 4; k++) {
+		f[k] = _mm_loadu_ps(fac + k * 4);
+		a[k] = _mm_loadu_ps(v2 + k * 4);
+		b[k] = _mm_loadu_ps(v3 + k * 4);
+	}
+
+	for (i = 0; i < samples; i++) {
+		__m128 x = _mm_set1_ps((float) sample_buffer[i]);
+
+		for (k = 0; k < lanes / 4; k++) {
+			__m128 v1 = a[k];
+
+			a[k] = b[k];
+			b[k] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(f[k], a[k]), v1), x);
+		}
+	}
+
+	for (k = 0; k < lanes / 4; k++) {
+		_mm_storeu_ps(v2 + k * 4, a[k]);
+		_mm_storeu_ps(v3 + k * 4, b[k]);
+	}
+#else
+	float32x4_t f[GOERTZEL_GROUP / 4], a[GOERTZEL_GROUP / 4], b[GOERTZEL_GROUP / 4];
+
+	for (k = 0; k < lanes / 4; k++) {
+		f[k] = vld1q_f32(fac + k * 4);
+		a[k] = vld1q_f32(v2 + k * 4);
+		b[k] = vld1q_f32(v3 + k * 4);
+	}
+
+	for (i = 0; i < samples; i++) {
+		float32x4_t x = vdupq_n_f32((float) sample_buffer[i]);
+
+		for (k = 0; k < lanes / 4; k++) {
+			float32x4_t v1 = a[k];
+
+			a[k] = b[k];
+			b[k] = vaddq_f32(vsubq_f32(vmulq_f32(f[k], a[k]), v1), x);
+		}
+	}
+
+	for (k = 0; k < lanes / 4; k++) {
+		vst1q_f32(v2 + k * 4, a[k]);
+		vst1q_f32(v3 + k * 4, b[k]);
+	}
+#endif
+}
+#endif
+
+/* filters left rounded up to whole vectors, at most one group */
+static int goertzel_group_lanes(int left, int width)
+{
+	if (left >= GOERTZEL_GROUP) {
+		return GOERTZEL_GROUP;
+	}
+
+	return (left + width - 1) / width * width;
+}
+
+static void goertzel_bank_update(teletone_goertzel_state_t **gs, int count, const int16_t *sample_buffer, int samples, int exact)
+{
+	int x;
+
+#if defined(TELETONE_HAVE_SSE2) || defined(TELETONE_HAVE_NEON)
+	if (!exact) {
+		float fac[GOERTZEL_BANK_MAX] = { 0 }, v2[GOERTZEL_BANK_MAX] = { 0 }, v3[GOERTZEL_BANK_MAX] = { 0 };
+
+		for (x = 0; x < count; x++) {
+			fac[x] = (float) gs[x]->fac;
+			v2[x] = gs[x]->v2;
+			v3[x] = gs[x]->v3;
+		}
+
+		for (x = 0; x < count; x += GOERTZEL_GROUP) {
+			goertzel_group_update_fast(fac + x, v2 + x, v3 + x, goertzel_group_lanes(count - x, 4), sample_buffer, samples);
+		}
+
+		for (x = 0; x < count; x++) {
+			gs[x]->v2 = v2[x];
+			gs[x]->v3 = v3[x];
+		}
+
+		return;
+	}
+#endif
+
+	if (count < GOERTZEL_BANK_MIN) {
+		for (x = 0; x < count; x++) {
+			teletone_goertzel_update(gs[x], (int16_t *) sample_buffer, samples);
+		}
+
+		return;
+	}
+
+	{
+		double fac[GOERTZEL_BANK_MAX] = { 0 }, v2[GOERTZEL_BANK_MAX] = { 0 }, v3[GOERTZEL_BANK_MAX] = { 0 };
+
+		for (x = 0; x < count; x++) {
+			fac[x] = gs[x]->fac;
+			v2[x] = gs[x]->v2;
+			v3[x] = gs[x]->v3;
+		}
+
+		for (x = 0; x < count; x += GOERTZEL_GROUP) {
+			goertzel_group_update_exact(fac + x, v2 + x, v3 + x, goertzel_group_lanes(count - x, 2), sample_buffer, samples);
+		}
+
+		for (x = 0; x < count; x++) {
+			gs[x]->v2 = (float) v2[x];
+			gs[x]->v3 = (float) v3[x];
+		}
+	}
+}
+
+static float energy_update(float energy, const int16_t *sample_buffer, int samples)
+{
+	float famp;
+	int i;
+
+	for (i = 0; i < samples; i++) {
+		famp = sample_buffer[i];
+		energy += famp*famp;
+	}
+
+	return energy;
+}
+
 #ifdef _MSC_VER
 #pragma warning(disable:4244)
 #endif
@@ -218,10 +459,14 @@ TELETONE_API(int) teletone_multi_tone_detect (teletone_multi_tone_t *mt,
 								int16_t sample_buffer[],
 								int samples)
 {
-	int sample, limit = 0, j, x = 0;
-	float v1, famp;
+	int sample, limit = 0, x = 0, tones = 0;
 	float eng_sum = 0, eng_all[TELETONE_MAX_TONES] = {0.0};
 	int gtest = 0, see_hit = 0;
+	teletone_goertzel_state_t *gs[TELETONE_MAX_TONES];
+
+	for (tones = 0; tones < TELETONE_MAX_TONES && tones < mt->tone_count; tones++) {
+		gs[tones] = &mt->gs[tones];
+	}
 
 	for (sample = 0;  sample >= 0 && sample < samples; sample = limit) {
 		mt->total_samples++;
@@ -235,21 +480,11 @@ TELETONE_API(int) teletone_multi_tone_detect (teletone_multi_tone_t *mt,
 			limit = samples;
 		}
 
-		for (j = sample;  j < limit;  j++) {
-			famp = sample_buffer[j];
-			
-			mt->energy += famp*famp;
+		mt->energy = energy_update(mt->energy, sample_buffer + sample, limit - sample);
 
-			for(x = 0; x < TELETONE_MAX_TONES && x < mt->tone_count; x++) {
-				v1 = mt->gs[x].v2;
-				mt->gs[x].v2 = mt->gs[x].v3;
-				mt->gs[x].v3 = (float)(mt->gs[x].fac * mt->gs[x].v2 - v1 + famp);
-	
-				v1 = mt->gs2[x].v2;
-				mt->gs2[x].v2 = mt->gs2[x].v3;
-				mt->gs2[x].v3 = (float)(mt->gs2[x].fac*mt->gs2[x].v2 - v1 + famp);
-			}
-		}
+		/* gs2 shares the coefficients and the resets of gs so it always holds the same state */
+		goertzel_bank_update(gs, tones, sample_buffer + sample, limit - sample, 1);
+		memcpy(mt->gs2, mt->gs, tones * sizeof(mt->gs[0]));
 
 		mt->current_sample += (limit - sample);
 		if (mt->current_sample < mt->min_samples) {
@@ -310,10 +545,8 @@ TELETONE_API(teletone_hit_type_t) teletone_dtmf_detect (teletone_dtmf_detect_sta
 {
 	float row_energy[GRID_FACTOR];
 	float col_energy[GRID_FACTOR];
-	float famp;
-	float v1;
+	teletone_goertzel_state_t *gs[GRID_FACTOR * 4];
 	int i;
-	int j;
 	int sample;
 	int best_row;
 	int best_col;
@@ -321,6 +554,13 @@ TELETONE_API(teletone_hit_type_t) teletone_dtmf_detect (teletone_dtmf_detect_sta
 	int limit;
 	teletone_hit_type_t r = 0;
 
+	for (i = 0;	 i < GRID_FACTOR;  i++) {
+		gs[i] = &dtmf_detect_state->row_out[i];
+		gs[i + GRID_FACTOR] = &dtmf_detect_state->col_out[i];
+		gs[i + GRID_FACTOR * 2] = &dtmf_detect_state->row_out2nd[i];
+		gs[i + GRID_FACTOR * 3] = &dtmf_detect_state->col_out2nd[i];
+	}
+
 	for (sample = 0;  sample < samples;	 sample = limit) {
 		/* BLOCK_LEN is optimised to meet the DTMF specs. */
 		if ((samples - sample) >= (BLOCK_LEN - dtmf_detect_state->current_sample)) {
@@ -329,31 +569,8 @@ TELETONE_API(teletone_hit_type_t) teletone_dtmf_detect (teletone_dtmf_detect_sta
 			limit = samples;
 		}
 
-		for (j = sample;  j < limit;  j++) {
-			int x = 0;
-			famp = sample_buffer[j];
-			
-			dtmf_detect_state->energy += famp*famp;
-
-			for(x = 0; x < GRID_FACTOR; x++) {
-				v1 = dtmf_detect_state->row_out[x].v2;
-				dtmf_detect_state->row_out[x].v2 = dtmf_detect_state->row_out[x].v3;
-				dtmf_detect_state->row_out[x].v3 = (float)(dtmf_detect_state->row_out[x].fac*dtmf_detect_state->row_out[x].v2 - v1 + famp);
-	
-				v1 = dtmf_detect_state->col_out[x].v2;
-				dtmf_detect_state->col_out[x].v2 = dtmf_detect_state->col_out[x].v3;
-				dtmf_detect_state->col_out[x].v3 = (float)(dtmf_detect_state->col_out[x].fac*dtmf_detect_state->col_out[x].v2 - v1 + famp);
-
-				v1 = dtmf_detect_state->col_out2nd[x].v2;
-				dtmf_detect_state->col_out2nd[x].v2 = dtmf_detect_state->col_out2nd[x].v3;
-				dtmf_detect_state->col_out2nd[x].v3 = (float)(dtmf_detect_state->col_out2nd[x].fac*dtmf_detect_state->col_out2nd[x].v2 - v1 + famp);
-		
-				v1 = dtmf_detect_state->row_out2nd[x].v2;
-				dtmf_detect_state->row_out2nd[x].v2 = dtmf_detect_state->row_out2nd[x].v3;
-				dtmf_detect_state->row_out2nd[x].v3 = (float)(dtmf_detect_state->row_out2nd[x].fac*dtmf_detect_state->row_out2nd[x].v2 - v1 + famp);
-			}
-
-		}
+		dtmf_detect_state->energy = energy_update(dtmf_detect_state->energy, sample_buffer + sample, limit - sample);
+		goertzel_bank_update(gs, GRID_FACTOR * 4, sample_buffer + sample, limit - sample, 0);
 
 		if (dtmf_detect_state->zc > 0) {
 			if (dtmf_detect_state->energy < LOW_ENG && dtmf_detect_state->lenergy < LOW_ENG) {
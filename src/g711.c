@@ -32,6 +32,7 @@
 #endif
 #endif
 
+#include <switch_simd.h>
 #include "g711.h"
 
 /* Copied from the CCITT G.711 specification */
@@ -88,6 +89,600 @@ uint8_t ulaw_to_alaw(uint8_t ulaw)
 	return ulaw_to_alaw_table[ulaw];
 }
 
+/*- End of function --------------------------------------------------------*/
+
+/* Decoding tables, generated from ulaw_to_linear() and alaw_to_linear() */
+static const int16_t ulaw_to_linear_table[256] = {
+	-32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956,
+	-23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+	-15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412,
+	-11900, -11388, -10876, -10364, -9852, -9340, -8828, -8316,
+	-7932, -7676, -7420, -7164, -6908, -6652, -6396, -6140,
+	-5884, -5628, -5372, -5116, -4860, -4604, -4348, -4092,
+	-3900, -3772, -3644, -3516, -3388, -3260, -3132, -3004,
+	-2876, -2748, -2620, -2492, -2364, -2236, -2108, -1980,
+	-1884, -1820, -1756, -1692, -1628, -1564, -1500, -1436,
+	-1372, -1308, -1244, -1180, -1116, -1052, -988, -924,
+	-876, -844, -812, -780, -748, -716, -684, -652,
+	-620, -588, -556, -524, -492, -460, -428, -396,
+	-372, -356, -340, -324, -308, -292, -276, -260,
+	-244, -228, -212, -196, -180, -164, -148, -132,
+	-120, -112, -104, -96, -88, -80, -72, -64,
+	-56, -48, -40, -32, -24, -16, -8, 0,
+	32124, 31100, 30076, 29052, 28028, 27004, 25980, 24956,
+	23932, 22908, 21884, 20860, 19836, 18812, 17788, 16764,
+	15996, 15484, 14972, 14460, 13948, 13436, 12924, 12412,
+	11900, 11388, 10876, 10364, 9852, 9340, 8828, 8316,
+	7932, 7676, 7420, 7164, 6908, 6652, 6396, 6140,
+	5884, 5628, 5372, 5116, 4860, 4604, 4348, 4092,
+	3900, 3772, 3644, 3516, 3388, 3260, 3132, 3004,
+	2876, 2748, 2620, 2492, 2364, 2236, 2108, 1980,
+	1884, 1820, 1756, 1692, 1628, 1564, 1500, 1436,
+	1372, 1308, 1244, 1180, 1116, 1052, 988, 924,
+	876, 844, 812, 780, 748, 716, 684, 652,
+	620, 588, 556, 524, 492, 460, 428, 396,
+	372, 356, 340, 324, 308, 292, 276, 260,
+	244, 228, 212, 196, 180, 164, 148, 132,
+	120, 112, 104, 96, 88, 80, 72, 64,
+	56, 48, 40, 32, 24, 16, 8, 0
+};
+
+static const int16_t alaw_to_linear_table[256] = {
+	-5504, -5248, -6016, -5760, -4480, -4224, -4992, -4736,
+	-7552, -7296, -8064, -7808, -6528, -6272, -7040, -6784,
+	-2752, -2624, -3008, -2880, -2240, -2112, -2496, -2368,
+	-3776, -3648, -4032, -3904, -3264, -3136, -3520, -3392,
+	-22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+	-30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+	-11008, -10496, -12032, -11520, -8960, -8448, -9984, -9472,
+	-15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+	-344, -328, -376, -360, -280, -264, -312, -296,
+	-472, -456, -504, -488, -408, -392, -440, -424,
+	-88, -72, -120, -104, -24, -8, -56, -40,
+	-216, -200, -248, -232, -152, -136, -184, -168,
+	-1376, -1312, -1504, -1440, -1120, -1056, -1248, -1184,
+	-1888, -1824, -2016, -1952, -1632, -1568, -1760, -1696,
+	-688, -656, -752, -720, -560, -528, -624, -592,
+	-944, -912, -1008, -976, -816, -784, -880, -848,
+	5504, 5248, 6016, 5760, 4480, 4224, 4992, 4736,
+	7552, 7296, 8064, 7808, 6528, 6272, 7040, 6784,
+	2752, 2624, 3008, 2880, 2240, 2112, 2496, 2368,
+	3776, 3648, 4032, 3904, 3264, 3136, 3520, 3392,
+	22016, 20992, 24064, 23040, 17920, 16896, 19968, 18944,
+	30208, 29184, 32256, 31232, 26112, 25088, 28160, 27136,
+	11008, 10496, 12032, 11520, 8960, 8448, 9984, 9472,
+	15104, 14592, 16128, 15616, 13056, 12544, 14080, 13568,
+	344, 328, 376, 360, 280, 264, 312, 296,
+	472, 456, 504, 488, 408, 392, 440, 424,
+	88, 72, 120, 104, 24, 8, 56, 40,
+	216, 200, 248, 232, 152, 136, 184, 168,
+	1376, 1312, 1504, 1440, 1120, 1056, 1248, 1184,
+	1888, 1824, 2016, 1952, 1632, 1568, 1760, 1696,
+	688, 656, 752, 720, 560, 528, 624, 592,
+	944, 912, 1008, 976, 816, 784, 880, 848
+};
+
+/*
+ * Block conversion.  The vector kernels do the same segment/mantissa arithmetic as the inline
+ * functions in g711.h, eight or sixteen lanes at a time.  Each returns how many samples it handled
+ * and the caller finishes the rest with the scalar code.
+ *
+ * Encoding: the segment is the number of thresholds the magnitude reaches, the mantissa is
+ * (magnitude >> shift) done as an unsigned high multiply by a power of two that is halved for every
+ * threshold reached, since SSE2 has no per lane shifts.  Out of range u-law values come out right
+ * through the saturating bias.  Decoding: the mantissa is scaled by 2^seg, built from the three
+ * segment bits, with a low multiply.
+ */
+#ifdef SWITCH_HAVE_SSE2
+static inline __m128i g711_select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128i ulaw_encode_sse2(__m128i x)
+{
+	const __m128i bias = _mm_set1_epi16(ULAW_BIAS);
+	__m128i neg = _mm_srai_epi16(x, 15);
+	__m128i lin = g711_select_sse2(neg, _mm_subs_epi16(bias, x), _mm_adds_epi16(x, bias));
+	__m128i seg = _mm_setzero_si128();
+	__m128i mul = _mm_set1_epi16(1 << 13);
+	__m128i ge, code;
+	int k;
+
+	for (k = 8; k <= 14; k++) {
+		ge = _mm_cmpgt_epi16(lin, _mm_set1_epi16((1 << k) - 1));
+		seg = _mm_sub_epi16(seg, ge);
+		mul = _mm_sub_epi16(mul, _mm_and_si128(_mm_srli_epi16(mul, 1), ge));
+	}
+
+	code = _mm_or_si128(_mm_slli_epi16(seg, 4), _mm_and_si128(_mm_mulhi_epu16(lin, mul), _mm_set1_epi16(0x0F)));
+	code = _mm_xor_si128(code, _mm_xor_si128(_mm_set1_epi16(0xFF), _mm_and_si128(neg, _mm_set1_epi16(0x80))));
+#ifdef ULAW_ZEROTRAP
+	code = _mm_or_si128(code, _mm_and_si128(_mm_cmpeq_epi16(code, _mm_setzero_si128()), _mm_set1_epi16(0x02)));
+#endif
+	return code;
+}
+
+static inline __m128i alaw_encode_sse2(__m128i x)
+{
+	__m128i neg = _mm_srai_epi16(x, 15);
+	__m128i lin = g711_select_sse2(neg, _mm_sub_epi16(_mm_set1_epi16(-8), x), x);
+	__m128i seg = _mm_setzero_si128();
+	__m128i mul = _mm_set1_epi16(1 << 12);
+	__m128i ge, code;
+	int k;
+
+	/* -1 .. -7 are "just a tiny step below zero" */
+	lin = _mm_max_epi16(lin, _mm_setzero_si128());
+
+	for (k = 8; k <= 14; k++) {
+		ge = _mm_cmpgt_epi16(lin, _mm_set1_epi16((1 << k) - 1));
+		seg = _mm_sub_epi16(seg, ge);
+		if (k > 8) {
+			mul = _mm_sub_epi16(mul, _mm_and_si128(_mm_srli_epi16(mul, 1), ge));
+		}
+	}
+
+	code = _mm_or_si128(_mm_slli_epi16(seg, 4), _mm_and_si128(_mm_mulhi_epu16(lin, mul), _mm_set1_epi16(0x0F)));
+	return _mm_xor_si128(code, _mm_xor_si128(_mm_set1_epi16(ALAW_AMI_MASK | 0x80), _mm_and_si128(neg, _mm_set1_epi16(0x80))));
+}
+
+static inline __m128i g711_seg_scale_sse2(__m128i v)
+{
+	__m128i m = _mm_set1_epi16(1);
+	__m128i bit;
+
+	bit = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(0x10)), _mm_set1_epi16(0x10));
+	m = g711_select_sse2(bit, _mm_slli_epi16(m, 1), m);
+	bit = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(0x20)), _mm_set1_epi16(0x20));
+	m = g711_select_sse2(bit, _mm_slli_epi16(m, 2), m);
+	bit = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(0x40)), _mm_set1_epi16(0x40));
+	return g711_select_sse2(bit, _mm_slli_epi16(m, 4), m);
+}
+
+static inline __m128i ulaw_decode_sse2(__m128i u)
+{
+	const __m128i bias = _mm_set1_epi16(ULAW_BIAS);
+	__m128i t, sign;
+
+	u = _mm_xor_si128(u, _mm_set1_epi16(0xFF));
+	t = _mm_add_epi16(_mm_slli_epi16(_mm_and_si128(u, _mm_set1_epi16(0x0F)), 3), bias);
+	t = _mm_mullo_epi16(t, g711_seg_scale_sse2(u));
+	sign = _mm_cmpeq_epi16(_mm_and_si128(u, _mm_set1_epi16(0x80)), _mm_set1_epi16(0x80));
+	return g711_select_sse2(sign, _mm_sub_epi16(bias, t), _mm_sub_epi16(t, bias));
+}
+
+static inline __m128i alaw_decode_sse2(__m128i a)
+{
+	__m128i i, seg0, sign;
+
+	a = _mm_xor_si128(a, _mm_set1_epi16(ALAW_AMI_MASK));
+	seg0 = _mm_cmpeq_epi16(_mm_and_si128(a, _mm_set1_epi16(0x70)), _mm_setzero_si128());
+	i = _mm_slli_epi16(_mm_and_si128(a, _mm_set1_epi16(0x0F)), 4);
+	i = _mm_add_epi16(i, g711_select_sse2(seg0, _mm_set1_epi16(8), _mm_set1_epi16(0x108)));
+	i = _mm_mullo_epi16(i, _mm_max_epi16(_mm_srli_epi16(g711_seg_scale_sse2(a), 1), _mm_set1_epi16(1)));
+	sign = _mm_cmpeq_epi16(_mm_and_si128(a, _mm_set1_epi16(0x80)), _mm_set1_epi16(0x80));
+	return g711_select_sse2(sign, i, _mm_sub_epi16(_mm_setzero_si128(), i));
+}
+
+static int ulaw_encode_block_sse2(uint8_t *ulaw, const int16_t *amp, int len)
+{
+	int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m128i lo = ulaw_encode_sse2(_mm_loadu_si128((const __m128i *) (amp + i)));
+		__m128i hi = ulaw_encode_sse2(_mm_loadu_si128((const __m128i *) (amp + i + 8)));
+		_mm_storeu_si128((__m128i *) (ulaw + i), _mm_packus_epi16(lo, hi));
+	}
+
+	return i;
+}
+
+static int alaw_encode_block_sse2(uint8_t *alaw, const int16_t *amp, int len)
+{
+	int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m128i lo = alaw_encode_sse2(_mm_loadu_si128((const __m128i *) (amp + i)));
+		__m128i hi = alaw_encode_sse2(_mm_loadu_si128((const __m128i *) (amp + i + 8)));
+		_mm_storeu_si128((__m128i *) (alaw + i), _mm_packus_epi16(lo, hi));
+	}
+
+	return i;
+}
+
+static int ulaw_decode_block_sse2(int16_t *amp, const uint8_t *ulaw, int len)
+{
+	int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (ulaw + i));
+		_mm_storeu_si128((__m128i *) (amp + i), ulaw_decode_sse2(_mm_unpacklo_epi8(v, _mm_setzero_si128())));
+		_mm_storeu_si128((__m128i *) (amp + i + 8), ulaw_decode_sse2(_mm_unpackhi_epi8(v, _mm_setzero_si128())));
+	}
+
+	return i;
+}
+
+static int alaw_decode_block_sse2(int16_t *amp, const uint8_t *alaw, int len)
+{
+	int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (alaw + i));
+		_mm_storeu_si128((__m128i *) (amp + i), alaw_decode_sse2(_mm_unpacklo_epi8(v, _mm_setzero_si128())));
+		_mm_storeu_si128((__m128i *) (amp + i + 8), alaw_decode_sse2(_mm_unpackhi_epi8(v, _mm_setzero_si128())));
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_AVX2
+static inline SWITCH_TARGET_AVX2 __m256i ulaw_encode_avx2(__m256i x)
+{
+	const __m256i bias = _mm256_set1_epi16(ULAW_BIAS);
+	__m256i neg = _mm256_srai_epi16(x, 15);
+	__m256i lin = _mm256_blendv_epi8(_mm256_adds_epi16(x, bias), _mm256_subs_epi16(bias, x), neg);
+	__m256i seg = _mm256_setzero_si256();
+	__m256i mul = _mm256_set1_epi16(1 << 13);
+	__m256i ge, code;
+	int k;
+
+	for (k = 8; k <= 14; k++) {
+		ge = _mm256_cmpgt_epi16(lin, _mm256_set1_epi16((1 << k) - 1));
+		seg = _mm256_sub_epi16(seg, ge);
+		mul = _mm256_sub_epi16(mul, _mm256_and_si256(_mm256_srli_epi16(mul, 1), ge));
+	}
+
+	code = _mm256_or_si256(_mm256_slli_epi16(seg, 4), _mm256_and_si256(_mm256_mulhi_epu16(lin, mul), _mm256_set1_epi16(0x0F)));
+	code = _mm256_xor_si256(code, _mm256_xor_si256(_mm256_set1_epi16(0xFF), _mm256_and_si256(neg, _mm256_set1_epi16(0x80))));
+#ifdef ULAW_ZEROTRAP
+	code = _mm256_or_si256(code, _mm256_and_si256(_mm256_cmpeq_epi16(code, _mm256_setzero_si256()), _mm256_set1_epi16(0x02)));
+#endif
+	return code;
+}
+
+static inline SWITCH_TARGET_AVX2 __m256i alaw_encode_avx2(__m256i x)
+{
+	__m256i neg = _mm256_srai_epi16(x, 15);
+	__m256i lin = _mm256_blendv_epi8(x, _mm256_sub_epi16(_mm256_set1_epi16(-8), x), neg);
+	__m256i seg = _mm256_setzero_si256();
+	__m256i mul = _mm256_set1_epi16(1 << 12);
+	__m256i ge, code;
+	int k;
+
+	lin = _mm256_max_epi16(lin, _mm256_setzero_si256());
+
+	for (k = 8; k <= 14; k++) {
+		ge = _mm256_cmpgt_epi16(lin, _mm256_set1_epi16((1 << k) - 1));
+		seg = _mm256_sub_epi16(seg, ge);
+		if (k > 8) {
+			mul = _mm256_sub_epi16(mul, _mm256_and_si256(_mm256_srli_epi16(mul, 1), ge));
+		}
+	}
+
+	code = _mm256_or_si256(_mm256_slli_epi16(seg, 4), _mm256_and_si256(_mm256_mulhi_epu16(lin, mul), _mm256_set1_epi16(0x0F)));
+	return _mm256_xor_si256(code, _mm256_xor_si256(_mm256_set1_epi16(ALAW_AMI_MASK | 0x80), _mm256_and_si256(neg, _mm256_set1_epi16(0x80))));
+}
+
+static inline SWITCH_TARGET_AVX2 __m256i g711_seg_scale_avx2(__m256i v)
+{
+	__m256i m = _mm256_set1_epi16(1);
+	__m256i bit;
+
+	bit = _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x10)), _mm256_set1_epi16(0x10));
+	m = _mm256_blendv_epi8(m, _mm256_slli_epi16(m, 1), bit);
+	bit = _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x20)), _mm256_set1_epi16(0x20));
+	m = _mm256_blendv_epi8(m, _mm256_slli_epi16(m, 2), bit);
+	bit = _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x40)), _mm256_set1_epi16(0x40));
+	return _mm256_blendv_epi8(m, _mm256_slli_epi16(m, 4), bit);
+}
+
+static inline SWITCH_TARGET_AVX2 __m256i ulaw_decode_avx2(__m256i u)
+{
+	const __m256i bias = _mm256_set1_epi16(ULAW_BIAS);
+	__m256i t, sign;
+
+	u = _mm256_xor_si256(u, _mm256_set1_epi16(0xFF));
+	t = _mm256_add_epi16(_mm256_slli_epi16(_mm256_and_si256(u, _mm256_set1_epi16(0x0F)), 3), bias);
+	t = _mm256_mullo_epi16(t, g711_seg_scale_avx2(u));
+	sign = _mm256_cmpeq_epi16(_mm256_and_si256(u, _mm256_set1_epi16(0x80)), _mm256_set1_epi16(0x80));
+	return _mm256_blendv_epi8(_mm256_sub_epi16(t, bias), _mm256_sub_epi16(bias, t), sign);
+}
+
+static inline SWITCH_TARGET_AVX2 __m256i alaw_decode_avx2(__m256i a)
+{
+	__m256i i, seg0, sign;
+
+	a = _mm256_xor_si256(a, _mm256_set1_epi16(ALAW_AMI_MASK));
+	seg0 = _mm256_cmpeq_epi16(_mm256_and_si256(a, _mm256_set1_epi16(0x70)), _mm256_setzero_si256());
+	i = _mm256_slli_epi16(_mm256_and_si256(a, _mm256_set1_epi16(0x0F)), 4);
+	i = _mm256_add_epi16(i, _mm256_blendv_epi8(_mm256_set1_epi16(0x108), _mm256_set1_epi16(8), seg0));
+	i = _mm256_mullo_epi16(i, _mm256_max_epi16(_mm256_srli_epi16(g711_seg_scale_avx2(a), 1), _mm256_set1_epi16(1)));
+	sign = _mm256_cmpeq_epi16(_mm256_and_si256(a, _mm256_set1_epi16(0x80)), _mm256_set1_epi16(0x80));
+	return _mm256_blendv_epi8(_mm256_sub_epi16(_mm256_setzero_si256(), i), i, sign);
+}
+
+static SWITCH_TARGET_AVX2 int ulaw_encode_block_avx2(uint8_t *ulaw, const int16_t *amp, int len)
+{
+	int i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		__m256i lo = ulaw_encode_avx2(_mm256_loadu_si256((const __m256i *) (amp + i)));
+		__m256i hi = ulaw_encode_avx2(_mm256_loadu_si256((const __m256i *) (amp + i + 16)));
+		/* packus works per 128 bit lane, put the quadwords back in order */
+		_mm256_storeu_si256((__m256i *) (ulaw + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8));
+	}
+
+	return i;
+}
+
+static SWITCH_TARGET_AVX2 int alaw_encode_block_avx2(uint8_t *alaw, const int16_t *amp, int len)
+{
+	int i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		__m256i lo = alaw_encode_avx2(_mm256_loadu_si256((const __m256i *) (amp + i)));
+		__m256i hi = alaw_encode_avx2(_mm256_loadu_si256((const __m256i *) (amp + i + 16)));
+		_mm256_storeu_si256((__m256i *) (alaw + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8));
+	}
+
+	return i;
+}
+
+static SWITCH_TARGET_AVX2 int ulaw_decode_block_avx2(int16_t *amp, const uint8_t *ulaw, int len)
+{
+	int i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		__m256i lo = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (ulaw + i)));
+		__m256i hi = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (ulaw + i + 16)));
+		_mm256_storeu_si256((__m256i *) (amp + i), ulaw_decode_avx2(lo));
+		_mm256_storeu_si256((__m256i *) (amp + i + 16), ulaw_decode_avx2(hi));
+	}
+
+	return i;
+}
+
+static SWITCH_TARGET_AVX2 int alaw_decode_block_avx2(int16_t *amp, const uint8_t *alaw, int len)
+{
+	int i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		__m256i lo = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (alaw + i)));
+		__m256i hi = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (alaw + i + 16)));
+		_mm256_storeu_si256((__m256i *) (amp + i), alaw_decode_avx2(lo));
+		_mm256_storeu_si256((__m256i *) (amp + i + 16), alaw_decode_avx2(hi));
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_NEON
+/* NEON has count leading zeros and per lane shifts, so the segment and mantissa come out directly */
+static inline uint16x8_t ulaw_encode_neon(int16x8_t x)
+{
+	const int16x8_t bias = vdupq_n_s16(ULAW_BIAS);
+	uint16x8_t neg = vcltq_s16(x, vdupq_n_s16(0));
+	uint16x8_t lin = vreinterpretq_u16_s16(vbslq_s16(neg, vqsubq_s16(bias, x), vqaddq_s16(x, bias)));
+	uint16x8_t seg = vsubq_u16(vdupq_n_u16(8), vclzq_u16(vorrq_u16(lin, vdupq_n_u16(0xFF))));
+	int16x8_t shift = vnegq_s16(vreinterpretq_s16_u16(vaddq_u16(seg, vdupq_n_u16(3))));
+	uint16x8_t code = vorrq_u16(vshlq_n_u16(seg, 4), vandq_u16(vshlq_u16(lin, shift), vdupq_n_u16(0x0F)));
+
+	code = veorq_u16(code, vbslq_u16(neg, vdupq_n_u16(0x7F), vdupq_n_u16(0xFF)));
+#ifdef ULAW_ZEROTRAP
+	code = vorrq_u16(code, vandq_u16(vceqq_u16(code, vdupq_n_u16(0)), vdupq_n_u16(0x02)));
+#endif
+	return code;
+}
+
+static inline uint16x8_t alaw_encode_neon(int16x8_t x)
+{
+	uint16x8_t neg = vcltq_s16(x, vdupq_n_s16(0));
+	int16x8_t slin = vmaxq_s16(vbslq_s16(neg, vsubq_s16(vdupq_n_s16(-8), x), x), vdupq_n_s16(0));
+	uint16x8_t lin = vreinterpretq_u16_s16(slin);
+	uint16x8_t seg = vsubq_u16(vdupq_n_u16(8), vclzq_u16(vorrq_u16(lin, vdupq_n_u16(0xFF))));
+	int16x8_t shift = vnegq_s16(vmaxq_s16(vreinterpretq_s16_u16(vaddq_u16(seg, vdupq_n_u16(3))), vdupq_n_s16(4)));
+	uint16x8_t code = vorrq_u16(vshlq_n_u16(seg, 4), vandq_u16(vshlq_u16(lin, shift), vdupq_n_u16(0x0F)));
+
+	return veorq_u16(code, vbslq_u16(neg, vdupq_n_u16(ALAW_AMI_MASK), vdupq_n_u16(ALAW_AMI_MASK | 0x80)));
+}
+
+static inline int16x8_t ulaw_decode_neon(uint16x8_t u)
+{
+	const int16x8_t bias = vdupq_n_s16(ULAW_BIAS);
+	int16x8_t t, seg;
+
+	u = veorq_u16(u, vdupq_n_u16(0xFF));
+	t = vaddq_s16(vreinterpretq_s16_u16(vshlq_n_u16(vandq_u16(u, vdupq_n_u16(0x0F)), 3)), bias);
+	seg = vreinterpretq_s16_u16(vshrq_n_u16(vandq_u16(u, vdupq_n_u16(0x70)), 4));
+	t = vshlq_s16(t, seg);
+	return vbslq_s16(vtstq_u16(u, vdupq_n_u16(0x80)), vsubq_s16(bias, t), vsubq_s16(t, bias));
+}
+
+static inline int16x8_t alaw_decode_neon(uint16x8_t a)
+{
+	int16x8_t i, seg;
+	uint16x8_t seg0;
+
+	a = veorq_u16(a, vdupq_n_u16(ALAW_AMI_MASK));
+	seg = vreinterpretq_s16_u16(vshrq_n_u16(vandq_u16(a, vdupq_n_u16(0x70)), 4));
+	seg0 = vceqq_s16(seg, vdupq_n_s16(0));
+	i = vreinterpretq_s16_u16(vshlq_n_u16(vandq_u16(a, vdupq_n_u16(0x0F)), 4));
+	i = vaddq_s16(i, vbslq_s16(seg0, vdupq_n_s16(8), vdupq_n_s16(0x108)));
+	i = vshlq_s16(i, vmaxq_s16(vsubq_s16(seg, vdupq_n_s16(1)), vdupq_n_s16(0)));
+	return vbslq_s16(vtstq_u16(a, vdupq_n_u16(0x80)), i, vnegq_s16(i));
+}
+
+static int ulaw_encode_block_neon(uint8_t *ulaw, const int16_t *amp, int len)
+{
+	int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		uint16x8_t lo = ulaw_encode_neon(vld1q_s16(amp + i));
+		uint16x8_t hi = ulaw_encode_neon(vld1q_s16(amp + i + 8));
+		vst1q_u8(ulaw + i, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+	}
+
+	return i;
+}
+
+static int alaw_encode_block_neon(uint8_t *alaw, const int16_t *amp, int len)
+{
+	int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		uint16x8_t lo = alaw_encode_neon(vld1q_s16(amp + i));
+		uint16x8_t hi = alaw_encode_neon(vld1q_s16(amp + i + 8));
+		vst1q_u8(alaw + i, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+	}
+
+	return i;
+}
+
+static int ulaw_decode_block_neon(int16_t *amp, const uint8_t *ulaw, int len)
+{
+	int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		uint8x16_t v = vld1q_u8(ulaw + i);
+		vst1q_s16(amp + i, ulaw_decode_neon(vmovl_u8(vget_low_u8(v))));
+		vst1q_s16(amp + i + 8, ulaw_decode_neon(vmovl_u8(vget_high_u8(v))));
+	}
+
+	return i;
+}
+
+static int alaw_decode_block_neon(int16_t *amp, const uint8_t *alaw, int len)
+{
+	int i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		uint8x16_t v = vld1q_u8(alaw + i);
+		vst1q_s16(amp + i, alaw_decode_neon(vmovl_u8(vget_low_u8(v))));
+		vst1q_s16(amp + i + 8, alaw_decode_neon(vmovl_u8(vget_high_u8(v))));
+	}
+
+	return i;
+}
+#endif
+
+static inline int ulaw_encode_block_simd(uint8_t *ulaw, const int16_t *amp, int len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return ulaw_encode_block_avx2(ulaw, amp, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return ulaw_encode_block_sse2(ulaw, amp, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return ulaw_encode_block_neon(ulaw, amp, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline int ulaw_decode_block_simd(int16_t *amp, const uint8_t *ulaw, int len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return ulaw_decode_block_avx2(amp, ulaw, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return ulaw_decode_block_sse2(amp, ulaw, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return ulaw_decode_block_neon(amp, ulaw, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline int alaw_encode_block_simd(uint8_t *alaw, const int16_t *amp, int len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return alaw_encode_block_avx2(alaw, amp, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return alaw_encode_block_sse2(alaw, amp, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return alaw_encode_block_neon(alaw, amp, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline int alaw_decode_block_simd(int16_t *amp, const uint8_t *alaw, int len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return alaw_decode_block_avx2(amp, alaw, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return alaw_decode_block_sse2(amp, alaw, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return alaw_decode_block_neon(amp, alaw, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+G711_DECLARE(void) g711_ulaw_encode_block(uint8_t *ulaw, const int16_t *amp, int len)
+{
+	int i;
+
+	for (i = ulaw_encode_block_simd(ulaw, amp, len); i < len; i++) {
+		ulaw[i] = linear_to_ulaw(amp[i]);
+	}
+}
+
+/*- End of function --------------------------------------------------------*/
+
+G711_DECLARE(void) g711_ulaw_decode_block(int16_t *amp, const uint8_t *ulaw, int len)
+{
+	int i;
+
+	for (i = ulaw_decode_block_simd(amp, ulaw, len); i < len; i++) {
+		amp[i] = ulaw_to_linear_table[ulaw[i]];
+	}
+}
+
+/*- End of function --------------------------------------------------------*/
+
+G711_DECLARE(void) g711_alaw_encode_block(uint8_t *alaw, const int16_t *amp, int len)
+{
+	int i;
+
+	for (i = alaw_encode_block_simd(alaw, amp, len); i < len; i++) {
+		alaw[i] = linear_to_alaw(amp[i]);
+	}
+}
+
+/*- End of function --------------------------------------------------------*/
+
+G711_DECLARE(void) g711_alaw_decode_block(int16_t *amp, const uint8_t *alaw, int len)
+{
+	int i;
+
+	for (i = alaw_decode_block_simd(amp, alaw, len); i < len; i++) {
+		amp[i] = alaw_to_linear_table[alaw[i]];
+	}
+}
+
 /*- End of function --------------------------------------------------------*/
 /*- End of file ------------------------------------------------------------*/
 
@@ -335,6 +335,42 @@ extern "C" {
 */
 	uint8_t ulaw_to_alaw(uint8_t ulaw);
 
+#ifdef SWITCH_DECLARE
+#define G711_DECLARE(type) SWITCH_DECLARE(type)
+#else
+#define G711_DECLARE(type) type
+#endif
+
+/*! \brief Encode a block of linear samples to u-law.
+    The output is identical to calling linear_to_ulaw() on every sample, but whole
+    frames are converted with the vector units when the cpu has them.
+    \param ulaw The u-law output buffer, len bytes.
+    \param amp The linear samples to encode.
+    \param len The number of samples.
+*/
+	G711_DECLARE(void) g711_ulaw_encode_block(uint8_t *ulaw, const int16_t *amp, int len);
+
+/*! \brief Decode a block of u-law samples to linear, see ulaw_to_linear().
+    \param amp The linear output buffer, len samples.
+    \param ulaw The u-law samples to decode.
+    \param len The number of samples.
+*/
+	G711_DECLARE(void) g711_ulaw_decode_block(int16_t *amp, const uint8_t *ulaw, int len);
+
+/*! \brief Encode a block of linear samples to A-law, see linear_to_alaw().
+    \param alaw The A-law output buffer, len bytes.
+    \param amp The linear samples to encode.
+    \param len The number of samples.
+*/
+	G711_DECLARE(void) g711_alaw_encode_block(uint8_t *alaw, const int16_t *amp, int len);
+
+/*! \brief Decode a block of A-law samples to linear, see alaw_to_linear().
+    \param amp The linear output buffer, len samples.
+    \param alaw The A-law samples to decode.
+    \param len The number of samples.
+*/
+	G711_DECLARE(void) g711_alaw_decode_block(int16_t *amp, const uint8_t *alaw, int len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -173,8 +173,8 @@ struct switch_core_session {
 };
 
 struct switch_media_bug {
-	switch_buffer_t *raw_write_buffer;
-	switch_buffer_t *raw_read_buffer;
+	switch_spsc_buffer_t *raw_write_buffer;
+	switch_spsc_buffer_t *raw_read_buffer;
 	switch_frame_t *read_replace_frame_in;
 	switch_frame_t *read_replace_frame_out;
 	switch_frame_t *write_replace_frame_in;
@@ -317,4 +317,14 @@ void switch_core_session_init(switch_memory_pool_t *pool);
 void switch_core_session_uninit(void);
 void switch_core_state_machine_init(switch_memory_pool_t *pool);
 switch_memory_pool_t *switch_core_memory_init(void);
+void switch_core_file_cache_init(switch_memory_pool_t *pool);
+void switch_core_file_cache_destroy(void);
+void switch_core_speech_cache_init(switch_memory_pool_t *pool);
+void switch_core_speech_cache_destroy(void);
+void switch_core_image_cache_init(switch_memory_pool_t *pool);
+void switch_core_image_cache_destroy(void);
+void switch_core_video_band_init(void);
+void switch_core_video_band_destroy(void);
+void switch_resample_pool_init(switch_memory_pool_t *pool);
+void switch_resample_pool_destroy(void);
 void switch_core_memory_stop(void);
@@ -166,6 +166,66 @@ SWITCH_DECLARE(switch_size_t) switch_buffer_zwrite(_In_ switch_buffer_t *buffer,
 
 SWITCH_DECLARE(void *) switch_buffer_get_head_pointer(switch_buffer_t *buffer);
 
+/*! \brief Allocate a new single producer single consumer ring buffer
+ * \param buffer returned pointer to the new buffer
+ * \param size capacity in bytes, rounded up to a power of two
+ * \return status
+ * \note one thread may write while one other thread reads without any locking,
+ *       several readers or several writers have to be serialized by the caller
+ */
+SWITCH_DECLARE(switch_status_t) switch_spsc_buffer_create(_Out_ switch_spsc_buffer_t **buffer, _In_ switch_size_t size);
+
+/*! \brief Destroy a single producer single consumer ring buffer
+ * \param buffer buffer to destroy
+ */
+SWITCH_DECLARE(void) switch_spsc_buffer_destroy(switch_spsc_buffer_t **buffer);
+
+/*! \brief Get the capacity of a switch_spsc_buffer_t
+ * \param buffer any buffer of type switch_spsc_buffer_t
+ * \return int size of the buffer.
+ */
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_len(_In_ switch_spsc_buffer_t *buffer);
+
+/*! \brief Get the in use amount of a switch_spsc_buffer_t as seen by the consumer
+ * \param buffer any buffer of type switch_spsc_buffer_t
+ * \return int size of buffer curently in use
+ */
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_inuse(_In_ switch_spsc_buffer_t *buffer);
+
+/*! \brief Get the freespace of a switch_spsc_buffer_t as seen by the producer
+ * \param buffer any buffer of type switch_spsc_buffer_t
+ * \return int freespace in the buffer
+ */
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_freespace(_In_ switch_spsc_buffer_t *buffer);
+
+/*! \brief Write data into a switch_spsc_buffer_t, producer side
+ * \param buffer any buffer of type switch_spsc_buffer_t
+ * \param data pointer to the data to be written
+ * \param datalen amount of data to be written
+ * \return datalen, or 0 and nothing written when it does not fit
+ */
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_write(_In_ switch_spsc_buffer_t *buffer, _In_bytecount_(datalen) const void *data, _In_ switch_size_t datalen);
+
+/*! \brief Read data from a switch_spsc_buffer_t up to the ammount of datalen if it is available, consumer side
+ * \param buffer any buffer of type switch_spsc_buffer_t
+ * \param data pointer to the read data to be returned
+ * \param datalen amount of data to be returned
+ * \return int ammount of data actually read
+ */
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_read(_In_ switch_spsc_buffer_t *buffer, _In_ void *data, _In_ switch_size_t datalen);
+
+/*! \brief Remove data from a switch_spsc_buffer_t, consumer side
+ * \param buffer any buffer of type switch_spsc_buffer_t
+ * \param datalen amount of data to be removed
+ * \return size of buffer, or 0 if unable to toss that much data
+ */
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_toss(_In_ switch_spsc_buffer_t *buffer, _In_ switch_size_t datalen);
+
+/*! \brief Remove all data written so far, consumer side
+ * \param buffer any buffer of type switch_spsc_buffer_t
+ */
+SWITCH_DECLARE(void) switch_spsc_buffer_zero(_In_ switch_spsc_buffer_t *buffer);
+
 /** @} */
 
 SWITCH_END_EXTERN_C
@@ -1972,6 +1972,13 @@ SWITCH_DECLARE(switch_status_t) switch_core_perform_file_open(const char *file,
 */
 SWITCH_DECLARE(switch_status_t) switch_core_file_read(_In_ switch_file_handle_t *fh, void *data, switch_size_t *len);
 
+/*!
+  \brief Fill the read buffer of a file handle opened with pre_buffer_datalen set, without consuming anything
+  \param fh the file handle to read ahead on
+  \return SWITCH_STATUS_SUCCESS if there is buffered data to read
+*/
+SWITCH_DECLARE(switch_status_t) switch_core_file_read_ahead(_In_ switch_file_handle_t *fh);
+
 /*!
   \brief Write media to a file handle
   \param fh the file handle to write to
@@ -2036,6 +2043,24 @@ SWITCH_DECLARE(switch_status_t) switch_core_file_pre_close(_In_ switch_file_hand
 
 SWITCH_DECLARE(switch_status_t) switch_core_file_handle_dup(switch_file_handle_t *oldfh, switch_file_handle_t **newfh, switch_memory_pool_t *pool);
 
+/*!
+  \brief Configure the cache of decoded audio used for repeated file playback
+  \param max_bytes total memory the cache may use (0 to disable)
+  \param max_file_bytes largest single decoded file that will be cached (0 for no limit besides max_bytes)
+*/
+SWITCH_DECLARE(void) switch_core_file_cache_configure(switch_size_t max_bytes, switch_size_t max_file_bytes);
+
+/*!
+  \brief Drop every cached file, entries still being played are freed when their last reader closes
+*/
+SWITCH_DECLARE(void) switch_core_file_cache_flush(void);
+
+/*!
+  \brief Write the file cache counters to a stream
+  \param stream the stream to write to
+*/
+SWITCH_DECLARE(void) switch_core_file_cache_status(switch_stream_handle_t *stream);
+
 /*!
   \brief Close an open file handle
   \param fh the file handle to close
@@ -2129,6 +2154,24 @@ SWITCH_DECLARE(switch_status_t) switch_core_speech_read_tts(switch_speech_handle
 */
 SWITCH_DECLARE(switch_status_t) switch_core_speech_close(switch_speech_handle_t *sh, switch_speech_flag_t *flags);
 
+/*!
+  \brief Configure the cache of synthesized speech shared by all speech handles
+  \param max_bytes total memory the cache may use (0 to disable)
+  \param dir directory where synthesized audio is also kept across restarts (NULL for memory only)
+*/
+SWITCH_DECLARE(void) switch_core_speech_cache_configure(switch_size_t max_bytes, const char *dir);
+
+/*!
+  \brief Drop every cached text from memory, entries still being played are freed when their last reader is done
+*/
+SWITCH_DECLARE(void) switch_core_speech_cache_flush(void);
+
+/*!
+  \brief Write the speech cache counters to a stream
+  \param stream the stream to write to
+*/
+SWITCH_DECLARE(void) switch_core_speech_cache_status(switch_stream_handle_t *stream);
+
 
 /*!
   \brief Open an asr handle
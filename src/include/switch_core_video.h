@@ -451,6 +451,37 @@ SWITCH_DECLARE(switch_status_t) switch_img_to_raw(switch_image_t *src, void *des
 SWITCH_DECLARE(switch_status_t) switch_img_from_raw(switch_image_t *dest, void *src, switch_img_fmt_t fmt, int width, int height);
 SWITCH_DECLARE(switch_image_t *) switch_img_write_text_img(int w, int h, switch_bool_t full, const char *text);
 
+/*! default memory budget of the rendered image cache */
+#define SWITCH_IMG_CACHE_DEFAULT_SIZE (16 * 1024 * 1024)
+
+/*!\brief Look up a rendered image (text banner, decoded png ...) in the process wide image cache
+*
+* \param[in]    key       Everything that went into producing the image (text, font, size, colors, dimensions ...)
+* \return       A copy of the cached image the caller must free, NULL on a miss
+*/
+SWITCH_DECLARE(switch_image_t *) switch_img_cache_get(const char *key);
+
+/*!\brief Store a copy of a rendered image in the process wide image cache, least recently used images are evicted
+*
+* \param[in]    key       The lookup key
+* \param[in]    img       The image, still owned by the caller
+*/
+SWITCH_DECLARE(void) switch_img_cache_put(const char *key, switch_image_t *img);
+
+/*!\brief Set the memory budget of the image cache
+*
+* \param[in]    max_bytes Total bytes the cache may use, 0 disables it
+*/
+SWITCH_DECLARE(void) switch_img_cache_configure(switch_size_t max_bytes);
+SWITCH_DECLARE(void) switch_img_cache_flush(void);
+SWITCH_DECLARE(void) switch_img_cache_status(switch_stream_handle_t *stream);
+
+/*!\brief Set how many helper threads may split the rows of large images (chromakey, alpha patching)
+*
+* \param[in]    threads   Number of helpers, 0 keeps everything on the calling thread, -1 picks one less than the cpu count
+*/
+SWITCH_DECLARE(void) switch_img_set_band_threads(int threads);
+
 SWITCH_DECLARE(switch_image_t *) switch_img_read_file(const char* file_name);
 SWITCH_DECLARE(switch_status_t) switch_img_letterbox(switch_image_t *img, switch_image_t **imgP, int width, int height, const char *color);
 SWITCH_DECLARE(switch_bool_t) switch_core_has_video(void);
@@ -384,6 +384,8 @@ struct switch_file_handle {
 	int64_t vpos;
 	void *muxbuf;
 	switch_size_t muxlen;
+	/*! decoded audio being captured for the core file cache */
+	struct switch_file_cache_fill_s *cache_fill;
 };
 
 /*! \brief Abstract interface to an asr module */
@@ -515,6 +517,8 @@ struct switch_speech_handle {
 
 	/*! private data for the format module to store handle specific info */
 	void *private_info;
+	/*! synthesized speech cache state, NULL when the cache is off */
+	struct switch_speech_cache_s *cache;
 };
 
 /*! \brief Abstract interface to a say module */
@@ -45,6 +45,14 @@ typedef enum {
     SPT_INVALID_STREAM
 } switch_packetizer_bitstream_t;
 
+/* one piece of a packet as handed out by switch_packetizer_read_iov */
+typedef struct switch_packetizer_iov_s {
+    const void *base;
+    uint32_t len;
+} switch_packetizer_iov_t;
+
+#define SWITCH_PACKETIZER_MAX_IOV 2
+
 /*
 
     create a packetizer and feed data, to avoid data copy, data MUST be valid before the next feed, or before close.
@@ -55,6 +63,15 @@ SWITCH_DECLARE(switch_packetizer_t *) switch_packetizer_create(switch_packetizer
 SWITCH_DECLARE(switch_status_t) switch_packetizer_feed(switch_packetizer_t *packetizer, void *data, uint32_t size);
 SWITCH_DECLARE(switch_status_t) switch_packetizer_feed_extradata(switch_packetizer_t *packetizer, void *data, uint32_t size);
 SWITCH_DECLARE(switch_status_t) switch_packetizer_read(switch_packetizer_t *packetizer, switch_frame_t *frame);
+
+/*
+
+    same as switch_packetizer_read but without the copy, iov MUST have room for SWITCH_PACKETIZER_MAX_IOV entries.
+    the pieces point into the fed data or the packetizer itself and are valid until the next read, feed or close.
+    m is set on the last packet of the access unit.
+
+ */
+SWITCH_DECLARE(switch_status_t) switch_packetizer_read_iov(switch_packetizer_t *packetizer, switch_packetizer_iov_t *iov, int *iovcnt, switch_bool_t *m);
 SWITCH_DECLARE(void) switch_packetizer_close(switch_packetizer_t **packetizer);
 
 #endif
@@ -70,6 +70,10 @@ SWITCH_BEGIN_EXTERN_C
 	uint32_t to_size;
 	/*! the number of channels */
 	int channels;
+	/*! the quality the handle was created with */
+	int quality;
+	/*! filter state when an integer ratio is handled without speex */
+	struct switch_resample_fir_s *fir;
 
 } switch_audio_resampler_t;
 
@@ -91,6 +95,7 @@ SWITCH_DECLARE(switch_status_t) switch_resample_perform_create(switch_audio_resa
 /*!
   \brief Destroy an existing resampler handle
   \param resampler the resampler handle to destroy
+  \note the handle may be kept in a pool and handed out again by switch_resample_create()
  */
 SWITCH_DECLARE(void) switch_resample_destroy(switch_audio_resampler_t **resampler);
 
@@ -103,6 +108,12 @@ SWITCH_DECLARE(void) switch_resample_destroy(switch_audio_resampler_t **resample
  */
 SWITCH_DECLARE(uint32_t) switch_resample_process(switch_audio_resampler_t *resampler, int16_t *src, uint32_t srclen);
 
+/*!
+  \brief Enable or disable the built in filters for 2x, 3x, 4x and 6x rate changes (8k/16k/24k/32k/48k)
+  \param enabled when false every new handle uses speex
+ */
+SWITCH_DECLARE(void) switch_resample_set_fast_ratios(switch_bool_t enabled);
+
 
 /*!
   \brief Convert an array of floats to an array of shorts
@@ -176,6 +187,24 @@ SWITCH_DECLARE(uint32_t) switch_merge_sln(int16_t *data, uint32_t samples, int16
 SWITCH_DECLARE(uint32_t) switch_unmerge_sln(int16_t *data, uint32_t samples, int16_t *other_data, uint32_t other_samples, int channels);
 SWITCH_DECLARE(void) switch_mux_channels(int16_t *data, switch_size_t samples, uint32_t orig_channels, uint32_t channels);
 
+/*!
+  \brief Add signed linear samples into a 32 bit mix accumulator
+  \param acc the accumulator
+  \param data the samples to add
+  \param samples the number of 2 byte samples (all channels)
+*/
+SWITCH_DECLARE(void) switch_accumulate_sln(int32_t *acc, const int16_t *data, uint32_t samples);
+
+/*!
+  \brief Write a mix back to signed linear, optionally taking one contribution out of it first
+  \param data the destination
+  \param acc the accumulator filled by switch_accumulate_sln
+  \param other_data the contribution to remove or NULL
+  \param samples the number of 2 byte samples (all channels)
+  \note the result saturates at the 16 bit range
+*/
+SWITCH_DECLARE(void) switch_mix_minus_sln(int16_t *data, const int32_t *acc, const int16_t *other_data, uint32_t samples);
+
 #define switch_resample_calc_buffer_size(_to, _from, _srclen) ((uint32_t)(((float)_to / (float)_from) * (float)_srclen) * 2)
 
 SWITCH_DECLARE(void) switch_agc_set(switch_agc_t *agc, uint32_t energy_avg, 
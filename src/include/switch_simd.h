@@ -0,0 +1,112 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Anthony Minessale II <anthm@freeswitch.org>
+ *
+ *
+ * switch_simd.h -- SIMD feature detection for media kernels
+ *
+ */
+/*! \file switch_simd.h
+    \brief SIMD feature detection
+
+	Media helpers that carry vector code include this header to learn which instruction sets the compiler can emit
+	(SWITCH_HAVE_SSE2, SWITCH_HAVE_AVX2, SWITCH_HAVE_NEON) and ask switch_simd_flags() at runtime which of them the
+	cpu actually has.  SSE2 is part of the x86_64 baseline and NEON of aarch64, AVX2 functions are compiled with
+	SWITCH_TARGET_AVX2 and must only be called when SWITCH_SIMD_AVX2 is set.  Every vector path has a scalar
+	equivalent producing identical output.
+
+	This header is not pulled in by switch.h on purpose, the intrinsic headers are large.
+*/
+#ifndef SWITCH_SIMD_H
+#define SWITCH_SIMD_H
+
+#include <switch.h>
+
+#if !defined(SWITCH_NO_SIMD)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SWITCH_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(SWITCH_HAVE_SSE2) && !defined(SWITCH_NO_AVX2) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SWITCH_HAVE_AVX2 1
+#define SWITCH_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(SWITCH_HAVE_SSE2) && !defined(SWITCH_NO_AVX2) && defined(_MSC_VER)
+#define SWITCH_HAVE_AVX2 1
+#define SWITCH_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define SWITCH_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#endif
+
+SWITCH_BEGIN_EXTERN_C
+
+typedef enum {
+	SWITCH_SIMD_NONE = 0,
+	SWITCH_SIMD_SSE2 = (1 << 0),
+	SWITCH_SIMD_AVX2 = (1 << 1),
+	SWITCH_SIMD_NEON = (1 << 2)
+} switch_simd_flag_enum_t;
+typedef uint32_t switch_simd_flag_t;
+
+/*!
+  \brief Instruction sets both compiled in and supported by the running cpu
+*/
+SWITCH_DECLARE(switch_simd_flag_t) switch_simd_cpu_flags(void);
+
+/*!
+  \brief Instruction sets the media kernels are currently allowed to use
+*/
+SWITCH_DECLARE(switch_simd_flag_t) switch_simd_flags(void);
+
+/*!
+  \brief Restrict the instruction sets the media kernels may use (for testing and benchmarking)
+  \param flags the wanted sets, anything the cpu lacks is dropped
+  \return the sets now in use
+*/
+SWITCH_DECLARE(switch_simd_flag_t) switch_simd_set_flags(switch_simd_flag_t flags);
+
+SWITCH_DECLARE(const char *) switch_simd_flags2str(switch_simd_flag_t flags);
+
+SWITCH_END_EXTERN_C
+#endif
+/* For Emacs:
+ * Local Variables:
+ * mode:c
+ * indent-tabs-mode:t
+ * tab-width:4
+ * c-basic-offset:4
+ * End:
+ * For VIM:
+ * vim:set softtabstop=4 shiftwidth=4 tabstop=4 noet:
+ */
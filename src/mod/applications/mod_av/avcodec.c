@@ -1159,6 +1159,12 @@ static switch_status_t consume_nalu(h264_codec_context_t *context, switch_frame_
 		return SWITCH_STATUS_NOTFOUND;
 	}
 
+	if ((pkt->flags & AV_PKT_FLAG_KEY)) {
+		switch_set_flag(frame, SFF_IS_KEYFRAME);
+	} else {
+		switch_clear_flag(frame, SFF_IS_KEYFRAME);
+	}
+
 	if (context->av_codec_id == AV_CODEC_ID_H263) {
 		return consume_h263_bitstream(context, frame);
 	}
@@ -9,6 +9,7 @@
 #endif
 
 #include <switch.h>
+#include <switch_simd.h>
 #include <stdio.h>
 
 #ifdef WIN32
@@ -69,3 +70,119 @@ avmd_desa2_tweaked(circ_buffer_t *b, size_t i, double *amplitude) {
 	*amplitude = 2.0 * PSI_Xn / sqrt(PSI_Yn);
 	return result;
 }
+
+/* The vector kernels below evaluate exactly the expressions
+ * of avmd_desa2_tweaked, in the same order, on 2 (SSE2, NEON)
+ * or 4 (AVX2) neighbouring positions at once. x points at the
+ * first sample of the window, they return how many positions
+ * they did.
+ */
+#ifdef SWITCH_HAVE_SSE2
+static size_t
+avmd_desa2_tweaked_sse2(const double *x, size_t n, double *omega, double *amplitude) {
+	const __m128d two = _mm_set1_pd(2.0);
+	size_t k;
+
+	for (k = 0; k + 2 <= n; k += 2) {
+		__m128d x0 = _mm_loadu_pd(x + k);
+		__m128d x1 = _mm_loadu_pd(x + k + 1);
+		__m128d x2 = _mm_loadu_pd(x + k + 2);
+		__m128d x3 = _mm_loadu_pd(x + k + 3);
+		__m128d x4 = _mm_loadu_pd(x + k + 4);
+		__m128d x2sq = _mm_mul_pd(x2, x2);
+		__m128d d = _mm_mul_pd(two, _mm_sub_pd(x2sq, _mm_mul_pd(x1, x3)));
+		__m128d psi_x = _mm_sub_pd(x2sq, _mm_mul_pd(x0, x4));
+		__m128d needed = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(x1, x1), _mm_mul_pd(x0, x2)), _mm_sub_pd(_mm_mul_pd(x3, x3), _mm_mul_pd(x2, x4)));
+		__m128d psi_y = _mm_add_pd(needed, psi_x);
+
+		_mm_storeu_pd(omega + k, _mm_div_pd(_mm_sub_pd(psi_x, needed), d));
+		_mm_storeu_pd(amplitude + k, _mm_div_pd(_mm_mul_pd(two, psi_x), _mm_sqrt_pd(psi_y)));
+	}
+
+	return k;
+}
+#endif
+
+#ifdef SWITCH_HAVE_AVX2
+static SWITCH_TARGET_AVX2 size_t
+avmd_desa2_tweaked_avx2(const double *x, size_t n, double *omega, double *amplitude) {
+	const __m256d two = _mm256_set1_pd(2.0);
+	size_t k;
+
+	for (k = 0; k + 4 <= n; k += 4) {
+		__m256d x0 = _mm256_loadu_pd(x + k);
+		__m256d x1 = _mm256_loadu_pd(x + k + 1);
+		__m256d x2 = _mm256_loadu_pd(x + k + 2);
+		__m256d x3 = _mm256_loadu_pd(x + k + 3);
+		__m256d x4 = _mm256_loadu_pd(x + k + 4);
+		__m256d x2sq = _mm256_mul_pd(x2, x2);
+		__m256d d = _mm256_mul_pd(two, _mm256_sub_pd(x2sq, _mm256_mul_pd(x1, x3)));
+		__m256d psi_x = _mm256_sub_pd(x2sq, _mm256_mul_pd(x0, x4));
+		__m256d needed = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(x1, x1), _mm256_mul_pd(x0, x2)), _mm256_sub_pd(_mm256_mul_pd(x3, x3), _mm256_mul_pd(x2, x4)));
+		__m256d psi_y = _mm256_add_pd(needed, psi_x);
+
+		_mm256_storeu_pd(omega + k, _mm256_div_pd(_mm256_sub_pd(psi_x, needed), d));
+		_mm256_storeu_pd(amplitude + k, _mm256_div_pd(_mm256_mul_pd(two, psi_x), _mm256_sqrt_pd(psi_y)));
+	}
+
+	return k;
+}
+#endif
+
+#ifdef SWITCH_HAVE_NEON
+static size_t
+avmd_desa2_tweaked_neon(const double *x, size_t n, double *omega, double *amplitude) {
+	const float64x2_t two = vdupq_n_f64(2.0);
+	size_t k;
+
+	for (k = 0; k + 2 <= n; k += 2) {
+		float64x2_t x0 = vld1q_f64(x + k);
+		float64x2_t x1 = vld1q_f64(x + k + 1);
+		float64x2_t x2 = vld1q_f64(x + k + 2);
+		float64x2_t x3 = vld1q_f64(x + k + 3);
+		float64x2_t x4 = vld1q_f64(x + k + 4);
+		float64x2_t x2sq = vmulq_f64(x2, x2);
+		float64x2_t d = vmulq_f64(two, vsubq_f64(x2sq, vmulq_f64(x1, x3)));
+		float64x2_t psi_x = vsubq_f64(x2sq, vmulq_f64(x0, x4));
+		float64x2_t needed = vaddq_f64(vsubq_f64(vmulq_f64(x1, x1), vmulq_f64(x0, x2)), vsubq_f64(vmulq_f64(x3, x3), vmulq_f64(x2, x4)));
+		float64x2_t psi_y = vaddq_f64(needed, psi_x);
+
+		vst1q_f64(omega + k, vdivq_f64(vsubq_f64(psi_x, needed), d));
+		vst1q_f64(amplitude + k, vdivq_f64(vmulq_f64(two, psi_x), vsqrtq_f64(psi_y)));
+	}
+
+	return k;
+}
+#endif
+
+static inline size_t
+avmd_desa2_tweaked_simd(const double *x, size_t n, double *omega, double *amplitude) {
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return avmd_desa2_tweaked_avx2(x, n, omega, amplitude);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return avmd_desa2_tweaked_sse2(x, n, omega, amplitude);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return avmd_desa2_tweaked_neon(x, n, omega, amplitude);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+void
+avmd_desa2_tweaked_block(circ_buffer_t *b, size_t i, size_t n, double *omega, double *amplitude) {
+	size_t k = 0, start = i & b->mask;
+
+	/* the window of the last position must not wrap around */
+	if (start + n + 4 <= b->buf_len) {
+		k = avmd_desa2_tweaked_simd(b->buf + start, n, omega, amplitude);
+	}
+
+	for (; k < n; k++) {
+		omega[k] = avmd_desa2_tweaked(b, i + k, &amplitude[k]);
+	}
+}
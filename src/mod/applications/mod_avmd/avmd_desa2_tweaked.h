@@ -47,5 +47,14 @@
  */
 double avmd_desa2_tweaked(circ_buffer_t *b, size_t i, double *amplitude) __attribute__ ((nonnull(1,3)));
 
+/* Same as avmd_desa2_tweaked for the n consecutive positions
+ * starting at i, omega[k] and amplitude[k] get the results
+ * for position i + k. Runs of samples that do not wrap around
+ * the end of the circular buffer are done with vector
+ * instructions when the CPU has them, results are the same
+ * as those of the scalar estimator.
+ */
+void avmd_desa2_tweaked_block(circ_buffer_t *b, size_t i, size_t n, double *omega, double *amplitude) __attribute__ ((nonnull(1,4,5)));
+
 
 #endif  /* __AVMD_DESA2_TWEAKED_H__ */
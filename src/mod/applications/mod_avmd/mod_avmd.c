@@ -115,6 +115,9 @@
 #define AVMD_READ_REPLACE	0
 #define AVMD_WRITE_REPLACE	1
 
+/*! Maximum number of shared detector threads */
+#define AVMD_DETECTOR_THREADS_MAX 64
+
 
 /* don't forget to update avmd_events_str table if you modify this */
 enum avmd_event
@@ -173,6 +176,7 @@ struct avmd_settings {
 	enum avmd_detection_mode mode;
 	uint8_t detectors_n;
 	uint8_t detectors_lagged_n;
+	uint8_t detector_threads;
 };
 
 /*! Status of the beep detection */
@@ -216,6 +220,7 @@ struct avmd_detector {
 	struct avmd_buffer buffer;
 	avmd_session_t *s;
 	size_t samples;
+	size_t pos;
 	uint8_t idx;
 	uint8_t lagged, lag;
 };
@@ -237,6 +242,16 @@ struct avmd_session {
 	switch_mutex_t *mutex_detectors_done;
 	switch_thread_cond_t *cond_detectors_done;
 	struct avmd_detector *detectors;
+	uint8_t pooled;
+
+	/* DESA-2 estimates of the current frame, computed once in avmd_process for
+	 * the window of the non lagged detectors which is the same for all of them */
+	double *desa_omega;
+	double *desa_amplitude;
+	double *desa_f;
+	size_t desa_len;
+	size_t desa_pos;
+	size_t desa_n;
 };
 
 static struct avmd_globals
@@ -245,6 +260,9 @@ static struct avmd_globals
 	struct avmd_settings settings;
 	switch_memory_pool_t *pool;
 	size_t session_n;
+	switch_queue_t *detector_queue;
+	switch_thread_t *detector_threads[AVMD_DETECTOR_THREADS_MAX];
+	uint8_t detector_thread_n;
 } avmd_globals;
 
 static void avmd_process(avmd_session_t *session, switch_frame_t *frame, uint8_t direction);
@@ -282,6 +300,12 @@ static void avmd_show(switch_stream_handle_t *stream, switch_mutex_t *mutex);
 static void* SWITCH_THREAD_FUNC
 avmd_detector_func(switch_thread_t *thread, void *arg);
 
+static void* SWITCH_THREAD_FUNC
+avmd_detector_pool_func(switch_thread_t *thread, void *arg);
+
+static void avmd_detector_pool_start(uint8_t threads);
+static void avmd_detector_pool_stop(void);
+
 static uint8_t
 avmd_detection_in_progress(avmd_session_t *s);
 
@@ -290,6 +314,9 @@ static switch_status_t avmd_launch_threads(avmd_session_t *s) {
 	struct avmd_detector *d;
 	switch_threadattr_t *thd_attr = NULL;
 
+	/* detectors of pooled sessions are run by the shared detector threads */
+	s->pooled = (s->settings.detector_threads > 0 && avmd_globals.detector_thread_n > 0);
+
 	idx = 0;
 	while (idx < s->settings.detectors_n) {
 		d = &s->detectors[idx];
@@ -298,6 +325,11 @@ static switch_status_t avmd_launch_threads(avmd_session_t *s) {
 		d->result = AVMD_DETECT_NONE;
 		d->lagged = 0;
 		d->lag = 0;
+		d->pos = s->pos;
+		if (s->pooled) {
+			++idx;
+			continue;
+		}
 		switch_threadattr_create(&thd_attr, avmd_globals.pool);
 		switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
 		if (switch_thread_create(&d->thread, thd_attr, avmd_detector_func, d, switch_core_session_get_pool(s->session)) != SWITCH_STATUS_SUCCESS) {
@@ -319,6 +351,11 @@ static switch_status_t avmd_launch_threads(avmd_session_t *s) {
 		d->result = AVMD_DETECT_NONE;
 		d->lagged = 1;
 		d->lag = idx + 1;
+		d->pos = s->pos;
+		if (s->pooled) {
+			++idx;
+			continue;
+		}
 		switch_threadattr_create(&thd_attr, avmd_globals.pool);
 		switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
 		if (switch_thread_create(&d->thread, thd_attr, avmd_detector_func, d, switch_core_session_get_pool(s->session)) != SWITCH_STATUS_SUCCESS) {
@@ -458,6 +495,13 @@ static switch_status_t init_avmd_session_data(avmd_session_t *avmd_session, swit
 	avmd_session->detection_start_time = 0;
 	avmd_session->detection_stop_time = 0;
 	avmd_session->frame_n_to_skip = 0;
+	avmd_session->pooled = 0;
+	avmd_session->desa_pos = 0;
+	avmd_session->desa_n = 0;
+	avmd_session->desa_len = 0;
+	avmd_session->desa_omega = NULL;
+	avmd_session->desa_amplitude = NULL;
+	avmd_session->desa_f = NULL;
 
 	buf_sz = AVMD_BEEP_LEN((uint32_t)avmd_session->rate) / (uint32_t) AVMD_SINE_LEN(avmd_session->rate);
 	if (buf_sz < 1) {
@@ -545,8 +589,10 @@ static void avmd_session_close(avmd_session_t *s) {
 		switch_thread_cond_signal(d->cond_start_processing);
 		switch_mutex_unlock(d->mutex);
 
-		switch_thread_join(&status, d->thread);
-		d->thread = NULL;
+		if (d->thread != NULL) {
+			switch_thread_join(&status, d->thread);
+			d->thread = NULL;
+		}
 
 		switch_mutex_destroy(d->mutex);
 		switch_thread_cond_destroy(d->cond_start_processing);
@@ -846,6 +892,7 @@ static void avmd_set_xml_default_configuration(switch_mutex_t *mutex) {
 	avmd_globals.settings.mode = AVMD_DETECT_BOTH;
 	avmd_globals.settings.detectors_n = 36;
 	avmd_globals.settings.detectors_lagged_n = 1;
+	avmd_globals.settings.detector_threads = 0;
 
 	if (mutex != NULL) {
 		switch_mutex_unlock(avmd_globals.mutex);
@@ -892,6 +939,8 @@ static switch_status_t avmd_load_xml_configuration(switch_mutex_t *mutex) {
 		switch_mutex_lock(mutex);
 	}
 
+	avmd_globals.settings.detector_threads = 0;
+
 	if ((xml = switch_xml_open_cfg("avmd.conf", &cfg, NULL)) != NULL) {
 
 		if ((x_lists = switch_xml_child(cfg, "settings"))) {
@@ -954,6 +1003,12 @@ static switch_status_t avmd_load_xml_configuration(switch_mutex_t *mutex) {
 					if(!avmd_parse_u8_user_input(value, &avmd_globals.settings.detectors_lagged_n, 0, UINT8_MAX)) {
 						bad_lagged = 0;
 					}
+				} else if (!strcmp(name, "detector_threads")) {
+					if(avmd_parse_u8_user_input(value, &avmd_globals.settings.detector_threads, 0, AVMD_DETECTOR_THREADS_MAX)) {
+						bad = 1;
+						switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "AVMD config parameter 'detector_threads' invalid - using default\n");
+						avmd_globals.settings.detector_threads = 0;
+					}
 				}
 			} // for
 		} // if list
@@ -1045,6 +1100,9 @@ static switch_status_t avmd_load_xml_configuration(switch_mutex_t *mutex) {
 		avmd_globals.settings.detectors_lagged_n = 1;
 	}
 
+	/* optional, detectors run in threads of their own session when missing */
+	avmd_detector_pool_start(avmd_globals.settings.detector_threads);
+
 	/**
 	 * Hint.
 	 */
@@ -1123,6 +1181,7 @@ static void avmd_show(switch_stream_handle_t *stream, switch_mutex_t *mutex) {
 	stream->write_function(stream, "sessions					   \t%"PRId64"\n", avmd_globals.session_n);
 	stream->write_function(stream, "detectors n					\t%u\n", avmd_globals.settings.detectors_n);
 	stream->write_function(stream, "detectors lagged n			 \t%u\n", avmd_globals.settings.detectors_lagged_n);
+	stream->write_function(stream, "detector threads			   \t%u (%u running)\n", avmd_globals.settings.detector_threads, avmd_globals.detector_thread_n);
 	stream->write_function(stream, "\n\n");
 
 	if (mutex != NULL) {
@@ -1223,10 +1282,10 @@ void avmd_config_dump(avmd_session_t *s) {
 	settings = &s->settings;
 	switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(s->session), SWITCH_LOG_INFO, "Avmd dynamic configuration: debug [%u], report_status [%u], fast_math [%u],"
 			" require_continuous_streak [%u], sample_n_continuous_streak [%u], sample_n_to_skip [%u], require_continuous_streak_amp [%u], sample_n_continuous_streak_amp [%u],"
-		   " simplified_estimation [%u], inbound_channel [%u], outbound_channel [%u], detection_mode [%u], detectors_n [%u], detectors_lagged_n [%u]\n",
+		   " simplified_estimation [%u], inbound_channel [%u], outbound_channel [%u], detection_mode [%u], detectors_n [%u], detectors_lagged_n [%u], detector_threads [%u]\n",
 			settings->debug, settings->report_status, settings->fast_math, settings->require_continuous_streak, settings->sample_n_continuous_streak,
 			settings->sample_n_to_skip, settings->require_continuous_streak_amp, settings->sample_n_continuous_streak_amp,
-			settings->simplified_estimation, settings->inbound_channnel, settings->outbound_channnel, settings->mode, settings->detectors_n, settings->detectors_lagged_n);
+			settings->simplified_estimation, settings->inbound_channnel, settings->outbound_channnel, settings->mode, settings->detectors_n, settings->detectors_lagged_n, settings->detector_threads);
 	return;
 }
 
@@ -1655,6 +1714,7 @@ SWITCH_MODULE_SHUTDOWN_FUNCTION(mod_avmd_shutdown) {
 #endif
 
 	switch_event_unbind_callback(avmd_reloadxml_event_handler);
+	avmd_detector_pool_stop();
 	switch_mutex_unlock(avmd_globals.mutex);
 	switch_mutex_destroy(avmd_globals.mutex);
 	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_NOTICE, "Advanced voicemail detection disabled\n");
@@ -2046,13 +2106,63 @@ avmd_detection_result(avmd_session_t *s) {
 	return AVMD_DETECT_NONE;
 }
 
+/*! \brief Compute DESA-2 estimates of the frame for the non lagged detectors.
+ * @param s An avmd session.
+ * @param samples Number of positions the detectors will look at.
+ * @details All non lagged detectors evaluate the same positions, each of them
+ * every resolution-th one, so the estimates are computed here once per frame
+ * instead of once per detector.
+ */
+static void avmd_desa_update(avmd_session_t *s, size_t samples) {
+	circ_buffer_t *b = &s->b;
+	enum avmd_detection_mode mode = s->settings.mode;
+	size_t k;
+
+	s->desa_n = 0;
+	if (s->settings.detectors_n == 0 || samples == 0) {
+		return;
+	}
+
+	if (samples > s->desa_len) {
+		s->desa_omega = (double *) switch_core_session_alloc(s->session, samples * sizeof(double));
+		s->desa_amplitude = (double *) switch_core_session_alloc(s->session, samples * sizeof(double));
+		s->desa_f = (double *) switch_core_session_alloc(s->session, samples * sizeof(double));
+		if (s->desa_omega == NULL || s->desa_amplitude == NULL || s->desa_f == NULL) {
+			s->desa_len = 0;
+			return;
+		}
+		s->desa_len = samples;
+	}
+
+	/* detectors evaluate positions pos + 1 to pos + samples */
+	s->desa_pos = s->detectors[0].pos & b->mask;
+	avmd_desa2_tweaked_block(b, s->desa_pos + 1, samples, s->desa_omega, s->desa_amplitude);
+
+	if (mode == AVMD_DETECT_FREQ || mode == AVMD_DETECT_BOTH) {
+		for (k = 0; k < samples; k++) {
+			double omega = s->desa_omega[k];
+
+			/* only used by avmd_process_sample for valid omega, NaN fails the test too */
+			if (omega >= -0.99999 && omega <= 0.99999) {
+#if !defined(WIN32) && defined(AVMD_FAST_MATH)
+				s->desa_f[k] = 0.5 * (double) fast_acosf((float)omega);
+#else
+				s->desa_f[k] = 0.5 * acos(omega);
+#endif /* !WIN32 && AVMD_FAST_MATH */
+			}
+		}
+	}
+
+	s->desa_n = samples;
+}
+
 /*! \brief Process one frame of data with avmd algorithm.
  * @param session An avmd session.
  * @param frame An audio frame.
  */
 static void avmd_process(avmd_session_t *s, switch_frame_t *frame, uint8_t direction) {
 	circ_buffer_t *b;
-	uint8_t idx;
+	uint8_t idx, queued = 0;
 	struct avmd_detector *d;
 
 
@@ -2083,6 +2193,8 @@ static void avmd_process(avmd_session_t *s, switch_frame_t *frame, uint8_t direc
 
 	INSERT_INT16_FRAME(b, (int16_t *)(frame->data), frame->samples);	/* Insert frame of 16 bit samples into buffer */
 
+	avmd_desa_update(s, s->frame_n == 0 ? frame->samples - AVMD_P : frame->samples);
+
 	idx = 0;
 	while (idx < (s->settings.detectors_n + s->settings.detectors_lagged_n)) {
 		d = &s->detectors[idx];
@@ -2092,12 +2204,20 @@ static void avmd_process(avmd_session_t *s, switch_frame_t *frame, uint8_t direc
 			d->flag_processing_done = 0;
 			d->flag_should_exit = 0;
 			d->samples = (s->frame_n == 0 ? frame->samples - AVMD_P : frame->samples);
-			switch_thread_cond_signal(d->cond_start_processing);
+			if (s->pooled) {
+				queued = 1;
+			} else {
+				switch_thread_cond_signal(d->cond_start_processing);
+			}
 		}
 		switch_mutex_unlock(d->mutex);
 		++idx;
 	}
 
+	if (queued) {
+		switch_queue_push(avmd_globals.detector_queue, s);
+	}
+
 	switch_mutex_lock(s->mutex_detectors_done);
 	while (avmd_detection_in_progress(s) == 1) {
 		switch_thread_cond_wait(s->cond_detectors_done, s->mutex_detectors_done);
@@ -2128,6 +2248,7 @@ static enum avmd_detection_mode avmd_process_sample(avmd_session_t *s, circ_buff
 	double omega = 0.0, amplitude = 0.0;
 	double f = 0.0, f_fir = 0.0;
 	double v_amp = 9999.9, v_fir = 9999.9;
+	const double *f_cached = NULL;
 
 	sma_buffer_t *sma_b = &buffer->sma_b;
 	sma_buffer_t *sqa_b = &buffer->sqa_b;
@@ -2145,7 +2266,13 @@ static enum avmd_detection_mode avmd_process_sample(avmd_session_t *s, circ_buff
 		return AVMD_DETECT_NONE;
 	}
 
-	omega = avmd_desa2_tweaked(b, pos + sample_n, &amplitude);
+	if ((pos & b->mask) == s->desa_pos && sample_n <= s->desa_n) {
+		omega = s->desa_omega[sample_n - 1];
+		amplitude = s->desa_amplitude[sample_n - 1];
+		f_cached = &s->desa_f[sample_n - 1];
+	} else {
+		omega = avmd_desa2_tweaked(b, pos + sample_n, &amplitude);
+	}
 
 	if (mode == AVMD_DETECT_AMP || mode == AVMD_DETECT_BOTH) {
 		if (ISNAN(amplitude) || ISINF(amplitude)) {
@@ -2201,11 +2328,15 @@ static enum avmd_detection_mode avmd_process_sample(avmd_session_t *s, circ_buff
 		} else {
 			if (valid_omega) {
 
+				if (f_cached != NULL) {
+					f = *f_cached;
+				} else {
 #if !defined(WIN32) && defined(AVMD_FAST_MATH)
-				f =  0.5 * (double) fast_acosf((float)omega);
+					f =  0.5 * (double) fast_acosf((float)omega);
 #else
-				f = 0.5 * acos(omega);
+					f = 0.5 * acos(omega);
 #endif /* !WIN32 && AVMD_FAST_MATH */
+				}
 				f_fir = sma_b->pos > 1 ? (AVMD_MEDIAN_FILTER(sma_b->data[sma_b->pos - 2], sma_b->data[sma_b->pos - 1], f)) : f;
 
 				APPEND_SMA_VAL(sma_b, f); /* append frequency */
@@ -2242,19 +2373,55 @@ static enum avmd_detection_mode avmd_process_sample(avmd_session_t *s, circ_buff
 	return AVMD_DETECT_NONE;
 }
 
+/*! \brief Run one detector over the current frame.
+ * @param d The detector, its processing_done flag must have been cleared by avmd_process.
+ * @details Called by the detector's own thread or by a shared detector thread.
+ */
+static void avmd_detector_process(struct avmd_detector *d) {
+	size_t sample_n = 0, samples;
+	uint8_t resolution, offset;
+	avmd_session_t *s = d->s;
+	enum avmd_detection_mode res = AVMD_DETECT_NONE;
+
+	switch_mutex_lock(d->mutex);
+	resolution = d->buffer.resolution;
+	offset = d->buffer.offset;
+	samples = d->samples;
+
+	if (d->lagged == 1) {
+		if (d->lag > 0) {
+			--d->lag;
+			goto done;
+		}
+		d->pos += AVMD_P;
+	}
+
+	switch_mutex_unlock(d->mutex);
+	sample_n = 1;
+	while (sample_n <= samples) {
+		if (((sample_n + offset) % resolution) == 0) {
+			res = avmd_process_sample(s, &s->b, sample_n, d->pos, d);
+			if (res != AVMD_DETECT_NONE) {
+				break;
+			}
+		}
+		++sample_n;
+	}
+	switch_mutex_lock(d->mutex);
+done:
+	d->flag_processing_done = 1;
+	d->result = res;
+	switch_mutex_unlock(d->mutex);
+}
+
 static void* SWITCH_THREAD_FUNC
 avmd_detector_func(switch_thread_t *thread, void *arg) {
-	size_t sample_n = 0, samples = AVMD_P;
-	size_t pos;
-	uint8_t resolution, offset;
 	avmd_session_t  *s;
-	enum avmd_detection_mode res = AVMD_DETECT_NONE;
 	struct avmd_detector *d;
 
 
 	d = (struct avmd_detector*) arg;
 	s = d->s;
-	pos = s->pos;
 	while (1) {
 		switch_mutex_lock(d->mutex);
 		while ((d->flag_processing_done == 1) && (d->flag_should_exit == 0)) {
@@ -2265,35 +2432,10 @@ avmd_detector_func(switch_thread_t *thread, void *arg) {
 			d->flag_processing_done = 1;
 			goto end;
 		}
-		resolution = d->buffer.resolution;
-		offset = d->buffer.offset;
-		samples = d->samples;
-
-		if (d->lagged == 1) {
-			if (d->lag > 0) {
-				--d->lag;
-				goto done;
-			}
-			pos += AVMD_P;
-		}
-
-		switch_mutex_unlock(d->mutex);
-		sample_n = 1;
-		while (sample_n <= samples) {
-			if (((sample_n + offset) % resolution) == 0) {
-				res = avmd_process_sample(d->s, &s->b, sample_n, pos, d);
-				if (res != AVMD_DETECT_NONE) {
-					break;
-				}
-			}
-			++sample_n;
-		}
-		switch_mutex_lock(d->mutex);
-done:
-		d->flag_processing_done = 1;
-		d->result = res;
 		switch_mutex_unlock(d->mutex);
 
+		avmd_detector_process(d);
+
 		switch_mutex_lock(s->mutex_detectors_done);
 		switch_thread_cond_signal(s->cond_detectors_done);
 		switch_mutex_unlock(s->mutex_detectors_done);
@@ -2305,6 +2447,77 @@ end:
 	return NULL;
 }
 
+/*! \brief Shared detector thread.
+ * @details Pops sessions queued by avmd_process and runs all their detectors
+ * that wait for the frame, one after the other. A NULL session stops the thread.
+ */
+static void* SWITCH_THREAD_FUNC
+avmd_detector_pool_func(switch_thread_t *thread, void *arg) {
+	void *pop = NULL;
+
+	while (switch_queue_pop(avmd_globals.detector_queue, &pop) == SWITCH_STATUS_SUCCESS && pop != NULL) {
+		avmd_session_t *s = (avmd_session_t *) pop;
+		struct avmd_detector *d;
+		uint8_t idx = 0, pending;
+
+		while (idx < (s->settings.detectors_n + s->settings.detectors_lagged_n)) {
+			d = &s->detectors[idx];
+			switch_mutex_lock(d->mutex);
+			pending = (d->flag_processing_done == 0);
+			switch_mutex_unlock(d->mutex);
+			if (pending) {
+				avmd_detector_process(d);
+			}
+			++idx;
+		}
+
+		switch_mutex_lock(s->mutex_detectors_done);
+		switch_thread_cond_signal(s->cond_detectors_done);
+		switch_mutex_unlock(s->mutex_detectors_done);
+	}
+	return NULL;
+}
+
+/*! \brief Start shared detector threads up to the configured number.
+ * @details Avmd globals mutex must be locked. Threads are never stopped
+ * before the module unloads, sessions started while detector_threads is 0
+ * get their own threads.
+ */
+static void avmd_detector_pool_start(uint8_t threads) {
+	switch_threadattr_t *thd_attr = NULL;
+
+	if (threads > AVMD_DETECTOR_THREADS_MAX) {
+		threads = AVMD_DETECTOR_THREADS_MAX;
+	}
+
+	if (threads > 0 && avmd_globals.detector_queue == NULL) {
+		switch_queue_create(&avmd_globals.detector_queue, SWITCH_CORE_QUEUE_LEN, avmd_globals.pool);
+	}
+
+	while (avmd_globals.detector_thread_n < threads) {
+		switch_threadattr_create(&thd_attr, avmd_globals.pool);
+		switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+		if (switch_thread_create(&avmd_globals.detector_threads[avmd_globals.detector_thread_n], thd_attr, avmd_detector_pool_func, NULL, avmd_globals.pool) != SWITCH_STATUS_SUCCESS) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "AVMD: can't start shared detector thread\n");
+			break;
+		}
+		++avmd_globals.detector_thread_n;
+	}
+}
+
+static void avmd_detector_pool_stop(void) {
+	switch_status_t status;
+	uint8_t idx;
+
+	for (idx = 0; idx < avmd_globals.detector_thread_n; idx++) {
+		switch_queue_push(avmd_globals.detector_queue, NULL);
+	}
+	for (idx = 0; idx < avmd_globals.detector_thread_n; idx++) {
+		switch_thread_join(&status, avmd_globals.detector_threads[idx]);
+	}
+	avmd_globals.detector_thread_n = 0;
+}
+
 
 /* For Emacs:
  * Local Variables:
@@ -0,0 +1,261 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * test_avmd.c -- runs the DESA-2 estimator of mod_avmd over a recorded beep
+ *
+ */
+#include <switch.h>
+#include <switch_simd.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <test/switch_test.h>
+
+#include "avmd_buffer.h"
+#include "avmd_desa2_tweaked.h"
+
+#define AVMD_TEST_RATE 8000
+#define AVMD_TEST_FRAME 160
+/* the fixture is 2 s of voice, 1 s of a 1 kHz beep and 0.5 s of silence */
+#define AVMD_TEST_FILE "sounds/avmd_voice_beep_8000.wav"
+/* resolutions of the 36 default detectors */
+#define AVMD_TEST_RESOLUTIONS 8
+
+static int16_t *avmd_load_wav(switch_memory_pool_t *pool, const char *name, switch_size_t *samples)
+{
+	switch_file_handle_t fh = { 0 };
+	char path[1024];
+	int16_t *data;
+	switch_size_t len = AVMD_TEST_FRAME, max = AVMD_TEST_RATE * 10;
+
+	switch_snprintf(path, sizeof(path), "%s%s%s", SWITCH_GLOBAL_dirs.conf_dir, SWITCH_PATH_SEPARATOR, name);
+	if (switch_core_file_open(&fh, path, 1, AVMD_TEST_RATE, SWITCH_FILE_FLAG_READ | SWITCH_FILE_DATA_SHORT, NULL) != SWITCH_STATUS_SUCCESS) {
+		return NULL;
+	}
+
+	data = switch_core_alloc(pool, max * sizeof(int16_t));
+	*samples = 0;
+	while (*samples + AVMD_TEST_FRAME <= max && switch_core_file_read(&fh, data + *samples, &len) == SWITCH_STATUS_SUCCESS && len) {
+		*samples += len;
+		len = AVMD_TEST_FRAME;
+	}
+
+	switch_core_file_close(&fh);
+	return data;
+}
+
+static void avmd_init_buffer(switch_memory_pool_t *pool, circ_buffer_t *b)
+{
+	memset(b, 0, sizeof(*b));
+	b->buf_len = CALC_BUFF_LEN(AVMD_TEST_FRAME * 6, AVMD_TEST_RATE / 500);
+	b->mask = b->buf_len - 1;
+	b->buf = switch_core_alloc(pool, b->buf_len * sizeof(BUFF_TYPE));
+}
+
+static int avmd_same(double a, double b)
+{
+	if (isnan(a) || isnan(b)) {
+		return isnan(a) && isnan(b);
+	}
+
+	return a == b || fabs(a - b) <= 1e-9 * fabs(b);
+}
+
+FST_CORE_BEGIN(".")
+{
+	FST_SUITE_BEGIN(avmd)
+	{
+		FST_SETUP_BEGIN()
+		{
+			fst_requires_module("mod_sndfile");
+		}
+		FST_SETUP_END()
+
+		FST_TEARDOWN_BEGIN()
+		{
+			switch_simd_set_flags(switch_simd_cpu_flags());
+		}
+		FST_TEARDOWN_END()
+
+		FST_TEST_BEGIN(desa2_block_matches_scalar)
+		{
+			static const switch_simd_flag_t levels[] = { SWITCH_SIMD_NONE, SWITCH_SIMD_SSE2, SWITCH_SIMD_SSE2 | SWITCH_SIMD_AVX2, SWITCH_SIMD_NEON };
+			double omega[AVMD_TEST_FRAME + 8], amplitude[AVMD_TEST_FRAME + 8];
+			switch_size_t samples = 0, i;
+			int16_t *audio = avmd_load_wav(fst_pool, AVMD_TEST_FILE, &samples);
+			circ_buffer_t b;
+			uint32_t l, bad = 0;
+			size_t k;
+
+			fst_requires(audio);
+			fst_requires(samples >= AVMD_TEST_RATE * 3);
+			avmd_init_buffer(fst_pool, &b);
+
+			for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+				if (switch_simd_set_flags(levels[l]) != levels[l]) {
+					continue;
+				}
+
+				b.pos = b.lpos = b.backlog = 0;
+				memset(b.buf, 0, b.buf_len * sizeof(BUFF_TYPE));
+
+				for (i = 0; i + AVMD_TEST_FRAME <= samples; i += AVMD_TEST_FRAME) {
+					size_t start = b.pos;
+
+					INSERT_INT16_FRAME(&b, audio + i, AVMD_TEST_FRAME);
+
+					/* odd lengths leave a tail, windows at the end of the buffer wrap around */
+					avmd_desa2_tweaked_block(&b, start, AVMD_TEST_FRAME + 3, omega, amplitude);
+
+					for (k = 0; k < AVMD_TEST_FRAME + 3; k++) {
+						double a, w = avmd_desa2_tweaked(&b, start + k, &a);
+
+						if (!avmd_same(omega[k], w) || !avmd_same(amplitude[k], a)) {
+							bad++;
+						}
+					}
+				}
+
+				fst_xcheck(bad == 0, "block estimates differ from the scalar estimator");
+			}
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(beep_frequency)
+		{
+			double omega[AVMD_TEST_FRAME], amplitude[AVMD_TEST_FRAME];
+			switch_size_t samples = 0, i;
+			int16_t *audio = avmd_load_wav(fst_pool, AVMD_TEST_FILE, &samples);
+			circ_buffer_t b;
+			double f_sum = 0.0;
+			uint32_t n = 0;
+			size_t k;
+
+			fst_requires(audio);
+			avmd_init_buffer(fst_pool, &b);
+
+			for (i = 0; i + AVMD_TEST_FRAME <= samples; i += AVMD_TEST_FRAME) {
+				size_t start = b.pos;
+
+				INSERT_INT16_FRAME(&b, audio + i, AVMD_TEST_FRAME);
+
+				/* the middle of the beep, windows inside the frame only */
+				if (i < AVMD_TEST_RATE * 2 + AVMD_TEST_RATE / 4 || i >= AVMD_TEST_RATE * 3 - AVMD_TEST_RATE / 4) {
+					continue;
+				}
+
+				avmd_desa2_tweaked_block(&b, start, AVMD_TEST_FRAME - 4, omega, amplitude);
+
+				for (k = 0; k < AVMD_TEST_FRAME - 4; k++) {
+					if (omega[k] >= -0.99999 && omega[k] <= 0.99999) {
+						f_sum += 0.5 * acos(omega[k]);
+						n++;
+					}
+				}
+			}
+
+			fst_requires(n > AVMD_TEST_RATE / 4);
+			fst_check_int_range((int) ((AVMD_TEST_RATE * f_sum / n) / (2.0 * M_PI)), 1000, 10);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(benchmark)
+		{
+			/* per channel cost of the DESA-2 front end for the default 36 detectors: each resolution r
+			 * has r detectors that together evaluate every position of the frame, previously each
+			 * detector ran the estimator and the arc cosine itself, now it is done once per frame */
+			struct {
+				const char *name;
+				switch_simd_flag_t simd;
+				int per_detector;
+			} modes[] = {
+				{ "per detector", SWITCH_SIMD_NONE, 1 },
+				{ "per frame", SWITCH_SIMD_NONE, 0 },
+				{ "per frame simd", 0, 0 }
+			};
+#ifdef BENCHMARK
+			uint32_t loops = 200;
+#else
+			uint32_t loops = 2;
+#endif
+			double omega[AVMD_TEST_FRAME], amplitude[AVMD_TEST_FRAME], f[AVMD_TEST_FRAME];
+			switch_size_t samples = 0, i;
+			int16_t *audio = avmd_load_wav(fst_pool, AVMD_TEST_FILE, &samples);
+			circ_buffer_t b;
+			uint32_t m, loop, r;
+			volatile double sink = 0.0;
+			size_t k;
+
+			fst_requires(audio);
+			avmd_init_buffer(fst_pool, &b);
+			modes[2].simd = switch_simd_cpu_flags();
+
+			for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+				switch_time_t start = switch_time_now(), took;
+
+				switch_simd_set_flags(modes[m].simd);
+
+				for (loop = 0; loop < loops; loop++) {
+					for (i = 0; i + AVMD_TEST_FRAME <= samples; i += AVMD_TEST_FRAME) {
+						size_t pos = b.pos;
+
+						INSERT_INT16_FRAME(&b, audio + i, AVMD_TEST_FRAME);
+
+						if (modes[m].per_detector) {
+							for (r = 1; r <= AVMD_TEST_RESOLUTIONS; r++) {
+								for (k = 1; k <= AVMD_TEST_FRAME - 4; k++) {
+									double a, w = avmd_desa2_tweaked(&b, pos + k, &a);
+
+									if (w >= -0.99999 && w <= 0.99999) {
+										sink += 0.5 * acos(w) + a;
+									}
+								}
+							}
+						} else {
+							avmd_desa2_tweaked_block(&b, pos + 1, AVMD_TEST_FRAME - 4, omega, amplitude);
+							for (k = 0; k < AVMD_TEST_FRAME - 4; k++) {
+								f[k] = (omega[k] >= -0.99999 && omega[k] <= 0.99999) ? 0.5 * acos(omega[k]) : 0.0;
+							}
+							for (r = 1; r <= AVMD_TEST_RESOLUTIONS; r++) {
+								for (k = 0; k < AVMD_TEST_FRAME - 4; k++) {
+									sink += f[k] + amplitude[k];
+								}
+							}
+						}
+					}
+				}
+
+				took = switch_time_now() - start;
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] %.1fus per channel second, %.0f channels per core\n",
+								  modes[m].name, (double) took * AVMD_TEST_RATE / ((double) samples * loops),
+								  took ? 1000000.0 * samples * loops / ((double) AVMD_TEST_RATE * took) : 0.0);
+			}
+		}
+		FST_TEST_END()
+	}
+	FST_SUITE_END()
+}
+FST_CORE_END()
@@ -722,6 +722,51 @@ SWITCH_STANDARD_API(db_cache_function)
 	return SWITCH_STATUS_SUCCESS;
 }
 
+#define FILE_CACHE_SYNTAX "status|flush"
+SWITCH_STANDARD_API(file_cache_function)
+{
+	if (zstr(cmd) || !strcasecmp(cmd, "status")) {
+		switch_core_file_cache_status(stream);
+	} else if (!strcasecmp(cmd, "flush")) {
+		switch_core_file_cache_flush();
+		stream->write_function(stream, "+OK\n");
+	} else {
+		stream->write_function(stream, "-USAGE: %s\n", FILE_CACHE_SYNTAX);
+	}
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+#define TTS_CACHE_SYNTAX "status|flush"
+SWITCH_STANDARD_API(tts_cache_function)
+{
+	if (zstr(cmd) || !strcasecmp(cmd, "status")) {
+		switch_core_speech_cache_status(stream);
+	} else if (!strcasecmp(cmd, "flush")) {
+		switch_core_speech_cache_flush();
+		stream->write_function(stream, "+OK\n");
+	} else {
+		stream->write_function(stream, "-USAGE: %s\n", TTS_CACHE_SYNTAX);
+	}
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+#define IMAGE_CACHE_SYNTAX "status|flush"
+SWITCH_STANDARD_API(image_cache_function)
+{
+	if (zstr(cmd) || !strcasecmp(cmd, "status")) {
+		switch_img_cache_status(stream);
+	} else if (!strcasecmp(cmd, "flush")) {
+		switch_img_cache_flush();
+		stream->write_function(stream, "+OK\n");
+	} else {
+		stream->write_function(stream, "-USAGE: %s\n", IMAGE_CACHE_SYNTAX);
+	}
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
 SWITCH_STANDARD_API(host_lookup_function)
 {
 	char host[256] = "";
@@ -7599,6 +7644,8 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_commands_load)
 	SWITCH_ADD_API(commands_api_interface, "console_complete_xml", "", console_complete_xml_function, "<line>");
 	SWITCH_ADD_API(commands_api_interface, "create_uuid", "Create a uuid", uuid_function, UUID_SYNTAX);
 	SWITCH_ADD_API(commands_api_interface, "db_cache", "Manage db cache", db_cache_function, "status");
+	SWITCH_ADD_API(commands_api_interface, "file_cache", "Manage decoded file cache", file_cache_function, FILE_CACHE_SYNTAX);
+	SWITCH_ADD_API(commands_api_interface, "tts_cache", "Manage synthesized speech cache", tts_cache_function, TTS_CACHE_SYNTAX);
 	SWITCH_ADD_API(commands_api_interface, "domain_data", "Find domain data", domain_data_function, "<domain> [var|param|attr] <name>");
 	SWITCH_ADD_API(commands_api_interface, "domain_exists", "Check if a domain exists", domain_exists_function, "<domain>");
 	SWITCH_ADD_API(commands_api_interface, "echo", "Echo", echo_function, "<data>");
@@ -7622,6 +7669,7 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_commands_load)
 	SWITCH_ADD_API(commands_api_interface, "gethost", "gethostbyname", gethost_api_function, "");
 	SWITCH_ADD_API(commands_api_interface, "getenv", "getenv", getenv_function, GETENV_SYNTAX);
 	SWITCH_ADD_API(commands_api_interface, "hupall", "hupall", hupall_api_function, "<cause> [<var> <value>] [<var2> <value2>]");
+	SWITCH_ADD_API(commands_api_interface, "image_cache", "Manage rendered image cache", image_cache_function, IMAGE_CACHE_SYNTAX);
 	SWITCH_ADD_API(commands_api_interface, "in_group", "Determine if a user is in a group", in_group_function, "<user>[@<domain>] <group_name>");
 	SWITCH_ADD_API(commands_api_interface, "is_lan_addr", "See if an ip is a lan addr", lan_addr_function, "<ip>");
 	SWITCH_ADD_API(commands_api_interface, "limit_usage", "Get the usage count of a limited resource", limit_usage_function, "<backend> <realm> <id>");
@@ -7751,6 +7799,12 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_commands_load)
 	switch_console_set_complete("add complete add");
 	switch_console_set_complete("add complete del");
 	switch_console_set_complete("add db_cache status");
+	switch_console_set_complete("add file_cache status");
+	switch_console_set_complete("add file_cache flush");
+	switch_console_set_complete("add tts_cache status");
+	switch_console_set_complete("add tts_cache flush");
+	switch_console_set_complete("add image_cache status");
+	switch_console_set_complete("add image_cache flush");
 	switch_console_set_complete("add fsctl api_expansion on");
 	switch_console_set_complete("add fsctl api_expansion off");
 	switch_console_set_complete("add fsctl debug_level");
@@ -2258,6 +2258,11 @@ switch_status_t conference_api_sub_list(conference_obj_t *conference, switch_str
 				fcount++;
 			}
 
+			if (conference_utils_test_flag(conference, CFLAG_MINIMIZE_AUDIO_ENCODING)) {
+				stream->write_function(stream, "%sminimize_audio_encoding", fcount ? "|" : "");
+				fcount++;
+			}
+
 			if (conference_utils_test_flag(conference, CFLAG_MANAGE_INBOUND_VIDEO_BITRATE)) {
 				stream->write_function(stream, "%smanage_inbound_bitrate", fcount ? "|" : "");
 				fcount++;
@@ -2287,7 +2292,7 @@ switch_status_t conference_api_sub_list(conference_obj_t *conference, switch_str
 				stream->write_function(stream, "none");
 			}
 
-			stream->write_function(stream, ")\n");
+			stream->write_function(stream, " deadline_misses: %u)\n", conference->deadline_misses);
 
 			count++;
 			if (!summary) {
@@ -4034,6 +4039,65 @@ switch_status_t conference_api_sub_get(conference_obj_t *conference,
 		} else if (strcasecmp(argv[2], "wait_mod") == 0) {
 			stream->write_function(stream, "%s",
 								   conference_utils_test_flag(conference, CFLAG_WAIT_MOD) ? "true" : "");
+		} else if (strcasecmp(argv[2], "audio_encodes") == 0) {
+			stream->write_function(stream, "%" SWITCH_UINT64_T_FMT,
+								   conference->audio_encodes);
+		} else if (strcasecmp(argv[2], "audio_encodes_saved") == 0) {
+			stream->write_function(stream, "%" SWITCH_UINT64_T_FMT,
+								   conference->audio_encodes_saved);
+		} else if (strcasecmp(argv[2], "deadline_misses") == 0) {
+			stream->write_function(stream, "%u",
+								   conference->deadline_misses);
+		} else if (strcasecmp(argv[2], "max_tick_usec") == 0) {
+			stream->write_function(stream, "%" SWITCH_TIME_T_FMT,
+								   conference->tick_time_max);
+		} else if (strcasecmp(argv[2], "mix_threads") == 0) {
+			stream->write_function(stream, "%u",
+								   conference->mix_thread_count);
+		} else if (strcasecmp(argv[2], "input_threads") == 0) {
+			conference_member_t *member;
+			uint32_t threads = 0;
+
+			switch_mutex_lock(conference->member_mutex);
+			for (member = conference->members; member; member = member->next) {
+				if (member->input_thread) {
+					threads++;
+				}
+			}
+			switch_mutex_unlock(conference->member_mutex);
+
+			stream->write_function(stream, "%u", threads);
+		} else if (strcasecmp(argv[2], "io_threads") == 0) {
+			stream->write_function(stream, "%u",
+								   conference->io_thread_count);
+		} else if (strcasecmp(argv[2], "io_members") == 0 || strcasecmp(argv[2], "io_max_tick_usec") == 0 ||
+				   strcasecmp(argv[2], "io_avg_tick_usec") == 0 || strcasecmp(argv[2], "io_late_ticks") == 0) {
+			uint64_t members = 0, ticks = 0, total = 0, late = 0;
+			switch_time_t max = 0;
+			uint32_t i;
+
+			/* the workers stay allocated for the life of the conference, stale numbers are fine here */
+			for (i = 0; i < conference->io_thread_count; i++) {
+				conference_io_worker_t *worker = &conference->io_workers[i];
+
+				members += worker->member_count;
+				ticks += worker->ticks;
+				total += worker->tick_time_total;
+				late += worker->late_ticks;
+				if (worker->tick_time_max > max) {
+					max = worker->tick_time_max;
+				}
+			}
+
+			if (strcasecmp(argv[2], "io_members") == 0) {
+				stream->write_function(stream, "%" SWITCH_UINT64_T_FMT, members);
+			} else if (strcasecmp(argv[2], "io_max_tick_usec") == 0) {
+				stream->write_function(stream, "%" SWITCH_TIME_T_FMT, max);
+			} else if (strcasecmp(argv[2], "io_avg_tick_usec") == 0) {
+				stream->write_function(stream, "%" SWITCH_UINT64_T_FMT, ticks ? total / ticks : 0);
+			} else {
+				stream->write_function(stream, "%" SWITCH_UINT64_T_FMT, late);
+			}
 		} else {
 			ret_status = SWITCH_STATUS_FALSE;
 		}
@@ -800,492 +800,700 @@ static void stop_talking_handler(conference_member_t *member)
 	
 }
 
-/* marshall frames from the call leg to the conference thread for muxing to other call legs */
-void *SWITCH_THREAD_FUNC conference_loop_input(switch_thread_t *thread, void *obj)
+/* take the call leg for reading, before the first conference_loop_input_frame() */
+static switch_status_t conference_loop_input_start(conference_member_t *member)
+{
+	switch_core_session_t *session = member->session;
+
+	if (switch_core_session_read_lock(session) != SWITCH_STATUS_SUCCESS) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	conference_utils_member_clear_flag_locked(member, MFLAG_TALKING);
+
+	switch_core_session_get_read_impl(session, &member->read_impl);
+
+	switch_channel_audio_sync(switch_core_session_get_channel(session));
+
+	member->hangover_hits = member->hangunder_hits = 0;
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+static void conference_loop_input_stop(conference_member_t *member)
+{
+	if (switch_queue_size(member->dtmf_queue)) {
+		switch_dtmf_t *dt;
+		void *pop;
+
+		while (switch_queue_trypop(member->dtmf_queue, &pop) == SWITCH_STATUS_SUCCESS) {
+			dt = (switch_dtmf_t *) pop;
+			free(dt);
+		}
+	}
+
+	switch_resample_destroy(&member->read_resampler);
+	switch_core_session_rwunlock(member->session);
+}
+
+/* marshall one frame from the call leg to the conference thread for muxing to other call legs,
+   SWITCH_STATUS_FALSE ends the input, SWITCH_STATUS_BREAK means the channel is busy elsewhere for now */
+static switch_status_t conference_loop_input_frame(conference_member_t *member, switch_io_flag_t io_flags)
 {
 	switch_event_t *event;
-	conference_member_t *member = obj;
-	switch_channel_t *channel;
+	switch_core_session_t *session = member->session;
+	switch_channel_t *channel = switch_core_session_get_channel(session);
 	switch_status_t status;
 	switch_frame_t *read_frame = NULL;
-	uint32_t hangover = 40, hangunder = 5, hangover_hits = 0, hangunder_hits = 0, diff_level = 400;
-	switch_core_session_t *session = member->session;
+	uint32_t hangover = 40, hangunder = 5, diff_level = 400;
 	uint32_t flush_len;
 	switch_frame_t tmp_frame = { 0 };
 
-	if (switch_core_session_read_lock(session) != SWITCH_STATUS_SUCCESS) {
-		goto end;
+	if (!conference_utils_member_test_flag(member, MFLAG_RUNNING) || !switch_channel_ready(channel)) {
+		return SWITCH_STATUS_FALSE;
 	}
 
-	switch_assert(member != NULL);
+	if (switch_channel_test_app_flag(channel, CF_APP_TAGGED)) {
+		return SWITCH_STATUS_BREAK;
+	}
 
-	conference_utils_member_clear_flag_locked(member, MFLAG_TALKING);
+	if (conference_utils_test_flag(member->conference, CFLAG_BREAKABLE) &&
+		switch_channel_test_flag(channel, CF_BREAK)) {
+		switch_channel_clear_flag(channel, CF_BREAK);
+		return SWITCH_STATUS_FALSE;
+	}
 
-	channel = switch_core_session_get_channel(session);
+	flush_len = switch_samples_per_packet(member->conference->rate, member->conference->interval) * 2 * member->conference->channels * (500 / member->conference->interval);
 
-	switch_core_session_get_read_impl(session, &member->read_impl);
+	/* Read a frame. */
+	status = switch_core_session_read_frame(session, &read_frame, io_flags, 0);
 
-	switch_channel_audio_sync(channel);
+	switch_mutex_lock(member->read_mutex);
 
-	flush_len = switch_samples_per_packet(member->conference->rate, member->conference->interval) * 2 * member->conference->channels * (500 / member->conference->interval);
+	/* end the loop, if appropriate */
+	if (!SWITCH_READ_ACCEPTABLE(status) || !conference_utils_member_test_flag(member, MFLAG_RUNNING)) {
+		switch_mutex_unlock(member->read_mutex);
+		return SWITCH_STATUS_FALSE;
+	}
 
-	/* As long as we have a valid read, feed that data into an input buffer where the conference thread will take it
-	   and mux it with any audio from other channels. */
+	if (switch_channel_test_flag(channel, CF_VIDEO) && !conference_utils_member_test_flag(member, MFLAG_ACK_VIDEO)) {
+		conference_utils_member_set_flag_locked(member, MFLAG_ACK_VIDEO);
+		switch_mutex_lock(member->flag_mutex);
+		switch_img_free(&member->avatar_png_img);
+		switch_mutex_unlock(member->flag_mutex);
+		conference_video_check_avatar(member, SWITCH_FALSE);
+		switch_core_session_video_reinit(member->session);
+		conference_video_set_floor_holder(member->conference, member, SWITCH_FALSE);
+		conference_video_check_flush(member, SWITCH_TRUE);
+		switch_core_session_request_video_refresh(member->session);
+	} else if (conference_utils_member_test_flag(member, MFLAG_ACK_VIDEO) && !switch_channel_test_flag(channel, CF_VIDEO)) {
+		conference_video_check_avatar(member, SWITCH_FALSE);
+	}
 
-	while (conference_utils_member_test_flag(member, MFLAG_RUNNING) && switch_channel_ready(channel)) {
+	/* if we have caller digits, feed them to the parser to find an action */
+	if (switch_channel_has_dtmf(channel)) {
+		char dtmf[128] = "";
 
-		if (switch_channel_ready(channel) && switch_channel_test_app_flag(channel, CF_APP_TAGGED)) {
-			switch_yield(100000);
-			continue;
-		}
+		switch_channel_dequeue_dtmf_string(channel, dtmf, sizeof(dtmf));
 
-		if (conference_utils_test_flag(member->conference, CFLAG_BREAKABLE) &&
-			switch_channel_test_flag(channel, CF_BREAK)) {
-			switch_channel_clear_flag(channel, CF_BREAK);
-			break;
+		if (conference_utils_member_test_flag(member, MFLAG_DIST_DTMF)) {
+			conference_member_send_all_dtmf(member, member->conference, dtmf);
+		} else if (member->dmachine) {
+			char *p;
+			char str[2] = "";
+			for (p = dtmf; p && *p; p++) {
+				str[0] = *p;
+				switch_ivr_dmachine_feed(member->dmachine, str, NULL);
+			}
 		}
+	} else if (member->dmachine) {
+		switch_ivr_dmachine_ping(member->dmachine, NULL);
+	}
 
-		/* Read a frame. */
-		status = switch_core_session_read_frame(session, &read_frame, SWITCH_IO_FLAG_NONE, 0);
+	if (switch_queue_size(member->dtmf_queue)) {
+		switch_dtmf_t *dt;
+		void *pop;
 
-		switch_mutex_lock(member->read_mutex);
+		if (switch_queue_trypop(member->dtmf_queue, &pop) == SWITCH_STATUS_SUCCESS) {
+			dt = (switch_dtmf_t *) pop;
+			switch_core_session_send_dtmf(member->session, dt);
+			free(dt);
+		}
+	}
 
-		/* end the loop, if appropriate */
-		if (!SWITCH_READ_ACCEPTABLE(status) || !conference_utils_member_test_flag(member, MFLAG_RUNNING)) {
-			switch_mutex_unlock(member->read_mutex);
-			break;
+	if (switch_channel_test_flag(member->channel, CF_CONFERENCE_RESET_MEDIA)) {
+		member->reset_media = 10;
+		switch_channel_audio_sync(member->channel);
+		switch_channel_clear_flag(member->channel, CF_CONFERENCE_RESET_MEDIA);
+	}
+
+	if (member->reset_media) {
+		if (--member->reset_media > 0) {
+			goto do_continue;
 		}
 
-		if (switch_channel_test_flag(channel, CF_VIDEO) && !conference_utils_member_test_flag(member, MFLAG_ACK_VIDEO)) {
-			conference_utils_member_set_flag_locked(member, MFLAG_ACK_VIDEO);
-			switch_mutex_lock(member->flag_mutex);
-			switch_img_free(&member->avatar_png_img);
-			switch_mutex_unlock(member->flag_mutex);
-			conference_video_check_avatar(member, SWITCH_FALSE);
-			switch_core_session_video_reinit(member->session);
-			conference_video_set_floor_holder(member->conference, member, SWITCH_FALSE);
-			conference_video_check_flush(member, SWITCH_TRUE);
-			switch_core_session_request_video_refresh(member->session);
-		} else if (conference_utils_member_test_flag(member, MFLAG_ACK_VIDEO) && !switch_channel_test_flag(channel, CF_VIDEO)) {
-			conference_video_check_avatar(member, SWITCH_FALSE);
+		if (conference_member_setup_media(member, member->conference)) {
+			switch_mutex_unlock(member->read_mutex);
+			return SWITCH_STATUS_FALSE;
 		}
 
-		/* if we have caller digits, feed them to the parser to find an action */
-		if (switch_channel_has_dtmf(channel)) {
-			char dtmf[128] = "";
+		member->loop_loop = 1;
 
-			switch_channel_dequeue_dtmf_string(channel, dtmf, sizeof(dtmf));
+		goto do_continue;
+	}
 
-			if (conference_utils_member_test_flag(member, MFLAG_DIST_DTMF)) {
-				conference_member_send_all_dtmf(member, member->conference, dtmf);
-			} else if (member->dmachine) {
-				char *p;
-				char str[2] = "";
-				for (p = dtmf; p && *p; p++) {
-					str[0] = *p;
-					switch_ivr_dmachine_feed(member->dmachine, str, NULL);
+	if (switch_test_flag(read_frame, SFF_CNG)) {
+		if (member->hangunder_hits) {
+			member->hangunder_hits--;
+		}
+		if (conference_utils_member_test_flag(member, MFLAG_TALKING)) {
+			if (++member->hangover_hits >= hangover) {
+				member->hangover_hits = member->hangunder_hits = 0;
+				if (member->nogate_count < hangover) {
+					member->nogate_count = 0;
+				} else {
+					member->nogate_count -= hangover;
 				}
+				conference_utils_member_clear_flag_locked(member, MFLAG_TALKING);
+				conference_member_update_status_field(member);
+				conference_member_set_score_iir(member, 0);
+				member->floor_packets = 0;
+				stop_talking_handler(member);
 			}
-		} else if (member->dmachine) {
-			switch_ivr_dmachine_ping(member->dmachine, NULL);
 		}
 
-		if (switch_queue_size(member->dtmf_queue)) {
-			switch_dtmf_t *dt;
-			void *pop;
+		goto do_continue;
+	}
+
+	if (!switch_channel_test_flag(channel, CF_AUDIO)) {
+		goto do_continue;
+	}
+	
+	/* if the member can speak, compute the audio energy level and */
+	/* generate events when the level crosses the threshold        */
+	if (((conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) && !conference_utils_member_test_flag(member, MFLAG_HOLD)) ||
+		 conference_utils_member_test_flag(member, MFLAG_MUTE_DETECT))) {
+		uint32_t energy = 0, i = 0, samples = 0, j = 0;
+		int16_t *data;
+		int gate_check = 0;
+		int score_iir = 0;
+		
+		data = read_frame->data;
+		member->score = 0;
 
-			if (switch_queue_trypop(member->dtmf_queue, &pop) == SWITCH_STATUS_SUCCESS) {
-				dt = (switch_dtmf_t *) pop;
-				switch_core_session_send_dtmf(member->session, dt);
-				free(dt);
+		if (member->volume_in_level) {
+			switch_change_sln_volume(read_frame->data, (read_frame->datalen / 2) * member->conference->channels, member->volume_in_level);
+		}
+
+		if ((samples = read_frame->datalen / sizeof(*data))) {
+			for (i = 0; i < samples; i++) {
+				energy += abs(data[j]);
+				j++;
 			}
+
+			member->score = energy / samples;
 		}
 
-		if (switch_channel_test_flag(member->channel, CF_CONFERENCE_RESET_MEDIA)) {
-			member->reset_media = 10;
-			switch_channel_audio_sync(member->channel);
-			switch_channel_clear_flag(member->channel, CF_CONFERENCE_RESET_MEDIA);
+		if (member->vol_period) {
+			member->vol_period--;
 		}
 
-		if (member->reset_media) {
-			if (--member->reset_media > 0) {
-				goto do_continue;
-			}
+		gate_check = conference_member_noise_gate_check(member);
 
-			if (conference_member_setup_media(member, member->conference)) {
-				switch_mutex_unlock(member->read_mutex);
-				break;
-			}
+		if (gate_check && member->agc) {
+			switch_agc_feed(member->agc, (int16_t *)read_frame->data, (read_frame->datalen / 2) * member->conference->channels, 1);
+		}
 
-			member->loop_loop = 1;
+		score_iir = (int) (((1.0 - SCORE_DECAY) * (float) member->score) + (SCORE_DECAY * (float) member->score_iir));
 
-			goto do_continue;
+		if (score_iir > SCORE_MAX_IIR) {
+			score_iir = SCORE_MAX_IIR;
 		}
 
-		if (switch_test_flag(read_frame, SFF_CNG)) {
-			if (hangunder_hits) {
-				hangunder_hits--;
-			}
-			if (conference_utils_member_test_flag(member, MFLAG_TALKING)) {
-				if (++hangover_hits >= hangover) {
-					hangover_hits = hangunder_hits = 0;
-					if (member->nogate_count < hangover) {
-						member->nogate_count = 0;
-					} else {
-						member->nogate_count -= hangover;
+		conference_member_set_score_iir(member, score_iir);
+		
+		if (member->auto_energy_level && !conference_utils_member_test_flag(member, MFLAG_TALKING)) {
+			if (++member->auto_energy_track >= (1000 / member->conference->interval * member->conference->auto_energy_sec)) {
+				if (member->energy_level > member->conference->energy_level) {
+					int new_level = member->energy_level - 100;
+					
+					if (new_level < member->conference->energy_level) {
+						new_level = member->conference->energy_level;
 					}
-					conference_utils_member_clear_flag_locked(member, MFLAG_TALKING);
-					conference_member_update_status_field(member);
-					conference_member_set_score_iir(member, 0);
-					member->floor_packets = 0;
-					stop_talking_handler(member);
+					member->energy_level = new_level;
+					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "ENERGY DOWN %d\n", member->energy_level);
 				}
+				member->auto_energy_track = 0;
 			}
-
-			goto do_continue;
 		}
 
-		if (!switch_channel_test_flag(channel, CF_AUDIO)) {
-			goto do_continue;
-		}
-		
-		/* if the member can speak, compute the audio energy level and */
-		/* generate events when the level crosses the threshold        */
-		if (((conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) && !conference_utils_member_test_flag(member, MFLAG_HOLD)) ||
-			 conference_utils_member_test_flag(member, MFLAG_MUTE_DETECT))) {
-			uint32_t energy = 0, i = 0, samples = 0, j = 0;
-			int16_t *data;
-			int gate_check = 0;
-			int score_iir = 0;
-			
-			data = read_frame->data;
-			member->score = 0;
+		gate_check = conference_member_noise_gate_check(member);
+
+		if (conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) && !conference_utils_member_test_flag(member, MFLAG_HOLD)) {
+			if (member->max_energy_level) {
+				if (member->score > member->max_energy_level && ++member->max_energy_hits > member->max_energy_hit_trigger) {
+					member->mute_counter = member->burst_mute_count;
+					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "MAX ENERGY HIT!\n");
+				} else if (!member->mute_counter && member->score > (int)((double)member->max_energy_level * .75)) {
+					int dec = 1;
+
+					if (member->score_count > 9) {
+						dec = 4;
+					} else if (member->score_count > 6) {
+						dec = 3;
+					} else if (member->score_count > 3) {
+						dec = 2;
+					}
 
-			if (member->volume_in_level) {
-				switch_change_sln_volume(read_frame->data, (read_frame->datalen / 2) * member->conference->channels, member->volume_in_level);
+					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "MAX ENERGY THRESHOLD! -%d\n", dec);
+					switch_change_sln_volume(read_frame->data, (read_frame->datalen / 2) * member->conference->channels, -1 * dec);
+				} 
 			}
 
-			if ((samples = read_frame->datalen / sizeof(*data))) {
-				for (i = 0; i < samples; i++) {
-					energy += abs(data[j]);
-					j++;
+			if (member->mute_counter > 0) {
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "MAX ENERGY DECAY %d\n", member->mute_counter);
+				member->mute_counter--;
+				switch_generate_sln_silence(read_frame->data, (read_frame->datalen / 2), member->conference->channels, 1400 * (member->conference->rate / 8000));
+				if (member->mute_counter == 0) {
+					member->max_energy_hits = 0;
 				}
-
-				member->score = energy / samples;
 			}
+			
+			if (conference_utils_member_test_flag(member, MFLAG_TALKING)) {
+				member->talking_count++;
 
-			if (member->vol_period) {
-				member->vol_period--;
-			}
+				if (gate_check) {
+					int gate_count = 0, nogate_count = 0;
+					double pct;
+					member->score_accum += member->score;
+					member->score_delta_accum += abs(member->score - member->last_score);
+					member->score_count++;
+					member->score_avg = member->score_accum / member->score_count;
 
-			gate_check = conference_member_noise_gate_check(member);
+					member->gate_count++;
+					member->gate_open = 1;
 
-			if (gate_check && member->agc) {
-				switch_agc_feed(member->agc, (int16_t *)read_frame->data, (read_frame->datalen / 2) * member->conference->channels, 1);
-			}
+					gate_count = member->gate_count;
+					nogate_count = member->nogate_count;
 
-			score_iir = (int) (((1.0 - SCORE_DECAY) * (float) member->score) + (SCORE_DECAY * (float) member->score_iir));
+					if (!gate_count) {
+						pct = 0;
+					} else {
+						pct = ((float)nogate_count / (float)gate_count) * 100;
+					}
+				
+					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "TRACK %d %d %d/%d %f\n", 
+									  member->score, 
+									  member->score_avg,
+									  gate_count, nogate_count, pct);
+					
 
-			if (score_iir > SCORE_MAX_IIR) {
-				score_iir = SCORE_MAX_IIR;
+				} else {
+					member->nogate_count++;
+					member->gate_open = 0;
+				}
+			
 			}
+		
+			if (conference_utils_member_test_flag(member, MFLAG_TALK_DATA_EVENTS)) {
+				if (++member->talk_track >= (1000 / member->conference->interval * 10)) {
+					uint32_t diff = 0; 
+					double avg = 0;
+					switch_event_t *event;
+
+					if (switch_event_create_subclass(&event, SWITCH_EVENT_CUSTOM, CONF_EVENT_MAINT) == SWITCH_STATUS_SUCCESS) {
+						conference_member_add_event_data(member, event);
+				
 
-			conference_member_set_score_iir(member, score_iir);
-			
-			if (member->auto_energy_level && !conference_utils_member_test_flag(member, MFLAG_TALKING)) {
-				if (++member->auto_energy_track >= (1000 / member->conference->interval * member->conference->auto_energy_sec)) {
-					if (member->energy_level > member->conference->energy_level) {
-						int new_level = member->energy_level - 100;
-						
-						if (new_level < member->conference->energy_level) {
-							new_level = member->conference->energy_level;
+						if (member->first_talk_detect) {
+
+							if (!member->talk_detects) {
+								member->talk_detects = 1;
+							}
+				
+							diff = (uint32_t) (switch_micro_time_now() - member->first_talk_detect) / 1000;
+							avg = (double)diff / member->talk_detects;
+							switch_event_add_header(event, SWITCH_STACK_BOTTOM, "talk-detects", "%d", member->talk_detects);
+							switch_event_add_header(event, SWITCH_STACK_BOTTOM, "talk-detect-duration", "%d", diff);
+							switch_event_add_header(event, SWITCH_STACK_BOTTOM, "talk-detect-avg", "%f", avg);
+						} else {
+							switch_event_add_header(event, SWITCH_STACK_BOTTOM, "talk-detects", "%d", 0);
 						}
-						member->energy_level = new_level;
-						switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "ENERGY DOWN %d\n", member->energy_level);
+
+				
+						switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Action", "talk-report");
+						switch_event_fire(&event);
 					}
-					member->auto_energy_track = 0;
+
+					if (!conference_utils_member_test_flag(member, MFLAG_TALKING)) {
+						member->first_talk_detect = 0;
+						member->talk_detects = 0;
+					} else {
+						member->talk_detects = 1;
+					}
+
+					member->talk_track = 0;
 				}
 			}
+		}
 
-			gate_check = conference_member_noise_gate_check(member);
-
-			if (conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) && !conference_utils_member_test_flag(member, MFLAG_HOLD)) {
-				if (member->max_energy_level) {
-					if (member->score > member->max_energy_level && ++member->max_energy_hits > member->max_energy_hit_trigger) {
-						member->mute_counter = member->burst_mute_count;
-						switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "MAX ENERGY HIT!\n");
-					} else if (!member->mute_counter && member->score > (int)((double)member->max_energy_level * .75)) {
-						int dec = 1;
-
-						if (member->score_count > 9) {
-							dec = 4;
-						} else if (member->score_count > 6) {
-							dec = 3;
-						} else if (member->score_count > 3) {
-							dec = 2;
-						}
 
-						switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "MAX ENERGY THRESHOLD! -%d\n", dec);
-						switch_change_sln_volume(read_frame->data, (read_frame->datalen / 2) * member->conference->channels, -1 * dec);
-					} 
-				}
+		if (gate_check) {
+			uint32_t diff = member->score - member->energy_level;
+			if (member->hangover_hits) {
+				member->hangover_hits--;
+			}
 
-				if (member->mute_counter > 0) {
-					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "MAX ENERGY DECAY %d\n", member->mute_counter);
-					member->mute_counter--;
-					switch_generate_sln_silence(read_frame->data, (read_frame->datalen / 2), member->conference->channels, 1400 * (member->conference->rate / 8000));
-					if (member->mute_counter == 0) {
-						member->max_energy_hits = 0;
-					}
-				}
-				
-				if (conference_utils_member_test_flag(member, MFLAG_TALKING)) {
-					member->talking_count++;
+			if (member->id == member->conference->floor_holder) {
+				member->floor_packets++;
+			}
 
-					if (gate_check) {
-						int gate_count = 0, nogate_count = 0;
-						double pct;
-						member->score_accum += member->score;
-						member->score_delta_accum += abs(member->score - member->last_score);
-						member->score_count++;
-						member->score_avg = member->score_accum / member->score_count;
+			if (diff >= diff_level || ++member->hangunder_hits >= hangunder) {
 
-						member->gate_count++;
-						member->gate_open = 1;
+				member->hangover_hits = member->hangunder_hits = 0;
+				member->last_talking = switch_epoch_time_now(NULL);
 
-						gate_count = member->gate_count;
-						nogate_count = member->nogate_count;
+				if (!conference_utils_member_test_flag(member, MFLAG_TALKING)) {
+					conference_utils_member_set_flag_locked(member, MFLAG_TALKING);
+					conference_member_update_status_field(member);
+					member->floor_packets = 0;
 
-						if (!gate_count) {
-							pct = 0;
-						} else {
-							pct = ((float)nogate_count / (float)gate_count) * 100;
-						}
 					
-						switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG2, "TRACK %d %d %d/%d %f\n", 
-										  member->score, 
-										  member->score_avg,
-										  gate_count, nogate_count, pct);
-						
-
-					} else {
-						member->nogate_count++;
-						member->gate_open = 0;
+					if (!member->first_talk_detect) {
+						member->first_talk_detect = switch_micro_time_now();
 					}
-				
-				}
-			
-				if (conference_utils_member_test_flag(member, MFLAG_TALK_DATA_EVENTS)) {
-					if (++member->talk_track >= (1000 / member->conference->interval * 10)) {
-						uint32_t diff = 0; 
-						double avg = 0;
-						switch_event_t *event;
-
-						if (switch_event_create_subclass(&event, SWITCH_EVENT_CUSTOM, CONF_EVENT_MAINT) == SWITCH_STATUS_SUCCESS) {
-							conference_member_add_event_data(member, event);
 					
-
-							if (member->first_talk_detect) {
-
-								if (!member->talk_detects) {
-									member->talk_detects = 1;
-								}
+					member->talk_detects++;
+					member->score_delta_accum = 0;
+					member->score_accum = 0;
+					member->score_count = 0;
+					member->talking_count = 0;
 					
-								diff = (uint32_t) (switch_micro_time_now() - member->first_talk_detect) / 1000;
-								avg = (double)diff / member->talk_detects;
-								switch_event_add_header(event, SWITCH_STACK_BOTTOM, "talk-detects", "%d", member->talk_detects);
-								switch_event_add_header(event, SWITCH_STACK_BOTTOM, "talk-detect-duration", "%d", diff);
-								switch_event_add_header(event, SWITCH_STACK_BOTTOM, "talk-detect-avg", "%f", avg);
-							} else {
-								switch_event_add_header(event, SWITCH_STACK_BOTTOM, "talk-detects", "%d", 0);
-							}
+					if (test_eflag(member->conference, EFLAG_START_TALKING) && conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) &&
+						!conference_utils_member_test_flag(member, MFLAG_HOLD) &&
+						switch_event_create_subclass(&event, SWITCH_EVENT_CUSTOM, CONF_EVENT_MAINT) == SWITCH_STATUS_SUCCESS) {
+						conference_member_add_event_data(member, event);
+						switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Action", "start-talking");
+						switch_event_fire(&event);
+					}
 
-					
-							switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Action", "talk-report");
-							switch_event_fire(&event);
-						}
+					if (conference_utils_member_test_flag(member, MFLAG_MUTE_DETECT) && !conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK)) {
 
-						if (!conference_utils_member_test_flag(member, MFLAG_TALKING)) {
-							member->first_talk_detect = 0;
-							member->talk_detects = 0;
-						} else {
-							member->talk_detects = 1;
+						if (!zstr(member->conference->mute_detect_sound)) {
+							conference_utils_member_set_flag(member, MFLAG_INDICATE_MUTE_DETECT);
 						}
 
-						member->talk_track = 0;
+						if (test_eflag(member->conference, EFLAG_MUTE_DETECT) &&
+							switch_event_create_subclass(&event, SWITCH_EVENT_CUSTOM, CONF_EVENT_MAINT) == SWITCH_STATUS_SUCCESS) {
+							conference_member_add_event_data(member, event);
+							switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Action", "mute-detect");
+							switch_event_fire(&event);
+						}
 					}
 				}
 			}
+		} else {
+			if (member->hangunder_hits) {
+				member->hangunder_hits--;
+			}
 
+			if (conference_utils_member_test_flag(member, MFLAG_TALKING) && conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) &&
+				!conference_utils_member_test_flag(member, MFLAG_HOLD)) {
+				if (++member->hangover_hits >= hangover) {
+					member->hangover_hits = member->hangunder_hits = 0;
 
-			if (gate_check) {
-				uint32_t diff = member->score - member->energy_level;
-				if (hangover_hits) {
-					hangover_hits--;
-				}
+					if (member->nogate_count < hangover) {
+						member->nogate_count = 0;
+					} else {
+						member->nogate_count -= hangover;
+					}
+
+					conference_utils_member_clear_flag_locked(member, MFLAG_TALKING);
+					conference_member_update_status_field(member);
 
-				if (member->id == member->conference->floor_holder) {
-					member->floor_packets++;
+					stop_talking_handler(member);						
 				}
+			}
+		}
 
-				if (diff >= diff_level || ++hangunder_hits >= hangunder) {
 
-					hangover_hits = hangunder_hits = 0;
-					member->last_talking = switch_epoch_time_now(NULL);
+		member->last_score = member->score;
 
-					if (!conference_utils_member_test_flag(member, MFLAG_TALKING)) {
-						conference_utils_member_set_flag_locked(member, MFLAG_TALKING);
-						conference_member_update_status_field(member);
-						member->floor_packets = 0;
+		if ((switch_channel_test_flag(channel, CF_VIDEO) || member->avatar_png_img) && (member->id == member->conference->floor_holder)) {
+			if (member->id != member->conference->video_floor_holder &&
+				(member->floor_packets > member->conference->video_floor_packets || member->energy_level == 0)) {
+				conference_video_set_floor_holder(member->conference, member, SWITCH_FALSE);
+			}
+		}
+	}
 
-						
-						if (!member->first_talk_detect) {
-							member->first_talk_detect = switch_micro_time_now();
-						}
-						
-						member->talk_detects++;
-						member->score_delta_accum = 0;
-						member->score_accum = 0;
-						member->score_count = 0;
-						member->talking_count = 0;
-						
-						if (test_eflag(member->conference, EFLAG_START_TALKING) && conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) &&
-							!conference_utils_member_test_flag(member, MFLAG_HOLD) &&
-							switch_event_create_subclass(&event, SWITCH_EVENT_CUSTOM, CONF_EVENT_MAINT) == SWITCH_STATUS_SUCCESS) {
-							conference_member_add_event_data(member, event);
-							switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Action", "start-talking");
-							switch_event_fire(&event);
-						}
+	/* skip frames that are not actual media or when we are muted or silent */
+	if ((conference_utils_member_test_flag(member, MFLAG_TALKING) || member->energy_level == 0 || conference_utils_test_flag(member->conference, CFLAG_AUDIO_ALWAYS))
+		&& conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) && !conference_utils_test_flag(member->conference, CFLAG_WAIT_MOD)
+		&& !conference_utils_member_test_flag(member, MFLAG_HOLD)
+		&& (member->conference->count > 1 || (member->conference->record_count && member->conference->count >= member->conference->min_recording_participants))) {
+		switch_audio_resampler_t *read_resampler = member->read_resampler;
+		void *data;
+		uint32_t datalen;
+
+		if (read_resampler) {
+			int16_t *bptr = (int16_t *) read_frame->data;
+			int len = (int) read_frame->datalen;
+
+			switch_resample_process(read_resampler, bptr, len / 2 / member->read_impl.number_of_channels);
+			memcpy(member->resample_out, read_resampler->to, read_resampler->to_len * 2 * member->read_impl.number_of_channels);
+			len = read_resampler->to_len * 2 * member->read_impl.number_of_channels;
+			datalen = len;
+			data = member->resample_out;
+		} else {
+			data = read_frame->data;
+			datalen = read_frame->datalen;
+		}
 
-						if (conference_utils_member_test_flag(member, MFLAG_MUTE_DETECT) && !conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK)) {
+		tmp_frame.data = data;
+		tmp_frame.datalen = datalen;
+		tmp_frame.rate = member->conference->rate;
+		conference_member_check_channels(&tmp_frame, member, SWITCH_TRUE);
 
-							if (!zstr(member->conference->mute_detect_sound)) {
-								conference_utils_member_set_flag(member, MFLAG_INDICATE_MUTE_DETECT);
-							}
 
-							if (test_eflag(member->conference, EFLAG_MUTE_DETECT) &&
-								switch_event_create_subclass(&event, SWITCH_EVENT_CUSTOM, CONF_EVENT_MAINT) == SWITCH_STATUS_SUCCESS) {
-								conference_member_add_event_data(member, event);
-								switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Action", "mute-detect");
-								switch_event_fire(&event);
-							}
-						}
-					}
-				}
-			} else {
-				if (hangunder_hits) {
-					hangunder_hits--;
-				}
+		if (datalen) {
+			switch_size_t ok = 1;
+			
+			/* Write the audio into the input buffer */
+			switch_mutex_lock(member->audio_in_mutex);
+			if (switch_buffer_inuse(member->audio_buffer) > flush_len) {
+				switch_buffer_toss(member->audio_buffer, tmp_frame.datalen);
+			}
+			ok = switch_buffer_write(member->audio_buffer, tmp_frame.data, tmp_frame.datalen);
+			switch_mutex_unlock(member->audio_in_mutex);
+			if (!ok) {
+				switch_mutex_unlock(member->read_mutex);
+				return SWITCH_STATUS_FALSE;
+			}
+		}
+	}
 
-				if (conference_utils_member_test_flag(member, MFLAG_TALKING) && conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) &&
-					!conference_utils_member_test_flag(member, MFLAG_HOLD)) {
-					if (++hangover_hits >= hangover) {
-						hangover_hits = hangunder_hits = 0;
+ do_continue:
 
-						if (member->nogate_count < hangover) {
-							member->nogate_count = 0;
-						} else {
-							member->nogate_count -= hangover;
-						}
+	switch_mutex_unlock(member->read_mutex);
 
-						conference_utils_member_clear_flag_locked(member, MFLAG_TALKING);
-						conference_member_update_status_field(member);
+	return SWITCH_STATUS_SUCCESS;
+}
 
-						stop_talking_handler(member);						
-					}
-				}
+/* input thread for the call leg, as long as we have a valid read, feed that data into an input buffer where
+   the conference thread will take it and mux it with any audio from other channels */
+void *SWITCH_THREAD_FUNC conference_loop_input(switch_thread_t *thread, void *obj)
+{
+	conference_member_t *member = obj;
+	switch_status_t status;
+
+	if (conference_loop_input_start(member) == SWITCH_STATUS_SUCCESS) {
+		while ((status = conference_loop_input_frame(member, SWITCH_IO_FLAG_NONE)) != SWITCH_STATUS_FALSE) {
+			if (status == SWITCH_STATUS_BREAK) {
+				switch_yield(100000);
 			}
+		}
 
+		conference_loop_input_stop(member);
+	}
 
-			member->last_score = member->score;
+	conference_utils_member_clear_flag_locked(member, MFLAG_ITHREAD);
 
-			if ((switch_channel_test_flag(channel, CF_VIDEO) || member->avatar_png_img) && (member->id == member->conference->floor_holder)) {
-				if (member->id != member->conference->video_floor_holder &&
-					(member->floor_packets > member->conference->video_floor_packets || member->energy_level == 0)) {
-					conference_video_set_floor_holder(member->conference, member, SWITCH_FALSE);
-				}
-			}
-		}
+	return NULL;
+}
 
-		/* skip frames that are not actual media or when we are muted or silent */
-		if ((conference_utils_member_test_flag(member, MFLAG_TALKING) || member->energy_level == 0 || conference_utils_test_flag(member->conference, CFLAG_AUDIO_ALWAYS))
-			&& conference_utils_member_test_flag(member, MFLAG_CAN_SPEAK) && !conference_utils_test_flag(member->conference, CFLAG_WAIT_MOD)
-			&& !conference_utils_member_test_flag(member, MFLAG_HOLD)
-			&& (member->conference->count > 1 || (member->conference->record_count && member->conference->count >= member->conference->min_recording_participants))) {
-			switch_audio_resampler_t *read_resampler = member->read_resampler;
-			void *data;
-			uint32_t datalen;
-
-			if (read_resampler) {
-				int16_t *bptr = (int16_t *) read_frame->data;
-				int len = (int) read_frame->datalen;
-
-				switch_resample_process(read_resampler, bptr, len / 2 / member->read_impl.number_of_channels);
-				memcpy(member->resample_out, read_resampler->to, read_resampler->to_len * 2 * member->read_impl.number_of_channels);
-				len = read_resampler->to_len * 2 * member->read_impl.number_of_channels;
-				datalen = len;
-				data = member->resample_out;
-			} else {
-				data = read_frame->data;
-				datalen = read_frame->datalen;
-			}
 
-			tmp_frame.data = data;
-			tmp_frame.datalen = datalen;
-			tmp_frame.rate = member->conference->rate;
-			conference_member_check_channels(&tmp_frame, member, SWITCH_TRUE);
+static void conference_loop_io_detach(conference_io_worker_t *worker, uint32_t i)
+{
+	conference_member_t *member = worker->members[i];
 
+	worker->members[i] = worker->members[--worker->member_count];
+	member->io_worker = NULL;
 
-			if (datalen) {
-				switch_size_t ok = 1;
-				
-				/* Write the audio into the input buffer */
-				switch_mutex_lock(member->audio_in_mutex);
-				if (switch_buffer_inuse(member->audio_buffer) > flush_len) {
-					switch_buffer_toss(member->audio_buffer, tmp_frame.datalen);
-				}
-				ok = switch_buffer_write(member->audio_buffer, tmp_frame.data, tmp_frame.datalen);
-				switch_mutex_unlock(member->audio_in_mutex);
-				if (!ok) {
-					switch_mutex_unlock(member->read_mutex);
-					break;
-				}
+	conference_loop_input_stop(member);
+	conference_utils_member_clear_flag_locked(member, MFLAG_ITHREAD);
+}
+
+/* reads one frame for each of its members every conference tick instead of a blocking input thread per member */
+static void *SWITCH_THREAD_FUNC conference_loop_io_worker_run(switch_thread_t *thread, void *obj)
+{
+	conference_io_worker_t *worker = (conference_io_worker_t *) obj;
+	conference_obj_t *conference = worker->conference;
+	uint32_t samples = switch_samples_per_packet(conference->rate, conference->interval);
+	switch_timer_t timer = { 0 };
+	switch_time_t tick_start, tick_time;
+	uint32_t i;
+
+	if (switch_core_timer_init(&timer, conference->timer_name, conference->interval, samples, NULL) != SWITCH_STATUS_SUCCESS) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Conference %s: io thread timer setup failed\n", conference->name);
+		return NULL;
+	}
+
+	while (conference->io_running) {
+		switch_core_timer_next(&timer);
+
+		tick_start = switch_time_now();
+
+		switch_mutex_lock(worker->mutex);
+		for (i = 0; i < worker->member_count;) {
+			if (conference_loop_input_frame(worker->members[i], SWITCH_IO_FLAG_NOBLOCK) == SWITCH_STATUS_FALSE) {
+				conference_loop_io_detach(worker, i);
+				continue;
 			}
+			i++;
 		}
+		switch_mutex_unlock(worker->mutex);
 
-	do_continue:
+		tick_time = switch_time_now() - tick_start;
+		worker->ticks++;
+		worker->tick_time_total += tick_time;
 
-		switch_mutex_unlock(member->read_mutex);
+		if (tick_time > worker->tick_time_max) {
+			worker->tick_time_max = tick_time;
+		}
 
+		if (tick_time > (switch_time_t) conference->interval * 1000) {
+			worker->late_ticks++;
+		}
 	}
 
-	if (switch_queue_size(member->dtmf_queue)) {
-		switch_dtmf_t *dt;
-		void *pop;
+	/* hand back whoever is left, their session threads are waiting on MFLAG_ITHREAD */
+	switch_mutex_lock(worker->mutex);
+	while (worker->member_count) {
+		conference_loop_io_detach(worker, 0);
+	}
+	switch_mutex_unlock(worker->mutex);
 
-		while (switch_queue_trypop(member->dtmf_queue, &pop) == SWITCH_STATUS_SUCCESS) {
-			dt = (switch_dtmf_t *) pop;
-			free(dt);
+	switch_core_timer_destroy(&timer);
+
+	return NULL;
+}
+
+/* give the member to the least loaded io thread, only members whose packets match the conference interval
+   qualify since every read has to be satisfied once per conference tick */
+static switch_status_t conference_loop_io_attach(conference_member_t *member)
+{
+	conference_obj_t *conference = member->conference;
+	conference_io_worker_t *worker = NULL;
+	switch_codec_implementation_t read_impl = { 0 };
+	switch_status_t status = SWITCH_STATUS_FALSE;
+	uint32_t i;
+
+	if (!conference->io_thread_count || conference_utils_member_test_flag(member, MFLAG_ITHREAD)) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	switch_core_session_get_read_impl(member->session, &read_impl);
+
+	if (read_impl.microseconds_per_packet != conference->interval * 1000) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	switch_mutex_lock(conference->io_mutex);
+
+	if (!conference->io_running) {
+		goto end;
+	}
+
+	for (i = 0; i < conference->io_thread_count; i++) {
+		if (!worker || conference->io_workers[i].member_count < worker->member_count) {
+			worker = &conference->io_workers[i];
 		}
 	}
 
+	if (conference_loop_input_start(member) != SWITCH_STATUS_SUCCESS) {
+		goto end;
+	}
 
-	switch_resample_destroy(&member->read_resampler);
-	switch_core_session_rwunlock(session);
+	switch_mutex_lock(worker->mutex);
+
+	if (worker->member_alloc == worker->member_count) {
+		worker->member_alloc = worker->member_alloc ? worker->member_alloc * 2 : 16;
+		worker->members = realloc(worker->members, sizeof(conference_member_t *) * worker->member_alloc);
+		switch_assert(worker->members);
+	}
+
+	worker->members[worker->member_count++] = member;
+	member->io_worker = worker;
+	conference_utils_member_set_flag_locked(member, MFLAG_ITHREAD);
+
+	switch_mutex_unlock(worker->mutex);
+
+	status = SWITCH_STATUS_SUCCESS;
 
  end:
 
-	conference_utils_member_clear_flag_locked(member, MFLAG_ITHREAD);
+	switch_mutex_unlock(conference->io_mutex);
 
-	return NULL;
+	return status;
 }
 
+void conference_loop_launch_io_workers(conference_obj_t *conference)
+{
+	switch_threadattr_t *thd_attr = NULL;
+	uint32_t i;
+
+	if (!conference->io_threads || conference->io_workers) {
+		return;
+	}
+
+	switch_mutex_init(&conference->io_mutex, SWITCH_MUTEX_NESTED, conference->pool);
+
+	conference->io_workers = switch_core_alloc(conference->pool, sizeof(conference_io_worker_t) * conference->io_threads);
+	conference->io_running = 1;
+
+	for (i = 0; i < conference->io_threads; i++) {
+		conference_io_worker_t *worker = &conference->io_workers[i];
 
-/* launch an input thread for the call leg */
+		worker->conference = conference;
+		switch_mutex_init(&worker->mutex, SWITCH_MUTEX_NESTED, conference->pool);
+
+		switch_threadattr_create(&thd_attr, conference->pool);
+		switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+		switch_threadattr_priority_set(thd_attr, SWITCH_PRI_REALTIME);
+
+		if (switch_thread_create(&worker->thread, thd_attr, conference_loop_io_worker_run, worker, conference->pool) != SWITCH_STATUS_SUCCESS) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Conference %s: only %u of %u io threads started\n",
+							  conference->name, i, conference->io_threads);
+			break;
+		}
+
+		switch_mutex_lock(conference->io_mutex);
+		conference->io_thread_count++;
+		switch_mutex_unlock(conference->io_mutex);
+	}
+}
+
+void conference_loop_stop_io_workers(conference_obj_t *conference)
+{
+	switch_status_t st;
+	uint32_t i, count;
+
+	if (!conference->io_workers) {
+		return;
+	}
+
+	switch_mutex_lock(conference->io_mutex);
+	conference->io_running = 0;
+	count = conference->io_thread_count;
+	conference->io_thread_count = 0;
+	switch_mutex_unlock(conference->io_mutex);
+
+	for (i = 0; i < count; i++) {
+		switch_thread_join(&st, conference->io_workers[i].thread);
+		switch_safe_free(conference->io_workers[i].members);
+	}
+}
+
+/* launch an input thread for the call leg, or hand it to the io threads when the conference has them */
 void conference_loop_launch_input(conference_member_t *member, switch_memory_pool_t *pool)
 {
 	switch_threadattr_t *thd_attr = NULL;
 
+	if (conference_loop_io_attach(member) == SWITCH_STATUS_SUCCESS) {
+		return;
+	}
+
 	switch_mutex_lock(member->flag_mutex);
 	
 	if (member != NULL && !conference_utils_member_test_flag(member, MFLAG_ITHREAD)) {
@@ -1306,7 +1514,7 @@ void conference_loop_launch_input(conference_member_t *member, switch_memory_poo
 void conference_loop_output(conference_member_t *member)
 {
 	switch_channel_t *channel;
-	switch_frame_t write_frame = { 0 };
+	switch_frame_t write_frame = { 0 }, shared_frame = { 0 }, *send_frame;
 	uint8_t *data = NULL;
 	switch_timer_t timer = { 0 };
 	uint32_t interval;
@@ -1354,6 +1562,9 @@ void conference_loop_output(conference_member_t *member)
 
 	write_frame.codec = &member->write_codec;
 
+	shared_frame.data = switch_core_session_alloc(member->session, SWITCH_RECOMMENDED_BUFFER_SIZE);
+	shared_frame.buflen = SWITCH_RECOMMENDED_BUFFER_SIZE;
+
 	/* Start the input thread */
 	conference_loop_launch_input(member, switch_core_session_get_pool(member->session));
 
@@ -1538,22 +1749,28 @@ void conference_loop_output(conference_member_t *member)
 
 			if ((write_frame.datalen = (uint32_t) switch_buffer_read(use_buffer, write_frame.data, bytes))) {
 				write_frame.samples = write_frame.datalen / 2 / member->conference->channels;
+				send_frame = &write_frame;
+
+				if (conference_member_pop_audio_ref(member, write_frame.datalen, &shared_frame) == SWITCH_STATUS_SUCCESS) {
+					/* the conference thread already encoded this frame for everyone in our codec set */
+					send_frame = &shared_frame;
+				} else {
+					if( !conference_utils_member_test_flag(member, MFLAG_CAN_HEAR)) {
+						memset(write_frame.data, 255, write_frame.datalen);
+					} else if (member->volume_out_level) { /* Check for output volume adjustments */
+						switch_change_sln_volume(write_frame.data, write_frame.samples * member->conference->channels, member->volume_out_level);
+					}
 
-				if( !conference_utils_member_test_flag(member, MFLAG_CAN_HEAR)) {
-					memset(write_frame.data, 255, write_frame.datalen);
-				} else if (member->volume_out_level) { /* Check for output volume adjustments */
-					switch_change_sln_volume(write_frame.data, write_frame.samples * member->conference->channels, member->volume_out_level);
-				}
+					//write_frame.timestamp = timer.samplecount;
 
-				//write_frame.timestamp = timer.samplecount;
+					if (member->fnode) {
+						conference_member_add_file_data(member, write_frame.data, write_frame.datalen);
+					}
 
-				if (member->fnode) {
-					conference_member_add_file_data(member, write_frame.data, write_frame.datalen);
+					conference_member_check_channels(&write_frame, member, SWITCH_FALSE);
 				}
 
-				conference_member_check_channels(&write_frame, member, SWITCH_FALSE);
-
-				if (switch_core_session_write_frame(member->session, &write_frame, SWITCH_IO_FLAG_NONE, 0) != SWITCH_STATUS_SUCCESS) {
+				if (switch_core_session_write_frame(member->session, send_frame, SWITCH_IO_FLAG_NONE, 0) != SWITCH_STATUS_SUCCESS) {
 					switch_mutex_unlock(member->audio_out_mutex);
 					switch_mutex_unlock(member->write_mutex);
 					break;
@@ -1567,6 +1784,7 @@ void conference_loop_output(conference_member_t *member)
 			if (switch_buffer_inuse(member->mux_buffer)) {
 				switch_mutex_lock(member->audio_out_mutex);
 				switch_buffer_zero(member->mux_buffer);
+				conference_member_flush_audio_refs(member);
 				switch_mutex_unlock(member->audio_out_mutex);
 			}
 			conference_utils_member_clear_flag_locked(member, MFLAG_FLUSH_BUFFER);
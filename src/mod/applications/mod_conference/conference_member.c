@@ -546,6 +546,265 @@ void conference_member_check_channels(switch_frame_t *frame, conference_member_t
 	}
 }
 
+static switch_codec_t *conference_member_shared_audio_codec(conference_obj_t *conference, conference_member_t *member)
+{
+	switch_codec_t *codec;
+
+	if (!member->session || conference_utils_member_test_flag(member, MFLAG_NOCHANNEL) ||
+		!conference_utils_member_test_flag(member, MFLAG_RUNNING) || !switch_channel_test_flag(member->channel, CF_AUDIO) ||
+		!conference_utils_member_test_flag(member, MFLAG_CAN_HEAR) ||
+		conference_utils_member_test_flag(member, MFLAG_HAS_AUDIO) ||
+		conference_utils_member_test_flag(member, MFLAG_POSITIONAL) ||
+		conference_utils_member_test_flag(member, MFLAG_NO_MINIMIZE_AUDIO_ENCODING) ||
+		conference->channels != member->read_impl.number_of_channels ||
+		conference->relationship_total || member->volume_out_level || member->fnode) {
+		return NULL;
+	}
+
+	if (!(codec = switch_core_session_get_write_codec(member->session)) || !switch_core_codec_ready(codec) ||
+		switch_test_flag(codec, SWITCH_CODEC_FLAG_PASSTHROUGH)) {
+		return NULL;
+	}
+
+	if (codec->implementation->microseconds_per_packet / 1000 != (int) conference->interval ||
+		codec->implementation->number_of_channels != conference->channels) {
+		return NULL;
+	}
+
+	return codec;
+}
+
+static audio_codec_set_t *conference_member_find_audio_codec_set(conference_obj_t *conference, switch_codec_t *check_codec)
+{
+	audio_codec_set_t *codec_set;
+	int i;
+
+	for (i = 0; i < conference->audio_write_codecs_count; i++) {
+		codec_set = conference->audio_write_codecs[i];
+
+		if (codec_set->impl == check_codec->implementation && !strcmp(switch_str_nil(codec_set->fmtp), switch_str_nil(check_codec->fmtp_in))) {
+			return switch_core_codec_ready(&codec_set->codec) ? codec_set : NULL;
+		}
+	}
+
+	if (i >= MAX_MUX_CODECS) {
+		return NULL;
+	}
+
+	codec_set = switch_core_alloc(conference->pool, sizeof(*codec_set));
+	codec_set->impl = check_codec->implementation;
+	codec_set->bytes = switch_samples_per_packet(conference->rate, conference->interval) * 2 * conference->channels;
+
+	if (check_codec->fmtp_in) {
+		codec_set->fmtp = switch_core_strdup(conference->pool, check_codec->fmtp_in);
+	}
+
+	conference->audio_write_codecs[i] = codec_set;
+	conference->audio_write_codecs_count = i + 1;
+
+	if (switch_core_codec_copy(check_codec, &codec_set->codec, NULL, conference->pool) != SWITCH_STATUS_SUCCESS) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Cannot set up audio write codec %s at slot %d\n",
+						  check_codec->implementation->iananame, i);
+		return NULL;
+	}
+
+	if (codec_set->codec.implementation != check_codec->implementation) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Audio write codec %s at slot %d does not match the channel codec\n",
+						  check_codec->implementation->iananame, i);
+		switch_core_codec_destroy(&codec_set->codec);
+		return NULL;
+	}
+
+	if (conference->rate != (uint32_t)codec_set->impl->actual_samples_per_second &&
+		switch_resample_create(&codec_set->resampler, conference->rate, codec_set->impl->actual_samples_per_second,
+							   codec_set->bytes, SWITCH_RESAMPLE_QUALITY, conference->channels) != SWITCH_STATUS_SUCCESS) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Cannot set up resampler for audio write codec %s at slot %d\n",
+						  check_codec->implementation->iananame, i);
+		switch_core_codec_destroy(&codec_set->codec);
+		return NULL;
+	}
+
+	for (i = 0; i < MAX_AUDIO_MUX_FRAMES; i++) {
+		codec_set->frames[i].data = switch_core_alloc(conference->pool, SWITCH_RECOMMENDED_BUFFER_SIZE);
+	}
+
+	switch_mutex_init(&codec_set->mutex, SWITCH_MUTEX_NESTED, conference->pool);
+
+	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG, "Setting up audio write codec %s at slot %d\n",
+					  codec_set->impl->iananame, conference->audio_write_codecs_count - 1);
+
+	return codec_set;
+}
+
+/* Called once per mux tick with the conference mutex held, after the member audio has been read,
+   returns how many codec sets have enough members to be worth encoding */
+int conference_member_check_audio_codec_sets(conference_obj_t *conference)
+{
+	conference_member_t *member;
+	switch_codec_t *check_codec;
+	int i, sets = 0;
+
+	conference->audio_mux_tick++;
+
+	for (i = 0; i < conference->audio_write_codecs_count; i++) {
+		conference->audio_write_codecs[i]->members = 0;
+	}
+
+	for (member = conference->members; member; member = member->next) {
+		member->audio_codec_set = NULL;
+
+		if (!conference_utils_test_flag(conference, CFLAG_MINIMIZE_AUDIO_ENCODING)) {
+			continue;
+		}
+
+		if ((check_codec = conference_member_shared_audio_codec(conference, member)) &&
+			(member->audio_codec_set = conference_member_find_audio_codec_set(conference, check_codec))) {
+			if (++member->audio_codec_set->members == 2) {
+				sets++;
+			}
+		}
+	}
+
+	return sets;
+}
+
+/* Encode the listener mix once for every codec set with more than one member */
+void conference_member_encode_audio_codec_sets(conference_obj_t *conference, int16_t *data, uint32_t bytes)
+{
+	audio_codec_set_t *codec_set;
+	audio_mux_frame_t *mux_frame;
+	int i;
+
+	for (i = 0; i < conference->audio_write_codecs_count; i++) {
+		void *pcm = data;
+		uint32_t pcm_len = bytes, rate = conference->rate, enc_rate = 0, enc_len = SWITCH_RECOMMENDED_BUFFER_SIZE, seq;
+		unsigned int flag = 0;
+
+		codec_set = conference->audio_write_codecs[i];
+
+		if (codec_set->members < 2 || bytes != codec_set->bytes) {
+			continue;
+		}
+
+		if (codec_set->resampler) {
+			switch_resample_process(codec_set->resampler, data, bytes / 2 / conference->channels);
+			pcm = codec_set->resampler->to;
+			pcm_len = codec_set->resampler->to_len * 2 * conference->channels;
+			rate = codec_set->resampler->to_rate;
+		}
+
+		seq = codec_set->seq + 1;
+		mux_frame = &codec_set->frames[seq % MAX_AUDIO_MUX_FRAMES];
+
+		/* output threads may still be copying older frames out of the ring, only this slot is taken away from them */
+		switch_mutex_lock(codec_set->mutex);
+		mux_frame->seq = 0;
+		switch_mutex_unlock(codec_set->mutex);
+
+		if (switch_core_codec_encode(&codec_set->codec, NULL, pcm, pcm_len, rate,
+									 mux_frame->data, &enc_len, &enc_rate, &flag) != SWITCH_STATUS_SUCCESS || !enc_len) {
+			/* everybody in the set encodes on their own this tick */
+			continue;
+		}
+
+		switch_mutex_lock(codec_set->mutex);
+		mux_frame->datalen = enc_len;
+		mux_frame->samples = codec_set->impl->samples_per_packet;
+		mux_frame->seq = codec_set->seq = seq;
+		switch_mutex_unlock(codec_set->mutex);
+
+		codec_set->tick = conference->audio_mux_tick;
+		conference->audio_encodes++;
+		conference->audio_encodes_saved += codec_set->members - 1;
+	}
+}
+
+/* The codec set whose frame this member gets for the current tick, if any, safe to call from the mix workers */
+audio_codec_set_t *conference_member_share_audio(conference_obj_t *conference, conference_member_t *member, uint32_t bytes)
+{
+	audio_codec_set_t *codec_set = member->audio_codec_set;
+
+	if (!codec_set || codec_set->tick != conference->audio_mux_tick || bytes != codec_set->bytes) {
+		return NULL;
+	}
+
+	return codec_set;
+}
+
+/* Record which shared frame belongs to the frame just written to the mux_buffer, call with audio_out_mutex held */
+void conference_member_push_audio_ref(conference_member_t *member, audio_codec_set_t *codec_set)
+{
+	audio_mux_ref_t *ref = &member->audio_mux_refs[member->audio_mux_written % MAX_AUDIO_MUX_REFS];
+
+	ref->codec_set = codec_set;
+	ref->seq = codec_set ? codec_set->seq : 0;
+	ref->pos = member->audio_mux_written++;
+}
+
+/* Fetch the shared frame for the frame just read from the mux_buffer, call with audio_out_mutex held */
+switch_status_t conference_member_pop_audio_ref(conference_member_t *member, uint32_t bytes, switch_frame_t *frame)
+{
+	uint32_t pos = member->audio_mux_read++;
+	audio_mux_ref_t *ref = &member->audio_mux_refs[pos % MAX_AUDIO_MUX_REFS];
+	audio_codec_set_t *codec_set = ref->codec_set;
+	audio_mux_frame_t *mux_frame;
+	switch_status_t status = SWITCH_STATUS_FALSE;
+
+	if (ref->pos != pos || !codec_set || bytes != codec_set->bytes) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	/* anything touching the decoded audio on the way out needs a private encode */
+	if (!conference_utils_member_test_flag(member, MFLAG_CAN_HEAR) || member->volume_out_level || member->fnode) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	if (!member->session || !(frame->codec = switch_core_session_get_write_codec(member->session)) ||
+		frame->codec->implementation != codec_set->impl) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	switch_mutex_lock(codec_set->mutex);
+	mux_frame = &codec_set->frames[ref->seq % MAX_AUDIO_MUX_FRAMES];
+
+	if (mux_frame->seq == ref->seq && mux_frame->datalen <= frame->buflen) {
+		memcpy(frame->data, mux_frame->data, mux_frame->datalen);
+		frame->datalen = mux_frame->datalen;
+		frame->samples = mux_frame->samples;
+		frame->rate = codec_set->impl->actual_samples_per_second;
+		status = SWITCH_STATUS_SUCCESS;
+	}
+	switch_mutex_unlock(codec_set->mutex);
+
+	return status;
+}
+
+/* The mux_buffer was emptied, nothing recorded for it is valid anymore, call with audio_out_mutex held */
+void conference_member_flush_audio_refs(conference_member_t *member)
+{
+	member->audio_mux_read = member->audio_mux_written;
+}
+
+void conference_member_destroy_audio_codec_sets(conference_obj_t *conference)
+{
+	audio_codec_set_t *codec_set;
+	int i;
+
+	for (i = 0; i < conference->audio_write_codecs_count; i++) {
+		codec_set = conference->audio_write_codecs[i];
+
+		if (switch_core_codec_ready(&codec_set->codec)) {
+			switch_core_codec_destroy(&codec_set->codec);
+		}
+
+		if (codec_set->resampler) {
+			switch_resample_destroy(&codec_set->resampler);
+		}
+	}
+
+	conference->audio_write_codecs_count = 0;
+}
+
 
 void conference_member_add_file_data(conference_member_t *member, int16_t *data, switch_size_t file_data_len)
 {
@@ -836,6 +1095,10 @@ switch_status_t conference_member_add(conference_obj_t *conference, conference_m
 
 		conference_video_reset_member_codec_index(member);
 
+		if ((var = switch_channel_get_variable(channel, "audio_use_dedicated_encoder")) && switch_true(var)) {
+			conference_utils_member_set_flag_locked(member, MFLAG_NO_MINIMIZE_AUDIO_ENCODING);
+		}
+
 		if (has_video) {
 			int bitrate = conference->video_codec_settings.video.bandwidth;
 			
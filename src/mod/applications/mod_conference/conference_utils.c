@@ -154,6 +154,8 @@ void conference_utils_set_mflags(const char *flags, member_flag_t *f)
 				f[MFLAG_NO_VIDEO_BLANKS] = 1;
 			} else if (!strcasecmp(argv[i], "no-minimize-encoding")) {
 				f[MFLAG_NO_MINIMIZE_ENCODING] = 1;
+			} else if (!strcasecmp(argv[i], "no-minimize-audio-encoding")) {
+				f[MFLAG_NO_MINIMIZE_AUDIO_ENCODING] = 1;
 			} else if (!strcasecmp(argv[i], "second-screen")) {
 				f[MFLAG_SECOND_SCREEN] = 1;
 				f[MFLAG_CAN_SPEAK] = 0;
@@ -206,6 +208,8 @@ void conference_utils_set_cflags(const char *flags, conference_flag_t *f)
 				f[CFLAG_POSITIONAL] = 1;
 			} else if (!strcasecmp(argv[i], "minimize-video-encoding")) {
 				f[CFLAG_MINIMIZE_VIDEO_ENCODING] = 1;
+			} else if (!strcasecmp(argv[i], "minimize-audio-encoding")) {
+				f[CFLAG_MINIMIZE_AUDIO_ENCODING] = 1;
 			} else if (!strcasecmp(argv[i], "video-bridge-first-two")) {
 				f[CFLAG_VIDEO_BRIDGE_FIRST_TWO] = 1;
 			} else if (!strcasecmp(argv[i], "video-required-for-canvas")) {
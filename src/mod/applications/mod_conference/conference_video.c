@@ -413,6 +413,7 @@ void conference_video_reset_layer(mcu_layer_t *layer)
 	layer->banner_patched = 0;
 	layer->is_avatar = 0;
 	layer->need_patch = 0;
+	layer->scaled_cached = 0;
 	layer->manual_border = 0;
 	
 	conference_video_reset_layer_cam(layer);
@@ -503,12 +504,12 @@ static void set_bounds(int *x, int *y, int img_w, int img_h, int crop_w, int cro
 
 }
 
-void conference_video_scale_and_patch(mcu_layer_t *layer, switch_image_t *ximg, switch_bool_t freeze)
+/* the caller holds the canvas mutex, layers that do not overlap may be patched from several threads at once */
+static void scale_and_patch_layer(mcu_layer_t *layer, switch_image_t *ximg, switch_bool_t freeze)
 {
 	switch_image_t *IMG, *img;
-	int img_changed = 0, want_w = 0, want_h = 0, border = 0;
-
-	switch_mutex_lock(layer->canvas->mutex);
+	int img_changed = 0, want_w = 0, want_h = 0, border = 0, cached = 0;
+	switch_time_t start;
 
 	IMG = layer->canvas->img;
 	img = ximg ? ximg : layer->cur_img;
@@ -516,9 +517,10 @@ void conference_video_scale_and_patch(mcu_layer_t *layer, switch_image_t *ximg,
 	switch_assert(IMG);
 
 	if (!img) {
-		switch_mutex_unlock(layer->canvas->mutex);
 		return;
 	}
+
+	start = switch_time_now();
 	//printf("RAW %dx%d\n", img->d_w, img->d_h);
 
 	if (layer->img_count++ == 0 || layer->last_w != img->d_w || layer->last_h != img->d_h) {
@@ -560,6 +562,10 @@ void conference_video_scale_and_patch(mcu_layer_t *layer, switch_image_t *ximg,
 	layer->last_w = img->d_w;
 	layer->last_h = img->d_h;
 
+	/* layer->img still holds this very image scaled, unless something about it changed */
+	cached = layer->scaled_cached && !ximg && !img_changed && !freeze && !layer->bugged && !layer->overlay_img;
+	layer->scaled_cached = 0;
+
 
 	if (layer->bugged) {
 		if (layer->member_id > -1 && layer->member && switch_thread_rwlock_tryrdlock(layer->member->rwlock) == SWITCH_STATUS_SUCCESS) {
@@ -638,6 +644,8 @@ void conference_video_scale_and_patch(mcu_layer_t *layer, switch_image_t *ximg,
 			int can_zoom = 0;
 			int did_zoom = 0;
 
+			cached = 0;
+
 			if (screen_aspect <= img_aspect) {
 				if (img->d_h != layer->screen_h) {
 					scale = (double)layer->screen_h / img->d_h;
@@ -844,6 +852,7 @@ void conference_video_scale_and_patch(mcu_layer_t *layer, switch_image_t *ximg,
 		switch_mutex_lock(layer->overlay_mutex);
 		if (!layer->img) {
 			layer->img = switch_img_alloc(NULL, SWITCH_IMG_FMT_I420, img_w, img_h, 1);
+			cached = 0;
 		}
 		switch_mutex_unlock(layer->overlay_mutex);
 
@@ -858,9 +867,13 @@ void conference_video_scale_and_patch(mcu_layer_t *layer, switch_image_t *ximg,
 
 		//printf("SCALE %d,%d %dx%d\n", x_pos, y_pos, img_w, img_h);
 
-		switch_img_scale(img, &layer->img, img_w, img_h);
-		
-		if (layer->logo_img) {
+		if (cached) {
+			switch_atomic_inc(&layer->canvas->scale_cache_hits);
+		} else {
+			switch_img_scale(img, &layer->img, img_w, img_h);
+		}
+
+		if (layer->logo_img && !cached) {
 			//int ew = layer->screen_w - (border * 2), eh = layer->screen_h - (layer->banner_img ? layer->banner_img->d_h : 0) - (border * 2);
 			int ew = layer->img->d_w - (border * 2), eh = layer->img->d_h - (border * 2);
 			int ex = 0, ey = 0;
@@ -924,8 +937,14 @@ void conference_video_scale_and_patch(mcu_layer_t *layer, switch_image_t *ximg,
 		switch_img_patch(IMG, img, 0, 0);
 	}
 
-	switch_mutex_unlock(layer->canvas->mutex);
+	layer->patch_time += switch_time_now() - start;
+}
 
+void conference_video_scale_and_patch(mcu_layer_t *layer, switch_image_t *ximg, switch_bool_t freeze)
+{
+	switch_mutex_lock(layer->canvas->mutex);
+	scale_and_patch_layer(layer, ximg, freeze);
+	switch_mutex_unlock(layer->canvas->mutex);
 }
 
 void conference_video_set_canvas_bgcolor(mcu_canvas_t *canvas, char *color)
@@ -1281,7 +1300,8 @@ void conference_video_layer_set_banner(conference_member_t *member, mcu_layer_t
 	switch_event_t *params = NULL;
 	const char *font_face = NULL;
 	const char *var, *tmp = NULL;
-	char *dup = NULL;
+	char *dup = NULL, *key = NULL;
+	switch_image_t *cached = NULL;
 
 	switch_mutex_lock(layer->canvas->mutex);
 
@@ -1376,6 +1396,15 @@ void conference_video_layer_set_banner(conference_member_t *member, mcu_layer_t
 		switch_img_txt_handle_destroy(&layer->txthandle);
 	}
 
+	/* the same banner comes back on every layout change and rejoin */
+	key = switch_mprintf("banner|%s|%s|%s|%u|%u|%s", switch_str_nil(font_face), fg, bg, font_size, layer->screen_w, text);
+
+	if ((cached = switch_img_cache_get(key))) {
+		switch_img_free(&layer->banner_img);
+		layer->banner_img = cached;
+		goto end;
+	}
+
 	switch_img_txt_handle_create(&layer->txthandle, font_face, fg, bg, font_size, 0, NULL);
 
 	if (!layer->txthandle) {
@@ -1394,11 +1423,13 @@ void conference_video_layer_set_banner(conference_member_t *member, mcu_layer_t
 	layer->banner_img = switch_img_alloc(NULL, SWITCH_IMG_FMT_I420, layer->screen_w, font_size * 2, 1);
 	conference_video_reset_image(layer->banner_img, &bgcolor);
 	switch_img_txt_handle_render(layer->txthandle, layer->banner_img, font_size / 2, font_size / 2, text, NULL, fg, bg, 0, 0);
+	switch_img_cache_put(key, layer->banner_img);
 
  end:
 
 	if (params) switch_event_destroy(&params);
 
+	switch_safe_free(key);
 	switch_safe_free(dup);
 
 	switch_mutex_unlock(layer->canvas->mutex);
@@ -1412,6 +1443,14 @@ void conference_video_reset_video_bitrate_counters(conference_member_t *member)
 	member->layer_loops = 0;
 }
 
+/* members who join or ask for a refresh can be served from the keyframe cache of their codec group */
+static switch_bool_t conference_video_keyframe_cache_usable(conference_member_t *member)
+{
+	return member->conference->video_keyframe_cache_size &&
+		conference_utils_test_flag(member->conference, CFLAG_MINIMIZE_VIDEO_ENCODING) &&
+		!conference_utils_member_test_flag(member, MFLAG_NO_MINIMIZE_ENCODING);
+}
+
 switch_status_t conference_video_attach_video_layer(conference_member_t *member, mcu_canvas_t *canvas, int idx)
 {
 	mcu_layer_t *layer = NULL;
@@ -1515,7 +1554,10 @@ switch_status_t conference_video_attach_video_layer(conference_member_t *member,
 	conference_utils_member_set_flag_locked(member, MFLAG_VIDEO_JOIN);
 	switch_channel_set_flag(member->channel, CF_VIDEO_REFRESH_REQ);
 	layer->manual_border = member->video_manual_border;
-	canvas->send_keyframe = 30;
+
+	if (!conference_video_keyframe_cache_usable(member)) {
+		canvas->send_keyframe = 30;
+	}
 
 	//member->watching_canvas_id = canvas->canvas_id;
 	conference_video_check_used_layers(canvas);
@@ -1857,6 +1899,135 @@ void conference_video_destroy_canvas(mcu_canvas_t **canvasP) {
 	*canvasP = NULL;
 }
 
+/* Keyframe cache
+ *
+ * With video-keyframe-cache-size each codec group keeps its packets from the last keyframe the
+ * encoder produced on.  A member who joins or asks for a refresh gets that run of packets in front
+ * of the live stream and the rest of the group keeps its delta frames.  When the run outgrows the
+ * cache, the encoder is reset or a replay does not fit the member's queue, it falls back to making
+ * the whole group send a keyframe like before, see conference_video_keyframe_cache_usable().
+ */
+void conference_video_keyframe_cache_add(conference_obj_t *conference, codec_set_t *codec_set, switch_frame_t *frame)
+{
+	keyframe_cache_t *cache = codec_set->keyframe_cache;
+	switch_bool_t start;
+
+	if (!cache) {
+		cache = switch_core_alloc(conference->pool, sizeof(*cache));
+		cache->size = conference->video_keyframe_cache_size;
+		switch_malloc(cache->data, cache->size);
+		codec_set->keyframe_cache = cache;
+	}
+
+	start = !cache->packet_count || cache->packets[cache->packet_count - 1].m;
+
+	if (start && switch_test_flag(frame, SFF_IS_KEYFRAME)) {
+		cache->used = 0;
+		cache->packet_count = 0;
+		cache->frame_count = 0;
+		cache->valid = SWITCH_TRUE;
+	}
+
+	if (!cache->valid) {
+		return;
+	}
+
+	if (cache->packet_count == MAX_KEYFRAME_CACHE_PACKETS || cache->used + frame->packetlen > cache->size ||
+		(start && cache->frame_count == MAX_KEYFRAME_CACHE_FRAMES)) {
+		cache->valid = SWITCH_FALSE;
+		return;
+	}
+
+	cache->packets[cache->packet_count].offset = cache->used;
+	cache->packets[cache->packet_count].packetlen = frame->packetlen;
+	cache->packets[cache->packet_count].timestamp = frame->timestamp;
+	cache->packets[cache->packet_count].m = frame->m;
+	memcpy(cache->data + cache->used, frame->packet, frame->packetlen);
+
+	cache->used += frame->packetlen;
+	cache->packet_count++;
+
+	if (frame->m) {
+		cache->frame_count++;
+	}
+}
+
+switch_bool_t conference_video_keyframe_cache_ready(codec_set_t *codec_set)
+{
+	return codec_set->keyframe_cache && codec_set->keyframe_cache->valid && codec_set->keyframe_cache->packet_count;
+}
+
+/* queue the cached packets, the last of them being the one in frame, for a member who is not getting this group's video yet */
+switch_status_t conference_video_keyframe_cache_replay(codec_set_t *codec_set, conference_member_t *member, switch_frame_t *frame)
+{
+	keyframe_cache_t *cache = codec_set->keyframe_cache;
+	switch_frame_t replay_frame = *frame;
+	int i, older = 0, n = 0;
+
+	if (switch_frame_buffer_size(member->fb) + cache->packet_count > MEMBER_VIDEO_FB_LEN) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	for (i = 0; i < cache->packet_count; i++) {
+		if (cache->packets[i].m && cache->packets[i].timestamp != frame->timestamp) {
+			older++;
+		}
+	}
+
+	switch_set_flag(&replay_frame, SFF_ENCODED);
+	switch_clear_flag(&replay_frame, SFF_IS_KEYFRAME);
+
+	for (i = 0; i < cache->packet_count; i++) {
+		keyframe_cache_packet_t *packet = &cache->packets[i];
+		switch_frame_t *dupframe;
+
+		replay_frame.packet = cache->data + packet->offset;
+		replay_frame.packetlen = packet->packetlen;
+		replay_frame.data = cache->data + packet->offset + 12;
+		replay_frame.datalen = packet->packetlen - 12;
+		replay_frame.buflen = replay_frame.datalen;
+		replay_frame.m = packet->m;
+		replay_frame.timestamp = packet->timestamp;
+
+		/* older frames go out right before the live one instead of being played at their original pace */
+		if (frame->timestamp && packet->timestamp != frame->timestamp) {
+			replay_frame.timestamp = frame->timestamp - (older - n);
+
+			if (packet->m) {
+				n++;
+			}
+		}
+
+		if (switch_frame_buffer_dup(member->fb, &replay_frame, &dupframe) != SWITCH_STATUS_SUCCESS) {
+			return SWITCH_STATUS_FALSE;
+		}
+
+		if (switch_frame_buffer_trypush(member->fb, dupframe) != SWITCH_STATUS_SUCCESS) {
+			switch_frame_buffer_free(member->fb, &dupframe);
+			return SWITCH_STATUS_FALSE;
+		}
+	}
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+void conference_video_keyframe_cache_destroy(codec_set_t *codec_set)
+{
+	if (codec_set->keyframe_cache) {
+		switch_safe_free(codec_set->keyframe_cache->data);
+		codec_set->keyframe_cache = NULL;
+	}
+}
+
+/* the keyframe cache can not serve a member, make the whole canvas send keyframes */
+static void conference_video_force_keyframe(mcu_canvas_t *canvas)
+{
+	if (!canvas->send_keyframe) {
+		canvas->send_keyframe = 30;
+		canvas->keyframes_forced++;
+	}
+}
+
 void conference_video_write_canvas_image_to_codec_group(conference_obj_t *conference, mcu_canvas_t *canvas, codec_set_t *codec_set,
 														int codec_index, uint32_t timestamp, switch_bool_t need_refresh,
 														switch_bool_t send_keyframe, switch_bool_t need_reset)
@@ -1881,6 +2052,10 @@ void conference_video_write_canvas_image_to_codec_group(conference_obj_t *confer
 		int type = 1; // sum flags: 1 encoder; 2; decoder
 		switch_core_codec_control(&codec_set->codec, SCC_VIDEO_RESET, SCCT_INT, (void *)&type, SCCT_NONE, NULL, NULL, NULL);
 		need_refresh = SWITCH_TRUE;
+
+		if (codec_set->keyframe_cache) {
+			codec_set->keyframe_cache->valid = SWITCH_FALSE;
+		}
 	}
 
 	if (send_keyframe) {
@@ -1918,9 +2093,14 @@ void conference_video_write_canvas_image_to_codec_group(conference_obj_t *confer
 
 			frame->packetlen = frame->datalen + 12;
 
+			if (conference->video_keyframe_cache_size) {
+				conference_video_keyframe_cache_add(conference, codec_set, frame);
+			}
+
 			switch_mutex_lock(conference->member_mutex);
 			for (imember = conference->members; imember; imember = imember->next) {
 				switch_frame_t *dupframe;
+				switch_bool_t catch_up = SWITCH_FALSE;
 
 				if (imember->watching_canvas_id != canvas->canvas_id) {
 					continue;
@@ -1939,10 +2119,19 @@ void conference_video_write_canvas_image_to_codec_group(conference_obj_t *confer
 				}
 				
 				if (conference_utils_member_test_flag(imember, MFLAG_VIDEO_JOIN) && !send_keyframe) {
-					continue;
-				}
+					if (!conference->video_keyframe_cache_size || canvas->send_keyframe) {
+						continue;
+					}
+
+					if (!conference_video_keyframe_cache_ready(codec_set)) {
+						conference_video_force_keyframe(canvas);
+						continue;
+					}
 
-				conference_utils_member_clear_flag(imember, MFLAG_VIDEO_JOIN);
+					catch_up = SWITCH_TRUE;
+				} else {
+					conference_utils_member_clear_flag(imember, MFLAG_VIDEO_JOIN);
+				}
 				
 				if (!imember->session || !switch_channel_test_flag(imember->channel, CF_VIDEO_READY) ||
 					switch_core_session_read_lock(imember->session) != SWITCH_STATUS_SUCCESS) {
@@ -1961,6 +2150,18 @@ void conference_video_write_canvas_image_to_codec_group(conference_obj_t *confer
 					continue;
 				}
 
+				if (catch_up) {
+					if (conference_video_keyframe_cache_replay(codec_set, imember, frame) == SWITCH_STATUS_SUCCESS) {
+						conference_utils_member_clear_flag(imember, MFLAG_VIDEO_JOIN);
+						canvas->keyframes_avoided++;
+					} else {
+						conference_video_force_keyframe(canvas);
+					}
+
+					switch_core_session_rwunlock(imember->session);
+					continue;
+				}
+
 				//switch_core_session_write_encoded_video_frame(imember->session, frame, 0, 0);
 				switch_set_flag(frame, SFF_ENCODED);
 
@@ -2252,7 +2453,7 @@ void conference_video_launch_layer_thread(conference_member_t *member)
 {
 	switch_threadattr_t *thd_attr = NULL;
 
-	if (switch_core_cpu_count() < 3) {
+	if (switch_core_cpu_count() < 3 || member->conference->video_layer_threads > 0) {
 		return;
 	}
 
@@ -3045,6 +3246,146 @@ void conference_video_check_auto_bitrate(conference_member_t *member, mcu_layer_
 	}
 }
 
+static void *SWITCH_THREAD_FUNC conference_video_layer_worker_run(switch_thread_t *thread, void *obj)
+{
+	mcu_canvas_t *canvas = (mcu_canvas_t *) obj;
+	mcu_layer_t *layer;
+	uint32_t gen = 0;
+
+	switch_mutex_lock(canvas->patch_mutex);
+	while (canvas->patch_running) {
+		if (gen == canvas->patch_gen) {
+			switch_thread_cond_wait(canvas->patch_cond, canvas->patch_mutex);
+			continue;
+		}
+
+		if (canvas->patch_next >= canvas->patch_layer_count) {
+			/* everything in this round is taken, wait for the next one */
+			gen = canvas->patch_gen;
+			continue;
+		}
+
+		layer = canvas->patch_layers[canvas->patch_next++];
+		switch_mutex_unlock(canvas->patch_mutex);
+
+		scale_and_patch_layer(layer, NULL, SWITCH_FALSE);
+
+		switch_mutex_lock(canvas->patch_mutex);
+		if (++canvas->patch_done == canvas->patch_layer_count) {
+			switch_thread_cond_signal(canvas->patch_done_cond);
+		}
+	}
+	switch_mutex_unlock(canvas->patch_mutex);
+
+	return NULL;
+}
+
+/* a pool per canvas scaling the layers with a new image in parallel, in place of one layer thread per member */
+static void conference_video_launch_layer_workers(mcu_canvas_t *canvas)
+{
+	conference_obj_t *conference = canvas->conference;
+	switch_threadattr_t *thd_attr = NULL;
+	int i;
+
+	if (conference->video_layer_threads <= 0 || canvas->layer_threads) {
+		return;
+	}
+
+	switch_mutex_init(&canvas->patch_mutex, SWITCH_MUTEX_NESTED, canvas->pool);
+	switch_thread_cond_create(&canvas->patch_cond, canvas->pool);
+	switch_thread_cond_create(&canvas->patch_done_cond, canvas->pool);
+
+	canvas->layer_threads = switch_core_alloc(canvas->pool, sizeof(switch_thread_t *) * conference->video_layer_threads);
+	canvas->patch_running = 1;
+
+	for (i = 0; i < conference->video_layer_threads; i++) {
+		switch_threadattr_create(&thd_attr, canvas->pool);
+		switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+
+		if (switch_thread_create(&canvas->layer_threads[i], thd_attr, conference_video_layer_worker_run, canvas, canvas->pool) != SWITCH_STATUS_SUCCESS) {
+			break;
+		}
+
+		canvas->layer_thread_count++;
+	}
+
+	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG, "Canvas %d: %d layer threads\n", canvas->canvas_id + 1, canvas->layer_thread_count);
+}
+
+static void conference_video_stop_layer_workers(mcu_canvas_t *canvas)
+{
+	switch_status_t st;
+	int i;
+
+	if (!canvas->layer_threads) {
+		return;
+	}
+
+	switch_mutex_lock(canvas->patch_mutex);
+	canvas->patch_running = 0;
+	switch_thread_cond_broadcast(canvas->patch_cond);
+	switch_mutex_unlock(canvas->patch_mutex);
+
+	for (i = 0; i < canvas->layer_thread_count; i++) {
+		switch_thread_join(&st, canvas->layer_threads[i]);
+	}
+
+	canvas->layer_thread_count = 0;
+	canvas->layer_threads = NULL;
+}
+
+/* publish a round of layers to the pool, the caller holds the canvas mutex until conference_video_wait_layer_workers() */
+static void conference_video_dispatch_layer_workers(mcu_canvas_t *canvas, mcu_layer_t **layers, int count)
+{
+	if (!count) {
+		return;
+	}
+
+	switch_mutex_lock(canvas->patch_mutex);
+	memcpy(canvas->patch_layers, layers, sizeof(*layers) * count);
+	canvas->patch_layer_count = count;
+	canvas->patch_next = 0;
+	canvas->patch_done = 0;
+	canvas->patch_gen++;
+	switch_thread_cond_broadcast(canvas->patch_cond);
+	switch_mutex_unlock(canvas->patch_mutex);
+}
+
+static void conference_video_wait_layer_workers(mcu_canvas_t *canvas)
+{
+	switch_mutex_lock(canvas->patch_mutex);
+	while (canvas->patch_done < canvas->patch_layer_count) {
+		switch_thread_cond_wait(canvas->patch_done_cond, canvas->patch_mutex);
+	}
+	canvas->patch_layer_count = 0;
+	switch_mutex_unlock(canvas->patch_mutex);
+}
+
+static void conference_video_add_timing(mcu_canvas_timing_t *timing, switch_time_t usec)
+{
+	timing->last = usec;
+	timing->total += usec;
+	timing->count++;
+
+	if (usec > timing->max) {
+		timing->max = usec;
+	}
+}
+
+/* time spent scaling and patching the layers since the last call, whichever thread did it */
+static switch_time_t conference_video_take_patch_time(mcu_canvas_t *canvas)
+{
+	switch_time_t total = 0;
+	int i;
+
+	for (i = 0; i < canvas->total_layers; i++) {
+		total += canvas->layers[i].patch_time;
+		canvas->layers[i].patch_time = 0;
+	}
+
+	return total;
+}
+
 static void wait_for_canvas(mcu_canvas_t *canvas)
 {
 	switch_mutex_lock(canvas->write_mutex);
@@ -3151,9 +3492,11 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 
 	packet = switch_core_alloc(conference->pool, SWITCH_RTP_MAX_BUF_LEN);
 
+	conference_video_launch_layer_workers(canvas);
+
 	while (conference_globals.running && !conference_utils_test_flag(conference, CFLAG_DESTRUCT) && conference_utils_test_flag(conference, CFLAG_VIDEO_MUXING)) {
 		switch_bool_t need_refresh = SWITCH_FALSE, send_keyframe = SWITCH_FALSE, need_reset = SWITCH_FALSE;
-		switch_time_t now;
+		switch_time_t now, tick_start = 0;
 		int min_members = 0;
 		int count_changed = 0;
 		int file_count = 0, check_async_file = 0, check_file = 0;
@@ -3344,8 +3687,14 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 
 			if (imember->watching_canvas_id == canvas->canvas_id && switch_channel_test_flag(imember->channel, CF_VIDEO_REFRESH_REQ)) {
 				switch_channel_clear_flag(imember->channel, CF_VIDEO_REFRESH_REQ);
-				canvas->send_keyframe = 30;
-				send_keyframe = 1;
+
+				if (conference_video_keyframe_cache_usable(imember)) {
+					conference_utils_member_set_flag_locked(imember, MFLAG_VIDEO_JOIN);
+				} else {
+					canvas->send_keyframe = 30;
+					canvas->keyframes_forced++;
+					send_keyframe = 1;
+				}
 			}
 
 			if (conference_utils_test_flag(conference, CFLAG_MINIMIZE_VIDEO_ENCODING) &&
@@ -4000,6 +4349,14 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 			switch_mutex_unlock(conference->file_mutex);
 
 			if (!canvas->playing_video_file) {
+				mcu_layer_t *patch_layers[MCU_MAX_LAYERS];
+				int patch_count = 0;
+
+				if (canvas->layer_thread_count) {
+					/* keep the layers still until the pool is done with them */
+					switch_mutex_lock(canvas->mutex);
+				}
+
 				for (i = 0; i < canvas->total_layers; i++) {
 					mcu_layer_t *layer = &canvas->layers[i];
 
@@ -4009,7 +4366,9 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 							canvas->refresh++;
 						}
 
-						if (layer->member && switch_core_cpu_count() > 2) {
+						if (canvas->layer_thread_count) {
+							patch_layers[patch_count++] = layer;
+						} else if (layer->member && switch_core_cpu_count() > 2) {
 							layer->need_patch = 1;
 							conference_video_wake_layer_thread(layer->member);
 						} else {
@@ -4020,9 +4379,24 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 					}
 				}
 
+				if (canvas->layer_thread_count) {
+					/* done before the tick sleep, which absorbs the time spent, so the canvas is not locked while sleeping */
+					conference_video_dispatch_layer_workers(canvas, patch_layers, patch_count);
+					conference_video_wait_layer_workers(canvas);
+					switch_mutex_unlock(canvas->mutex);
+				}
+
 				switch_core_timer_next(&canvas->timer);
+				tick_start = switch_time_now();
+
 				wait_for_canvas(canvas);
-				
+
+				conference_video_add_timing(&canvas->layer_wait_timing, switch_time_now() - tick_start);
+
+				if (canvas->layer_thread_count) {
+					switch_mutex_lock(canvas->mutex);
+				}
+
 				for (i = 0; i < canvas->total_layers; i++) {
 					mcu_layer_t *layer = &canvas->layers[i];
 					
@@ -4031,12 +4405,19 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 						layer->mute_patched = 0;
 						layer->banner_patched = 0;
 
+						/* overlapping layers are redrawn every frame, no need to scale them again when nothing new came in */
+						layer->scaled_cached = !layer->tagged;
+						layer->tagged = 0;
+
 						if (canvas->refresh) {
 							layer->refresh = 1;
 							canvas->refresh++;
 						}
 
-						if (layer->member && switch_core_cpu_count() > 2) {
+						if (canvas->layer_thread_count) {
+							/* drawn here, in order, they cover each other */
+							scale_and_patch_layer(layer, NULL, SWITCH_FALSE);
+						} else if (layer->member && switch_core_cpu_count() > 2) {
 							layer->need_patch = 1;
 							conference_video_wake_layer_thread(layer->member);
 						} else {
@@ -4044,6 +4425,10 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 						}
 					}
 				}
+
+				if (canvas->layer_thread_count) {
+					switch_mutex_unlock(canvas->mutex);
+				}
 			}
 
 			if (canvas->refresh > 1) {
@@ -4163,12 +4548,18 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 				}
 			}
 
+			conference_video_add_timing(&canvas->compose_timing, conference_video_take_patch_time(canvas));
+
 			if (min_members && conference_utils_test_flag(conference, CFLAG_MINIMIZE_VIDEO_ENCODING)) {
+				switch_time_t encode_start = switch_time_now();
+
 				for (i = 0; canvas->write_codecs[i] && switch_core_codec_ready(&canvas->write_codecs[i]->codec) && i < MAX_MUX_CODECS; i++) {
 					canvas->write_codecs[i]->frame.img = write_img;
 					conference_video_write_canvas_image_to_codec_group(conference, canvas, canvas->write_codecs[i], i,
 																	   timestamp, need_refresh, send_keyframe, need_reset);
 				}
+
+				conference_video_add_timing(&canvas->encode_timing, switch_time_now() - encode_start);
 			}
 
 			switch_mutex_lock(conference->member_mutex);
@@ -4232,9 +4623,15 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 			}
 
 			switch_mutex_unlock(conference->member_mutex);
+
+			if (tick_start) {
+				conference_video_add_timing(&canvas->frame_timing, switch_time_now() - tick_start);
+			}
 		} // NOT PERSONAL
 	}
 
+	conference_video_stop_layer_workers(canvas);
+
 	switch_img_free(&file_img);
 
 	for (i = 0; i < MCU_MAX_LAYERS; i++) {
@@ -4261,6 +4658,7 @@ void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thr
 		if (canvas->write_codecs[i] && switch_core_codec_ready(&canvas->write_codecs[i]->codec)) {
 			switch_core_codec_destroy(&canvas->write_codecs[i]->codec);
 			switch_img_free(&(canvas->write_codecs[i]->scaled_img));
+			conference_video_keyframe_cache_destroy(canvas->write_codecs[i]);
 		}
 	}
 
@@ -4635,6 +5033,7 @@ void *SWITCH_THREAD_FUNC conference_video_super_muxing_thread_run(switch_thread_
 	for (i = 0; i < MAX_MUX_CODECS; i++) {
 		if (canvas->write_codecs[i] && switch_core_codec_ready(&canvas->write_codecs[i]->codec)) {
 			switch_core_codec_destroy(&canvas->write_codecs[i]->codec);
+			conference_video_keyframe_cache_destroy(canvas->write_codecs[i]);
 		}
 	}
 
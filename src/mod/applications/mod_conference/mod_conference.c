@@ -204,6 +204,282 @@ void conference_send_notify(conference_obj_t *conference, const char *status, co
 }
 
 
+/* Build what one member hears this tick and queue it on the member's mux_buffer */
+static switch_status_t conference_mix_member(conference_obj_t *conference, conference_member_t *omember, const int32_t *main_frame,
+											 int16_t *write_frame, uint32_t bytes)
+{
+	conference_member_t *imember;
+	audio_codec_set_t *codec_set;
+	switch_size_t ok = 1;
+	int16_t *bptr;
+	uint32_t x;
+	int32_t z;
+
+	if (!conference_utils_member_test_flag(omember, MFLAG_RUNNING) ||
+		(!conference_utils_member_test_flag(omember, MFLAG_NOCHANNEL) && !switch_channel_test_flag(omember->channel, CF_AUDIO))) {
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	if (!conference_utils_member_test_flag(omember, MFLAG_CAN_HEAR)) {
+		switch_mutex_lock(omember->audio_out_mutex);
+		memset(write_frame, 255, bytes);
+		if ((ok = switch_buffer_write(omember->mux_buffer, write_frame, bytes))) {
+			conference_member_push_audio_ref(omember, NULL);
+		}
+		switch_mutex_unlock(omember->audio_out_mutex);
+
+		return ok ? SWITCH_STATUS_SUCCESS : SWITCH_STATUS_FALSE;
+	}
+
+	bptr = (int16_t *) omember->frame;
+
+	if (!conference->relationship_total) {
+		/* the common case, everybody hears the whole mix minus their own audio */
+		switch_mix_minus_sln(write_frame, main_frame, conference_utils_member_test_flag(omember, MFLAG_HAS_AUDIO) ? bptr : NULL, bytes / 2);
+	} else {
+		for (x = 0; x < bytes / 2 ; x++) {
+			z = main_frame[x];
+
+			/* bptr[x] represents my own contribution to this audio sample */
+			if (conference_utils_member_test_flag(omember, MFLAG_HAS_AUDIO) && x <= omember->read / 2) {
+				z -= (int32_t) bptr[x];
+			}
+
+			/* when there are relationships, we have to do more work by scouring all the members to see if there are any
+			   reasons why we should not be hearing a paticular member, and if not, delete their samples as well.
+			*/
+			for (imember = conference->members; imember; imember = imember->next) {
+				if (imember != omember && conference_utils_member_test_flag(imember, MFLAG_HAS_AUDIO)) {
+					conference_relationship_t *rel;
+					switch_size_t found = 0;
+					int16_t *rptr = (int16_t *) imember->frame;
+					for (rel = imember->relationships; rel; rel = rel->next) {
+						if ((rel->id == omember->id || rel->id == 0) && !switch_test_flag(rel, RFLAG_CAN_SPEAK)) {
+							z -= (int32_t) rptr[x];
+							found = 1;
+							break;
+						}
+					}
+					if (!found) {
+						for (rel = omember->relationships; rel; rel = rel->next) {
+							if ((rel->id == imember->id || rel->id == 0) && !switch_test_flag(rel, RFLAG_CAN_HEAR)) {
+								z -= (int32_t) rptr[x];
+								break;
+							}
+						}
+					}
+
+				}
+			}
+
+			/* Now we can convert to 16 bit. */
+			switch_normalize_to_16bit(z);
+			write_frame[x] = (int16_t) z;
+		}
+	}
+
+	if (!omember->channel || switch_channel_test_flag(omember->channel, CF_AUDIO)) {
+		codec_set = conference_member_share_audio(conference, omember, bytes);
+
+		switch_mutex_lock(omember->audio_out_mutex);
+		if ((ok = switch_buffer_write(omember->mux_buffer, write_frame, bytes))) {
+			conference_member_push_audio_ref(omember, codec_set);
+		}
+		switch_mutex_unlock(omember->audio_out_mutex);
+	}
+
+	return ok ? SWITCH_STATUS_SUCCESS : SWITCH_STATUS_FALSE;
+}
+
+static switch_status_t conference_mix_members(conference_obj_t *conference, uint32_t slice, uint32_t slices)
+{
+	int16_t write_frame[SWITCH_RECOMMENDED_BUFFER_SIZE];
+	uint32_t i, first = conference->mix_member_count * slice / slices, last = conference->mix_member_count * (slice + 1) / slices;
+	switch_status_t status = SWITCH_STATUS_SUCCESS;
+
+	for (i = first; i < last; i++) {
+		if (conference_mix_member(conference, conference->mix_members[i], conference->mix_main_frame, write_frame, conference->mix_bytes) != SWITCH_STATUS_SUCCESS) {
+			status = SWITCH_STATUS_FALSE;
+		}
+	}
+
+	return status;
+}
+
+static void *SWITCH_THREAD_FUNC conference_mix_worker_run(switch_thread_t *thread, void *obj)
+{
+	conference_mix_worker_t *worker = (conference_mix_worker_t *) obj;
+	conference_obj_t *conference = worker->conference;
+	uint32_t generation = 0;
+	switch_status_t status;
+
+	switch_mutex_lock(conference->mix_mutex);
+	while (conference->mix_running) {
+		if (generation == conference->mix_generation) {
+			switch_thread_cond_wait(conference->mix_cond, conference->mix_mutex);
+			continue;
+		}
+
+		generation = conference->mix_generation;
+		switch_mutex_unlock(conference->mix_mutex);
+
+		status = conference_mix_members(conference, worker->slice, conference->mix_thread_count + 1);
+
+		switch_mutex_lock(conference->mix_mutex);
+		if (status != SWITCH_STATUS_SUCCESS) {
+			conference->mix_failed = 1;
+		}
+		if (!--conference->mix_pending) {
+			switch_thread_cond_signal(conference->mix_done_cond);
+		}
+	}
+	switch_mutex_unlock(conference->mix_mutex);
+
+	return NULL;
+}
+
+void conference_mix_launch_workers(conference_obj_t *conference)
+{
+	switch_threadattr_t *thd_attr = NULL;
+	uint32_t i;
+
+	if (!conference->mix_threads || conference->mix_workers) {
+		return;
+	}
+
+	switch_mutex_init(&conference->mix_mutex, SWITCH_MUTEX_NESTED, conference->pool);
+	switch_thread_cond_create(&conference->mix_cond, conference->pool);
+	switch_thread_cond_create(&conference->mix_done_cond, conference->pool);
+
+	conference->mix_workers = switch_core_alloc(conference->pool, sizeof(conference_mix_worker_t) * conference->mix_threads);
+	conference->mix_running = 1;
+
+	for (i = 0; i < conference->mix_threads; i++) {
+		conference_mix_worker_t *worker = &conference->mix_workers[i];
+
+		worker->conference = conference;
+		worker->slice = i + 1;
+
+		switch_threadattr_create(&thd_attr, conference->pool);
+		switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+		switch_threadattr_priority_set(thd_attr, SWITCH_PRI_REALTIME);
+
+		if (switch_thread_create(&worker->thread, thd_attr, conference_mix_worker_run, worker, conference->pool) != SWITCH_STATUS_SUCCESS) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Conference %s: only %u of %u mix threads started\n",
+							  conference->name, i, conference->mix_threads);
+			break;
+		}
+
+		conference->mix_thread_count++;
+	}
+}
+
+void conference_mix_stop_workers(conference_obj_t *conference)
+{
+	switch_status_t st;
+	uint32_t i;
+
+	if (!conference->mix_workers) {
+		return;
+	}
+
+	switch_mutex_lock(conference->mix_mutex);
+	conference->mix_running = 0;
+	switch_thread_cond_broadcast(conference->mix_cond);
+	switch_mutex_unlock(conference->mix_mutex);
+
+	for (i = 0; i < conference->mix_thread_count; i++) {
+		switch_thread_join(&st, conference->mix_workers[i].thread);
+	}
+
+	conference->mix_thread_count = 0;
+	conference->mix_workers = NULL;
+	switch_safe_free(conference->mix_members);
+	conference->mix_member_alloc = 0;
+}
+
+/* Add every talker to main_frame (which may already hold file audio) and write each member's mix to its mux_buffer,
+   called from the conference thread with the conference mutex held */
+switch_status_t conference_mix_audio(conference_obj_t *conference, int32_t *main_frame, uint32_t bytes)
+{
+	conference_member_t *omember;
+	switch_status_t status = SWITCH_STATUS_SUCCESS;
+	uint32_t count = 0;
+
+	conference->mux_loop_count = 0;
+	conference->member_loop_count = 0;
+
+	/* Copy audio from every member known to be producing audio into the main frame. */
+	for (omember = conference->members; omember; omember = omember->next) {
+		conference->member_loop_count++;
+
+		if (!(conference_utils_member_test_flag(omember, MFLAG_RUNNING) && conference_utils_member_test_flag(omember, MFLAG_HAS_AUDIO))) {
+			continue;
+		}
+
+		switch_accumulate_sln(main_frame, (int16_t *) omember->frame, omember->read / 2);
+	}
+
+	if (conference_member_check_audio_codec_sets(conference)) {
+		int16_t mix_frame[SWITCH_RECOMMENDED_BUFFER_SIZE];
+
+		/* listeners in a codec set hear the plain mix */
+		switch_mix_minus_sln(mix_frame, main_frame, NULL, bytes / 2);
+		conference_member_encode_audio_codec_sets(conference, mix_frame, bytes);
+	}
+
+	/* Create write frame once per member who is not deaf for each sample in the main frame
+	   check if our audio is involved and if so, subtract it from the sample so we don't hear ourselves.
+	   Since main frame was 32 bit int, we did not lose any detail, now that we have to convert to 16 bit we can
+	   cut it off at the min and max range if need be and write the frame to the output buffer.
+	*/
+	if (!conference->mix_thread_count || (uint32_t) conference->member_loop_count < conference->mix_threads_min_members) {
+		int16_t write_frame[SWITCH_RECOMMENDED_BUFFER_SIZE];
+
+		for (omember = conference->members; omember; omember = omember->next) {
+			if (conference_mix_member(conference, omember, main_frame, write_frame, bytes) != SWITCH_STATUS_SUCCESS) {
+				return SWITCH_STATUS_FALSE;
+			}
+		}
+
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	/* big conference, split the members between this thread and the mix workers */
+	if (conference->mix_member_alloc < (uint32_t) conference->member_loop_count) {
+		conference->mix_member_alloc = conference->member_loop_count * 2;
+		conference->mix_members = realloc(conference->mix_members, sizeof(conference_member_t *) * conference->mix_member_alloc);
+		switch_assert(conference->mix_members);
+	}
+
+	for (omember = conference->members; omember; omember = omember->next) {
+		conference->mix_members[count++] = omember;
+	}
+
+	switch_mutex_lock(conference->mix_mutex);
+	conference->mix_member_count = count;
+	conference->mix_main_frame = main_frame;
+	conference->mix_bytes = bytes;
+	conference->mix_failed = 0;
+	conference->mix_pending = conference->mix_thread_count;
+	conference->mix_generation++;
+	switch_thread_cond_broadcast(conference->mix_cond);
+	switch_mutex_unlock(conference->mix_mutex);
+
+	status = conference_mix_members(conference, 0, conference->mix_thread_count + 1);
+
+	switch_mutex_lock(conference->mix_mutex);
+	while (conference->mix_pending) {
+		switch_thread_cond_wait(conference->mix_done_cond, conference->mix_mutex);
+	}
+	if (conference->mix_failed) {
+		status = SWITCH_STATUS_FALSE;
+	}
+	switch_mutex_unlock(conference->mix_mutex);
+
+	return status;
+}
+
 /* Main monitor thread (1 per distinct conference room) */
 void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *obj)
 {
@@ -218,7 +494,6 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 	uint8_t *async_file_frame;
 	int16_t *bptr;
 	uint32_t x = 0;
-	int32_t z = 0;
 	conference_cdr_node_t *np;
 	switch_time_t last_heartbeat_time = switch_epoch_time_now(NULL);
 
@@ -236,6 +511,9 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 	conference_globals.threads++;
 	switch_mutex_unlock(conference_globals.hash_mutex);
 
+	conference_mix_launch_workers(conference);
+	conference_loop_launch_io_workers(conference);
+
 	conference->auto_recording = 0;
 	conference->record_count = 0;
 
@@ -247,6 +525,7 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 		int nomoh = 0;
 		uint32_t floor_holder;
 		switch_status_t moh_status = SWITCH_STATUS_SUCCESS;
+		switch_time_t tick_start, tick_time;
 
 		/* Sync the conference to a single timing source */
 		if (switch_core_timer_next(&timer) != SWITCH_STATUS_SUCCESS) {
@@ -254,6 +533,8 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 			break;
 		}
 
+		tick_start = switch_time_now();
+
 		switch_mutex_lock(conference->mutex);
 		has_file_data = ready = total = 0;
 
@@ -574,9 +855,7 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 
 		if (ready || has_file_data) {
 			/* Use more bits in the main_frame to preserve the exact sum of the audio samples. */
-			int main_frame[SWITCH_RECOMMENDED_BUFFER_SIZE] = { 0 };
-			int16_t write_frame[SWITCH_RECOMMENDED_BUFFER_SIZE] = { 0 };
-
+			int32_t main_frame[SWITCH_RECOMMENDED_BUFFER_SIZE] = { 0 };
 
 			/* Init the main frame with file data if there is any. */
 			bptr = (int16_t *) file_frame;
@@ -591,102 +870,9 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 				}
 			}
 
-			conference->mux_loop_count = 0;
-			conference->member_loop_count = 0;
-
-
-			/* Copy audio from every member known to be producing audio into the main frame. */
-			for (omember = conference->members; omember; omember = omember->next) {
-				conference->member_loop_count++;
-
-				if (!(conference_utils_member_test_flag(omember, MFLAG_RUNNING) && conference_utils_member_test_flag(omember, MFLAG_HAS_AUDIO))) {
-					continue;
-				}
-
-				bptr = (int16_t *) omember->frame;
-				for (x = 0; x < omember->read / 2; x++) {
-					main_frame[x] += (int32_t) bptr[x];
-				}
-			}
-
-			/* Create write frame once per member who is not deaf for each sample in the main frame
-			   check if our audio is involved and if so, subtract it from the sample so we don't hear ourselves.
-			   Since main frame was 32 bit int, we did not lose any detail, now that we have to convert to 16 bit we can
-			   cut it off at the min and max range if need be and write the frame to the output buffer.
-			*/
-			for (omember = conference->members; omember; omember = omember->next) {
-				switch_size_t ok = 1;
-
-				if (!conference_utils_member_test_flag(omember, MFLAG_RUNNING) ||
-					(!conference_utils_member_test_flag(omember, MFLAG_NOCHANNEL) && !switch_channel_test_flag(omember->channel, CF_AUDIO))) {
-					continue;
-				}
-				
-				if (!conference_utils_member_test_flag(omember, MFLAG_CAN_HEAR)) {
-					switch_mutex_lock(omember->audio_out_mutex);
-					memset(write_frame, 255, bytes);
-					ok = switch_buffer_write(omember->mux_buffer, write_frame, bytes);
-					switch_mutex_unlock(omember->audio_out_mutex);
-					if (!ok) {
-						switch_mutex_unlock(conference->mutex);
-						goto end;
-					}
-					continue;
-				}
-
-				bptr = (int16_t *) omember->frame;
-
-				for (x = 0; x < bytes / 2 ; x++) {
-					z = main_frame[x];
-
-					/* bptr[x] represents my own contribution to this audio sample */
-					if (conference_utils_member_test_flag(omember, MFLAG_HAS_AUDIO) && x <= omember->read / 2) {
-						z -= (int32_t) bptr[x];
-					}
-
-					/* when there are relationships, we have to do more work by scouring all the members to see if there are any
-					   reasons why we should not be hearing a paticular member, and if not, delete their samples as well.
-					*/
-					if (conference->relationship_total) {
-						for (imember = conference->members; imember; imember = imember->next) {
-							if (imember != omember && conference_utils_member_test_flag(imember, MFLAG_HAS_AUDIO)) {
-								conference_relationship_t *rel;
-								switch_size_t found = 0;
-								int16_t *rptr = (int16_t *) imember->frame;
-								for (rel = imember->relationships; rel; rel = rel->next) {
-									if ((rel->id == omember->id || rel->id == 0) && !switch_test_flag(rel, RFLAG_CAN_SPEAK)) {
-										z -= (int32_t) rptr[x];
-										found = 1;
-										break;
-									}
-								}
-								if (!found) {
-									for (rel = omember->relationships; rel; rel = rel->next) {
-										if ((rel->id == imember->id || rel->id == 0) && !switch_test_flag(rel, RFLAG_CAN_HEAR)) {
-											z -= (int32_t) rptr[x];
-											break;
-										}
-									}
-								}
-
-							}
-						}
-					}
-
-					/* Now we can convert to 16 bit. */
-					switch_normalize_to_16bit(z);
-					write_frame[x] = (int16_t) z;
-				}
-
-				if (!omember->channel || switch_channel_test_flag(omember->channel, CF_AUDIO)) {
-					switch_mutex_lock(omember->audio_out_mutex);
-					ok = switch_buffer_write(omember->mux_buffer, write_frame, bytes);
-					switch_mutex_unlock(omember->audio_out_mutex);
-					if (!ok) {
-						switch_mutex_unlock(conference->mutex);
-						goto end;
-					}
-				}
+			if (conference_mix_audio(conference, main_frame, bytes) != SWITCH_STATUS_SUCCESS) {
+				switch_mutex_unlock(conference->mutex);
+				goto end;
 			}
 		} else { /* There is no source audio.  Push silence into all of the buffers */
 			int16_t write_frame[SWITCH_RECOMMENDED_BUFFER_SIZE] = { 0 };
@@ -697,16 +883,25 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 				memset(write_frame, 255, bytes);
 			}
 
+			if (conference_member_check_audio_codec_sets(conference)) {
+				conference_member_encode_audio_codec_sets(conference, write_frame, bytes);
+			}
+
 			for (omember = conference->members; omember; omember = omember->next) {
 				switch_size_t ok = 1;
+				audio_codec_set_t *codec_set;
 
 				if (!conference_utils_member_test_flag(omember, MFLAG_RUNNING) ||
 					(!conference_utils_member_test_flag(omember, MFLAG_NOCHANNEL) && !switch_channel_test_flag(omember->channel, CF_AUDIO))) {
 					continue;
 				}
 
+				codec_set = conference_member_share_audio(conference, omember, bytes);
+
 				switch_mutex_lock(omember->audio_out_mutex);
-				ok = switch_buffer_write(omember->mux_buffer, write_frame, bytes);
+				if ((ok = switch_buffer_write(omember->mux_buffer, write_frame, bytes))) {
+					conference_member_push_audio_ref(omember, codec_set);
+				}
 				switch_mutex_unlock(omember->audio_out_mutex);
 
 				if (!ok) {
@@ -767,6 +962,17 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 			conference_utils_set_flag(conference, CFLAG_ENDCONF_FORCED);
 		}
 
+		/* everything above has to fit in one interval or the members hear a gap */
+		tick_time = switch_time_now() - tick_start;
+
+		if (tick_time > conference->tick_time_max) {
+			conference->tick_time_max = tick_time;
+		}
+
+		if (tick_time > conference->interval * 1000) {
+			conference->deadline_misses++;
+		}
+
 		switch_mutex_unlock(conference->mutex);
 	}
 	/* Rinse ... Repeat */
@@ -848,6 +1054,10 @@ void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *ob
 	switch_thread_rwlock_unlock(conference->rwlock);
 	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG, "Write Lock OFF\n");
 
+	conference_mix_stop_workers(conference);
+	conference_loop_stop_io_workers(conference);
+	conference_member_destroy_audio_codec_sets(conference);
+
 	if (conference->la) {
 		switch_live_array_destroy(&conference->la);
 	}
@@ -1401,6 +1611,49 @@ void conference_jlist(conference_obj_t *conference, cJSON *json_conferences)
 		cJSON_AddNumberToObject(json_conference, "max_members", conference->max_members);
 	}
 
+	if (conference->canvas_count) {
+		cJSON *json_canvases, *json_canvas, *json_timing;
+		int i;
+
+		cJSON_AddItemToObject(json_conference, "canvases", json_canvases = cJSON_CreateArray());
+
+		switch_mutex_lock(conference->canvas_mutex);
+		for (i = 0; i < MAX_CANVASES; i++) {
+			mcu_canvas_t *canvas = conference->canvases[i];
+			const char *names[] = { "compose", "layer_wait", "encode", "frame" };
+			mcu_canvas_timing_t *timings[4];
+			int j;
+
+			if (!canvas) continue;
+
+			timings[0] = &canvas->compose_timing;
+			timings[1] = &canvas->layer_wait_timing;
+			timings[2] = &canvas->encode_timing;
+			timings[3] = &canvas->frame_timing;
+
+			cJSON_AddItemToArray(json_canvases, json_canvas = cJSON_CreateObject());
+			cJSON_AddNumberToObject(json_canvas, "canvas_id", canvas->canvas_id + 1);
+			cJSON_AddNumberToObject(json_canvas, "layers_used", canvas->layers_used);
+			cJSON_AddNumberToObject(json_canvas, "total_layers", canvas->total_layers);
+			cJSON_AddNumberToObject(json_canvas, "layer_threads", canvas->layer_thread_count);
+			cJSON_AddNumberToObject(json_canvas, "scale_cache_hits", (double) switch_atomic_read(&canvas->scale_cache_hits));
+			cJSON_AddNumberToObject(json_canvas, "keyframes_forced", (double) canvas->keyframes_forced);
+			cJSON_AddNumberToObject(json_canvas, "keyframes_avoided", (double) canvas->keyframes_avoided);
+
+			/* microseconds per frame */
+			cJSON_AddItemToObject(json_canvas, "timing", json_timing = cJSON_CreateObject());
+			for (j = 0; j < 4; j++) {
+				cJSON *json_stage;
+
+				cJSON_AddItemToObject(json_timing, names[j], json_stage = cJSON_CreateObject());
+				cJSON_AddNumberToObject(json_stage, "last", (double) timings[j]->last);
+				cJSON_AddNumberToObject(json_stage, "avg", timings[j]->count ? (double) timings[j]->total / timings[j]->count : 0);
+				cJSON_AddNumberToObject(json_stage, "max", (double) timings[j]->max);
+			}
+		}
+		switch_mutex_unlock(conference->canvas_mutex);
+	}
+
 	cJSON_AddItemToObject(json_conference, "variables", json_conference_variables = cJSON_CreateObject());
 	for (hp = conference->variables->headers; hp; hp = hp->next) {
 		cJSON_AddStringToObject(json_conference_variables, hp->name, hp->value);
@@ -2445,7 +2698,7 @@ SWITCH_STANDARD_APP(conference_function)
 
 	if (conference->conference_video_mode == CONF_VIDEO_MODE_MUX) {
 		switch_queue_create(&member.video_queue, 200, member.pool);
-		switch_frame_buffer_create(&member.fb, 500);
+		switch_frame_buffer_create(&member.fb, MEMBER_VIDEO_FB_LEN);
 	}
 
 	/* Add the caller to the conference */
@@ -2504,6 +2757,11 @@ SWITCH_STANDARD_APP(conference_function)
 		member.input_thread = NULL;
 	}
 
+	/* or for the io thread reading it to let go */
+	while (conference_utils_member_test_flag(&member, MFLAG_ITHREAD)) {
+		switch_cond_next();
+	}
+
 	switch_core_session_video_reset(session);
 	switch_channel_clear_flag_recursive(channel, CF_VIDEO_DECODED_READ);
 
@@ -2775,6 +3033,8 @@ conference_obj_t *conference_new(char *name, conference_xml_cfg_t cfg, switch_co
 	conference_video_mode_t conference_video_mode = CONF_VIDEO_MODE_PASSTHROUGH;
 	int conference_video_quality = 1;
 	int auto_kps_debounce = 5000;
+	int video_layer_threads = 0;
+	int video_keyframe_cache_size = 0;
 	float fps = 30.0f;
 	uint32_t max_members = 0;
 	uint32_t announce_count = 0;
@@ -2813,6 +3073,9 @@ conference_obj_t *conference_new(char *name, conference_xml_cfg_t cfg, switch_co
 	char *video_codec_config_profile_name = NULL;
 	int tmp;
 	int heartbeat_period_sec = 0;
+	int audio_mix_threads = 0;
+	int audio_mix_threads_min_members = 200;
+	int member_io_threads = 0;
 	switch_event_t *var_event = NULL;
 
 	/* Validate the conference name */
@@ -3143,6 +3406,20 @@ conference_obj_t *conference_new(char *name, conference_xml_cfg_t cfg, switch_co
 					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "video-kps-debounce must be 0 or higher\n");
 				}
 
+			} else if (!strcasecmp(var, "video-layer-threads") && !zstr(val)) {
+				video_layer_threads = atoi(val);
+
+				if (video_layer_threads > (int) switch_core_cpu_count()) {
+					video_layer_threads = switch_core_cpu_count();
+				}
+			} else if (!strcasecmp(var, "video-keyframe-cache-size") && !zstr(val)) {
+				int tmp = atoi(val);
+
+				if (tmp >= 0) {
+					video_keyframe_cache_size = tmp;
+				} else {
+					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "video-keyframe-cache-size must be 0 or higher\n");
+				}
 			} else if (!strcasecmp(var, "video-mode") && !zstr(val)) {
 				if (!strcasecmp(val, "passthrough")) {
 					conference_video_mode = CONF_VIDEO_MODE_PASSTHROUGH;
@@ -3179,6 +3456,12 @@ conference_obj_t *conference_new(char *name, conference_xml_cfg_t cfg, switch_co
 				video_codec_config_profile_name = val;
 			} else if (!strcasecmp(var, "heartbeat-period-sec") && !zstr(val)) {
 				heartbeat_period_sec = atoi(val);
+			} else if (!strcasecmp(var, "audio-mix-threads") && !zstr(val)) {
+				audio_mix_threads = atoi(val);
+			} else if (!strcasecmp(var, "audio-mix-threads-min-members") && !zstr(val)) {
+				audio_mix_threads_min_members = atoi(val);
+			} else if (!strcasecmp(var, "member-io-threads") && !zstr(val)) {
+				member_io_threads = atoi(val);
 			}
 		}
 
@@ -3244,6 +3527,8 @@ conference_obj_t *conference_new(char *name, conference_xml_cfg_t cfg, switch_co
 	conference->broadcast_chat_messages = broadcast_chat_messages;
 	conference->video_quality = conference_video_quality;
 	conference->auto_kps_debounce = auto_kps_debounce;
+	conference->video_layer_threads = video_layer_threads;
+	conference->video_keyframe_cache_size = video_keyframe_cache_size * 1024;
 	switch_event_create_plain(&conference->variables, SWITCH_EVENT_CHANNEL_DATA);
 	conference->conference_video_mode = conference_video_mode;
 	conference->video_codec_config_profile_name = switch_core_strdup(conference->pool, video_codec_config_profile_name);
@@ -3702,6 +3987,19 @@ conference_obj_t *conference_new(char *name, conference_xml_cfg_t cfg, switch_co
 		conference->heartbeat_period_sec = heartbeat_period_sec;
 	}
 
+	if (audio_mix_threads > 0) {
+		if (audio_mix_threads >= (int) switch_core_cpu_count()) {
+			audio_mix_threads = switch_core_cpu_count() - 1;
+		}
+
+		conference->mix_threads = audio_mix_threads;
+		conference->mix_threads_min_members = audio_mix_threads_min_members > 0 ? audio_mix_threads_min_members : 0;
+	}
+
+	if (member_io_threads > 0) {
+		conference->io_threads = member_io_threads;
+	}
+
 	/* Create the conference unique identifier */
 	switch_uuid_get(&uuid);
 	switch_uuid_format(uuid_str, &uuid);
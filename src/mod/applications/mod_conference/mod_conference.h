@@ -106,6 +106,11 @@
 #define CONFFUNCAPISIZE (sizeof(conference_api_sub_commands)/sizeof(conference_api_sub_commands[0]))
 
 #define MAX_MUX_CODECS 50
+#define MAX_AUDIO_MUX_FRAMES 32
+#define MAX_AUDIO_MUX_REFS 64
+#define MEMBER_VIDEO_FB_LEN 500
+#define MAX_KEYFRAME_CACHE_PACKETS 400
+#define MAX_KEYFRAME_CACHE_FRAMES 300
 
 #define ALC_HRTF_SOFT  0x1992
 
@@ -215,6 +220,7 @@ typedef enum {
 	MFLAG_DED_VID_LAYER,
 	MFLAG_HOLD,
 	MFLAG_SKIP_DTMF,
+	MFLAG_NO_MINIMIZE_AUDIO_ENCODING,
 	///////////////////////////
 	MFLAG_MAX
 } member_flag_t;
@@ -257,6 +263,7 @@ typedef enum {
 	CFLAG_NO_MOH,
 	CFLAG_DED_VID_LAYER_AUDIO_FLOOR,
 	CFLAG_BREAKABLE,
+	CFLAG_MINIMIZE_AUDIO_ENCODING,
 	/////////////////////////////////
 	CFLAG_MAX
 } conference_flag_t;
@@ -503,8 +510,17 @@ typedef struct mcu_layer_s {
 	switch_mutex_t *overlay_mutex;
 	switch_core_video_filter_t overlay_filters;
 	int manual_border;
+	int scaled_cached;
+	switch_time_t patch_time;
 } mcu_layer_t;
 
+typedef struct mcu_canvas_timing_s {
+	switch_time_t last;
+	switch_time_t max;
+	switch_time_t total;
+	uint64_t count;
+} mcu_canvas_timing_t;
+
 typedef struct video_layout_s {
 	char *name;
 	char *audio_position;
@@ -525,6 +541,25 @@ typedef struct layout_group_s {
 	video_layout_node_t *layouts;
 } layout_group_t;
 
+/* one packet of the keyframe cache, the bytes live in keyframe_cache_t.data */
+typedef struct keyframe_cache_packet_s {
+	uint32_t offset;
+	uint32_t packetlen;
+	uint32_t timestamp;
+	uint8_t m;
+} keyframe_cache_packet_t;
+
+/* encoded packets of a codec group from the last keyframe on, replayed to members who join or ask for a refresh */
+typedef struct keyframe_cache_s {
+	uint8_t *data;
+	uint32_t size;
+	uint32_t used;
+	keyframe_cache_packet_t packets[MAX_KEYFRAME_CACHE_PACKETS];
+	int packet_count;
+	int frame_count;
+	switch_bool_t valid;
+} keyframe_cache_t;
+
 typedef struct codec_set_s {
 	switch_codec_t codec;
 	switch_frame_t frame;
@@ -533,8 +568,59 @@ typedef struct codec_set_s {
 	uint8_t fps_divisor;
 	uint32_t frame_count;
 	char *video_codec_group;
+	keyframe_cache_t *keyframe_cache;
 } codec_set_t;
 
+/* one encoded frame of the listener mix */
+typedef struct audio_mux_frame_s {
+	uint32_t seq;
+	uint32_t datalen;
+	uint32_t samples;
+	uint8_t *data;
+} audio_mux_frame_t;
+
+/* members who only listen and share a write codec get the mix encoded once for all of them */
+typedef struct audio_codec_set_s {
+	switch_codec_t codec;
+	const switch_codec_implementation_t *impl;
+	char *fmtp;
+	switch_audio_resampler_t *resampler;
+	switch_mutex_t *mutex;
+	uint32_t bytes;
+	uint32_t seq;
+	uint32_t tick;
+	uint32_t members;
+	audio_mux_frame_t frames[MAX_AUDIO_MUX_FRAMES];
+} audio_codec_set_t;
+
+/* extra thread sharing the per member mixing of a large conference */
+typedef struct conference_mix_worker_s {
+	struct conference_obj *conference;
+	switch_thread_t *thread;
+	uint32_t slice;
+} conference_mix_worker_t;
+
+/* thread reading the audio of many members, once per conference tick, in place of one input thread each */
+typedef struct conference_io_worker_s {
+	struct conference_obj *conference;
+	switch_thread_t *thread;
+	switch_mutex_t *mutex;
+	conference_member_t **members;
+	uint32_t member_count;
+	uint32_t member_alloc;
+	uint64_t ticks;
+	uint64_t tick_time_total;
+	switch_time_t tick_time_max;
+	uint32_t late_ticks;
+} conference_io_worker_t;
+
+/* which shared frame, if any, goes with each frame in a member's mux_buffer */
+typedef struct audio_mux_ref_s {
+	audio_codec_set_t *codec_set;
+	uint32_t seq;
+	uint32_t pos;
+} audio_mux_ref_t;
+
 
 typedef struct mcu_canvas_s {
 	int width;
@@ -573,6 +659,24 @@ typedef struct mcu_canvas_s {
 	codec_set_t *write_codecs[MAX_MUX_CODECS];
 	int write_codecs_count;
 	switch_bool_t disable_auto_clear;
+	int layer_thread_count;
+	switch_thread_t **layer_threads;
+	switch_mutex_t *patch_mutex;
+	switch_thread_cond_t *patch_cond;
+	switch_thread_cond_t *patch_done_cond;
+	int patch_running;
+	uint32_t patch_gen;
+	mcu_layer_t *patch_layers[MCU_MAX_LAYERS];
+	int patch_layer_count;
+	int patch_next;
+	int patch_done;
+	switch_atomic_t scale_cache_hits;
+	uint64_t keyframes_forced;
+	uint64_t keyframes_avoided;
+	mcu_canvas_timing_t compose_timing;
+	mcu_canvas_timing_t layer_wait_timing;
+	mcu_canvas_timing_t encode_timing;
+	mcu_canvas_timing_t frame_timing;
 } mcu_canvas_t;
 
 /* Record Node */
@@ -746,6 +850,8 @@ typedef struct conference_obj {
 	switch_hash_t *layout_hash;
 	switch_hash_t *layout_group_hash;
 	switch_fps_t video_fps;
+	int video_layer_threads;
+	uint32_t video_keyframe_cache_size;
 	int recording_members;
 	uint32_t video_floor_packets;
 	video_layout_t *new_personal_vlayout;
@@ -763,6 +869,34 @@ typedef struct conference_obj {
 	int mux_paused;
 	char *video_codec_config_profile_name;
 	int heartbeat_period_sec;
+	audio_codec_set_t *audio_write_codecs[MAX_MUX_CODECS];
+	int audio_write_codecs_count;
+	uint32_t audio_mux_tick;
+	uint64_t audio_encodes;
+	uint64_t audio_encodes_saved;
+	uint32_t mix_threads;
+	uint32_t mix_threads_min_members;
+	uint32_t mix_thread_count;
+	conference_mix_worker_t *mix_workers;
+	switch_mutex_t *mix_mutex;
+	switch_thread_cond_t *mix_cond;
+	switch_thread_cond_t *mix_done_cond;
+	int mix_running;
+	uint32_t mix_generation;
+	uint32_t mix_pending;
+	int mix_failed;
+	conference_member_t **mix_members;
+	uint32_t mix_member_count;
+	uint32_t mix_member_alloc;
+	const int32_t *mix_main_frame;
+	uint32_t mix_bytes;
+	uint32_t deadline_misses;
+	switch_time_t tick_time_max;
+	uint32_t io_threads;
+	uint32_t io_thread_count;
+	conference_io_worker_t *io_workers;
+	switch_mutex_t *io_mutex;
+	int io_running;
 } conference_obj_t;
 
 /* Relationship with another member */
@@ -907,6 +1041,15 @@ struct conference_member {
 	mcu_layer_cam_opts_t cam_opts;
 	switch_core_video_filter_t video_filters;
 	int video_manual_border;
+
+	audio_codec_set_t *audio_codec_set;
+	audio_mux_ref_t audio_mux_refs[MAX_AUDIO_MUX_REFS];
+	uint32_t audio_mux_written;
+	uint32_t audio_mux_read;
+
+	conference_io_worker_t *io_worker;
+	uint32_t hangover_hits;
+	uint32_t hangunder_hits;
 };
 
 typedef enum {
@@ -1079,6 +1222,10 @@ video_layout_t *conference_video_get_layout(conference_obj_t *conference, const
 void conference_video_check_avatar(conference_member_t *member, switch_bool_t force);
 void conference_video_find_floor(conference_member_t *member, switch_bool_t entering);
 void conference_video_destroy_canvas(mcu_canvas_t **canvasP);
+void conference_video_keyframe_cache_add(conference_obj_t *conference, codec_set_t *codec_set, switch_frame_t *frame);
+switch_bool_t conference_video_keyframe_cache_ready(codec_set_t *codec_set);
+switch_status_t conference_video_keyframe_cache_replay(codec_set_t *codec_set, conference_member_t *member, switch_frame_t *frame);
+void conference_video_keyframe_cache_destroy(codec_set_t *codec_set);
 void conference_video_fnode_check(conference_file_node_t *fnode, int canvas_id);
 switch_status_t conference_video_set_canvas_bgimg(mcu_canvas_t *canvas, const char *img_path);
 switch_status_t conference_video_set_canvas_fgimg(mcu_canvas_t *canvas, const char *img_path);
@@ -1091,6 +1238,13 @@ void conference_video_wake_layer_thread(conference_member_t *member);
 
 int conference_member_noise_gate_check(conference_member_t *member);
 void conference_member_check_channels(switch_frame_t *frame, conference_member_t *member, switch_bool_t in);
+int conference_member_check_audio_codec_sets(conference_obj_t *conference);
+void conference_member_encode_audio_codec_sets(conference_obj_t *conference, int16_t *data, uint32_t bytes);
+audio_codec_set_t *conference_member_share_audio(conference_obj_t *conference, conference_member_t *member, uint32_t bytes);
+void conference_member_push_audio_ref(conference_member_t *member, audio_codec_set_t *codec_set);
+switch_status_t conference_member_pop_audio_ref(conference_member_t *member, uint32_t bytes, switch_frame_t *frame);
+void conference_member_flush_audio_refs(conference_member_t *member);
+void conference_member_destroy_audio_codec_sets(conference_obj_t *conference);
 
 void conference_fnode_toggle_pause(conference_file_node_t *fnode, switch_stream_handle_t *stream);
 void conference_fnode_check_status(conference_file_node_t *fnode, switch_stream_handle_t *stream);
@@ -1107,10 +1261,15 @@ switch_status_t conference_member_del_relationship(conference_member_t *member,
 switch_status_t conference_member_add(conference_obj_t *conference, conference_member_t *member);
 switch_status_t conference_member_del(conference_obj_t *conference, conference_member_t *member);
 void *SWITCH_THREAD_FUNC conference_thread_run(switch_thread_t *thread, void *obj);
+switch_status_t conference_mix_audio(conference_obj_t *conference, int32_t *main_frame, uint32_t bytes);
+void conference_mix_launch_workers(conference_obj_t *conference);
+void conference_mix_stop_workers(conference_obj_t *conference);
 void *SWITCH_THREAD_FUNC conference_video_muxing_thread_run(switch_thread_t *thread, void *obj);
 void *SWITCH_THREAD_FUNC conference_video_super_muxing_thread_run(switch_thread_t *thread, void *obj);
 void conference_loop_output(conference_member_t *member);
 void conference_loop_launch_input(conference_member_t *member, switch_memory_pool_t *pool);
+void conference_loop_launch_io_workers(conference_obj_t *conference);
+void conference_loop_stop_io_workers(conference_obj_t *conference);
 uint32_t conference_file_stop(conference_obj_t *conference, file_stop_t stop);
 switch_status_t conference_file_play(conference_obj_t *conference, char *file, uint32_t leadin, switch_channel_t *channel, uint8_t async);
 void conference_member_send_all_dtmf(conference_member_t *member, conference_obj_t *conference, const char *dtmf);
@@ -0,0 +1,184 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * test_keyframe_cache.c -- feeds encoded packets to a codec group keyframe cache and replays it to a member
+ *
+ */
+#include <switch.h>
+#include <stdlib.h>
+#include <mod_conference.h>
+
+#include <test/switch_test.h>
+
+#define KC_TICKS 3000
+
+/* packet `index` of the frame at `tick`, the payload says which one it is */
+static void kc_packet(switch_frame_t *frame, uint8_t *packet, uint32_t tick, int index, int count, switch_bool_t key)
+{
+	uint32_t len = 100 + index * 10, i;
+
+	memset(packet, 0, 12);
+	for (i = 0; i < len; i++) {
+		packet[12 + i] = (uint8_t) (tick * 31 + index * 7 + i);
+	}
+
+	memset(frame, 0, sizeof(*frame));
+	frame->packet = packet;
+	frame->data = packet + 12;
+	frame->datalen = len;
+	frame->packetlen = len + 12;
+	frame->buflen = SWITCH_RTP_MAX_BUF_LEN - 12;
+	frame->timestamp = tick * KC_TICKS;
+	frame->m = index == count - 1;
+	frame->flags = SFF_RAW_RTP | SFF_RAW_RTP_PARSE_FRAME | SFF_USE_VIDEO_TIMESTAMP;
+
+	if (key) {
+		frame->flags |= SFF_IS_KEYFRAME;
+	}
+}
+
+static void kc_feed(conference_obj_t *conference, codec_set_t *codec_set, uint32_t tick, int count, switch_bool_t key, switch_frame_t *last)
+{
+	uint8_t packet[SWITCH_RTP_MAX_BUF_LEN];
+	int i;
+
+	for (i = 0; i < count; i++) {
+		kc_packet(last, packet, tick, i, count, key);
+		conference_video_keyframe_cache_add(conference, codec_set, last);
+	}
+
+	last->packet = NULL;
+	last->data = NULL;
+}
+
+FST_CORE_BEGIN("./conf")
+{
+	FST_SUITE_BEGIN(conference_keyframe_cache)
+	{
+		FST_SETUP_BEGIN()
+		{
+		}
+		FST_SETUP_END()
+
+		FST_TEARDOWN_BEGIN()
+		{
+		}
+		FST_TEARDOWN_END()
+
+		FST_TEST_BEGIN(replay_from_keyframe)
+		{
+			conference_obj_t *conference = switch_core_alloc(fst_pool, sizeof(*conference));
+			codec_set_t *codec_set = switch_core_alloc(fst_pool, sizeof(*codec_set));
+			conference_member_t *member = switch_core_alloc(fst_pool, sizeof(*member));
+			uint8_t packet[SWITCH_RTP_MAX_BUF_LEN];
+			switch_frame_t frame = { 0 }, want;
+			uint32_t expect[][2] = { { 1, 0 }, { 1, 1 }, { 1, 2 }, { 2, 0 }, { 3, 0 }, { 3, 1 } };
+			uint32_t i;
+			void *pop;
+
+			conference->pool = fst_pool;
+			conference->video_keyframe_cache_size = 64 * 1024;
+			switch_frame_buffer_create(&member->fb, MEMBER_VIDEO_FB_LEN);
+
+			/* nothing to serve before the first keyframe */
+			kc_feed(conference, codec_set, 0, 2, SWITCH_FALSE, &frame);
+			fst_check(!conference_video_keyframe_cache_ready(codec_set));
+
+			kc_feed(conference, codec_set, 1, 3, SWITCH_TRUE, &frame);
+			kc_feed(conference, codec_set, 2, 1, SWITCH_FALSE, &frame);
+			kc_feed(conference, codec_set, 3, 2, SWITCH_FALSE, &frame);
+			fst_requires(conference_video_keyframe_cache_ready(codec_set));
+			fst_check(codec_set->keyframe_cache->packet_count == 6);
+			fst_check(codec_set->keyframe_cache->frame_count == 3);
+
+			/* the live frame is the last packet of tick 3 */
+			kc_packet(&frame, packet, 3, 1, 2, SWITCH_FALSE);
+			fst_requires(conference_video_keyframe_cache_replay(codec_set, member, &frame) == SWITCH_STATUS_SUCCESS);
+			fst_check(switch_frame_buffer_size(member->fb) == 6);
+
+			for (i = 0; i < 6; i++) {
+				switch_frame_t *got;
+				uint8_t want_packet[SWITCH_RTP_MAX_BUF_LEN];
+
+				fst_requires(switch_frame_buffer_trypop(member->fb, &pop) == SWITCH_STATUS_SUCCESS);
+				got = (switch_frame_t *) pop;
+
+				kc_packet(&want, want_packet, expect[i][0], expect[i][1], expect[i][0] == 1 ? 3 : expect[i][0] == 2 ? 1 : 2, SWITCH_FALSE);
+
+				fst_check(got->packetlen == want.packetlen);
+				fst_check(!memcmp(got->data, want.data, want.datalen));
+				fst_check(got->m == want.m);
+				fst_check(switch_test_flag(got, SFF_ENCODED));
+
+				/* the keyframe and the delta after it are squeezed in right before the live frame */
+				if (expect[i][0] == 3) {
+					fst_check(got->timestamp == 3 * KC_TICKS);
+				} else {
+					fst_check(got->timestamp == 3 * KC_TICKS - 3 + expect[i][0]);
+				}
+
+				switch_frame_buffer_free(member->fb, &got);
+			}
+
+			/* a new keyframe starts over */
+			kc_feed(conference, codec_set, 4, 2, SWITCH_TRUE, &frame);
+			fst_check(codec_set->keyframe_cache->packet_count == 2);
+			fst_check(codec_set->keyframe_cache->frame_count == 1);
+
+			conference_video_keyframe_cache_destroy(codec_set);
+			switch_frame_buffer_destroy(&member->fb);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(overflow)
+		{
+			conference_obj_t *conference = switch_core_alloc(fst_pool, sizeof(*conference));
+			codec_set_t *codec_set = switch_core_alloc(fst_pool, sizeof(*codec_set));
+			switch_frame_t frame = { 0 };
+			uint32_t tick;
+
+			conference->pool = fst_pool;
+			conference->video_keyframe_cache_size = 1024;
+
+			kc_feed(conference, codec_set, 0, 2, SWITCH_TRUE, &frame);
+			fst_check(conference_video_keyframe_cache_ready(codec_set));
+
+			/* a run longer than the cache can not be served until the next keyframe */
+			for (tick = 1; tick < 10; tick++) {
+				kc_feed(conference, codec_set, tick, 1, SWITCH_FALSE, &frame);
+			}
+			fst_check(!conference_video_keyframe_cache_ready(codec_set));
+
+			kc_feed(conference, codec_set, 10, 1, SWITCH_TRUE, &frame);
+			fst_check(conference_video_keyframe_cache_ready(codec_set));
+
+			conference_video_keyframe_cache_destroy(codec_set);
+		}
+		FST_TEST_END()
+	}
+	FST_SUITE_END()
+}
+FST_CORE_END()
@@ -0,0 +1,244 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * test_mixer.c -- drives the audio mixer with virtual members that have no session
+ *
+ */
+#include <switch.h>
+#include <switch_simd.h>
+#include <stdlib.h>
+#include <mod_conference.h>
+
+#include <test/switch_test.h>
+
+#define MIX_RATE 48000
+#define MIX_INTERVAL 20
+
+static uint32_t mix_bytes(void)
+{
+	return switch_samples_per_packet(MIX_RATE, MIX_INTERVAL) * 2;
+}
+
+static conference_obj_t *mixer_conference(switch_memory_pool_t *pool, uint32_t count, uint32_t talkers)
+{
+	conference_obj_t *conference = switch_core_alloc(pool, sizeof(*conference));
+	conference_member_t *member, *last = NULL;
+	uint32_t i;
+
+	conference->pool = pool;
+	conference->rate = MIX_RATE;
+	conference->channels = 1;
+	conference->interval = MIX_INTERVAL;
+
+	for (i = 0; i < count; i++) {
+		member = switch_core_alloc(pool, sizeof(*member));
+		member->id = i + 1;
+		member->conference = conference;
+		member->frame_size = SWITCH_RECOMMENDED_BUFFER_SIZE;
+		member->frame = switch_core_alloc(pool, member->frame_size);
+		switch_mutex_init(&member->audio_out_mutex, SWITCH_MUTEX_NESTED, pool);
+		switch_buffer_create_dynamic(&member->mux_buffer, CONF_DBLOCK_SIZE, CONF_DBUFFER_SIZE, CONF_DBUFFER_MAX);
+
+		/* virtual members, nothing but the flags the mixer looks at */
+		member->flags[MFLAG_RUNNING] = 1;
+		member->flags[MFLAG_NOCHANNEL] = 1;
+		member->flags[MFLAG_CAN_HEAR] = 1;
+		member->flags[MFLAG_CAN_SPEAK] = i < talkers;
+
+		if (last) {
+			last->next = member;
+		} else {
+			conference->members = member;
+		}
+		last = member;
+	}
+
+	return conference;
+}
+
+static void mixer_conference_destroy(conference_obj_t *conference)
+{
+	conference_member_t *member;
+
+	conference_mix_stop_workers(conference);
+
+	for (member = conference->members; member; member = member->next) {
+		switch_buffer_destroy(&member->mux_buffer);
+	}
+}
+
+/* one conference tick: talkers produce a frame, everybody gets their mix, probe keeps what the first two members heard */
+static switch_status_t mixer_tick(conference_obj_t *conference, uint32_t tick, int16_t *probe)
+{
+	int32_t main_frame[SWITCH_RECOMMENDED_BUFFER_SIZE] = { 0 };
+	int16_t out[SWITCH_RECOMMENDED_BUFFER_SIZE];
+	uint32_t bytes = mix_bytes(), samples = bytes / 2, i;
+	conference_member_t *member;
+	switch_status_t status;
+
+	for (member = conference->members; member; member = member->next) {
+		int16_t *data = (int16_t *) member->frame;
+
+		member->flags[MFLAG_HAS_AUDIO] = member->flags[MFLAG_CAN_SPEAK];
+		member->read = member->flags[MFLAG_HAS_AUDIO] ? bytes : 0;
+
+		if (member->flags[MFLAG_HAS_AUDIO]) {
+			/* loud enough that a few talkers clip */
+			for (i = 0; i < samples; i++) {
+				data[i] = (int16_t) ((((i * 7 + member->id * 131 + tick * 17) % 509) - 254) * 40);
+			}
+		}
+	}
+
+	status = conference_mix_audio(conference, main_frame, bytes);
+
+	for (member = conference->members, i = 0; member; member = member->next, i++) {
+		switch_buffer_read(member->mux_buffer, out, bytes);
+
+		if (probe && i < 2) {
+			memcpy(probe + i * samples, out, bytes);
+		}
+	}
+
+	return status;
+}
+
+FST_CORE_BEGIN("./conf")
+{
+	FST_SUITE_BEGIN(conference_mixer)
+	{
+		FST_SETUP_BEGIN()
+		{
+		}
+		FST_SETUP_END()
+
+		FST_TEARDOWN_BEGIN()
+		{
+			switch_simd_set_flags(switch_simd_cpu_flags());
+		}
+		FST_TEARDOWN_END()
+
+		FST_TEST_BEGIN(mix_matches_scalar)
+		{
+			static const switch_simd_flag_t levels[] = { SWITCH_SIMD_SSE2, SWITCH_SIMD_SSE2 | SWITCH_SIMD_AVX2, SWITCH_SIMD_NEON };
+			uint32_t samples = mix_bytes() / 2, tick, l, i;
+			int16_t *want = switch_core_alloc(fst_pool, samples * 2 * 2 * 10);
+			int16_t *got = switch_core_alloc(fst_pool, samples * 2 * 2 * 10);
+			conference_obj_t *conference;
+			int threads;
+
+			switch_simd_set_flags(SWITCH_SIMD_NONE);
+			conference = mixer_conference(fst_pool, 24, 6);
+
+			for (tick = 0; tick < 10; tick++) {
+				fst_requires(mixer_tick(conference, tick, want + tick * samples * 2) == SWITCH_STATUS_SUCCESS);
+			}
+
+			mixer_conference_destroy(conference);
+
+			/* a listener hears the saturated sum of the talkers */
+			for (i = 0; i < samples; i++) {
+				int32_t z = 0;
+				conference_member_t *member;
+
+				for (member = conference->members; member; member = member->next) {
+					if (member->flags[MFLAG_CAN_SPEAK] && member->id != 2) {
+						z += ((int16_t *) member->frame)[i];
+					}
+				}
+
+				switch_normalize_to_16bit(z);
+				fst_check(want[9 * samples * 2 + samples + i] == (int16_t) z);
+			}
+
+			for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+				if (switch_simd_set_flags(levels[l]) != levels[l]) {
+					continue;
+				}
+
+				for (threads = 0; threads <= 3; threads += 3) {
+					conference = mixer_conference(fst_pool, 24, 6);
+					conference->mix_threads = threads;
+					conference->mix_threads_min_members = 1;
+					conference_mix_launch_workers(conference);
+
+					for (tick = 0; tick < 10; tick++) {
+						fst_requires(mixer_tick(conference, tick, got + tick * samples * 2) == SWITCH_STATUS_SUCCESS);
+					}
+
+					mixer_conference_destroy(conference);
+
+					fst_xcheck(!memcmp(got, want, samples * 2 * 2 * 10 * sizeof(int16_t)), "mix differs from the scalar single thread mix");
+				}
+			}
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(benchmark)
+		{
+			struct {
+				const char *name;
+				switch_simd_flag_t simd;
+				int threads;
+			} modes[] = {
+				{ "scalar", SWITCH_SIMD_NONE, 0 },
+				{ "simd", 0, 0 },
+				{ "simd+workers", 0, 3 }
+			};
+#ifdef BENCHMARK
+			uint32_t count = 2000, talkers = 50, ticks = 3000;
+#else
+			uint32_t count = 300, talkers = 10, ticks = 50;
+#endif
+			uint32_t m, tick;
+
+			modes[1].simd = modes[2].simd = switch_simd_cpu_flags();
+
+			for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+				conference_obj_t *conference = mixer_conference(fst_pool, count, talkers);
+				switch_time_t start;
+
+				switch_simd_set_flags(modes[m].simd);
+				conference->mix_threads = modes[m].threads;
+				conference->mix_threads_min_members = 1;
+				conference_mix_launch_workers(conference);
+
+				start = switch_time_now();
+				for (tick = 0; tick < ticks; tick++) {
+					fst_requires(mixer_tick(conference, tick, NULL) == SWITCH_STATUS_SUCCESS);
+				}
+
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] %u members, %u talkers: %" SWITCH_TIME_T_FMT "us per %dms tick\n",
+								  modes[m].name, count, talkers, (switch_time_now() - start) / ticks, MIX_INTERVAL);
+
+				mixer_conference_destroy(conference);
+			}
+		}
+		FST_TEST_END()
+	}
+	FST_SUITE_END()
+}
+FST_CORE_END()
@@ -41,6 +41,7 @@ SWITCH_MODULE_DEFINITION(mod_test, mod_test_load, mod_test_shutdown, mod_test_ru
 typedef struct {
 	char *text;
 	int samples;
+	int fail;
 	const char *channel_uuid;
 } test_tts_t;
 
@@ -406,6 +407,9 @@ static switch_status_t test_speech_feed_tts(switch_speech_handle_t *sh, char *te
 			context->samples = atoi(p) * sh->samplerate / 1000;
 		}
 
+		/* end the text with an engine error instead of a normal stop */
+		context->fail = strstr(text, "error://") != NULL;
+
 		context->text = switch_core_strdup(sh->memory_pool, text);
 	}
 
@@ -417,7 +421,7 @@ static switch_status_t test_speech_read_tts(switch_speech_handle_t *sh, void *da
 	test_tts_t *context = (test_tts_t *)sh->private_info;
 
 	if (context->samples <= 0) {
-		return SWITCH_STATUS_FALSE;
+		return context->fail ? SWITCH_STATUS_GENERR : SWITCH_STATUS_FALSE;
 	}
 
 	if (context->samples < *datalen / 2 / sh->channels) {
@@ -34,11 +34,29 @@ typedef enum {
 	CDR_LEG_B = (1 << 1)
 } cdr_leg_t;
 
+typedef enum {
+	CDR_FSYNC_NONE,
+	CDR_FSYNC_ROTATE,
+	CDR_FSYNC_FLUSH
+} cdr_fsync_t;
+
+#define CDR_DEFAULT_BUFFER_SIZE 65536
+#define CDR_DEFAULT_FLUSH_MS 1000
+
 struct cdr_fd {
 	int fd;
 	char *path;
 	int64_t bytes;
 	switch_mutex_t *mutex;
+	/* buffered mode */
+	char *buf;
+	switch_size_t buf_len;
+	uint32_t buf_cdrs;
+	int flush_requested;
+	uint64_t cdrs_queued;
+	uint64_t cdrs_written;
+	uint64_t flushes;
+	uint64_t write_errors;
 };
 typedef struct cdr_fd cdr_fd_t;
 
@@ -58,6 +76,13 @@ static struct {
 	int rotate;
 	int debug;
 	cdr_leg_t legs;
+	int buffered;
+	switch_size_t buffer_size;
+	uint32_t flush_ms;
+	cdr_fsync_t fsync_policy;
+	int running;
+	switch_queue_t *flush_queue;
+	switch_thread_t *writer_thread;
 } globals;
 
 SWITCH_MODULE_LOAD_FUNCTION(mod_cdr_csv_load);
@@ -93,6 +118,15 @@ static void do_reopen(cdr_fd_t *fd)
 	}
 }
 
+static void do_fsync(int fd)
+{
+#ifdef _MSC_VER
+	_commit(fd);
+#else
+	fsync(fd);
+#endif
+}
+
 static void do_rotate(cdr_fd_t *fd)
 {
 	switch_time_exp_t tm;
@@ -100,6 +134,10 @@ static void do_rotate(cdr_fd_t *fd)
 	switch_size_t retsize;
 	char *p;
 
+	if (fd->fd > -1 && globals.fsync_policy != CDR_FSYNC_NONE) {
+		do_fsync(fd->fd);
+	}
+
 	close(fd->fd);
 	fd->fd = -1;
 
@@ -129,6 +167,172 @@ static void do_rotate(cdr_fd_t *fd)
 
 }
 
+/* write len bytes to an fd, reopening/rotating on errors like the unbuffered path does.
+ * Caller must hold fd->mutex, returns how many bytes could not be written. */
+static switch_size_t write_fd(cdr_fd_t *fd, const char *p, switch_size_t left)
+{
+	int loops = 0;
+
+	if (fd->fd < 0) {
+		do_reopen(fd);
+		if (fd->fd < 0) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Error opening %s\n", fd->path);
+			fd->write_errors++;
+			return left;
+		}
+	}
+
+	if (fd->bytes + left > UINT_MAX) {
+		do_rotate(fd);
+	}
+
+	while (left > 0 && fd->fd > -1 && loops < 10) {
+		int bytes_in = write(fd->fd, p, (unsigned int) left);
+
+		if (bytes_in > 0) {
+			p += bytes_in;
+			left -= bytes_in;
+			fd->bytes += bytes_in;
+			continue;
+		}
+
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Write error to file %s %d/%d\n", fd->path, bytes_in, (int) left);
+		fd->write_errors++;
+		loops++;
+		do_rotate(fd);
+	}
+
+	return left;
+}
+
+/* write out the pending buffer of an fd, caller must hold fd->mutex.
+ * Anything that could not be written stays in the buffer for the next attempt. */
+static void flush_fd(cdr_fd_t *fd)
+{
+	switch_size_t left = fd->buf_len;
+
+	fd->flush_requested = 0;
+
+	if (!left) {
+		return;
+	}
+
+	left = write_fd(fd, fd->buf, left);
+
+	if (left) {
+		if (left < fd->buf_len) {
+			switch_size_t done = fd->buf_len - left, i;
+			uint32_t cdrs = 0;
+
+			/* every template ends in a newline, count the records that made it out */
+			for (i = 0; i < done && cdrs < fd->buf_cdrs; i++) {
+				if (fd->buf[i] == '\n') {
+					cdrs++;
+				}
+			}
+			fd->cdrs_written += cdrs;
+			fd->buf_cdrs -= cdrs;
+
+			memmove(fd->buf, fd->buf + done, left);
+		} else {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Keeping %u buffered CDRs for %s\n", fd->buf_cdrs, fd->path);
+		}
+	} else {
+		fd->cdrs_written += fd->buf_cdrs;
+		fd->buf_cdrs = 0;
+		if (fd->fd > -1 && globals.fsync_policy == CDR_FSYNC_FLUSH) {
+			do_fsync(fd->fd);
+		}
+	}
+
+	fd->buf_len = left;
+	fd->flushes++;
+}
+
+static void flush_all(void)
+{
+	switch_hash_index_t *hi;
+	void *val;
+	cdr_fd_t *fd;
+
+	switch_mutex_lock(globals.mutex);
+	for (hi = switch_core_hash_first(globals.fd_hash); hi; hi = switch_core_hash_next(&hi)) {
+		switch_core_hash_this(hi, NULL, NULL, &val);
+		fd = (cdr_fd_t *) val;
+		switch_mutex_lock(fd->mutex);
+		flush_fd(fd);
+		switch_mutex_unlock(fd->mutex);
+	}
+	switch_mutex_unlock(globals.mutex);
+}
+
+static void *SWITCH_THREAD_FUNC cdr_writer_thread(switch_thread_t *thread, void *obj)
+{
+	switch_interval_time_t interval = (switch_interval_time_t) globals.flush_ms * 1000;
+	switch_time_t last_sweep = switch_micro_time_now();
+	void *pop;
+
+	while (globals.running) {
+		if (switch_queue_pop_timeout(globals.flush_queue, &pop, interval) == SWITCH_STATUS_SUCCESS && pop) {
+			cdr_fd_t *fd = (cdr_fd_t *) pop;
+
+			switch_mutex_lock(fd->mutex);
+			flush_fd(fd);
+			switch_mutex_unlock(fd->mutex);
+		}
+
+		if (switch_micro_time_now() - last_sweep >= interval) {
+			flush_all();
+			last_sweep = switch_micro_time_now();
+		}
+	}
+
+	flush_all();
+
+	return NULL;
+}
+
+static void buffer_cdr(cdr_fd_t *fd, const char *log_line, switch_size_t len)
+{
+	if (fd->buf_len + len > globals.buffer_size) {
+		/* the writer thread is behind, write inline rather than grow without bound */
+		flush_fd(fd);
+	}
+
+	if (len > globals.buffer_size && !fd->buf_len) {
+		/* larger than the whole buffer, write it on its own */
+		fd->cdrs_queued++;
+		if (write_fd(fd, log_line, len)) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Error writing oversized CDR to %s, dropping CDR\n", fd->path);
+			return;
+		}
+		fd->cdrs_written++;
+		if (globals.fsync_policy == CDR_FSYNC_FLUSH) {
+			do_fsync(fd->fd);
+		}
+		return;
+	}
+
+	if (fd->buf_len + len > globals.buffer_size) {
+		/* the flush above failed and the file is still unwritable */
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "CDR buffer for %s is full, dropping CDR\n", fd->path);
+		fd->write_errors++;
+		return;
+	}
+
+	memcpy(fd->buf + fd->buf_len, log_line, len);
+	fd->buf_len += len;
+	fd->buf_cdrs++;
+	fd->cdrs_queued++;
+
+	if (fd->buf_len >= globals.buffer_size / 2 && !fd->flush_requested) {
+		fd->flush_requested = 1;
+		if (switch_queue_trypush(globals.flush_queue, fd) != SWITCH_STATUS_SUCCESS) {
+			fd->flush_requested = 0;
+		}
+	}
+}
+
 static void write_cdr(const char *path, const char *log_line)
 {
 	cdr_fd_t *fd = NULL;
@@ -143,6 +347,9 @@ static void write_cdr(const char *path, const char *log_line)
 		fd->fd = -1;
 		switch_mutex_init(&fd->mutex, SWITCH_MUTEX_NESTED, globals.pool);
 		fd->path = switch_core_strdup(globals.pool, path);
+		if (globals.buffered) {
+			fd->buf = switch_core_alloc(globals.pool, globals.buffer_size);
+		}
 		switch_core_hash_insert(globals.fd_hash, path, fd);
 	}
 	switch_mutex_unlock(globals.mutex);
@@ -150,6 +357,11 @@ static void write_cdr(const char *path, const char *log_line)
 	switch_mutex_lock(fd->mutex);
 	bytes_out = (unsigned) strlen(log_line);
 
+	if (fd->buf && globals.running) {
+		buffer_cdr(fd, log_line, bytes_out);
+		goto end;
+	}
+
 	if (fd->fd < 0) {
 		do_reopen(fd);
 		if (fd->fd < 0) {
@@ -172,6 +384,9 @@ static void write_cdr(const char *path, const char *log_line)
 		fd->bytes += bytes_in;
 	}
 
+	fd->cdrs_queued++;
+	fd->cdrs_written++;
+
   end:
 
 	switch_mutex_unlock(fd->mutex);
@@ -287,6 +502,7 @@ static void do_rotate_all()
 		switch_core_hash_this(hi, NULL, NULL, &val);
 		fd = (cdr_fd_t *) val;
 		switch_mutex_lock(fd->mutex);
+		flush_fd(fd);
 		do_rotate(fd);
 		switch_mutex_unlock(fd->mutex);
 	}
@@ -304,7 +520,14 @@ static void do_teardown()
 		switch_core_hash_this(hi, NULL, NULL, &val);
 		fd = (cdr_fd_t *) val;
 		switch_mutex_lock(fd->mutex);
+		flush_fd(fd);
+		if (fd->buf_len) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Lost %u unwritten CDRs for %s\n", fd->buf_cdrs, fd->path);
+		}
 		if (fd->fd > -1) {
+			if (globals.fsync_policy != CDR_FSYNC_NONE) {
+				do_fsync(fd->fd);
+			}
 			close(fd->fd);
 			fd->fd = -1;
 		}
@@ -324,14 +547,48 @@ static void event_handler(switch_event_t *event)
 }
 
 
+static void do_status(switch_stream_handle_t *stream)
+{
+	switch_hash_index_t *hi;
+	void *val;
+	cdr_fd_t *fd;
+
+	switch_mutex_lock(globals.mutex);
+	for (hi = switch_core_hash_first(globals.fd_hash); hi; hi = switch_core_hash_next(&hi)) {
+		switch_core_hash_this(hi, NULL, NULL, &val);
+		fd = (cdr_fd_t *) val;
+		switch_mutex_lock(fd->mutex);
+		stream->write_function(stream, "%s\tqueued=%" SWITCH_UINT64_T_FMT "\twritten=%" SWITCH_UINT64_T_FMT "\tpending=%u\tpending_bytes=%"
+							   SWITCH_SIZE_T_FMT "\tflushes=%" SWITCH_UINT64_T_FMT "\terrors=%" SWITCH_UINT64_T_FMT "\n",
+							   fd->path, fd->cdrs_queued, fd->cdrs_written, fd->buf_cdrs, fd->buf_len, fd->flushes, fd->write_errors);
+		switch_mutex_unlock(fd->mutex);
+	}
+	switch_mutex_unlock(globals.mutex);
+}
+
 SWITCH_STANDARD_API(cdr_csv_function)
 {
+	if (zstr(cmd)) {
+		return SWITCH_STATUS_FALSE;
+	}
+
 	if (!strcmp(cmd, "rotate")) {
 		do_rotate_all();
 		stream->write_function(stream, "+OK");
 		return SWITCH_STATUS_SUCCESS;
 	}
 
+	if (!strcmp(cmd, "flush")) {
+		flush_all();
+		stream->write_function(stream, "+OK");
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	if (!strcmp(cmd, "status")) {
+		do_status(stream);
+		return SWITCH_STATUS_SUCCESS;
+	}
+
 	return SWITCH_STATUS_FALSE;
 }
 
@@ -363,6 +620,8 @@ static switch_status_t load_config(switch_memory_pool_t *pool)
 	switch_core_hash_init(&globals.template_hash);
 
 	globals.pool = pool;
+	globals.buffer_size = CDR_DEFAULT_BUFFER_SIZE;
+	globals.flush_ms = CDR_DEFAULT_FLUSH_MS;
 
 	switch_core_hash_insert(globals.template_hash, "default", default_template);
 	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG, "Adding default template.\n");
@@ -394,6 +653,26 @@ static switch_status_t load_config(switch_memory_pool_t *pool)
 					globals.default_template = switch_core_strdup(pool, val);
 				} else if (!strcasecmp(var, "master-file-only")) {
 					globals.masterfileonly = switch_true(val);
+				} else if (!strcasecmp(var, "buffered")) {
+					globals.buffered = switch_true(val);
+				} else if (!strcasecmp(var, "buffer-size")) {
+					int tmp = atoi(val);
+					if (tmp >= 4096) {
+						globals.buffer_size = tmp;
+					}
+				} else if (!strcasecmp(var, "flush-interval")) {
+					int tmp = atoi(val);
+					if (tmp > 0) {
+						globals.flush_ms = tmp;
+					}
+				} else if (!strcasecmp(var, "fsync")) {
+					if (!strcasecmp(val, "flush")) {
+						globals.fsync_policy = CDR_FSYNC_FLUSH;
+					} else if (!strcasecmp(val, "rotate")) {
+						globals.fsync_policy = CDR_FSYNC_ROTATE;
+					} else {
+						globals.fsync_policy = CDR_FSYNC_NONE;
+					}
 				}
 			}
 		}
@@ -451,11 +730,27 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_cdr_csv_load)
 		return status;
 	}
 
+	if (globals.buffered) {
+		switch_threadattr_t *thd_attr = NULL;
+
+		switch_queue_create(&globals.flush_queue, 1024, globals.pool);
+		globals.running = 1;
+
+		switch_threadattr_create(&thd_attr, globals.pool);
+		switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+		if (switch_thread_create(&globals.writer_thread, thd_attr, cdr_writer_thread, NULL, globals.pool) != SWITCH_STATUS_SUCCESS) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Can't start CDR writer thread, writing unbuffered\n");
+			globals.running = 0;
+		}
+	}
+
 	switch_core_add_state_handler(&state_handlers);
 	*module_interface = switch_loadable_module_create_module_interface(pool, modname);
 
-	SWITCH_ADD_API(api_interface, "cdr_csv", "cdr_csv controls", cdr_csv_function, "parameters");
+	SWITCH_ADD_API(api_interface, "cdr_csv", "cdr_csv controls", cdr_csv_function, "rotate|flush|status");
 	switch_console_set_complete("add cdr_csv rotate");
+	switch_console_set_complete("add cdr_csv flush");
+	switch_console_set_complete("add cdr_csv status");
 
 	return status;
 }
@@ -469,6 +764,15 @@ SWITCH_MODULE_SHUTDOWN_FUNCTION(mod_cdr_csv_shutdown)
 	switch_event_unbind_callback(event_handler);
 	switch_core_remove_state_handler(&state_handlers);
 
+	if (globals.writer_thread) {
+		switch_status_t st;
+
+		globals.running = 0;
+		switch_queue_trypush(globals.flush_queue, NULL);
+		switch_thread_join(&st, globals.writer_thread);
+		globals.writer_thread = NULL;
+	}
+
 	do_teardown();
 	switch_core_hash_destroy(&globals.fd_hash);
 	switch_core_hash_destroy(&globals.template_hash);
@@ -73,6 +73,12 @@ typedef struct {
 	cdr_field_t fields[1];
 } db_schema_t;
 
+/* a CDR waiting for the batch writer: the VALUES list for the spool fallback and the COPY text row */
+typedef struct {
+	char *values;
+	char *copy_row;
+} pg_cdr_t;
+
 static struct {
 	switch_memory_pool_t *pool;
 	switch_hash_t *fd_hash;
@@ -88,8 +94,24 @@ static struct {
 	spool_format_t spool_format;
 	int rotate;
 	int debug;
+	int batch_size;
+	int batch_timeout;
+	int batch_capacity;
+	switch_queue_t *batch_queue;
+	switch_thread_t *batch_thread;
+	PGconn *batch_connection;
+	switch_mutex_t *stats_mutex;
+	uint64_t cdrs_queued;
+	uint64_t cdrs_copied;
+	uint64_t cdrs_spooled;
+	uint64_t batches;
+	uint64_t batches_failed;
 } globals;
 
+static switch_xml_config_int_options_t config_opt_batch_size = { SWITCH_TRUE, 0, SWITCH_TRUE, 100000 };
+static switch_xml_config_int_options_t config_opt_batch_timeout = { SWITCH_TRUE, 1, SWITCH_TRUE, 60000 };
+static switch_xml_config_int_options_t config_opt_batch_capacity = { SWITCH_TRUE, 1, SWITCH_FALSE, 0 };
+
 static switch_xml_config_enum_item_t config_opt_cdr_leg_enum[] = {
         {"a", CDR_LEG_A},
         {"b", CDR_LEG_B},
@@ -122,6 +144,9 @@ static switch_xml_config_item_t config_settings[] = {
 	SWITCH_CONFIG_ITEM("spool-format", SWITCH_CONFIG_ENUM, CONFIG_RELOADABLE, &globals.spool_format, (void *) SPOOL_FORMAT_CSV, &config_opt_spool_format_enum, "csv|sql", "Disk spool format to use if SQL insert fails."),
 	SWITCH_CONFIG_ITEM("rotate-on-hup", SWITCH_CONFIG_BOOL, CONFIG_RELOADABLE, &globals.rotate, SWITCH_FALSE, NULL, NULL, NULL),
 	SWITCH_CONFIG_ITEM("debug", SWITCH_CONFIG_BOOL, CONFIG_RELOADABLE, &globals.debug, SWITCH_FALSE, NULL, NULL, NULL),
+	SWITCH_CONFIG_ITEM("batch-size", SWITCH_CONFIG_INT, 0, &globals.batch_size, 0, &config_opt_batch_size, NULL, "Stream CDRs with COPY in batches of this size (0 for one INSERT per CDR)."),
+	SWITCH_CONFIG_ITEM("batch-timeout", SWITCH_CONFIG_INT, 0, &globals.batch_timeout, 1000, &config_opt_batch_timeout, NULL, "Milliseconds to wait before copying a partial batch."),
+	SWITCH_CONFIG_ITEM("batch-queue-capacity", SWITCH_CONFIG_INT, 0, &globals.batch_capacity, 50000, &config_opt_batch_capacity, NULL, "CDRs held in memory before spooling to disk."),
 
 	/* key, type, flags, ptr, defaultvalue, function, functiondata, syntax, helptext */
 	SWITCH_CONFIG_ITEM_CALLBACK("spool-dir", SWITCH_CONFIG_STRING, CONFIG_RELOADABLE, &globals.spool_dir, NULL, config_validate_spool_dir, NULL, NULL, NULL),
@@ -244,9 +269,218 @@ static void spool_cdr(const char *path, const char *log_line)
 	switch_safe_free(log_line_lf);
 }
 
+static void spool_values(const char *values, const char *sql)
+{
+	char *path = NULL, *dup_sql = NULL;
+
+	if (globals.spool_format == SPOOL_FORMAT_SQL) {
+		if (!sql) {
+			dup_sql = switch_mprintf("INSERT INTO %s (%s) VALUES (%s);", globals.db_table, globals.db_schema->columns, values);
+			sql = dup_sql;
+		}
+		path = switch_mprintf("%s%scdr-spool.sql", globals.spool_dir, SWITCH_PATH_SEPARATOR);
+		assert(path);
+		spool_cdr(path, sql);
+	} else {
+		path = switch_mprintf("%s%scdr-spool.csv", globals.spool_dir, SWITCH_PATH_SEPARATOR);
+		assert(path);
+		spool_cdr(path, values);
+	}
+
+	if (globals.stats_mutex) {
+		switch_mutex_lock(globals.stats_mutex);
+		globals.cdrs_spooled++;
+		switch_mutex_unlock(globals.stats_mutex);
+	}
+
+	switch_safe_free(path);
+	switch_safe_free(dup_sql);
+}
+
+/* append one COPY text format column to the row buffer, escaping as described in the COPY docs */
+static void copy_append(switch_stream_handle_t *stream, const char *var, cdr_field_t *cdr_field)
+{
+	const char *p;
+	char buf[128];
+	switch_size_t n = 0;
+
+	if (cdr_field != globals.db_schema->fields) {
+		stream->raw_write_function(stream, (uint8_t *) "\t", 1);
+	}
+
+	if (zstr(var)) {
+		if (cdr_field->not_null == SWITCH_FALSE) {
+			stream->raw_write_function(stream, (uint8_t *) "\\N", 2);
+		}
+		return;
+	}
+
+	for (p = var; *p; p++) {
+		const char *esc = NULL;
+
+		switch (*p) {
+		case '\\': esc = "\\\\"; break;
+		case '\t': esc = "\\t"; break;
+		case '\n': esc = "\\n"; break;
+		case '\r': esc = "\\r"; break;
+		default: break;
+		}
+
+		if (n + 2 >= sizeof(buf)) {
+			stream->raw_write_function(stream, (uint8_t *) buf, n);
+			n = 0;
+		}
+
+		if (esc) {
+			buf[n++] = esc[0];
+			buf[n++] = esc[1];
+		} else {
+			buf[n++] = *p;
+		}
+	}
+
+	if (n) {
+		stream->raw_write_function(stream, (uint8_t *) buf, n);
+	}
+}
+
+/* stream a batch of rows over the background connection with COPY FROM STDIN */
+static switch_status_t copy_batch(pg_cdr_t **batch, int count)
+{
+	switch_stream_handle_t stream = { 0 };
+	PGresult *res;
+	char *sql;
+	int i, ok = 0;
+
+	if (!globals.batch_connection || PQstatus(globals.batch_connection) != CONNECTION_OK) {
+		if (globals.batch_connection) {
+			PQfinish(globals.batch_connection);
+		}
+		globals.batch_connection = PQconnectdb(globals.db_info);
+		if (PQstatus(globals.batch_connection) != CONNECTION_OK) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Connection to database failed: %s", PQerrorMessage(globals.batch_connection));
+			return SWITCH_STATUS_FALSE;
+		}
+	}
+
+	SWITCH_STANDARD_STREAM(stream);
+
+	for (i = 0; i < count; i++) {
+		stream.write_function(&stream, "%s\n", batch[i]->copy_row);
+	}
+
+	sql = switch_mprintf("COPY %s (%s) FROM STDIN", globals.db_table, globals.db_schema->columns);
+
+	res = PQexec(globals.batch_connection, sql);
+	if (PQresultStatus(res) != PGRES_COPY_IN) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "COPY command failed: %s", PQresultErrorMessage(res));
+		PQclear(res);
+		goto end;
+	}
+	PQclear(res);
+
+	if (PQputCopyData(globals.batch_connection, (const char *) stream.data, (int) stream.data_len) != 1 ||
+		PQputCopyEnd(globals.batch_connection, NULL) != 1) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "COPY data failed: %s", PQerrorMessage(globals.batch_connection));
+		goto end;
+	}
+
+	ok = 1;
+	while ((res = PQgetResult(globals.batch_connection))) {
+		if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "COPY failed: %s", PQresultErrorMessage(res));
+			ok = 0;
+		}
+		PQclear(res);
+	}
+
+  end:
+
+	if (!ok) {
+		PQfinish(globals.batch_connection);
+		globals.batch_connection = NULL;
+	}
+
+	switch_safe_free(sql);
+	switch_safe_free(stream.data);
+
+	return ok ? SWITCH_STATUS_SUCCESS : SWITCH_STATUS_FALSE;
+}
+
+static void destroy_pg_cdr(pg_cdr_t *cdr)
+{
+	switch_safe_free(cdr->values);
+	switch_safe_free(cdr->copy_row);
+	free(cdr);
+}
+
+static void *SWITCH_THREAD_FUNC batch_thread(switch_thread_t *thread, void *obj)
+{
+	pg_cdr_t **batch = calloc(globals.batch_size, sizeof(pg_cdr_t *));
+	switch_interval_time_t timeout = (switch_interval_time_t) globals.batch_timeout * 1000;
+	void *pop = NULL;
+	int i;
+
+	switch_assert(batch);
+
+	while (!globals.shutdown || switch_queue_size(globals.batch_queue)) {
+		int count = 0;
+		switch_time_t deadline;
+
+		if (switch_queue_pop_timeout(globals.batch_queue, &pop, timeout) == SWITCH_STATUS_SUCCESS && pop) {
+			batch[count++] = (pg_cdr_t *) pop;
+		}
+
+		deadline = switch_micro_time_now() + timeout;
+
+		while (count && count < globals.batch_size) {
+			if (switch_queue_trypop(globals.batch_queue, &pop) == SWITCH_STATUS_SUCCESS) {
+				if (pop) batch[count++] = (pg_cdr_t *) pop;
+				continue;
+			}
+			if (globals.shutdown || switch_micro_time_now() >= deadline) {
+				break;
+			}
+			switch_yield(10000);
+		}
+
+		if (!count) {
+			continue;
+		}
+
+		if (copy_batch(batch, count) == SWITCH_STATUS_SUCCESS) {
+			switch_mutex_lock(globals.stats_mutex);
+			globals.cdrs_copied += count;
+			globals.batches++;
+			switch_mutex_unlock(globals.stats_mutex);
+		} else {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Spooling batch of %d CDRs to disk\n", count);
+			switch_mutex_lock(globals.stats_mutex);
+			globals.batches_failed++;
+			switch_mutex_unlock(globals.stats_mutex);
+			for (i = 0; i < count; i++) {
+				spool_values(batch[i]->values, NULL);
+			}
+		}
+
+		for (i = 0; i < count; i++) {
+			destroy_pg_cdr(batch[i]);
+		}
+	}
+
+	if (globals.batch_connection) {
+		PQfinish(globals.batch_connection);
+		globals.batch_connection = NULL;
+	}
+
+	free(batch);
+
+	return NULL;
+}
+
 static switch_status_t insert_cdr(const char *values)
 {
-	char *sql = NULL, *path = NULL;
+	char *sql = NULL;
 	PGresult *res;
 
 	sql = switch_mprintf("INSERT INTO %s (%s) VALUES (%s);", globals.db_table, globals.db_schema->columns, values);
@@ -291,17 +525,7 @@ static switch_status_t insert_cdr(const char *values)
 	switch_mutex_unlock(globals.db_mutex);
 
 	/* SQL INSERT failed for whatever reason. Spool the attempted query to disk */
-	if (globals.spool_format == SPOOL_FORMAT_SQL) {
-		path = switch_mprintf("%s%scdr-spool.sql", globals.spool_dir, SWITCH_PATH_SEPARATOR);
-		assert(path);
-		spool_cdr(path, sql);
-	} else {
-		path = switch_mprintf("%s%scdr-spool.csv", globals.spool_dir, SWITCH_PATH_SEPARATOR);
-		assert(path);
-		spool_cdr(path, values);
-	}
-
-	switch_safe_free(path);
+	spool_values(values, sql);
 	switch_safe_free(sql);
 
 	return SWITCH_STATUS_FALSE;
@@ -315,6 +539,7 @@ static switch_status_t my_on_reporting(switch_core_session_t *session)
 	const char *var = NULL;
 	cdr_field_t *cdr_field = NULL;
 	switch_size_t len, offset;
+	switch_stream_handle_t copy_stream = { 0 };
 
 	if (globals.shutdown) {
 		return SWITCH_STATUS_SUCCESS;
@@ -353,8 +578,18 @@ static switch_status_t my_on_reporting(switch_core_session_t *session)
 	switch_zmalloc(values, 1);
 	offset = 0;
 
+	if (globals.batch_queue) {
+		SWITCH_STANDARD_STREAM(copy_stream);
+	}
+
 	for (cdr_field = globals.db_schema->fields; cdr_field->var_name; cdr_field++) {
-		if ((var = switch_channel_get_variable(channel, cdr_field->var_name))) {
+		var = switch_channel_get_variable(channel, cdr_field->var_name);
+
+		if (copy_stream.data) {
+			copy_append(&copy_stream, var, cdr_field);
+		}
+
+		if (var) {
 			/* Allocate sufficient buffer for PQescapeString */
 			len = strlen(var);
 			tmp = switch_core_session_alloc(session, len * 2 + 1);
@@ -382,6 +617,26 @@ static switch_status_t my_on_reporting(switch_core_session_t *session)
 	}
 	*(values + --offset) = '\0';
 
+	if (copy_stream.data) {
+		pg_cdr_t *cdr;
+
+		switch_zmalloc(cdr, sizeof(*cdr));
+		cdr->values = values;
+		cdr->copy_row = (char *) copy_stream.data;
+
+		if (switch_queue_trypush(globals.batch_queue, cdr) != SWITCH_STATUS_SUCCESS) {
+			switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(session), SWITCH_LOG_WARNING, "Batch queue full, spooling cdr to disk\n");
+			spool_values(values, NULL);
+			destroy_pg_cdr(cdr);
+		} else {
+			switch_mutex_lock(globals.stats_mutex);
+			globals.cdrs_queued++;
+			switch_mutex_unlock(globals.stats_mutex);
+		}
+
+		return status;
+	}
+
 	insert_cdr(values);
 	switch_safe_free(values);
 
@@ -519,9 +774,32 @@ static switch_status_t load_config(switch_memory_pool_t *pool)
 }
 
 
+SWITCH_STANDARD_API(cdr_pg_csv_function)
+{
+	if (zstr(cmd) || strcasecmp(cmd, "status")) {
+		stream->write_function(stream, "-USAGE: status\n");
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	if (!globals.batch_queue) {
+		stream->write_function(stream, "mode: insert\n");
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	switch_mutex_lock(globals.stats_mutex);
+	stream->write_function(stream, "mode: copy\nbatch-size: %d\nqueue-depth: %u\nqueued: %" SWITCH_UINT64_T_FMT "\ncopied: %" SWITCH_UINT64_T_FMT
+						   "\nspooled: %" SWITCH_UINT64_T_FMT "\nbatches: %" SWITCH_UINT64_T_FMT "\nbatches-failed: %" SWITCH_UINT64_T_FMT "\n",
+						   globals.batch_size, switch_queue_size(globals.batch_queue), globals.cdrs_queued, globals.cdrs_copied,
+						   globals.cdrs_spooled, globals.batches, globals.batches_failed);
+	switch_mutex_unlock(globals.stats_mutex);
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
 SWITCH_MODULE_LOAD_FUNCTION(mod_cdr_pg_csv_load)
 {
 	switch_status_t status = SWITCH_STATUS_SUCCESS;
+	switch_api_interface_t *api_interface;
 
 	load_config(pool);
 
@@ -535,9 +813,22 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_cdr_pg_csv_load)
 		return status;
 	}
 
+	if (globals.batch_size > 0 && globals.db_schema) {
+		switch_threadattr_t *thd_attr = NULL;
+
+		switch_mutex_init(&globals.stats_mutex, SWITCH_MUTEX_NESTED, pool);
+		switch_queue_create(&globals.batch_queue, globals.batch_capacity, pool);
+
+		switch_threadattr_create(&thd_attr, pool);
+		switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+		switch_thread_create(&globals.batch_thread, thd_attr, batch_thread, NULL, pool);
+	}
+
 	switch_core_add_state_handler(&state_handlers);
 	*module_interface = switch_loadable_module_create_module_interface(pool, modname);
 
+	SWITCH_ADD_API(api_interface, "cdr_pg_csv", "cdr_pg_csv status", cdr_pg_csv_function, "status");
+
 	return status;
 }
 
@@ -547,6 +838,15 @@ SWITCH_MODULE_SHUTDOWN_FUNCTION(mod_cdr_pg_csv_shutdown)
 
 	globals.shutdown = 1;
 
+	if (globals.batch_thread) {
+		switch_status_t st;
+
+		/* the writer drains whatever is still queued before it exits */
+		switch_queue_trypush(globals.batch_queue, NULL);
+		switch_thread_join(&st, globals.batch_thread);
+		globals.batch_thread = NULL;
+	}
+
 	if (globals.db_online) {
 		PQfinish(globals.db_connection);
 		globals.db_online = 0;
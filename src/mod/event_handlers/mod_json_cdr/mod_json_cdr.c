@@ -33,6 +33,7 @@
 #include <switch.h>
 #include <sys/stat.h>
 #include <switch_curl.h>
+#include "cdr_batch.h"
 
 #define MAX_URLS 20
 #define MAX_ERR_DIRS 20
@@ -76,6 +77,10 @@ static struct {
 	int encode_values;
 	switch_queue_t *queue;
 	switch_thread_t *thread;
+
+	/* batch mode: CDRs are posted as NDJSON bodies by a pool of workers and spooled to disk when undeliverable */
+	cdr_batch_settings_t batch_settings;
+	cdr_batch_t *batch;
 } globals;
 
 typedef struct {
@@ -253,23 +258,9 @@ void destroy_cdr_data(cdr_data_t *data)
 	switch_safe_free(data);
 }
 
-static void process_cdr(cdr_data_t *data)
+static void log_cdr_to_disk(cdr_data_t *data)
 {
-	char *curl_json_text = NULL;
-	long httpRes;
-	CURL *curl_handle = NULL;
-	switch_curl_slist_t *headers = NULL;
-	switch_curl_slist_t *slist = NULL;
 	int fd = -1;
-	uint32_t cur_try;
-
-	switch_assert(data != NULL);
-
-	if (globals.shutdown) {
-		goto end;
-	}
-
-	switch_log_printf(SWITCH_CHANNEL_UUID_LOG(data->uuid), SWITCH_LOG_INFO, "Process [%s]\n", data->filename);
 
 	if (!zstr(data->logdir) && (globals.log_http_and_disk || !globals.url_count)) {
 		char *path = switch_mprintf("%s%s%s", data->logdir, SWITCH_PATH_SEPARATOR, data->filename);
@@ -300,6 +291,26 @@ static void process_cdr(cdr_data_t *data)
 			switch_safe_free(path);
 		}
 	}
+}
+
+static void process_cdr(cdr_data_t *data)
+{
+	char *curl_json_text = NULL;
+	long httpRes;
+	CURL *curl_handle = NULL;
+	switch_curl_slist_t *headers = NULL;
+	switch_curl_slist_t *slist = NULL;
+	uint32_t cur_try;
+
+	switch_assert(data != NULL);
+
+	if (globals.shutdown) {
+		goto end;
+	}
+
+	switch_log_printf(SWITCH_CHANNEL_UUID_LOG(data->uuid), SWITCH_LOG_INFO, "Process [%s]\n", data->filename);
+
+	log_cdr_to_disk(data);
 
 	/* try to post it to the web server */
 	if (globals.url_count) {
@@ -436,6 +447,129 @@ static void process_cdr(cdr_data_t *data)
 	destroy_cdr_data(data);
 }
 
+static const char *cdr_item_text(void *item)
+{
+	return ((cdr_data_t *) item)->json_text;
+}
+
+static const char *cdr_item_filename(void *item)
+{
+	return ((cdr_data_t *) item)->filename;
+}
+
+static void cdr_item_destroy(void *item)
+{
+	destroy_cdr_data((cdr_data_t *) item);
+}
+
+static void cdr_item_prepare(void *item)
+{
+	log_cdr_to_disk((cdr_data_t *) item);
+}
+
+static void cdr_item_lost(void *item)
+{
+	backup_cdr((cdr_data_t *) item);
+}
+
+/* join CDRs into one newline delimited body */
+static char *batch_body(char **texts, uint32_t count)
+{
+	switch_size_t len = 0, pos = 0;
+	uint32_t i;
+	char *body;
+
+	for (i = 0; i < count; i++) {
+		len += strlen(texts[i]) + 1;
+	}
+
+	body = malloc(len + 1);
+	switch_assert(body);
+
+	for (i = 0; i < count; i++) {
+		switch_size_t tlen = strlen(texts[i]);
+
+		memcpy(body + pos, texts[i], tlen);
+		pos += tlen;
+		if (!tlen || texts[i][tlen - 1] != '\n') {
+			body[pos++] = '\n';
+		}
+	}
+
+	body[pos] = '\0';
+
+	return body;
+}
+
+static void batch_curl_setup(switch_CURL *curl_handle)
+{
+	if (!zstr(globals.cred)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_HTTPAUTH, globals.auth_scheme);
+		switch_curl_easy_setopt(curl_handle, CURLOPT_USERPWD, globals.cred);
+	}
+
+	switch_curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "freeswitch-json/1.0");
+
+	if (!zstr(globals.ssl_cert_file)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_SSLCERT, globals.ssl_cert_file);
+	}
+
+	if (!zstr(globals.ssl_key_file)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_SSLKEY, globals.ssl_key_file);
+	}
+
+	if (!zstr(globals.ssl_key_password)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_SSLKEYPASSWD, globals.ssl_key_password);
+	}
+
+	if (!zstr(globals.ssl_version)) {
+		if (!strcasecmp(globals.ssl_version, "SSLv3")) {
+			switch_curl_easy_setopt(curl_handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_SSLv3);
+		} else if (!strcasecmp(globals.ssl_version, "TLSv1")) {
+			switch_curl_easy_setopt(curl_handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1);
+		}
+	}
+
+	if (!zstr(globals.ssl_cacert_file)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_CAINFO, globals.ssl_cacert_file);
+	}
+
+	/* only looked at for https urls */
+	switch_curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYPEER, globals.enable_cacert_check ? 1 : 0);
+	switch_curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYHOST, globals.enable_ssl_verifyhost ? 2 : 0);
+
+	switch_curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT, globals.timeout);
+}
+
+static const cdr_batch_ops_t batch_ops = {
+	/*.suffix */ ".cdr.json",
+	/*.content_type */ "Content-Type: application/x-ndjson",
+	/*.body */ batch_body,
+	/*.item_text */ cdr_item_text,
+	/*.item_filename */ cdr_item_filename,
+	/*.item_destroy */ cdr_item_destroy,
+	/*.item_prepare */ cdr_item_prepare,
+	/*.item_lost */ cdr_item_lost,
+	/*.curl_setup */ batch_curl_setup
+};
+
+SWITCH_STANDARD_API(json_cdr_api_function)
+{
+	if (zstr(cmd) || strcasecmp(cmd, "status")) {
+		stream->write_function(stream, "-USAGE: status\n");
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	if (!globals.batch) {
+		stream->write_function(stream, "batch mode disabled\n");
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	cdr_batch_status(globals.batch, stream);
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
 static switch_status_t my_on_reporting(switch_core_session_t *session)
 {
 	cJSON *json_cdr = NULL;
@@ -472,7 +606,7 @@ static switch_status_t my_on_reporting(switch_core_session_t *session)
 
 	json_text = cJSON_PrintUnformatted(json_cdr);
 
-	if (globals.url_count && globals.encode) {
+	if (globals.url_count && globals.encode && !globals.batch_settings.size) {
 		switch_size_t need_bytes = strlen(json_text) * 3;
 
 		json_text_escaped = malloc(need_bytes);
@@ -499,7 +633,9 @@ static switch_status_t my_on_reporting(switch_core_session_t *session)
 
 	switch_thread_rwlock_unlock(globals.log_path_lock);
 
-	if (globals.queue) {
+	if (globals.batch) {
+		cdr_batch_push(globals.batch, cdr_data);
+	} else if (globals.queue) {
 		if (switch_queue_trypush(globals.queue, cdr_data) != SWITCH_STATUS_SUCCESS) {
 			switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(session), SWITCH_LOG_WARNING, "Unable to push cdr to queue\n");
 			backup_cdr(cdr_data);
@@ -574,6 +710,7 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_json_cdr_load)
 	char *cf = "json_cdr.conf";
 	switch_xml_t cfg, xml, settings, param;
 	switch_status_t status = SWITCH_STATUS_SUCCESS;
+	switch_api_interface_t *api_interface;
 
 	memset(&globals, 0, sizeof(globals));
 
@@ -584,6 +721,7 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_json_cdr_load)
 	globals.pool = pool;
 	globals.auth_scheme = CURLAUTH_BASIC;
 	globals.encode_values = ENCODING_DEFAULT;
+	cdr_batch_settings_init(&globals.batch_settings);
 
 	switch_thread_rwlock_create(&globals.log_path_lock, pool);
 
@@ -695,6 +833,8 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_json_cdr_load)
 				}
 			} else if (!strcasecmp(var, "encode-values") && !zstr(val)) {
 				globals.encode_values = switch_true(val) ? ENCODING_DEFAULT : ENCODING_NONE;
+			} else if (cdr_batch_set_param(&globals.batch_settings, var, val, globals.pool)) {
+				/* batch-size, batch-timeout, batch-workers, batch-queue-capacity, max-backoff, spool-dir */
 			} else if (!strcasecmp(var, "queue-capacity") && !zstr(val)) {
 				int capacity = atoi(val);
 				if (capacity > 0) {
@@ -727,6 +867,23 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_json_cdr_load)
 
 	set_json_cdr_log_dirs();
 
+	if (globals.batch_settings.size && !globals.url_count) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "batch-size set without any url, batch mode disabled\n");
+		globals.batch_settings.size = 0;
+	}
+
+	if (globals.batch_settings.size) {
+		if (!globals.batch_settings.spool_dir) {
+			globals.batch_settings.spool_dir = switch_core_sprintf(globals.pool, "%s%sspool", globals.base_err_log_dir[0], SWITCH_PATH_SEPARATOR);
+		}
+		globals.batch_settings.urls = globals.urls;
+		globals.batch_settings.url_count = globals.url_count;
+		globals.batch_settings.delay = globals.delay;
+		globals.batch_settings.disable100continue = globals.disable100continue;
+
+		cdr_batch_create(&globals.batch, &globals.batch_settings, &batch_ops, globals.pool);
+	}
+
 	if (switch_event_bind_removable(modname, SWITCH_EVENT_TRAP, SWITCH_EVENT_SUBCLASS_ANY, event_handler, NULL, &globals.node) != SWITCH_STATUS_SUCCESS) {
 		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Couldn't bind!\n");
 		return SWITCH_STATUS_GENERR;
@@ -737,6 +894,8 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_json_cdr_load)
 
 	*module_interface = switch_loadable_module_create_module_interface(pool, modname);
 
+	SWITCH_ADD_API(api_interface, "json_cdr", "json_cdr status", json_cdr_api_function, "status");
+
 	switch_xml_free(xml);
 	return status;
 }
@@ -754,6 +913,8 @@ SWITCH_MODULE_SHUTDOWN_FUNCTION(mod_json_cdr_shutdown)
 		switch_thread_join(&status, globals.thread);
 	}
 
+	cdr_batch_destroy(&globals.batch);
+
 	switch_safe_free(globals.log_dir);
 
 	for (;err_dir_index < globals.err_dir_count; err_dir_index++) {
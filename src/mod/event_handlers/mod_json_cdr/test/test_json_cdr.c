@@ -0,0 +1,167 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * test_json_cdr.c -- batch mode of mod_json_cdr against a loopback stand-in server
+ *
+ */
+#include <switch.h>
+#include <test/switch_test.h>
+
+#include "cdr_test_server.h"
+
+/* must match the url in test/freeswitch.xml */
+#define JSON_CDR_TEST_PORT 18091
+#define JSON_CDR_TEST_TARGET "/cdr?token=abc"
+
+static cdr_test_server_t server;
+
+/* one JSON object per line and as many lines as the request says CDRs */
+static int ndjson_records(const char *body)
+{
+	const char *p = body;
+	int records = 0;
+
+	while (*p) {
+		const char *nl = strchr(p, '\n');
+		char *line;
+		cJSON *json;
+
+		if (!nl) {
+			return -1;
+		}
+
+		line = switch_mprintf("%.*s", (int) (nl - p), p);
+		json = cJSON_Parse(line);
+		free(line);
+
+		if (!json) {
+			return -1;
+		}
+
+		cJSON_Delete(json);
+		records++;
+		p = nl + 1;
+	}
+
+	return records;
+}
+
+FST_CORE_BEGIN(".")
+
+FST_MODULE_BEGIN(mod_json_cdr, json_cdr)
+
+char *spool_dir = NULL;
+
+FST_SETUP_BEGIN()
+{
+	fst_requires_module("mod_loopback");
+	spool_dir = switch_core_sprintf(fst_pool, "%s%sjson_cdr_spool", SWITCH_GLOBAL_dirs.log_dir, SWITCH_PATH_SEPARATOR);
+}
+FST_SETUP_END()
+
+FST_TEARDOWN_BEGIN()
+{
+}
+FST_TEARDOWN_END()
+
+FST_TEST_BEGIN(batch_format)
+{
+	uint32_t i;
+
+	cdr_test_count_files(spool_dir, ".cdr.json", SWITCH_TRUE);
+	fst_requires(cdr_test_server_start(&server, JSON_CDR_TEST_PORT) == SWITCH_STATUS_SUCCESS);
+
+	fst_requires(cdr_test_make_cdrs(5) == 5);
+	fst_check_int_equals(cdr_test_server_wait(&server, 5, 10000), 5);
+
+	/* batch-size is 5 and batch-timeout long enough to collect all of them */
+	fst_check_int_equals(server.requests, 1);
+
+	for (i = 0; i < server.requests; i++) {
+		fst_check_string_equals(server.request[i].target, JSON_CDR_TEST_TARGET);
+		fst_check_string_equals(server.request[i].content_type, "application/x-ndjson");
+		fst_check_int_equals(ndjson_records(server.request[i].body), server.request[i].count);
+	}
+
+	cdr_test_server_reset(&server);
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(spool_while_down)
+{
+	cdr_test_server_stop(&server);
+
+	fst_requires(cdr_test_make_cdrs(3) == 3);
+	fst_check_int_equals(cdr_test_wait_files(spool_dir, ".cdr.json", 3, 10000), 3);
+	fst_check_int_equals(server.requests, 0);
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(replay_on_recovery)
+{
+	switch_stream_handle_t stream = { 0 };
+	uint32_t i;
+	int left;
+
+	fst_requires(cdr_test_server_start(&server, JSON_CDR_TEST_PORT) == SWITCH_STATUS_SUCCESS);
+
+	/* no new CDRs, the spool alone has to find the server again */
+	fst_check_int_equals(cdr_test_server_wait(&server, 3, 15000), 3);
+
+	for (i = 0; i < server.requests; i++) {
+		fst_check_string_equals(server.request[i].target, JSON_CDR_TEST_TARGET);
+		fst_check_int_equals(ndjson_records(server.request[i].body), server.request[i].count);
+	}
+
+	/* files are unlinked once the post returns */
+	for (i = 0; i < 40 && (left = cdr_test_count_files(spool_dir, ".cdr.json", SWITCH_FALSE)); i++) {
+		switch_yield(50000);
+	}
+	fst_check_int_equals(left, 0);
+
+	SWITCH_STANDARD_STREAM(stream);
+	switch_api_execute("json_cdr", "status", NULL, &stream);
+	fst_check_string_has((char *) stream.data, "replayed: 3\n");
+	switch_safe_free(stream.data);
+
+	cdr_test_server_destroy(&server);
+}
+FST_TEST_END()
+
+FST_MODULE_END()
+
+FST_CORE_END()
+
+/* For Emacs:
+ * Local Variables:
+ * mode:c
+ * indent-tabs-mode:t
+ * tab-width:4
+ * c-basic-offset:4
+ * End:
+ * For VIM:
+ * vim:set softtabstop=4 shiftwidth=4 tabstop=4 noet:
+ */
@@ -34,6 +34,8 @@
 #include <switch.h>
 /* for apr_pstrcat */
 #define DEFAULT_PREBUFFER_SIZE 1024 * 64
+/* decoded frames kept for the listeners, must be a power of 2 */
+#define LOCAL_STREAM_RING_FRAMES 256
 
 SWITCH_MODULE_LOAD_FUNCTION(mod_local_stream_load);
 SWITCH_MODULE_SHUTDOWN_FUNCTION(mod_local_stream_shutdown);
@@ -57,7 +59,9 @@ static int THREADS = 0;
 struct local_stream_context {
 	struct local_stream_source *source;
 	switch_mutex_t *audio_mutex;
-	switch_buffer_t *audio_buffer;
+	uint64_t seq;
+	switch_size_t offset;
+	uint32_t overruns;
 	int err;
 	const char *file;
 	const char *func;
@@ -132,6 +136,12 @@ struct local_stream_source {
 	uint8_t text_opacity;
 	switch_mm_t mm;
 	int sync;
+	/* every decoded frame is written once into the ring and each listener follows it with its own cursor */
+	switch_thread_rwlock_t *ring_rwlock;
+	switch_byte_t *ring;
+	switch_size_t *ring_len;
+	uint64_t ring_seq;
+	switch_atomic_t overruns;
 };
 
 typedef struct local_stream_source local_stream_source_t;
@@ -227,7 +237,6 @@ static void *SWITCH_THREAD_FUNC read_stream_thread(switch_thread_t *thread, void
 	char file_buf[128] = "", path_buf[512] = "", last_path[512] = "", png_buf[512] = "", tmp_buf[512] = "";
 	int fd = -1;
 	switch_buffer_t *audio_buffer;
-	switch_byte_t *dist_buf;
 	switch_size_t used;
 	int skip = 0;
 	switch_memory_pool_t *temp_pool = NULL;
@@ -252,9 +261,11 @@ static void *SWITCH_THREAD_FUNC read_stream_thread(switch_thread_t *thread, void
 
 	switch_queue_create(&source->video_q, 500, source->pool);
 	switch_buffer_create_dynamic(&audio_buffer, 1024, source->prebuf + 10, 0);
-	dist_buf = switch_core_alloc(source->pool, source->prebuf + 10);
+	source->ring = switch_core_alloc(source->pool, source->abuflen * LOCAL_STREAM_RING_FRAMES);
+	source->ring_len = switch_core_alloc(source->pool, sizeof(*source->ring_len) * LOCAL_STREAM_RING_FRAMES);
 
 	switch_thread_rwlock_create(&source->rwlock, source->pool);
+	switch_thread_rwlock_create(&source->ring_rwlock, source->pool);
 
 	if (switch_core_timer_init(&source->timer, source->timer_name, source->interval, (int)source->samples, source->pool) != SWITCH_STATUS_SUCCESS) {
 		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CONSOLE, "Can't start timer.\n");
@@ -604,40 +615,15 @@ static void *SWITCH_THREAD_FUNC read_stream_thread(switch_thread_t *thread, void
 					switch_buffer_zero(audio_buffer);
 				} else if (used && (!is_open || used >= source->abuflen)) {
 					void *pop;
-					uint32_t bused = 0;
 					local_stream_context_t *cp = NULL;
+					switch_size_t slot;
 
-					switch_assert(source->abuflen <= source->prebuf);
-					used = switch_buffer_read(audio_buffer, dist_buf, source->abuflen);
-
-					switch_mutex_lock(source->mutex);
-					for (cp = source->context_list; cp && RUNNING; cp = cp->next) {
-
-						if (!cp->ready) {
-							continue;
-						}
-
-						switch_mutex_lock(cp->audio_mutex);
-
-						if (switch_test_flag(cp->handle, SWITCH_FILE_OPEN)) {
-							if (switch_test_flag(cp->handle, SWITCH_FILE_CALLBACK)) {
-								switch_mutex_unlock(cp->audio_mutex);
-								continue;
-							}
-						}
-
-						bused = (uint32_t)switch_buffer_inuse(cp->audio_buffer);
-
-						if (bused > source->samples * 768) {
-							switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG1, "Flushing Stream Handle Buffer [%s() %s:%d] size: %u samples: %ld\n",
-											  cp->func, cp->file, cp->line, bused, (long)source->samples);
-							switch_buffer_zero(cp->audio_buffer);
-						} else {
-							switch_buffer_write(cp->audio_buffer, dist_buf, used);
-						}
-						switch_mutex_unlock(cp->audio_mutex);
-					}
-					switch_mutex_unlock(source->mutex);
+					/* one copy per frame no matter how many handles are listening */
+					switch_thread_rwlock_wrlock(source->ring_rwlock);
+					slot = (switch_size_t) (source->ring_seq & (LOCAL_STREAM_RING_FRAMES - 1));
+					source->ring_len[slot] = switch_buffer_read(audio_buffer, source->ring + slot * source->abuflen, source->abuflen);
+					source->ring_seq++;
+					switch_thread_rwlock_unlock(source->ring_rwlock);
 
 
 					while (switch_queue_trypop(source->video_q, &pop) == SWITCH_STATUS_SUCCESS) {
@@ -912,11 +898,11 @@ static switch_status_t local_stream_file_open(switch_file_handle_t *handle, cons
 	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG, "Opening Stream [%s] %dhz\n", path, handle->samplerate);
 	handle->mm.source_fps = source->mm.source_fps;
 	switch_mutex_init(&context->audio_mutex, SWITCH_MUTEX_NESTED, context->pool);
-	if (switch_buffer_create_dynamic(&context->audio_buffer, 512, 1024, 0) != SWITCH_STATUS_SUCCESS) {
-		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Memory Error!\n");
-		status = SWITCH_STATUS_MEMERR;
-		goto end;
-	}
+
+	/* start at the live edge of the stream */
+	switch_thread_rwlock_rdlock(source->ring_rwlock);
+	context->seq = source->ring_seq;
+	switch_thread_rwlock_unlock(source->ring_rwlock);
 
 	if (!switch_core_has_video() || !source->has_video ||
 		(switch_test_flag(handle, SWITCH_FILE_FLAG_VIDEO) && !source->has_video && !source->blank_img && !source->cover_art && !source->banner_txt)) {
@@ -983,7 +969,6 @@ static switch_status_t local_stream_file_close(switch_file_handle_t *handle)
 	source->total--;
 
 	switch_img_free(&context->banner_img);
-	switch_buffer_destroy(&context->audio_buffer);
 	switch_mutex_unlock(context->audio_mutex);
 	//switch_core_destroy_memory_pool(&pool);
 
@@ -1151,6 +1136,46 @@ static switch_status_t local_stream_file_read_video(switch_file_handle_t *handle
 	return SWITCH_STATUS_SUCCESS;
 }
 
+/* copy up to need bytes from the shared ring starting at the cursor of the handle */
+static switch_size_t local_stream_ring_read(local_stream_context_t *context, switch_byte_t *data, switch_size_t need)
+{
+	local_stream_source_t *source = context->source;
+	switch_size_t bytes = 0;
+
+	switch_thread_rwlock_rdlock(source->ring_rwlock);
+
+	if (source->ring_seq - context->seq > LOCAL_STREAM_RING_FRAMES) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_DEBUG1, "Flushing Stream Handle Buffer [%s() %s:%d] behind: %ld frames\n",
+						  context->func, context->file, context->line, (long)(source->ring_seq - context->seq));
+		context->seq = source->ring_seq;
+		context->offset = 0;
+		context->overruns++;
+		switch_atomic_inc(&source->overruns);
+	}
+
+	while (bytes < need && context->seq != source->ring_seq) {
+		switch_size_t slot = (switch_size_t) (context->seq & (LOCAL_STREAM_RING_FRAMES - 1));
+		switch_size_t len = source->ring_len[slot] - context->offset;
+
+		if (len > need - bytes) {
+			len = need - bytes;
+		}
+
+		memcpy(data + bytes, source->ring + slot * source->abuflen + context->offset, len);
+		bytes += len;
+		context->offset += len;
+
+		if (context->offset >= source->ring_len[slot]) {
+			context->seq++;
+			context->offset = 0;
+		}
+	}
+
+	switch_thread_rwlock_unlock(source->ring_rwlock);
+
+	return bytes;
+}
+
 static switch_status_t local_stream_file_read(switch_file_handle_t *handle, void *data, size_t *len)
 {
 	local_stream_context_t *context = handle->private_info;
@@ -1171,7 +1196,7 @@ static switch_status_t local_stream_file_read(switch_file_handle_t *handle, void
 	switch_mutex_lock(context->audio_mutex);
 	need = *len * 2 * context->source->channels;
 
-	if ((bytes = switch_buffer_read(context->audio_buffer, data, need))) {
+	if ((bytes = local_stream_ring_read(context, data, need))) {
 		*len = bytes / 2 / context->source->channels;
 		context->source->sync = 1;
 	} else {
@@ -1496,6 +1521,8 @@ SWITCH_STANDARD_API(local_stream_function)
 					stream->write_function(stream, "  <prebuf>%d</prebuf>\n", source->prebuf);
 					stream->write_function(stream, "  <timer>%s</timer>\n", source->timer_name);
 					stream->write_function(stream, "  <total>%d</total>\n", source->total);
+					stream->write_function(stream, "  <frames>%" SWITCH_UINT64_T_FMT "</frames>\n", source->ring_seq);
+					stream->write_function(stream, "  <overruns>%u</overruns>\n", switch_atomic_read(&source->overruns));
 					stream->write_function(stream, "  <shuffle>%s</shuffle>\n", (source->shuffle) ? "true" : "false");
 					stream->write_function(stream, "  <ready>%s</ready>\n", (source->ready) ? "true" : "false");
 					stream->write_function(stream, "  <stopped>%s</stopped>\n", (source->stopped) ? "true" : "false");
@@ -1510,6 +1537,8 @@ SWITCH_STANDARD_API(local_stream_function)
 					stream->write_function(stream, "  prebuf:   %d\n", source->prebuf);
 					stream->write_function(stream, "  timer:    %s\n", source->timer_name);
 					stream->write_function(stream, "  total:    %d\n", source->total);
+					stream->write_function(stream, "  frames:   %" SWITCH_UINT64_T_FMT "\n", source->ring_seq);
+					stream->write_function(stream, "  overruns: %u\n", switch_atomic_read(&source->overruns));
 					stream->write_function(stream, "  shuffle:  %s\n", (source->shuffle) ? "true" : "false");
 					stream->write_function(stream, "  ready:    %s\n", (source->ready) ? "true" : "false");
 					stream->write_function(stream, "  stopped:  %s\n", (source->stopped) ? "true" : "false");
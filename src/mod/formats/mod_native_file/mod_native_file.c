@@ -171,6 +171,168 @@ static switch_status_t native_file_file_get_string(switch_file_handle_t *handle,
 	return SWITCH_STATUS_FALSE;
 }
 
+/* Prompt sets
+ *
+ * native_file_convert encodes a source file, or every .wav file in a directory, into one native
+ * file per codec next to the source (prompt.wav -> prompt.PCMU, prompt.G722 ...).  Playback with
+ * playback_native_prompts set picks the file matching the codec of the call and sends its frames
+ * without transcoding.
+ */
+#define NATIVE_FILE_CONVERT_SYNTAX "<file|directory> <codec>[,<codec>...]"
+
+static switch_status_t native_file_convert(const char *path, const char *iananame, switch_stream_handle_t *stream)
+{
+	switch_file_handle_t in = { 0 }, out = { 0 };
+	switch_codec_t codec = { 0 };
+	int16_t pcm[SWITCH_RECOMMENDED_BUFFER_SIZE / 2];
+	uint8_t encoded[SWITCH_RECOMMENDED_BUFFER_SIZE];
+	char *base = NULL, *dest = NULL, *e;
+	uint32_t rate, samples, frames = 0;
+	switch_status_t status = SWITCH_STATUS_FALSE;
+
+	if (switch_core_codec_init(&codec, iananame, NULL, NULL, 0, 0, 1, SWITCH_CODEC_FLAG_ENCODE | SWITCH_CODEC_FLAG_DECODE, NULL, NULL) != SWITCH_STATUS_SUCCESS) {
+		stream->write_function(stream, "-ERR Can't load codec %s\n", iananame);
+		return SWITCH_STATUS_FALSE;
+	}
+
+	if (!codec.implementation->encoded_bytes_per_packet) {
+		stream->write_function(stream, "-ERR %s has variable length frames and can't be stored natively\n", iananame);
+		goto end;
+	}
+
+	rate = codec.implementation->actual_samples_per_second;
+	samples = codec.implementation->decoded_bytes_per_packet / 2;
+	switch_assert(samples <= sizeof(pcm) / 2);
+
+	base = strdup(path);
+	switch_assert(base);
+
+	if ((e = strrchr(base, '.')) && !strchr(e, '/')) {
+		*e = '\0';
+	}
+
+	dest = switch_mprintf("%s.%s", base, codec.implementation->iananame);
+
+	if (switch_core_file_open(&in, path, 1, rate, SWITCH_FILE_FLAG_READ | SWITCH_FILE_DATA_SHORT, NULL) != SWITCH_STATUS_SUCCESS) {
+		stream->write_function(stream, "-ERR Can't open %s\n", path);
+		goto end;
+	}
+
+	if (switch_core_file_open(&out, dest, 1, rate, SWITCH_FILE_FLAG_WRITE | SWITCH_FILE_NATIVE, NULL) != SWITCH_STATUS_SUCCESS) {
+		stream->write_function(stream, "-ERR Can't open %s\n", dest);
+		goto end;
+	}
+
+	for (;;) {
+		switch_size_t len = samples;
+		uint32_t encoded_len = sizeof(encoded);
+		uint32_t encoded_rate = rate;
+		unsigned int flags = 0;
+
+		if (switch_core_file_read(&in, pcm, &len) != SWITCH_STATUS_SUCCESS || !len) {
+			break;
+		}
+
+		/* pad the last frame, playback reads whole frames */
+		if (len < samples) {
+			memset(pcm + len, 0, (samples - len) * 2);
+		}
+
+		if (switch_core_codec_encode(&codec, NULL, pcm, samples * 2, rate, encoded, &encoded_len, &encoded_rate, &flags) != SWITCH_STATUS_SUCCESS) {
+			stream->write_function(stream, "-ERR Encoder error on %s\n", path);
+			goto end;
+		}
+
+		len = encoded_len;
+
+		if (switch_core_file_write(&out, encoded, &len) != SWITCH_STATUS_SUCCESS) {
+			stream->write_function(stream, "-ERR Write error on %s\n", dest);
+			goto end;
+		}
+
+		frames++;
+	}
+
+	stream->write_function(stream, "+OK %s %u frames\n", dest, frames);
+	status = SWITCH_STATUS_SUCCESS;
+
+  end:
+
+	if (switch_test_flag((&in), SWITCH_FILE_OPEN)) {
+		switch_core_file_close(&in);
+	}
+
+	if (switch_test_flag((&out), SWITCH_FILE_OPEN)) {
+		switch_core_file_close(&out);
+	}
+
+	switch_core_codec_destroy(&codec);
+	switch_safe_free(base);
+	switch_safe_free(dest);
+
+	return status;
+}
+
+static void native_file_convert_all(const char *path, char **codecs, int codec_count, switch_stream_handle_t *stream)
+{
+	int i;
+
+	for (i = 0; i < codec_count; i++) {
+		native_file_convert(path, codecs[i], stream);
+	}
+}
+
+SWITCH_STANDARD_API(native_file_convert_function)
+{
+	char *mydata = NULL, *argv[2] = { 0 }, *codecs[SWITCH_MAX_CODECS] = { 0 };
+	int argc, codec_count;
+	switch_memory_pool_t *pool = NULL;
+	switch_dir_t *dir = NULL;
+
+	if (zstr(cmd) || !(mydata = strdup(cmd)) ||
+		(argc = switch_separate_string(mydata, ' ', argv, (sizeof(argv) / sizeof(argv[0])))) < 2 ||
+		!(codec_count = switch_separate_string(argv[1], ',', codecs, (sizeof(codecs) / sizeof(codecs[0]))))) {
+		stream->write_function(stream, "-USAGE: %s\n", NATIVE_FILE_CONVERT_SYNTAX);
+		goto done;
+	}
+
+	switch_core_new_memory_pool(&pool);
+
+	if (switch_directory_exists(argv[0], pool) != SWITCH_STATUS_SUCCESS) {
+		native_file_convert_all(argv[0], codecs, codec_count, stream);
+	} else if (switch_dir_open(&dir, argv[0], pool) == SWITCH_STATUS_SUCCESS) {
+		char file_buf[256] = "";
+		const char *fname;
+
+		while ((fname = switch_dir_next_file(dir, file_buf, sizeof(file_buf)))) {
+			const char *ext = strrchr(fname, '.');
+			char *src;
+
+			if (!ext || strcasecmp(ext, ".wav")) {
+				continue;
+			}
+
+			src = switch_mprintf("%s%s%s", argv[0], SWITCH_PATH_SEPARATOR, fname);
+			native_file_convert_all(src, codecs, codec_count, stream);
+			free(src);
+		}
+
+		switch_dir_close(dir);
+	} else {
+		stream->write_function(stream, "-ERR Can't open %s\n", argv[0]);
+	}
+
+  done:
+
+	if (pool) {
+		switch_core_destroy_memory_pool(&pool);
+	}
+
+	switch_safe_free(mydata);
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
 /* Registration */
 
 static char *supported_formats[SWITCH_MAX_CODECS + 1] = { 0 };
@@ -178,6 +340,7 @@ static char *supported_formats[SWITCH_MAX_CODECS + 1] = { 0 };
 SWITCH_MODULE_LOAD_FUNCTION(mod_native_file_load)
 {
 	switch_file_interface_t *file_interface;
+	switch_api_interface_t *commands_api_interface;
 
 	const switch_codec_implementation_t *codecs[SWITCH_MAX_CODECS];
 	uint32_t num_codecs = switch_loadable_module_get_codecs(codecs, sizeof(codecs) / sizeof(codecs[0]));
@@ -204,6 +367,8 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_native_file_load)
 	file_interface->file_set_string = native_file_file_set_string;
 	file_interface->file_get_string = native_file_file_get_string;
 
+	SWITCH_ADD_API(commands_api_interface, "native_file_convert", "Build native prompt files", native_file_convert_function, NATIVE_FILE_CONVERT_SYNTAX);
+
 	/* indicate that the module should continue to be loaded */
 	return SWITCH_STATUS_SUCCESS;
 }
@@ -39,6 +39,9 @@ SWITCH_MODULE_DEFINITION(mod_logfile, mod_logfile_load, mod_logfile_shutdown, NU
 #define DEFAULT_LIMIT	 0xA00000	/* About 10 MB */
 #define WARM_FUZZY_OFFSET 256
 #define MAX_ROT 4096			/* why not */
+#define DEFAULT_BUFFER_SIZE 65536
+#define DEFAULT_FLUSH_MS 500
+#define DEFAULT_QUEUE_SIZE 100000
 
 static switch_memory_pool_t *module_pool = NULL;
 static switch_hash_t *profile_hash = NULL;
@@ -60,6 +63,26 @@ struct logfile_profile {
 	uint32_t all_level;
 	uint32_t suffix;			/* suffix of the highest logfile name */
 	switch_bool_t log_uuid;
+	char *compress_cmd;			/* command run on every rotated file, e.g. "gzip" */
+
+	/* buffered mode: lines are queued by the logger and written in batches by a writer thread */
+	switch_bool_t buffered;
+	switch_size_t buffer_size;	/* flush once this many bytes are pending */
+	uint32_t flush_ms;			/* flush at least this often when data is pending */
+	uint32_t queue_size;		/* maximum number of lines waiting for the writer */
+	switch_queue_t *log_queue;
+	switch_thread_t *writer_thread;
+	char *wbuf;
+	switch_size_t wbuf_len;
+	uint32_t wbuf_lines;
+	volatile int running;
+	volatile int rotate_pending;
+	volatile int reopen_pending;
+	/* bumped from every logging thread as well as the writer */
+	switch_atomic_t lines_queued;
+	switch_atomic_t lines_written;
+	switch_atomic_t lines_dropped;
+	switch_atomic_t flushes;
 };
 
 typedef struct logfile_profile logfile_profile_t;
@@ -112,6 +135,20 @@ static switch_status_t mod_logfile_openlogfile(logfile_profile_t *profile, switc
 	return SWITCH_STATUS_SUCCESS;
 }
 
+/* hand a freshly rotated file to the configured compressor without waiting for it */
+static void mod_logfile_compress(logfile_profile_t *profile, const char *filename)
+{
+	char *cmd;
+
+	if (zstr(profile->compress_cmd)) {
+		return;
+	}
+
+	cmd = switch_mprintf("%s '%s'", profile->compress_cmd, filename);
+	switch_system(cmd, SWITCH_FALSE);
+	switch_safe_free(cmd);
+}
+
 /* rotate the log file */
 static switch_status_t mod_logfile_rotate(logfile_profile_t *profile)
 {
@@ -184,6 +221,8 @@ static switch_status_t mod_logfile_rotate(logfile_profile_t *profile)
 			goto end;
 		}
 
+		mod_logfile_compress(profile, to_filename);
+
 		if ((status = mod_logfile_openlogfile(profile, SWITCH_FALSE)) != SWITCH_STATUS_SUCCESS) {
 			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Error reopening log %s\n", profile->logfile);
 		}
@@ -204,7 +243,9 @@ static switch_status_t mod_logfile_rotate(logfile_profile_t *profile)
 		}
 
 		switch_file_close(profile->log_afd);
-		switch_file_rename(profile->logfile, filename, pool);
+		if (switch_file_rename(profile->logfile, filename, pool) == SWITCH_STATUS_SUCCESS) {
+			mod_logfile_compress(profile, filename);
+		}
 		if ((status = mod_logfile_openlogfile(profile, SWITCH_FALSE)) != SWITCH_STATUS_SUCCESS) {
 			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Error Rotating Log!\n");
 			goto end;
@@ -259,6 +300,192 @@ static switch_status_t mod_logfile_raw_write(logfile_profile_t *profile, char *l
 	return status;
 }
 
+/* write out everything collected in the profile's batch buffer with a single write */
+static void mod_logfile_flush(logfile_profile_t *profile)
+{
+	switch_size_t len = profile->wbuf_len;
+	switch_status_t status = SWITCH_STATUS_SUCCESS;
+
+	if (!len) {
+		return;
+	}
+
+	switch_mutex_lock(globals.mutex);
+
+	if (!profile->log_afd || switch_file_write(profile->log_afd, profile->wbuf, &len) != SWITCH_STATUS_SUCCESS) {
+		if (profile->log_afd) {
+			switch_file_close(profile->log_afd);
+			profile->log_afd = NULL;
+		}
+		if ((status = mod_logfile_openlogfile(profile, SWITCH_TRUE)) == SWITCH_STATUS_SUCCESS) {
+			len = profile->wbuf_len;
+			switch_file_write(profile->log_afd, profile->wbuf, &len);
+		}
+	}
+
+	switch_mutex_unlock(globals.mutex);
+
+	if (status == SWITCH_STATUS_SUCCESS) {
+		profile->log_size += len;
+		switch_atomic_add(&profile->lines_written, profile->wbuf_lines);
+	} else {
+		switch_atomic_add(&profile->lines_dropped, profile->wbuf_lines);
+	}
+
+	switch_atomic_inc(&profile->flushes);
+	profile->wbuf_len = 0;
+	profile->wbuf_lines = 0;
+
+	if (status == SWITCH_STATUS_SUCCESS && profile->roll_size && profile->log_size >= profile->roll_size) {
+		profile->rotate_pending = 1;
+	}
+}
+
+static void mod_logfile_buffer_line(logfile_profile_t *profile, char *line)
+{
+	switch_size_t len = strlen(line);
+
+	if (profile->wbuf_len + len > profile->buffer_size) {
+		mod_logfile_flush(profile);
+	}
+
+	if (len > profile->buffer_size) {
+		/* larger than the whole buffer, write it on its own */
+		switch_mutex_lock(globals.mutex);
+		if (profile->log_afd && switch_file_write(profile->log_afd, line, &len) == SWITCH_STATUS_SUCCESS) {
+			profile->log_size += len;
+			switch_atomic_inc(&profile->lines_written);
+		} else {
+			switch_atomic_inc(&profile->lines_dropped);
+		}
+		switch_mutex_unlock(globals.mutex);
+		return;
+	}
+
+	memcpy(profile->wbuf + profile->wbuf_len, line, len);
+	profile->wbuf_len += len;
+	profile->wbuf_lines++;
+}
+
+static void *SWITCH_THREAD_FUNC mod_logfile_writer_thread(switch_thread_t *thread, void *obj)
+{
+	logfile_profile_t *profile = (logfile_profile_t *) obj;
+	switch_time_t last_flush = switch_micro_time_now();
+	switch_interval_time_t flush_interval = (switch_interval_time_t) profile->flush_ms * 1000;
+	void *pop;
+
+	while (profile->running || switch_queue_size(profile->log_queue)) {
+		switch_time_t now;
+
+		if (switch_queue_pop_timeout(profile->log_queue, &pop, flush_interval) == SWITCH_STATUS_SUCCESS && pop) {
+			mod_logfile_buffer_line(profile, (char *) pop);
+			free(pop);
+
+			/* drain whatever else is already waiting before deciding to flush */
+			while (profile->wbuf_len < profile->buffer_size && switch_queue_trypop(profile->log_queue, &pop) == SWITCH_STATUS_SUCCESS) {
+				if (!pop) continue;
+				mod_logfile_buffer_line(profile, (char *) pop);
+				free(pop);
+			}
+		}
+
+		now = switch_micro_time_now();
+
+		if (profile->wbuf_len && (profile->wbuf_len >= profile->buffer_size || now - last_flush >= flush_interval || !profile->running)) {
+			mod_logfile_flush(profile);
+			last_flush = now;
+		}
+
+		if (profile->reopen_pending) {
+			mod_logfile_flush(profile);
+			switch_mutex_lock(globals.mutex);
+			if (profile->log_afd) {
+				switch_file_close(profile->log_afd);
+				profile->log_afd = NULL;
+			}
+			if (mod_logfile_openlogfile(profile, SWITCH_TRUE) != SWITCH_STATUS_SUCCESS) {
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Error Re-opening Log!\n");
+			}
+			switch_mutex_unlock(globals.mutex);
+			profile->reopen_pending = 0;
+		}
+
+		if (profile->rotate_pending) {
+			mod_logfile_flush(profile);
+			profile->rotate_pending = 0;
+			mod_logfile_rotate(profile);
+		}
+	}
+
+	mod_logfile_flush(profile);
+
+	return NULL;
+}
+
+static switch_status_t mod_logfile_queue_write(logfile_profile_t *profile, const char *log_data)
+{
+	char *dup;
+
+	if (zstr(log_data) || !profile->running) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	dup = strdup(log_data);
+	switch_assert(dup);
+
+	if (switch_queue_trypush(profile->log_queue, dup) != SWITCH_STATUS_SUCCESS) {
+		free(dup);
+		switch_atomic_inc(&profile->lines_dropped);
+		return SWITCH_STATUS_FALSE;
+	}
+
+	switch_atomic_inc(&profile->lines_queued);
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+static switch_status_t mod_logfile_write(logfile_profile_t *profile, char *log_data)
+{
+	if (profile->buffered) {
+		return mod_logfile_queue_write(profile, log_data);
+	}
+
+	return mod_logfile_raw_write(profile, log_data);
+}
+
+static switch_status_t mod_logfile_start_writer(logfile_profile_t *profile)
+{
+	switch_threadattr_t *thd_attr = NULL;
+
+	profile->wbuf = switch_core_alloc(module_pool, profile->buffer_size);
+	switch_queue_create(&profile->log_queue, profile->queue_size, module_pool);
+	profile->running = 1;
+
+	switch_threadattr_create(&thd_attr, module_pool);
+	switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+
+	if (switch_thread_create(&profile->writer_thread, thd_attr, mod_logfile_writer_thread, profile, module_pool) != SWITCH_STATUS_SUCCESS) {
+		profile->running = 0;
+		return SWITCH_STATUS_FALSE;
+	}
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+static void mod_logfile_stop_writer(logfile_profile_t *profile)
+{
+	switch_status_t st;
+
+	if (!profile->writer_thread) {
+		return;
+	}
+
+	profile->running = 0;
+	switch_queue_trypush(profile->log_queue, NULL);
+	switch_thread_join(&st, profile->writer_thread);
+	profile->writer_thread = NULL;
+}
+
 static switch_status_t process_node(const switch_log_node_t *node, switch_log_level_t level)
 {
 	switch_hash_index_t *hi;
@@ -302,13 +529,13 @@ static switch_status_t process_node(const switch_log_node_t *node, switch_log_le
 				argc = switch_split(dup, '\n', lines);
 				for (i = 0; i < argc; i++) {
 					switch_snprintf(buf, sizeof(buf), "%s %s\n", node->userdata, lines[i]);
-					mod_logfile_raw_write(profile, buf);
+					mod_logfile_write(profile, buf);
 				}
 
 				free(dup);
 
 			} else {
-				mod_logfile_raw_write(profile, node->data);
+				mod_logfile_write(profile, node->data);
 			}
 		}
 
@@ -326,6 +553,12 @@ static void cleanup_profile(void *ptr)
 {
 	logfile_profile_t *profile = (logfile_profile_t *) ptr;
 
+	mod_logfile_stop_writer(profile);
+	if (profile->buffered) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "Profile %s wrote %u of %u queued lines, %u dropped\n",
+						  profile->name, switch_atomic_read(&profile->lines_written), switch_atomic_read(&profile->lines_queued),
+						  switch_atomic_read(&profile->lines_dropped));
+	}
 	switch_core_hash_destroy(&profile->log_hash);
 	switch_file_close(profile->log_afd);
 	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "Closing %s\n", profile->logfile);
@@ -346,6 +579,9 @@ static switch_status_t load_profile(switch_xml_t xml)
 
 	new_profile->suffix = 1;
 	new_profile->log_uuid = SWITCH_TRUE;
+	new_profile->buffer_size = DEFAULT_BUFFER_SIZE;
+	new_profile->flush_ms = DEFAULT_FLUSH_MS;
+	new_profile->queue_size = DEFAULT_QUEUE_SIZE;
 
 	if ((settings = switch_xml_child(xml, "settings"))) {
 		for (param = switch_xml_child(settings, "param"); param; param = param->next) {
@@ -362,6 +598,27 @@ static switch_status_t load_profile(switch_xml_t xml)
 				}
 			} else if (!strcmp(var, "uuid")) {
 				new_profile->log_uuid = switch_true(val);
+			} else if (!strcmp(var, "buffered")) {
+				new_profile->buffered = switch_true(val);
+			} else if (!strcmp(var, "buffer-size")) {
+				int tmp = atoi(val);
+				if (tmp >= 1024) {
+					new_profile->buffer_size = tmp;
+				}
+			} else if (!strcmp(var, "flush-interval")) {
+				int tmp = atoi(val);
+				if (tmp > 0) {
+					new_profile->flush_ms = tmp;
+				}
+			} else if (!strcmp(var, "queue-size")) {
+				int tmp = atoi(val);
+				if (tmp > 0) {
+					new_profile->queue_size = tmp;
+				}
+			} else if (!strcmp(var, "compress-command")) {
+				if (!zstr(val)) {
+					new_profile->compress_cmd = switch_core_strdup(module_pool, val);
+				}
 			}
 		}
 	}
@@ -385,6 +642,11 @@ static switch_status_t load_profile(switch_xml_t xml)
 		return SWITCH_STATUS_GENERR;
 	}
 
+	if (new_profile->buffered && mod_logfile_start_writer(new_profile) != SWITCH_STATUS_SUCCESS) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Can't start writer thread for %s, writing unbuffered\n", new_profile->name);
+		new_profile->buffered = SWITCH_FALSE;
+	}
+
 	switch_core_hash_insert_destructor(profile_hash, new_profile->name, (void *) new_profile, cleanup_profile);
 	return SWITCH_STATUS_SUCCESS;
 }
@@ -403,13 +665,21 @@ static void event_handler(switch_event_t *event)
 			for (hi = switch_core_hash_first(profile_hash); hi; hi = switch_core_hash_next(&hi)) {
 				switch_core_hash_this(hi, &var, NULL, &val);
 				profile = val;
-				mod_logfile_rotate(profile);
+				if (profile->buffered) {
+					profile->rotate_pending = 1;
+				} else {
+					mod_logfile_rotate(profile);
+				}
 			}
 		} else {
 			switch_mutex_lock(globals.mutex);
 			for (hi = switch_core_hash_first(profile_hash); hi; hi = switch_core_hash_next(&hi)) {
 				switch_core_hash_this(hi, &var, NULL, &val);
 				profile = val;
+				if (profile->buffered) {
+					profile->reopen_pending = 1;
+					continue;
+				}
 				switch_file_close(profile->log_afd);
 				if (mod_logfile_openlogfile(profile, SWITCH_TRUE) != SWITCH_STATUS_SUCCESS) {
 					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Error Re-opening Log!\n");
@@ -420,10 +690,42 @@ static void event_handler(switch_event_t *event)
 	}
 }
 
+SWITCH_STANDARD_API(logfile_api_function)
+{
+	switch_hash_index_t *hi;
+	void *val;
+	const void *var;
+	logfile_profile_t *profile;
+
+	if (zstr(cmd) || strcasecmp(cmd, "status")) {
+		stream->write_function(stream, "-USAGE: status\n");
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	switch_mutex_lock(globals.mutex);
+	for (hi = switch_core_hash_first(profile_hash); hi; hi = switch_core_hash_next(&hi)) {
+		switch_core_hash_this(hi, &var, NULL, &val);
+		profile = val;
+		stream->write_function(stream, "%s\t%s\t%s\tsize=%" SWITCH_SIZE_T_FMT, profile->name, profile->logfile,
+							   profile->buffered ? "buffered" : "direct", profile->log_size);
+		if (profile->buffered) {
+			stream->write_function(stream, "\tqueued=%u\twritten=%u\tdropped=%u\tpending=%u\tflushes=%u",
+								   switch_atomic_read(&profile->lines_queued), switch_atomic_read(&profile->lines_written),
+								   switch_atomic_read(&profile->lines_dropped), switch_queue_size(profile->log_queue),
+								   switch_atomic_read(&profile->flushes));
+		}
+		stream->write_function(stream, "\n");
+	}
+	switch_mutex_unlock(globals.mutex);
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
 SWITCH_MODULE_LOAD_FUNCTION(mod_logfile_load)
 {
 	char *cf = "logfile.conf";
 	switch_xml_t cfg, xml, settings, param, profiles, xprofile;
+	switch_api_interface_t *api_interface;
 
 	module_pool = pool;
 
@@ -443,6 +745,8 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_logfile_load)
 	/* connect my internal structure to the blank pointer passed to me */
 	*module_interface = switch_loadable_module_create_module_interface(pool, modname);
 
+	SWITCH_ADD_API(api_interface, "logfile", "File logger status", logfile_api_function, "status");
+
 	if (!(xml = switch_xml_open_cfg(cf, &cfg, NULL))) {
 		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Open of %s failed\n", cf);
 	} else {
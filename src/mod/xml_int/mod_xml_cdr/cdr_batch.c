@@ -0,0 +1,597 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2014, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * cdr_batch.c -- batched CDR posting with a disk spool, shared by mod_xml_cdr and mod_json_cdr
+ *
+ * A pool of workers collects up to size CDRs (or whatever arrived within timeout ms) and posts
+ * them as one body framed by the module. Batches that can't be delivered are spooled one file
+ * per CDR and the worker backs off exponentially, spooled files are replayed once a post goes
+ * through again.
+ *
+ */
+#include <switch.h>
+#include <sys/stat.h>
+#include "cdr_batch.h"
+
+struct cdr_batch_s {
+	cdr_batch_settings_t settings;
+	cdr_batch_ops_t ops;
+	switch_memory_pool_t *pool;
+	switch_queue_t *queue;
+	switch_thread_t *threads[CDR_BATCH_MAX_WORKERS];
+	switch_mutex_t *spool_mutex;
+	switch_mutex_t *stats_mutex;
+	int shutdown;
+	int spool_pending;
+	uint64_t cdrs_queued;
+	uint64_t cdrs_posted;
+	uint64_t cdrs_spooled;
+	uint64_t cdrs_replayed;
+	uint64_t batches_posted;
+	uint64_t batches_failed;
+};
+
+static size_t batch_http_callback(char *buffer, size_t size, size_t nitems, void *outstream)
+{
+	return size * nitems;
+}
+
+void cdr_batch_settings_init(cdr_batch_settings_t *settings)
+{
+	memset(settings, 0, sizeof(*settings));
+	settings->timeout = CDR_BATCH_DEFAULT_TIMEOUT;
+	settings->workers = 1;
+	settings->capacity = CDR_BATCH_DEFAULT_CAPACITY;
+	settings->max_backoff = CDR_BATCH_DEFAULT_MAX_BACKOFF;
+}
+
+switch_bool_t cdr_batch_set_param(cdr_batch_settings_t *settings, const char *var, const char *val, switch_memory_pool_t *pool)
+{
+	if (zstr(val)) {
+		return SWITCH_FALSE;
+	}
+
+	if (!strcasecmp(var, "batch-size")) {
+		settings->size = switch_atoui(val);
+	} else if (!strcasecmp(var, "batch-timeout")) {
+		settings->timeout = switch_atoui(val);
+	} else if (!strcasecmp(var, "batch-workers")) {
+		settings->workers = switch_atoui(val);
+		if (settings->workers < 1) {
+			settings->workers = 1;
+		} else if (settings->workers > CDR_BATCH_MAX_WORKERS) {
+			settings->workers = CDR_BATCH_MAX_WORKERS;
+		}
+	} else if (!strcasecmp(var, "batch-queue-capacity")) {
+		if (atoi(val) > 0) {
+			settings->capacity = switch_atoui(val);
+		}
+	} else if (!strcasecmp(var, "max-backoff")) {
+		settings->max_backoff = switch_atoui(val);
+	} else if (!strcasecmp(var, "spool-dir")) {
+		if (switch_is_file_path(val)) {
+			settings->spool_dir = switch_core_strdup(pool, val);
+		} else {
+			settings->spool_dir = switch_core_sprintf(pool, "%s%s%s", SWITCH_GLOBAL_dirs.log_dir, SWITCH_PATH_SEPARATOR, val);
+		}
+	} else {
+		return SWITCH_FALSE;
+	}
+
+	return SWITCH_TRUE;
+}
+
+/* write a CDR to the spool dir so a worker can replay it once the web server is reachable again */
+static switch_status_t spool_cdr(cdr_batch_t *batch, const char *filename, const char *text)
+{
+	char *path, *tmp_path;
+	int fd = -1;
+	switch_status_t status = SWITCH_STATUS_FALSE;
+
+	if (!(path = switch_mprintf("%s%s%s", batch->settings.spool_dir, SWITCH_PATH_SEPARATOR, filename))) {
+		return status;
+	}
+
+	/* write under a name replay_spool ignores and only rename it into place once complete,
+	   so a half written file is never posted and unlinked */
+	if (!(tmp_path = switch_mprintf("%s.tmp", path))) {
+		switch_safe_free(path);
+		return status;
+	}
+
+#ifdef _MSC_VER
+	if ((fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR)) > -1) {
+#else
+	if ((fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)) > -1) {
+#endif
+		switch_size_t len = strlen(text);
+		switch_ssize_t wrote = 0, x;
+
+		do { x = write(fd, text + wrote, len - wrote);
+		} while (!(x<0) && len > (switch_size_t)(wrote += x));
+
+		if (close(fd) < 0) {
+			x = -1;
+		}
+
+		if (x < 0) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Error writing [%s]\n", tmp_path);
+			unlink(tmp_path);
+		} else if (rename(tmp_path, path) < 0) {
+			char ebuf[512] = { 0 };
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Can't rename %s to %s! [%s]\n", tmp_path, path,
+							  switch_strerror_r(errno, ebuf, sizeof(ebuf)));
+			unlink(tmp_path);
+		} else {
+			status = SWITCH_STATUS_SUCCESS;
+		}
+	} else {
+		char ebuf[512] = { 0 };
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Can't open %s! [%s]\n", tmp_path, switch_strerror_r(errno, ebuf, sizeof(ebuf)));
+	}
+
+	switch_safe_free(tmp_path);
+	switch_safe_free(path);
+
+	switch_mutex_lock(batch->stats_mutex);
+	if (status == SWITCH_STATUS_SUCCESS) {
+		batch->cdrs_spooled++;
+		batch->spool_pending = 1;
+	}
+	switch_mutex_unlock(batch->stats_mutex);
+
+	return status;
+}
+
+static void spool_item(cdr_batch_t *batch, void *item)
+{
+	if (spool_cdr(batch, batch->ops.item_filename(item), batch->ops.item_text(item)) != SWITCH_STATUS_SUCCESS) {
+		if (batch->ops.item_lost) {
+			batch->ops.item_lost(item);
+		} else {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_CRIT, "Lost CDR %s, unable to spool it\n", batch->ops.item_filename(item));
+		}
+	}
+}
+
+static char *read_spool_file(const char *path)
+{
+	struct stat st;
+	char *text = NULL;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) < 0) {
+		return NULL;
+	}
+
+	if (!fstat(fd, &st) && st.st_size > 0) {
+		switch_size_t got = 0;
+		switch_ssize_t x = 0;
+
+		text = malloc((size_t) st.st_size + 1);
+		switch_assert(text);
+
+		while (got < (switch_size_t) st.st_size && (x = read(fd, text + got, (unsigned) (st.st_size - got))) > 0) {
+			got += x;
+		}
+
+		if (x < 0) {
+			switch_safe_free(text);
+		} else {
+			text[got] = '\0';
+		}
+	}
+
+	close(fd);
+
+	return text;
+}
+
+static void batch_curl_setup(cdr_batch_t *batch, switch_CURL *curl_handle)
+{
+	switch_curl_easy_setopt(curl_handle, CURLOPT_POST, 1);
+	switch_curl_easy_setopt(curl_handle, CURLOPT_NOSIGNAL, 1);
+	switch_curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, batch_http_callback);
+	switch_curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPALIVE, 1L);
+
+	batch->ops.curl_setup(curl_handle);
+}
+
+/* POST one body, trying each url once. The handle is kept by the worker so the connection is reused.
+   The number of CDRs goes in a header so the configured urls are posted to as they are. */
+static switch_status_t batch_post(cdr_batch_t *batch, switch_CURL *curl_handle, int *url_index, const char *body, uint32_t count)
+{
+	switch_curl_slist_t *headers = NULL;
+	switch_status_t status = SWITCH_STATUS_FALSE;
+	char count_header[64];
+	int tries;
+
+	switch_snprintf(count_header, sizeof(count_header), "X-CDR-Count: %u", count);
+
+	headers = switch_curl_slist_append(headers, batch->ops.content_type);
+	headers = switch_curl_slist_append(headers, count_header);
+	if (batch->settings.disable100continue) {
+		headers = switch_curl_slist_append(headers, "Expect:");
+	}
+
+	switch_curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, headers);
+	switch_curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, body);
+
+	for (tries = 0; tries < batch->settings.url_count; tries++) {
+		const char *url = batch->settings.urls[*url_index];
+		long httpRes = 0;
+
+		switch_curl_easy_setopt(curl_handle, CURLOPT_URL, url);
+		switch_curl_easy_perform(curl_handle);
+		switch_curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &httpRes);
+
+		if (httpRes >= 200 && httpRes < 300) {
+			status = SWITCH_STATUS_SUCCESS;
+			break;
+		}
+
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Got error [%ld] posting batch of %u CDRs to web server [%s]\n", httpRes, count, url);
+
+		if (++(*url_index) >= batch->settings.url_count) {
+			*url_index = 0;
+		}
+	}
+
+	/* the list is only read during perform */
+	switch_curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, NULL);
+	switch_curl_slist_free_all(headers);
+
+	return status;
+}
+
+/* post up to one batch worth of spooled files. Returns SWITCH_STATUS_FALSE when the post failed and
+   SWITCH_STATUS_BREAK when there was nothing to post, the spool is empty or another worker is replaying it */
+static switch_status_t replay_spool(cdr_batch_t *batch, switch_CURL *curl_handle, int *url_index)
+{
+	switch_memory_pool_t *pool = NULL;
+	switch_dir_t *dir = NULL;
+	char fname_buf[512];
+	const char *fname;
+	char **paths, **texts;
+	switch_size_t slen = strlen(batch->ops.suffix);
+	uint32_t count = 0, i;
+	switch_status_t status = SWITCH_STATUS_BREAK;
+
+	if (switch_mutex_trylock(batch->spool_mutex) != SWITCH_STATUS_SUCCESS) {
+		/* another worker is already replaying */
+		return SWITCH_STATUS_BREAK;
+	}
+
+	paths = calloc(batch->settings.size, sizeof(char *));
+	texts = calloc(batch->settings.size, sizeof(char *));
+	switch_assert(paths && texts);
+
+	switch_core_new_memory_pool(&pool);
+
+	if (switch_dir_open(&dir, batch->settings.spool_dir, pool) != SWITCH_STATUS_SUCCESS) {
+		goto end;
+	}
+
+	while (count < batch->settings.size && (fname = switch_dir_next_file(dir, fname_buf, sizeof(fname_buf)))) {
+		switch_size_t flen = strlen(fname);
+		char *path;
+
+		if (flen <= slen || strcasecmp(fname + flen - slen, batch->ops.suffix)) {
+			continue;
+		}
+
+		path = switch_mprintf("%s%s%s", batch->settings.spool_dir, SWITCH_PATH_SEPARATOR, fname);
+
+		if ((texts[count] = read_spool_file(path))) {
+			paths[count++] = path;
+		} else {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Skipping unreadable spool file %s\n", path);
+			free(path);
+		}
+	}
+
+	switch_dir_close(dir);
+
+	if (count) {
+		char *body = batch->ops.body(texts, count);
+
+		if ((status = batch_post(batch, curl_handle, url_index, body, count)) == SWITCH_STATUS_SUCCESS) {
+			for (i = 0; i < count; i++) {
+				unlink(paths[i]);
+			}
+			switch_mutex_lock(batch->stats_mutex);
+			batch->cdrs_replayed += count;
+			batch->batches_posted++;
+			switch_mutex_unlock(batch->stats_mutex);
+		}
+
+		free(body);
+	}
+
+  end:
+
+	if (status == SWITCH_STATUS_BREAK) {
+		switch_mutex_lock(batch->stats_mutex);
+		batch->spool_pending = 0;
+		switch_mutex_unlock(batch->stats_mutex);
+	}
+
+	for (i = 0; i < count; i++) {
+		switch_safe_free(paths[i]);
+		switch_safe_free(texts[i]);
+	}
+	free(paths);
+	free(texts);
+
+	switch_core_destroy_memory_pool(&pool);
+	switch_mutex_unlock(batch->spool_mutex);
+
+	return status;
+}
+
+static uint32_t next_backoff(cdr_batch_t *batch, uint32_t backoff)
+{
+	backoff = backoff ? backoff * 2 : (batch->settings.delay ? batch->settings.delay : 1);
+
+	if (backoff > batch->settings.max_backoff) {
+		backoff = batch->settings.max_backoff;
+	}
+
+	return backoff;
+}
+
+static void *SWITCH_THREAD_FUNC batch_thread(switch_thread_t *t, void *obj)
+{
+	cdr_batch_t *batch = (cdr_batch_t *) obj;
+	void **items = calloc(batch->settings.size, sizeof(void *));
+	char **texts = calloc(batch->settings.size, sizeof(char *));
+	switch_interval_time_t batch_timeout = (switch_interval_time_t) batch->settings.timeout * 1000;
+	switch_CURL *curl_handle = NULL;
+	int url_index = 0;
+	uint32_t backoff = 0, i;
+	switch_time_t retry_at = 0;
+	void *pop = NULL;
+
+	switch_assert(items && texts);
+
+	curl_handle = switch_curl_easy_init();
+	batch_curl_setup(batch, curl_handle);
+
+	while (!batch->shutdown) {
+		uint32_t count = 0;
+		switch_time_t deadline;
+		char *body;
+
+		if (backoff && switch_micro_time_now() < retry_at) {
+			switch_yield(100000);
+			continue;
+		}
+
+		/* wait for the first CDR, then keep collecting until the batch is full or the timeout expires */
+		if (switch_queue_pop_timeout(batch->queue, &pop, batch_timeout) == SWITCH_STATUS_SUCCESS && pop) {
+			items[count++] = pop;
+		}
+
+		deadline = switch_micro_time_now() + batch_timeout;
+
+		while (count && count < batch->settings.size && !batch->shutdown) {
+			if (switch_queue_trypop(batch->queue, &pop) == SWITCH_STATUS_SUCCESS) {
+				if (pop) items[count++] = pop;
+				continue;
+			}
+			if (switch_micro_time_now() >= deadline) {
+				break;
+			}
+			switch_yield(10000);
+		}
+
+		if (!count) {
+			switch_status_t status = SWITCH_STATUS_BREAK;
+
+			/* without live traffic the spool is the probe that finds the server back after a failure */
+			while (batch->spool_pending && !batch->shutdown && (status = replay_spool(batch, curl_handle, &url_index)) == SWITCH_STATUS_SUCCESS) {
+				if (backoff) {
+					switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_NOTICE, "Web server reachable again, replaying spooled CDRs\n");
+					backoff = 0;
+				}
+				if (switch_queue_size(batch->queue)) {
+					break;
+				}
+			}
+
+			if (status == SWITCH_STATUS_FALSE) {
+				backoff = next_backoff(batch, backoff);
+				retry_at = switch_micro_time_now() + (switch_time_t) backoff * 1000000;
+
+				switch_mutex_lock(batch->stats_mutex);
+				batch->batches_failed++;
+				switch_mutex_unlock(batch->stats_mutex);
+
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Unable to replay spooled CDRs, backing off %u seconds\n", backoff);
+			}
+			continue;
+		}
+
+		for (i = 0; i < count; i++) {
+			if (batch->ops.item_prepare) {
+				batch->ops.item_prepare(items[i]);
+			}
+			texts[i] = (char *) batch->ops.item_text(items[i]);
+		}
+
+		body = batch->ops.body(texts, count);
+
+		if (batch_post(batch, curl_handle, &url_index, body, count) == SWITCH_STATUS_SUCCESS) {
+			switch_mutex_lock(batch->stats_mutex);
+			batch->cdrs_posted += count;
+			batch->batches_posted++;
+			switch_mutex_unlock(batch->stats_mutex);
+
+			if (backoff) {
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_NOTICE, "Web server reachable again, replaying spooled CDRs\n");
+			}
+			backoff = 0;
+
+			while (batch->spool_pending && !batch->shutdown && replay_spool(batch, curl_handle, &url_index) == SWITCH_STATUS_SUCCESS) {
+				if (switch_queue_size(batch->queue) >= batch->settings.size) {
+					/* don't starve live traffic */
+					break;
+				}
+			}
+		} else {
+			for (i = 0; i < count; i++) {
+				spool_item(batch, items[i]);
+			}
+
+			backoff = next_backoff(batch, backoff);
+			retry_at = switch_micro_time_now() + (switch_time_t) backoff * 1000000;
+
+			switch_mutex_lock(batch->stats_mutex);
+			batch->batches_failed++;
+			switch_mutex_unlock(batch->stats_mutex);
+
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Unable to post batch, spooled %u CDRs, backing off %u seconds\n", count, backoff);
+		}
+
+		free(body);
+
+		for (i = 0; i < count; i++) {
+			batch->ops.item_destroy(items[i]);
+		}
+	}
+
+	/* anything still queued is kept on disk for the next start */
+	while (switch_queue_trypop(batch->queue, &pop) == SWITCH_STATUS_SUCCESS) {
+		if (pop) {
+			spool_item(batch, pop);
+			batch->ops.item_destroy(pop);
+		}
+	}
+
+	switch_curl_easy_cleanup(curl_handle);
+	free(items);
+	free(texts);
+
+	return NULL;
+}
+
+switch_status_t cdr_batch_create(cdr_batch_t **batchp, const cdr_batch_settings_t *settings, const cdr_batch_ops_t *ops, switch_memory_pool_t *pool)
+{
+	cdr_batch_t *batch;
+	switch_threadattr_t *thd_attr;
+	uint32_t i;
+
+	if (!settings->size || !settings->url_count || zstr(settings->spool_dir)) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	batch = switch_core_alloc(pool, sizeof(*batch));
+	batch->settings = *settings;
+	batch->ops = *ops;
+	batch->pool = pool;
+
+	switch_dir_make_recursive(batch->settings.spool_dir, SWITCH_DEFAULT_DIR_PERMS, pool);
+
+	switch_mutex_init(&batch->spool_mutex, SWITCH_MUTEX_NESTED, pool);
+	switch_mutex_init(&batch->stats_mutex, SWITCH_MUTEX_NESTED, pool);
+	switch_queue_create(&batch->queue, batch->settings.capacity, pool);
+
+	/* pick up whatever a previous run left behind */
+	batch->spool_pending = 1;
+
+	switch_threadattr_create(&thd_attr, pool);
+	switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+	for (i = 0; i < batch->settings.workers; i++) {
+		switch_thread_create(&batch->threads[i], thd_attr, batch_thread, batch, pool);
+	}
+
+	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "Batch mode: %u CDRs per post, %u workers, spooling to %s\n",
+					  batch->settings.size, batch->settings.workers, batch->settings.spool_dir);
+
+	*batchp = batch;
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+void cdr_batch_destroy(cdr_batch_t **batchp)
+{
+	cdr_batch_t *batch = *batchp;
+	switch_status_t st;
+	uint32_t i;
+
+	if (!batch) {
+		return;
+	}
+
+	*batchp = NULL;
+	batch->shutdown = 1;
+
+	for (i = 0; i < batch->settings.workers; i++) {
+		switch_queue_trypush(batch->queue, NULL);
+	}
+	for (i = 0; i < batch->settings.workers; i++) {
+		if (batch->threads[i]) {
+			switch_thread_join(&st, batch->threads[i]);
+		}
+	}
+}
+
+void cdr_batch_push(cdr_batch_t *batch, void *item)
+{
+	if (switch_queue_trypush(batch->queue, item) != SWITCH_STATUS_SUCCESS) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Batch queue full, spooling cdr %s to disk\n", batch->ops.item_filename(item));
+		spool_item(batch, item);
+		batch->ops.item_destroy(item);
+		return;
+	}
+
+	switch_mutex_lock(batch->stats_mutex);
+	batch->cdrs_queued++;
+	switch_mutex_unlock(batch->stats_mutex);
+}
+
+void cdr_batch_status(cdr_batch_t *batch, switch_stream_handle_t *stream)
+{
+	switch_mutex_lock(batch->stats_mutex);
+	stream->write_function(stream, "workers: %u\nqueue-depth: %u\nqueued: %" SWITCH_UINT64_T_FMT "\nposted: %" SWITCH_UINT64_T_FMT
+						   "\nspooled: %" SWITCH_UINT64_T_FMT "\nreplayed: %" SWITCH_UINT64_T_FMT "\nbatches-posted: %" SWITCH_UINT64_T_FMT
+						   "\nbatches-failed: %" SWITCH_UINT64_T_FMT "\nspool-pending: %s\n",
+						   batch->settings.workers, switch_queue_size(batch->queue), batch->cdrs_queued, batch->cdrs_posted,
+						   batch->cdrs_spooled, batch->cdrs_replayed, batch->batches_posted, batch->batches_failed,
+						   batch->spool_pending ? "true" : "false");
+	switch_mutex_unlock(batch->stats_mutex);
+}
+
+/* For Emacs:
+ * Local Variables:
+ * mode:c
+ * indent-tabs-mode:t
+ * tab-width:4
+ * c-basic-offset:4
+ * End:
+ * For VIM:
+ * vim:set softtabstop=4 shiftwidth=4 tabstop=4 noet:
+ */
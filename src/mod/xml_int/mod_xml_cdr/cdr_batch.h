@@ -0,0 +1,102 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2014, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * cdr_batch.h -- batched CDR posting with a disk spool, shared by mod_xml_cdr and mod_json_cdr
+ *
+ */
+#ifndef CDR_BATCH_H
+#define CDR_BATCH_H
+
+#include <switch.h>
+#include <switch_curl.h>
+
+#define CDR_BATCH_MAX_WORKERS 16
+#define CDR_BATCH_DEFAULT_TIMEOUT 1000
+#define CDR_BATCH_DEFAULT_CAPACITY 10000
+#define CDR_BATCH_DEFAULT_MAX_BACKOFF 300
+
+typedef struct cdr_batch_s cdr_batch_t;
+
+/* what a module plugs into the batch pipeline, items are whatever the module queues */
+typedef struct {
+	/* spool file names end in this, e.g. ".cdr.xml" */
+	const char *suffix;
+	/* the whole header line, e.g. "Content-Type: text/xml" */
+	const char *content_type;
+	/* frame count CDR texts as one malloc'd request body */
+	char *(*body)(char **texts, uint32_t count);
+	const char *(*item_text)(void *item);
+	const char *(*item_filename)(void *item);
+	void (*item_destroy)(void *item);
+	/* optional, called on each item before it is posted */
+	void (*item_prepare)(void *item);
+	/* optional, called when an item can neither be posted nor spooled */
+	void (*item_lost)(void *item);
+	/* module options on a worker's handle: auth, tls, cookies, timeouts */
+	void (*curl_setup)(switch_CURL *curl_handle);
+} cdr_batch_ops_t;
+
+typedef struct {
+	uint32_t size;
+	uint32_t timeout;
+	uint32_t workers;
+	uint32_t capacity;
+	uint32_t max_backoff;
+	char *spool_dir;
+	/* filled in by the module from its own settings */
+	char **urls;
+	int url_count;
+	uint32_t delay;
+	int disable100continue;
+} cdr_batch_settings_t;
+
+void cdr_batch_settings_init(cdr_batch_settings_t *settings);
+
+/* returns SWITCH_TRUE when var is one of the batch params */
+switch_bool_t cdr_batch_set_param(cdr_batch_settings_t *settings, const char *var, const char *val, switch_memory_pool_t *pool);
+
+switch_status_t cdr_batch_create(cdr_batch_t **batchp, const cdr_batch_settings_t *settings, const cdr_batch_ops_t *ops, switch_memory_pool_t *pool);
+
+/* stop the workers, whatever is still queued is spooled for the next start */
+void cdr_batch_destroy(cdr_batch_t **batchp);
+
+/* hand an item to the workers, it is spooled right away when the queue is full */
+void cdr_batch_push(cdr_batch_t *batch, void *item);
+
+void cdr_batch_status(cdr_batch_t *batch, switch_stream_handle_t *stream);
+
+#endif
+
+/* For Emacs:
+ * Local Variables:
+ * mode:c
+ * indent-tabs-mode:t
+ * tab-width:4
+ * c-basic-offset:4
+ * End:
+ * For VIM:
+ * vim:set softtabstop=4 shiftwidth=4 tabstop=4 noet:
+ */
@@ -34,6 +34,7 @@
 #include <switch.h>
 #include <sys/stat.h>
 #include <switch_curl.h>
+#include "cdr_batch.h"
 #define MAX_URLS 20
 
 #define ENCODING_NONE 0
@@ -73,8 +74,17 @@ static struct {
 	switch_memory_pool_t *pool;
 	switch_event_node_t *node;
 	char *cookie_file;
+
+	/* batch mode: CDRs are posted as one <cdrs> document by a pool of workers and spooled to disk when undeliverable */
+	cdr_batch_settings_t batch_settings;
+	cdr_batch_t *batch;
 } globals;
 
+typedef struct {
+	char *xml_text;
+	char *filename;
+} xml_cdr_item_t;
+
 SWITCH_MODULE_LOAD_FUNCTION(mod_xml_cdr_load);
 SWITCH_MODULE_SHUTDOWN_FUNCTION(mod_xml_cdr_shutdown);
 SWITCH_MODULE_DEFINITION(mod_xml_cdr, mod_xml_cdr_load, mod_xml_cdr_shutdown, NULL);
@@ -182,6 +192,142 @@ static switch_status_t set_xml_cdr_log_dirs()
 	return status;
 }
 
+static const char *cdr_item_text(void *item)
+{
+	return ((xml_cdr_item_t *) item)->xml_text;
+}
+
+static const char *cdr_item_filename(void *item)
+{
+	return ((xml_cdr_item_t *) item)->filename;
+}
+
+static void cdr_item_destroy(void *item)
+{
+	xml_cdr_item_t *cdr = (xml_cdr_item_t *) item;
+
+	switch_safe_free(cdr->xml_text);
+	switch_safe_free(cdr->filename);
+	free(cdr);
+}
+
+/* wrap CDRs in a single <cdrs> document, dropping their individual xml declarations */
+static char *batch_body(char **texts, uint32_t count)
+{
+	switch_size_t len = 0, pos = 0;
+	uint32_t i;
+	char *body;
+
+	for (i = 0; i < count; i++) {
+		len += strlen(texts[i]) + 1;
+	}
+
+	len += strlen("<?xml version=\"1.0\"?>\n<cdrs>\n</cdrs>\n");
+	body = malloc(len + 1);
+	switch_assert(body);
+
+	pos = switch_snprintf(body, len + 1, "<?xml version=\"1.0\"?>\n<cdrs>\n");
+
+	for (i = 0; i < count; i++) {
+		const char *text = texts[i];
+		switch_size_t tlen;
+
+		if (!strncmp(text, "<?xml", 5) && (text = strstr(text, "?>"))) {
+			text += 2;
+			while (*text == '\r' || *text == '\n') text++;
+		} else {
+			text = texts[i];
+		}
+
+		tlen = strlen(text);
+		memcpy(body + pos, text, tlen);
+		pos += tlen;
+		if (!tlen || text[tlen - 1] != '\n') {
+			body[pos++] = '\n';
+		}
+	}
+
+	pos += switch_snprintf(body + pos, len + 1 - pos, "</cdrs>\n");
+	body[pos] = '\0';
+
+	return body;
+}
+
+static void batch_curl_setup(switch_CURL *curl_handle)
+{
+	if (!zstr(globals.cred)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_HTTPAUTH, globals.auth_scheme);
+		switch_curl_easy_setopt(curl_handle, CURLOPT_USERPWD, globals.cred);
+	}
+
+	switch_curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "freeswitch-xml/1.0");
+
+	if (!zstr(globals.ssl_cert_file)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_SSLCERT, globals.ssl_cert_file);
+	}
+
+	if (!zstr(globals.ssl_key_file)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_SSLKEY, globals.ssl_key_file);
+	}
+
+	if (!zstr(globals.ssl_key_password)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_SSLKEYPASSWD, globals.ssl_key_password);
+	}
+
+	if (globals.cookie_file) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_COOKIEJAR, globals.cookie_file);
+		switch_curl_easy_setopt(curl_handle, CURLOPT_COOKIEFILE, globals.cookie_file);
+	}
+
+	if (!zstr(globals.ssl_version)) {
+		if (!strcasecmp(globals.ssl_version, "SSLv3")) {
+			switch_curl_easy_setopt(curl_handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_SSLv3);
+		} else if (!strcasecmp(globals.ssl_version, "TLSv1")) {
+			switch_curl_easy_setopt(curl_handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1);
+		}
+	}
+
+	if (!zstr(globals.ssl_cacert_file)) {
+		switch_curl_easy_setopt(curl_handle, CURLOPT_CAINFO, globals.ssl_cacert_file);
+	}
+
+	/* only looked at for https urls */
+	switch_curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYPEER, globals.enable_cacert_check ? 1 : 0);
+	switch_curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYHOST, globals.enable_ssl_verifyhost ? 2 : 0);
+
+	switch_curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT, globals.timeout);
+	switch_curl_easy_setopt(curl_handle, CURLOPT_CONNECTTIMEOUT, !globals.delay ? 5 : (long)globals.delay);
+}
+
+static const cdr_batch_ops_t batch_ops = {
+	/*.suffix */ ".cdr.xml",
+	/*.content_type */ "Content-Type: text/xml",
+	/*.body */ batch_body,
+	/*.item_text */ cdr_item_text,
+	/*.item_filename */ cdr_item_filename,
+	/*.item_destroy */ cdr_item_destroy,
+	/*.item_prepare */ NULL,
+	/*.item_lost */ NULL,
+	/*.curl_setup */ batch_curl_setup
+};
+
+SWITCH_STANDARD_API(xml_cdr_api_function)
+{
+	if (zstr(cmd) || strcasecmp(cmd, "status")) {
+		stream->write_function(stream, "-USAGE: status\n");
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	if (!globals.batch) {
+		stream->write_function(stream, "batch mode disabled\n");
+		return SWITCH_STATUS_SUCCESS;
+	}
+
+	cdr_batch_status(globals.batch, stream);
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
 static switch_status_t my_on_reporting(switch_core_session_t *session)
 {
 	switch_xml_t cdr = NULL;
@@ -267,6 +413,19 @@ static switch_status_t my_on_reporting(switch_core_session_t *session)
 		switch_thread_rwlock_unlock(globals.log_path_lock);
 	}
 
+	if (globals.batch) {
+		xml_cdr_item_t *item = malloc(sizeof(*item));
+
+		switch_assert(item);
+		item->xml_text = xml_text;
+		item->filename = switch_mprintf("%s%s.cdr.xml", a_prefix, switch_core_session_get_uuid(session));
+		xml_text = NULL;
+
+		cdr_batch_push(globals.batch, item);
+
+		goto success;
+	}
+
 	/* try to post it to the web server */
 	if (globals.url_count) {
 		char *destUrl = NULL;
@@ -490,6 +649,7 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_xml_cdr_load)
 	char *cf = "xml_cdr.conf";
 	switch_xml_t cfg, xml, settings, param;
 	switch_status_t status = SWITCH_STATUS_SUCCESS;
+	switch_api_interface_t *api_interface;
 
 	/* test global state handlers */
 	switch_core_add_state_handler(&state_handlers);
@@ -509,6 +669,7 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_xml_cdr_load)
 	globals.disable100continue = 0;
 	globals.pool = pool;
 	globals.auth_scheme = CURLAUTH_BASIC;
+	cdr_batch_settings_init(&globals.batch_settings);
 
 	switch_thread_rwlock_create(&globals.log_path_lock, pool);
 	switch_mutex_init(&globals.url_index_mutex, SWITCH_MUTEX_NESTED, globals.pool);
@@ -616,6 +777,8 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_xml_cdr_load)
 				} else if (!strcasecmp(val, "any")) {
 					globals.auth_scheme = (long)CURLAUTH_ANY;
 				}
+			} else if (cdr_batch_set_param(&globals.batch_settings, var, val, globals.pool)) {
+				/* batch-size, batch-timeout, batch-workers, batch-queue-capacity, max-backoff, spool-dir */
 			} else if (!strcasecmp(var, "cookie-file")) {
 				globals.cookie_file = switch_core_strdup(globals.pool, val);
 			}
@@ -640,6 +803,25 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_xml_cdr_load)
 
 	set_xml_cdr_log_dirs();
 
+	if (globals.batch_settings.size && !globals.url_count) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "batch-size set without any url, batch mode disabled\n");
+		globals.batch_settings.size = 0;
+	}
+
+	if (globals.batch_settings.size) {
+		if (!globals.batch_settings.spool_dir) {
+			globals.batch_settings.spool_dir = switch_core_sprintf(globals.pool, "%s%sspool", globals.base_err_log_dir, SWITCH_PATH_SEPARATOR);
+		}
+		globals.batch_settings.urls = globals.urls;
+		globals.batch_settings.url_count = globals.url_count;
+		globals.batch_settings.delay = globals.delay;
+		globals.batch_settings.disable100continue = globals.disable100continue;
+
+		cdr_batch_create(&globals.batch, &globals.batch_settings, &batch_ops, globals.pool);
+	}
+
+	SWITCH_ADD_API(api_interface, "xml_cdr", "xml_cdr status", xml_cdr_api_function, "status");
+
 	switch_xml_free(xml);
 
 	return status;
@@ -650,6 +832,8 @@ SWITCH_MODULE_SHUTDOWN_FUNCTION(mod_xml_cdr_shutdown)
 
 	globals.shutdown = 1;
 
+	cdr_batch_destroy(&globals.batch);
+
 	switch_safe_free(globals.log_dir);
 	switch_safe_free(globals.err_log_dir);
 
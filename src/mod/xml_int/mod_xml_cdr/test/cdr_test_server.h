@@ -0,0 +1,347 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * cdr_test_server.h -- loopback HTTP stand-in for the batch tests of mod_xml_cdr and mod_json_cdr
+ *
+ * Answers every POST with 200 and keeps the request target, content type, X-CDR-Count and body
+ * of each request. Stopping it closes the listener so posts fail the way they do against a
+ * server that went away.
+ *
+ */
+#ifndef CDR_TEST_SERVER_H
+#define CDR_TEST_SERVER_H
+
+#include <switch.h>
+
+#define CDR_TEST_MAX_REQUESTS 64
+#define CDR_TEST_MAX_REQUEST (4 * 1024 * 1024)
+
+typedef struct {
+	char *target;
+	char *content_type;
+	char *body;
+	int count;
+} cdr_test_request_t;
+
+typedef struct {
+	switch_memory_pool_t *pool;
+	switch_port_t port;
+	switch_socket_t *listener;
+	switch_thread_t *thread;
+	switch_mutex_t *mutex;
+	volatile int running;
+	uint32_t requests;
+	uint32_t cdrs;
+	cdr_test_request_t request[CDR_TEST_MAX_REQUESTS];
+} cdr_test_server_t;
+
+static const char *cdr_test_header(const char *headers, const char *name)
+{
+	switch_size_t nlen = strlen(name);
+	const char *p = strstr(headers, "\r\n");
+
+	while (p && p[2] != '\r') {
+		p += 2;
+		if (!strncasecmp(p, name, nlen) && p[nlen] == ':') {
+			p += nlen + 1;
+			while (*p == ' ') p++;
+			return p;
+		}
+		p = strstr(p, "\r\n");
+	}
+
+	return NULL;
+}
+
+static char *cdr_test_header_dup(const char *headers, const char *name)
+{
+	const char *v = cdr_test_header(headers, name);
+
+	return v ? switch_mprintf("%.*s", (int) strcspn(v, "\r\n"), v) : NULL;
+}
+
+static void cdr_test_serve(cdr_test_server_t *srv, switch_socket_t *sock)
+{
+	char *buf = malloc(CDR_TEST_MAX_REQUEST + 1);
+	const char *reply = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+	switch_size_t got = 0, len, head_len = 0, body_len = 0;
+	const char *v;
+	char *end;
+	int continued = 0;
+
+	switch_assert(buf);
+
+	while (got < CDR_TEST_MAX_REQUEST) {
+		len = CDR_TEST_MAX_REQUEST - got;
+		if (switch_socket_recv(sock, buf + got, &len) != SWITCH_STATUS_SUCCESS || !len) {
+			goto done;
+		}
+		got += len;
+		buf[got] = '\0';
+
+		if (!head_len) {
+			if (!(end = strstr(buf, "\r\n\r\n"))) {
+				continue;
+			}
+			head_len = end - buf + 4;
+			if ((v = cdr_test_header(buf, "Content-Length"))) {
+				body_len = strtoul(v, NULL, 10);
+			}
+		}
+
+		if (got >= head_len + body_len) {
+			break;
+		}
+
+		if (!continued && (v = cdr_test_header(buf, "Expect")) && !strncasecmp(v, "100-continue", 12)) {
+			const char *cont = "HTTP/1.1 100 Continue\r\n\r\n";
+
+			len = strlen(cont);
+			switch_socket_send(sock, cont, &len);
+			continued = 1;
+		}
+	}
+
+	if (!head_len || got < head_len + body_len) {
+		goto done;
+	}
+
+	switch_mutex_lock(srv->mutex);
+	if (srv->requests < CDR_TEST_MAX_REQUESTS) {
+		cdr_test_request_t *req = &srv->request[srv->requests];
+		char *count;
+
+		req->target = switch_mprintf("%.*s", (int) strcspn(buf + 5, " "), buf + 5);
+		req->content_type = cdr_test_header_dup(buf, "Content-Type");
+		req->body = switch_mprintf("%.*s", (int) body_len, buf + head_len);
+		req->count = -1;
+		if ((count = cdr_test_header_dup(buf, "X-CDR-Count"))) {
+			req->count = atoi(count);
+			free(count);
+		}
+		if (req->count > 0) {
+			srv->cdrs += req->count;
+		}
+		srv->requests++;
+	}
+	switch_mutex_unlock(srv->mutex);
+
+	len = strlen(reply);
+	switch_socket_send(sock, reply, &len);
+
+  done:
+
+	free(buf);
+}
+
+static void *SWITCH_THREAD_FUNC cdr_test_server_thread(switch_thread_t *thread, void *obj)
+{
+	cdr_test_server_t *srv = (cdr_test_server_t *) obj;
+
+	while (srv->running) {
+		switch_socket_t *sock = NULL;
+		switch_memory_pool_t *pool = NULL;
+
+		if (switch_wait_sock(switch_socket_fd_get(srv->listener), 100, SWITCH_POLL_READ) <= 0) {
+			continue;
+		}
+
+		switch_core_new_memory_pool(&pool);
+
+		if (switch_socket_accept(&sock, srv->listener, pool) == SWITCH_STATUS_SUCCESS) {
+			switch_socket_timeout_set(sock, 2000000);
+			cdr_test_serve(srv, sock);
+			switch_socket_shutdown(sock, SWITCH_SHUTDOWN_READWRITE);
+			switch_socket_close(sock);
+		}
+
+		switch_core_destroy_memory_pool(&pool);
+	}
+
+	return NULL;
+}
+
+static switch_status_t cdr_test_server_start(cdr_test_server_t *srv, switch_port_t port)
+{
+	switch_sockaddr_t *sa;
+	switch_threadattr_t *thd_attr;
+
+	if (!srv->pool) {
+		switch_core_new_memory_pool(&srv->pool);
+		switch_mutex_init(&srv->mutex, SWITCH_MUTEX_NESTED, srv->pool);
+	}
+
+	srv->port = port;
+
+	if (switch_sockaddr_info_get(&sa, "127.0.0.1", SWITCH_UNSPEC, port, 0, srv->pool) != SWITCH_STATUS_SUCCESS ||
+		switch_socket_create(&srv->listener, switch_sockaddr_get_family(sa), SOCK_STREAM, SWITCH_PROTO_TCP, srv->pool) != SWITCH_STATUS_SUCCESS) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	switch_socket_opt_set(srv->listener, SWITCH_SO_REUSEADDR, 1);
+	switch_socket_opt_set(srv->listener, SWITCH_SO_NONBLOCK, TRUE);
+
+	if (switch_socket_bind(srv->listener, sa) != SWITCH_STATUS_SUCCESS || switch_socket_listen(srv->listener, 16) != SWITCH_STATUS_SUCCESS) {
+		switch_socket_close(srv->listener);
+		srv->listener = NULL;
+		return SWITCH_STATUS_FALSE;
+	}
+
+	srv->running = 1;
+	switch_threadattr_create(&thd_attr, srv->pool);
+	switch_thread_create(&srv->thread, thd_attr, cdr_test_server_thread, srv, srv->pool);
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+/* close the listener, connections are refused until the next start */
+static void cdr_test_server_stop(cdr_test_server_t *srv)
+{
+	switch_status_t st;
+
+	if (!srv->running) {
+		return;
+	}
+
+	srv->running = 0;
+	switch_thread_join(&st, srv->thread);
+	switch_socket_close(srv->listener);
+	srv->listener = NULL;
+}
+
+static void cdr_test_server_reset(cdr_test_server_t *srv)
+{
+	uint32_t i;
+
+	switch_mutex_lock(srv->mutex);
+	for (i = 0; i < srv->requests; i++) {
+		switch_safe_free(srv->request[i].target);
+		switch_safe_free(srv->request[i].content_type);
+		switch_safe_free(srv->request[i].body);
+	}
+	srv->requests = 0;
+	srv->cdrs = 0;
+	switch_mutex_unlock(srv->mutex);
+}
+
+static void cdr_test_server_destroy(cdr_test_server_t *srv)
+{
+	cdr_test_server_stop(srv);
+	if (srv->pool) {
+		cdr_test_server_reset(srv);
+		switch_core_destroy_memory_pool(&srv->pool);
+	}
+}
+
+/* wait up to ms for the server to have seen at least cdrs CDRs */
+static uint32_t cdr_test_server_wait(cdr_test_server_t *srv, uint32_t cdrs, uint32_t ms)
+{
+	switch_time_t deadline = switch_micro_time_now() + (switch_time_t) ms * 1000;
+
+	while (srv->cdrs < cdrs && switch_micro_time_now() < deadline) {
+		switch_yield(50000);
+	}
+
+	return srv->cdrs;
+}
+
+/* number of files in dir ending in suffix */
+static int cdr_test_count_files(const char *dir_path, const char *suffix, switch_bool_t remove)
+{
+	switch_memory_pool_t *pool = NULL;
+	switch_dir_t *dir = NULL;
+	char fname_buf[512];
+	const char *fname;
+	switch_size_t slen = strlen(suffix);
+	int count = 0;
+
+	switch_core_new_memory_pool(&pool);
+
+	if (switch_dir_open(&dir, dir_path, pool) == SWITCH_STATUS_SUCCESS) {
+		while ((fname = switch_dir_next_file(dir, fname_buf, sizeof(fname_buf)))) {
+			switch_size_t flen = strlen(fname);
+
+			if (flen > slen && !strcmp(fname + flen - slen, suffix)) {
+				count++;
+				if (remove) {
+					char *path = switch_mprintf("%s%s%s", dir_path, SWITCH_PATH_SEPARATOR, fname);
+					unlink(path);
+					free(path);
+				}
+			}
+		}
+		switch_dir_close(dir);
+	}
+
+	switch_core_destroy_memory_pool(&pool);
+
+	return count;
+}
+
+/* wait up to ms for dir to hold at least count files ending in suffix */
+static int cdr_test_wait_files(const char *dir_path, const char *suffix, int count, uint32_t ms)
+{
+	switch_time_t deadline = switch_micro_time_now() + (switch_time_t) ms * 1000;
+	int n;
+
+	while ((n = cdr_test_count_files(dir_path, suffix, SWITCH_FALSE)) < count && switch_micro_time_now() < deadline) {
+		switch_yield(50000);
+	}
+
+	return n;
+}
+
+/* originate and hang up count null channels, each one reports a CDR */
+static int cdr_test_make_cdrs(int count)
+{
+	int i, made = 0;
+
+	for (i = 0; i < count; i++) {
+		switch_core_session_t *session = NULL;
+		switch_call_cause_t cause = SWITCH_CAUSE_NORMAL_CLEARING;
+
+		if (switch_ivr_originate(NULL, &session, &cause, "null/+15553334444", 2, NULL, NULL, NULL, NULL, NULL, SOF_NONE, NULL, NULL) == SWITCH_STATUS_SUCCESS && session) {
+			switch_channel_hangup(switch_core_session_get_channel(session), SWITCH_CAUSE_NORMAL_CLEARING);
+			switch_core_session_rwunlock(session);
+			made++;
+		}
+	}
+
+	return made;
+}
+
+#endif
+
+/* For Emacs:
+ * Local Variables:
+ * mode:c
+ * indent-tabs-mode:t
+ * tab-width:4
+ * c-basic-offset:4
+ * End:
+ * For VIM:
+ * vim:set softtabstop=4 shiftwidth=4 tabstop=4 noet:
+ */
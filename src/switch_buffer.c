@@ -407,6 +407,157 @@ SWITCH_DECLARE(void) switch_buffer_destroy(switch_buffer_t **buffer)
 	}
 }
 
+/* Single producer single consumer ring
+ *
+ * head and tail only ever grow, head - tail is what is in use.  The producer is the only one
+ * storing head and the consumer the only one storing tail, each publishes its index with release
+ * semantics after touching the data and reads the other one with acquire semantics before, so
+ * neither side needs a lock.  The two indexes live on their own cache lines.
+ */
+#define SPSC_CACHE_LINE 64
+
+#if defined(__GNUC__) || defined(__clang__)
+#define spsc_load(_p) __atomic_load_n(_p, __ATOMIC_ACQUIRE)
+#define spsc_store(_p, _v) __atomic_store_n(_p, _v, __ATOMIC_RELEASE)
+#else
+/* volatile accesses are acquire and release with msvc on x86 and x64 */
+#define spsc_load(_p) (*(volatile switch_size_t *) (_p))
+#define spsc_store(_p, _v) (*(volatile switch_size_t *) (_p) = (_v))
+#endif
+
+struct switch_spsc_buffer {
+	switch_byte_t *data;
+	switch_size_t size;
+	switch_size_t mask;
+	char pad0[SPSC_CACHE_LINE];
+	switch_size_t head;
+	char pad1[SPSC_CACHE_LINE - sizeof(switch_size_t)];
+	switch_size_t tail;
+	char pad2[SPSC_CACHE_LINE - sizeof(switch_size_t)];
+};
+
+SWITCH_DECLARE(switch_status_t) switch_spsc_buffer_create(switch_spsc_buffer_t **buffer, switch_size_t size)
+{
+	switch_spsc_buffer_t *new_buffer;
+	switch_size_t len = 1;
+
+	while (len < size) {
+		len <<= 1;
+	}
+
+	if (!size || !len || !(new_buffer = calloc(1, sizeof(*new_buffer)))) {
+		return SWITCH_STATUS_MEMERR;
+	}
+
+	if (!(new_buffer->data = malloc(len))) {
+		free(new_buffer);
+		return SWITCH_STATUS_MEMERR;
+	}
+
+	new_buffer->size = len;
+	new_buffer->mask = len - 1;
+	*buffer = new_buffer;
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+SWITCH_DECLARE(void) switch_spsc_buffer_destroy(switch_spsc_buffer_t **buffer)
+{
+	if (buffer && *buffer) {
+		switch_safe_free((*buffer)->data);
+		free(*buffer);
+		*buffer = NULL;
+	}
+}
+
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_len(switch_spsc_buffer_t *buffer)
+{
+	return buffer->size;
+}
+
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_inuse(switch_spsc_buffer_t *buffer)
+{
+	return spsc_load(&buffer->head) - spsc_load(&buffer->tail);
+}
+
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_freespace(switch_spsc_buffer_t *buffer)
+{
+	return buffer->size - (spsc_load(&buffer->head) - spsc_load(&buffer->tail));
+}
+
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_write(switch_spsc_buffer_t *buffer, const void *data, switch_size_t datalen)
+{
+	switch_size_t head = buffer->head, off, first;
+
+	if (!datalen || buffer->size - (head - spsc_load(&buffer->tail)) < datalen) {
+		return 0;
+	}
+
+	off = head & buffer->mask;
+	first = buffer->size - off;
+
+	if (first > datalen) {
+		first = datalen;
+	}
+
+	if (data) {
+		memcpy(buffer->data + off, data, first);
+		memcpy(buffer->data, (const switch_byte_t *) data + first, datalen - first);
+	} else {
+		memset(buffer->data + off, 0, first);
+		memset(buffer->data, 0, datalen - first);
+	}
+
+	spsc_store(&buffer->head, head + datalen);
+
+	return datalen;
+}
+
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_read(switch_spsc_buffer_t *buffer, void *data, switch_size_t datalen)
+{
+	switch_size_t tail = buffer->tail, used = spsc_load(&buffer->head) - tail, off, first;
+
+	if (datalen > used) {
+		datalen = used;
+	}
+
+	if (!datalen) {
+		return 0;
+	}
+
+	off = tail & buffer->mask;
+	first = buffer->size - off;
+
+	if (first > datalen) {
+		first = datalen;
+	}
+
+	memcpy(data, buffer->data + off, first);
+	memcpy((switch_byte_t *) data + first, buffer->data, datalen - first);
+
+	spsc_store(&buffer->tail, tail + datalen);
+
+	return datalen;
+}
+
+SWITCH_DECLARE(switch_size_t) switch_spsc_buffer_toss(switch_spsc_buffer_t *buffer, switch_size_t datalen)
+{
+	switch_size_t tail = buffer->tail, used = spsc_load(&buffer->head) - tail;
+
+	if (datalen > used) {
+		return 0;
+	}
+
+	spsc_store(&buffer->tail, tail + datalen);
+
+	return used - datalen;
+}
+
+SWITCH_DECLARE(void) switch_spsc_buffer_zero(switch_spsc_buffer_t *buffer)
+{
+	spsc_store(&buffer->tail, spsc_load(&buffer->head));
+}
+
 /* For Emacs:
  * Local Variables:
  * mode:c
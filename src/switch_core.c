@@ -1962,6 +1962,11 @@ SWITCH_DECLARE(switch_status_t) switch_core_init(switch_core_flag_t flags, switc
 	}
 
 	switch_log_init(runtime.memory_pool, runtime.colorize_console);
+	switch_core_file_cache_init(runtime.memory_pool);
+	switch_core_speech_cache_init(runtime.memory_pool);
+	switch_core_image_cache_init(runtime.memory_pool);
+	switch_core_video_band_init();
+	switch_resample_pool_init(runtime.memory_pool);
 
 	runtime.tipping_point = 0;
 	runtime.timer_affinity = -1;
@@ -2085,6 +2090,12 @@ static void switch_load_core_config(const char *file)
 		}
 
 		if ((settings = switch_xml_child(cfg, "settings"))) {
+			switch_size_t file_cache_size = 0, file_cache_max_file_size = 0;
+			int file_cache_set = 0;
+			switch_size_t tts_cache_size = 0;
+			const char *tts_cache_dir = NULL;
+			int tts_cache_set = 0;
+
 			for (param = switch_xml_child(settings, "param"); param; param = param->next) {
 				const char *var = switch_xml_attr_soft(param, "name");
 				const char *val = switch_xml_attr_soft(param, "value");
@@ -2378,8 +2389,46 @@ static void switch_load_core_config(const char *file)
 					}
 				} else if (!strcasecmp(var, "max-audio-channels") && !zstr(val)) {
 					switch_core_max_audio_channels(atoi(val));
+				} else if (!strcasecmp(var, "file-cache-size") && !zstr(val)) {
+					int tmp = atoi(val);
+					if (tmp >= 0) {
+						file_cache_size = (switch_size_t) tmp * 1024 * 1024;
+						file_cache_set = 1;
+					}
+				} else if (!strcasecmp(var, "file-cache-max-file-size") && !zstr(val)) {
+					int tmp = atoi(val);
+					if (tmp >= 0) {
+						file_cache_max_file_size = (switch_size_t) tmp * 1024;
+						file_cache_set = 1;
+					}
+				} else if (!strcasecmp(var, "tts-cache-size") && !zstr(val)) {
+					int tmp = atoi(val);
+					if (tmp >= 0) {
+						tts_cache_size = (switch_size_t) tmp * 1024 * 1024;
+						tts_cache_set = 1;
+					}
+				} else if (!strcasecmp(var, "tts-cache-dir")) {
+					tts_cache_dir = val;
+					tts_cache_set = 1;
+				} else if (!strcasecmp(var, "image-cache-size") && !zstr(val)) {
+					int tmp = atoi(val);
+					if (tmp >= 0) {
+						switch_img_cache_configure((switch_size_t) tmp * 1024 * 1024);
+					}
+				} else if (!strcasecmp(var, "video-band-threads") && !zstr(val)) {
+					switch_img_set_band_threads(atoi(val));
+				} else if (!strcasecmp(var, "resample-fast-ratios") && !zstr(val)) {
+					switch_resample_set_fast_ratios(switch_true(val) ? SWITCH_TRUE : SWITCH_FALSE);
 				}
 			}
+
+			if (file_cache_set) {
+				switch_core_file_cache_configure(file_cache_size, file_cache_max_file_size);
+			}
+
+			if (tts_cache_set) {
+				switch_core_speech_cache_configure(tts_cache_size, tts_cache_dir);
+			}
 		}
 
 		if (runtime.event_channel_key_separator == NULL) {
@@ -3058,6 +3107,11 @@ SWITCH_DECLARE(switch_status_t) switch_core_destroy(void)
 	switch_log_shutdown();
 
 	switch_core_session_uninit();
+	switch_core_file_cache_destroy();
+	switch_core_speech_cache_destroy();
+	switch_core_image_cache_destroy();
+	switch_core_video_band_destroy();
+	switch_resample_pool_destroy();
 	switch_core_unset_variables();
 	switch_core_memory_stop();
 
@@ -62,6 +62,466 @@ static switch_status_t get_file_size(switch_file_handle_t *fh, const char **stri
 	return status;
 }
 
+/* Decoded audio cache
+ *
+ * Prompts played over and over (IVR menus, conference sounds, hold music) would otherwise be
+ * opened, decoded, muxed and resampled by the format module for every call.  When enabled,
+ * the first full read of an eligible local file captures the PCM the core hands back to the
+ * caller and later opens with the same path, mtime, rate and channels are served from memory.
+ */
+
+typedef struct file_cache_entry_s {
+	char *key;
+	int16_t *data;
+	switch_size_t samples;
+	switch_size_t bytes;
+	uint32_t rate;
+	uint32_t channels;
+	uint32_t refs;
+	uint8_t dead;
+	uint64_t hits;
+	struct file_cache_entry_s *prev;
+	struct file_cache_entry_s *next;
+} file_cache_entry_t;
+
+struct switch_file_cache_fill_s {
+	char *key;
+	int16_t *data;
+	switch_size_t samples;
+	switch_size_t alloced;
+	uint32_t rate;
+	uint32_t channels;
+};
+
+typedef struct file_cache_reader_s {
+	file_cache_entry_t *entry;
+	switch_size_t pos;
+} file_cache_reader_t;
+
+static struct {
+	switch_memory_pool_t *pool;
+	switch_mutex_t *mutex;
+	switch_hash_t *hash;
+	file_cache_entry_t *head;
+	file_cache_entry_t *tail;
+	switch_file_interface_t *file_interface;
+	switch_size_t max_bytes;
+	switch_size_t max_file_bytes;
+	switch_size_t bytes;
+	uint32_t entries;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t inserts;
+	uint64_t evictions;
+	uint64_t rejects;
+} file_cache;
+
+static void file_cache_entry_free(file_cache_entry_t *entry)
+{
+	switch_safe_free(entry->data);
+	switch_safe_free(entry->key);
+	free(entry);
+}
+
+/* must be called with file_cache.mutex held */
+static void file_cache_unlink(file_cache_entry_t *entry)
+{
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	} else {
+		file_cache.head = entry->next;
+	}
+
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	} else {
+		file_cache.tail = entry->prev;
+	}
+
+	entry->prev = entry->next = NULL;
+	switch_core_hash_delete(file_cache.hash, entry->key);
+	file_cache.bytes -= entry->bytes;
+	file_cache.entries--;
+	entry->dead = 1;
+}
+
+/* must be called with file_cache.mutex held */
+static void file_cache_evict(switch_size_t need)
+{
+	file_cache_entry_t *entry = file_cache.tail, *prev;
+
+	while (entry && file_cache.bytes + need > file_cache.max_bytes) {
+		prev = entry->prev;
+
+		if (!entry->refs) {
+			file_cache_unlink(entry);
+			file_cache_entry_free(entry);
+			file_cache.evictions++;
+		}
+
+		entry = prev;
+	}
+}
+
+static void file_cache_release(file_cache_entry_t *entry)
+{
+	uint8_t destroy = 0;
+
+	switch_mutex_lock(file_cache.mutex);
+	if (!--entry->refs && entry->dead) {
+		destroy = 1;
+	}
+	switch_mutex_unlock(file_cache.mutex);
+
+	if (destroy) {
+		file_cache_entry_free(entry);
+	}
+}
+
+static char *file_cache_key(const char *path, uint32_t rate, uint32_t channels)
+{
+	struct stat st;
+
+	if (stat(path, &st) || (st.st_mode & S_IFMT) != S_IFREG) {
+		return NULL;
+	}
+
+	return switch_mprintf("%s|%" SWITCH_INT64_T_FMT "|%" SWITCH_INT64_T_FMT "|%u|%u",
+						  path, (int64_t) st.st_mtime, (int64_t) st.st_size, rate, channels);
+}
+
+static file_cache_entry_t *file_cache_lookup(const char *key)
+{
+	file_cache_entry_t *entry;
+
+	switch_mutex_lock(file_cache.mutex);
+
+	if ((entry = switch_core_hash_find(file_cache.hash, key))) {
+		/* move to the front of the LRU list */
+		if (entry->prev) {
+			entry->prev->next = entry->next;
+
+			if (entry->next) {
+				entry->next->prev = entry->prev;
+			} else {
+				file_cache.tail = entry->prev;
+			}
+
+			entry->prev = NULL;
+			entry->next = file_cache.head;
+			file_cache.head->prev = entry;
+			file_cache.head = entry;
+		}
+
+		entry->refs++;
+		entry->hits++;
+		file_cache.hits++;
+	} else {
+		file_cache.misses++;
+	}
+
+	switch_mutex_unlock(file_cache.mutex);
+
+	return entry;
+}
+
+static void file_cache_fill_destroy(switch_file_handle_t *fh)
+{
+	struct switch_file_cache_fill_s *fill = fh->cache_fill;
+
+	if (fill) {
+		fh->cache_fill = NULL;
+		switch_safe_free(fill->data);
+		switch_safe_free(fill->key);
+		free(fill);
+	}
+}
+
+static void file_cache_fill_append(switch_file_handle_t *fh, const void *data, switch_size_t samples)
+{
+	struct switch_file_cache_fill_s *fill = fh->cache_fill;
+	switch_size_t need = (fill->samples + samples) * fill->channels;
+
+	if (need * sizeof(int16_t) > file_cache.max_file_bytes || fh->channels != fill->channels || fh->samplerate != fill->rate) {
+		switch_mutex_lock(file_cache.mutex);
+		file_cache.rejects++;
+		switch_mutex_unlock(file_cache.mutex);
+		file_cache_fill_destroy(fh);
+		return;
+	}
+
+	if (need > fill->alloced) {
+		switch_size_t len = fill->alloced ? fill->alloced : fill->rate * fill->channels;
+		void *mem;
+
+		while (len < need) {
+			len *= 2;
+		}
+
+		if (!(mem = realloc(fill->data, len * sizeof(int16_t)))) {
+			file_cache_fill_destroy(fh);
+			return;
+		}
+
+		fill->data = mem;
+		fill->alloced = len;
+	}
+
+	memcpy(fill->data + (fill->samples * fill->channels), data, samples * fill->channels * sizeof(int16_t));
+	fill->samples += samples;
+}
+
+static void file_cache_fill_finish(switch_file_handle_t *fh)
+{
+	struct switch_file_cache_fill_s *fill = fh->cache_fill;
+	file_cache_entry_t *entry;
+	switch_size_t bytes;
+
+	if (!fill->samples) {
+		file_cache_fill_destroy(fh);
+		return;
+	}
+
+	bytes = fill->samples * fill->channels * sizeof(int16_t);
+
+	switch_zmalloc(entry, sizeof(*entry));
+	entry->key = fill->key;
+	entry->data = fill->data;
+	entry->samples = fill->samples;
+	entry->bytes = bytes;
+	entry->rate = fill->rate;
+	entry->channels = fill->channels;
+
+	if (bytes < fill->alloced * sizeof(int16_t)) {
+		void *mem;
+
+		if ((mem = realloc(entry->data, bytes))) {
+			entry->data = mem;
+		}
+	}
+
+	fill->key = NULL;
+	fill->data = NULL;
+	file_cache_fill_destroy(fh);
+
+	switch_mutex_lock(file_cache.mutex);
+
+	if (bytes > file_cache.max_bytes || switch_core_hash_find(file_cache.hash, entry->key)) {
+		switch_mutex_unlock(file_cache.mutex);
+		file_cache_entry_free(entry);
+		return;
+	}
+
+	file_cache_evict(bytes);
+
+	if (file_cache.bytes + bytes > file_cache.max_bytes) {
+		/* everything left is in use */
+		file_cache.rejects++;
+		switch_mutex_unlock(file_cache.mutex);
+		file_cache_entry_free(entry);
+		return;
+	}
+
+	switch_core_hash_insert(file_cache.hash, entry->key, entry);
+	entry->next = file_cache.head;
+	if (file_cache.head) {
+		file_cache.head->prev = entry;
+	} else {
+		file_cache.tail = entry;
+	}
+	file_cache.head = entry;
+	file_cache.bytes += bytes;
+	file_cache.entries++;
+	file_cache.inserts++;
+
+	switch_mutex_unlock(file_cache.mutex);
+}
+
+static switch_status_t file_cache_file_open(switch_file_handle_t *fh, const char *path)
+{
+	/* handles are attached in switch_core_perform_file_open, never opened by name */
+	return SWITCH_STATUS_FALSE;
+}
+
+static switch_status_t file_cache_file_close(switch_file_handle_t *fh)
+{
+	file_cache_reader_t *reader = fh->private_info;
+
+	if (reader && reader->entry) {
+		file_cache_release(reader->entry);
+		reader->entry = NULL;
+	}
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+static switch_status_t file_cache_file_read(switch_file_handle_t *fh, void *data, switch_size_t *len)
+{
+	file_cache_reader_t *reader = fh->private_info;
+	file_cache_entry_t *entry = reader->entry;
+	switch_size_t want = *len;
+
+	if (reader->pos >= entry->samples) {
+		*len = 0;
+		return SWITCH_STATUS_FALSE;
+	}
+
+	if (want > entry->samples - reader->pos) {
+		want = entry->samples - reader->pos;
+	}
+
+	memcpy(data, entry->data + (reader->pos * entry->channels), want * entry->channels * sizeof(int16_t));
+	reader->pos += want;
+	fh->pos = reader->pos;
+	*len = want;
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+static switch_status_t file_cache_file_seek(switch_file_handle_t *fh, unsigned int *cur_sample, int64_t samples, int whence)
+{
+	file_cache_reader_t *reader = fh->private_info;
+	int64_t pos = samples;
+
+	if (whence == SEEK_CUR) {
+		pos += reader->pos;
+	} else if (whence == SEEK_END) {
+		pos += reader->entry->samples;
+	}
+
+	if (pos < 0) {
+		pos = 0;
+	} else if (pos > (int64_t) reader->entry->samples) {
+		pos = reader->entry->samples;
+	}
+
+	reader->pos = (switch_size_t) pos;
+	fh->pos = pos;
+	*cur_sample = (unsigned int) pos;
+
+	return SWITCH_STATUS_SUCCESS;
+}
+
+static void file_cache_attach(switch_file_handle_t *fh, file_cache_entry_t *entry)
+{
+	file_cache_reader_t *reader = switch_core_alloc(fh->memory_pool, sizeof(*reader));
+
+	reader->entry = entry;
+	fh->private_info = reader;
+	fh->samplerate = entry->rate;
+	fh->channels = entry->channels;
+	fh->samples = (unsigned int) entry->samples;
+	fh->sample_count = entry->samples;
+	fh->format = 0;
+	fh->sections = 0;
+	fh->seekable = 1;
+	fh->speed = 0;
+	fh->pos = 0;
+}
+
+static int file_cache_eligible(switch_file_handle_t *fh, unsigned int flags, int is_stream)
+{
+	if (!file_cache.mutex || !file_cache.max_bytes || is_stream || fh->params || fh->spool_path) {
+		return 0;
+	}
+
+	if (!(flags & SWITCH_FILE_FLAG_READ) || (flags & (SWITCH_FILE_FLAG_WRITE | SWITCH_FILE_NATIVE | SWITCH_FILE_NOMUX | SWITCH_FILE_FLAG_VIDEO |
+													  SWITCH_FILE_DATA_INT | SWITCH_FILE_DATA_FLOAT | SWITCH_FILE_DATA_DOUBLE |
+													  SWITCH_FILE_DATA_RAW))) {
+		return 0;
+	}
+
+	/* anything that can produce video is left alone */
+	return fh->file_interface && !fh->file_interface->file_read_video;
+}
+
+void switch_core_file_cache_init(switch_memory_pool_t *pool)
+{
+	switch_loadable_module_interface_t *module_interface;
+
+	memset(&file_cache, 0, sizeof(file_cache));
+	file_cache.pool = pool;
+	switch_mutex_init(&file_cache.mutex, SWITCH_MUTEX_NESTED, pool);
+	switch_core_hash_init(&file_cache.hash);
+
+	/* private interface, never registered, so the refcount and rwlock of a real one are available */
+	module_interface = switch_loadable_module_create_module_interface(pool, "core_file_cache");
+	file_cache.file_interface = switch_loadable_module_create_interface(module_interface, SWITCH_FILE_INTERFACE);
+	file_cache.file_interface->interface_name = "core_file_cache";
+	file_cache.file_interface->file_open = file_cache_file_open;
+	file_cache.file_interface->file_close = file_cache_file_close;
+	file_cache.file_interface->file_read = file_cache_file_read;
+	file_cache.file_interface->file_seek = file_cache_file_seek;
+}
+
+void switch_core_file_cache_destroy(void)
+{
+	if (!file_cache.mutex) {
+		return;
+	}
+
+	switch_core_file_cache_flush();
+	switch_core_hash_destroy(&file_cache.hash);
+	file_cache.mutex = NULL;
+}
+
+SWITCH_DECLARE(void) switch_core_file_cache_configure(switch_size_t max_bytes, switch_size_t max_file_bytes)
+{
+	if (!file_cache.mutex) {
+		return;
+	}
+
+	switch_mutex_lock(file_cache.mutex);
+	file_cache.max_bytes = max_bytes;
+	file_cache.max_file_bytes = max_file_bytes ? max_file_bytes : max_bytes;
+	file_cache_evict(0);
+	switch_mutex_unlock(file_cache.mutex);
+}
+
+SWITCH_DECLARE(void) switch_core_file_cache_flush(void)
+{
+	file_cache_entry_t *entry, *next;
+
+	if (!file_cache.mutex) {
+		return;
+	}
+
+	switch_mutex_lock(file_cache.mutex);
+
+	for (entry = file_cache.head; entry; entry = next) {
+		next = entry->next;
+		file_cache_unlink(entry);
+
+		/* entries still being played are freed by their last reader */
+		if (!entry->refs) {
+			file_cache_entry_free(entry);
+		}
+	}
+
+	switch_mutex_unlock(file_cache.mutex);
+}
+
+SWITCH_DECLARE(void) switch_core_file_cache_status(switch_stream_handle_t *stream)
+{
+	if (!file_cache.mutex) {
+		stream->write_function(stream, "file cache not initialized\n");
+		return;
+	}
+
+	switch_mutex_lock(file_cache.mutex);
+	stream->write_function(stream, "enabled: %s\n", file_cache.max_bytes ? "true" : "false");
+	stream->write_function(stream, "max-bytes: %" SWITCH_SIZE_T_FMT "\n", file_cache.max_bytes);
+	stream->write_function(stream, "max-file-bytes: %" SWITCH_SIZE_T_FMT "\n", file_cache.max_file_bytes);
+	stream->write_function(stream, "bytes: %" SWITCH_SIZE_T_FMT "\n", file_cache.bytes);
+	stream->write_function(stream, "entries: %u\n", file_cache.entries);
+	stream->write_function(stream, "hits: %" SWITCH_UINT64_T_FMT "\n", file_cache.hits);
+	stream->write_function(stream, "misses: %" SWITCH_UINT64_T_FMT "\n", file_cache.misses);
+	stream->write_function(stream, "inserts: %" SWITCH_UINT64_T_FMT "\n", file_cache.inserts);
+	stream->write_function(stream, "evictions: %" SWITCH_UINT64_T_FMT "\n", file_cache.evictions);
+	stream->write_function(stream, "rejects: %" SWITCH_UINT64_T_FMT "\n", file_cache.rejects);
+	switch_mutex_unlock(file_cache.mutex);
+}
+
 SWITCH_DECLARE(switch_status_t) switch_core_perform_file_open(const char *file, const char *func, int line,
 															  switch_file_handle_t *fh,
 															  const char *file_path,
@@ -77,6 +537,8 @@ SWITCH_DECLARE(switch_status_t) switch_core_perform_file_open(const char *file,
 	int to = 0;
 	int force_channels = 0;
 	uint32_t core_channel_limit;
+	char *cache_key = NULL;
+	file_cache_entry_t *cache_entry = NULL;
 
 	if (switch_test_flag(fh, SWITCH_FILE_OPEN)) {
 		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Handle already open\n");
@@ -84,6 +546,7 @@ SWITCH_DECLARE(switch_status_t) switch_core_perform_file_open(const char *file,
 	}
 
 	fh->samples_in = 0;
+	fh->cache_fill = NULL;
 
 	if (!(flags & SWITCH_FILE_FLAG_WRITE)) {
 		fh->samplerate = 0;
@@ -393,7 +856,19 @@ SWITCH_DECLARE(switch_status_t) switch_core_perform_file_open(const char *file,
 
 	file_path = fh->spool_path ? fh->spool_path : fh->file_path;
 
-	if ((status = fh->file_interface->file_open(fh, file_path)) != SWITCH_STATUS_SUCCESS) {
+	if (file_cache_eligible(fh, flags, is_stream) && (cache_key = file_cache_key(file_path, rate, channels))) {
+		cache_entry = file_cache_lookup(cache_key);
+	}
+
+	if (cache_entry) {
+		UNPROTECT_INTERFACE(fh->file_interface);
+		fh->file_interface = file_cache.file_interface;
+		PROTECT_INTERFACE(fh->file_interface);
+		file_cache_attach(fh, cache_entry);
+		switch_safe_free(cache_key);
+		status = SWITCH_STATUS_SUCCESS;
+	} else if ((status = fh->file_interface->file_open(fh, file_path)) != SWITCH_STATUS_SUCCESS) {
+		switch_safe_free(cache_key);
 		if (fh->spool_path) {
 			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Spool dir is set.  Make sure [%s] is also a valid path\n", fh->spool_path);
 		}
@@ -463,11 +938,27 @@ SWITCH_DECLARE(switch_status_t) switch_core_perform_file_open(const char *file,
 		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "File has %d channels, muxing to %d channel%s will occur.\n", fh->real_channels, fh->channels, fh->channels == 1 ? "" : "s");
 	}
 
+	if (cache_key) {
+		if (!switch_test_flag(fh, SWITCH_FILE_NATIVE)) {
+			struct switch_file_cache_fill_s *fill;
+
+			switch_zmalloc(fill, sizeof(*fill));
+			fill->key = cache_key;
+			fill->rate = fh->samplerate;
+			fill->channels = fh->channels;
+			fh->cache_fill = fill;
+		} else {
+			free(cache_key);
+		}
+	}
+
 	switch_set_flag_locked(fh, SWITCH_FILE_OPEN);
 	return status;
 
   fail:
 
+	switch_safe_free(cache_key);
+
 	switch_clear_flag_locked(fh, SWITCH_FILE_OPEN);
 
 	if (fh->params) {
@@ -484,7 +975,52 @@ SWITCH_DECLARE(switch_status_t) switch_core_perform_file_open(const char *file,
 	return status;
 }
 
-SWITCH_DECLARE(switch_status_t) switch_core_file_read(switch_file_handle_t *fh, void *data, switch_size_t *len)
+/* tops up the pre buffer with one read from the format module */
+static switch_status_t core_file_fill_pre_buffer(switch_file_handle_t *fh)
+{
+	switch_status_t status = SWITCH_STATUS_SUCCESS;
+	switch_size_t rlen;
+	int asis = switch_test_flag(fh, SWITCH_FILE_NATIVE);
+
+	if (!switch_test_flag(fh, SWITCH_FILE_BUFFER_DONE)) {
+		rlen = asis ? fh->pre_buffer_datalen : fh->pre_buffer_datalen / 2 / fh->real_channels;
+
+		if (switch_buffer_inuse(fh->pre_buffer) < rlen * 2 * fh->channels) {
+			if ((status = fh->file_interface->file_read(fh, fh->pre_buffer_data, &rlen)) == SWITCH_STATUS_BREAK) {
+				return SWITCH_STATUS_BREAK;
+			}
+
+
+			if (status != SWITCH_STATUS_SUCCESS || !rlen) {
+				switch_set_flag_locked(fh, SWITCH_FILE_BUFFER_DONE);
+			} else {
+				if (fh->real_channels != fh->channels && !switch_test_flag(fh, SWITCH_FILE_NOMUX)) {
+					switch_mux_channels((int16_t *) fh->pre_buffer_data, rlen, fh->real_channels, fh->channels);
+				}
+				switch_buffer_write(fh->pre_buffer, fh->pre_buffer_data, asis ? rlen : rlen * 2 * fh->channels);
+			}
+		}
+	}
+
+	return status;
+}
+
+SWITCH_DECLARE(switch_status_t) switch_core_file_read_ahead(switch_file_handle_t *fh)
+{
+	switch_assert(fh != NULL);
+
+	if (!switch_test_flag(fh, SWITCH_FILE_OPEN) || !switch_test_flag(fh, SWITCH_FILE_FLAG_READ) || !fh->pre_buffer) {
+		return SWITCH_STATUS_FALSE;
+	}
+
+	if (core_file_fill_pre_buffer(fh) == SWITCH_STATUS_BREAK) {
+		return SWITCH_STATUS_BREAK;
+	}
+
+	return switch_buffer_inuse(fh->pre_buffer) ? SWITCH_STATUS_SUCCESS : SWITCH_STATUS_FALSE;
+}
+
+static switch_status_t core_file_read(switch_file_handle_t *fh, void *data, switch_size_t *len)
 {
 	switch_status_t status = SWITCH_STATUS_FALSE;
 	switch_size_t want, orig_len = *len;
@@ -523,24 +1059,8 @@ SWITCH_DECLARE(switch_status_t) switch_core_file_read(switch_file_handle_t *fh,
 		switch_size_t rlen;
 		int asis = switch_test_flag(fh, SWITCH_FILE_NATIVE);
 
-		if (!switch_test_flag(fh, SWITCH_FILE_BUFFER_DONE)) {
-			rlen = asis ? fh->pre_buffer_datalen : fh->pre_buffer_datalen / 2 / fh->real_channels;
-
-			if (switch_buffer_inuse(fh->pre_buffer) < rlen * 2 * fh->channels) {
-				if ((status = fh->file_interface->file_read(fh, fh->pre_buffer_data, &rlen)) == SWITCH_STATUS_BREAK) {
-					return SWITCH_STATUS_BREAK;
-				}
-
-
-				if (status != SWITCH_STATUS_SUCCESS || !rlen) {
-					switch_set_flag_locked(fh, SWITCH_FILE_BUFFER_DONE);
-				} else {
-					if (fh->real_channels != fh->channels && !switch_test_flag(fh, SWITCH_FILE_NOMUX)) {
-						switch_mux_channels((int16_t *) fh->pre_buffer_data, rlen, fh->real_channels, fh->channels);
-					}
-					switch_buffer_write(fh->pre_buffer, fh->pre_buffer_data, asis ? rlen : rlen * 2 * fh->channels);
-				}
-			}
+		if ((status = core_file_fill_pre_buffer(fh)) == SWITCH_STATUS_BREAK) {
+			return SWITCH_STATUS_BREAK;
 		}
 
 		rlen = switch_buffer_read(fh->pre_buffer, data, asis ? *len : *len * 2 * fh->channels);
@@ -616,6 +1136,23 @@ SWITCH_DECLARE(switch_status_t) switch_core_file_read(switch_file_handle_t *fh,
 	return status;
 }
 
+SWITCH_DECLARE(switch_status_t) switch_core_file_read(switch_file_handle_t *fh, void *data, switch_size_t *len)
+{
+	switch_status_t status = core_file_read(fh, data, len);
+
+	if (fh->cache_fill) {
+		if (status == SWITCH_STATUS_SUCCESS && *len) {
+			file_cache_fill_append(fh, data, *len);
+		} else if (status == SWITCH_STATUS_FALSE && !*len && !(fh->max_samples > 0 && fh->samples_in >= (switch_size_t)fh->max_samples)) {
+			file_cache_fill_finish(fh);
+		} else {
+			file_cache_fill_destroy(fh);
+		}
+	}
+
+	return status;
+}
+
 SWITCH_DECLARE(switch_bool_t) switch_core_file_has_video(switch_file_handle_t *fh, switch_bool_t check_open)
 {
 	return ((!check_open || switch_test_flag(fh, SWITCH_FILE_OPEN)) && switch_test_flag(fh, SWITCH_FILE_FLAG_VIDEO)) ? SWITCH_TRUE : SWITCH_FALSE;
@@ -805,6 +1342,9 @@ SWITCH_DECLARE(switch_status_t) switch_core_file_seek(switch_file_handle_t *fh,
 		switch_buffer_zero(fh->pre_buffer);
 	}
 
+	/* a partial or reordered read is no good to the cache */
+	file_cache_fill_destroy(fh);
+
 	if (whence == SWITCH_SEEK_CUR) {
 		unsigned int cur = 0;
 
@@ -1001,6 +1541,7 @@ SWITCH_DECLARE(switch_status_t) switch_core_file_handle_dup(switch_file_handle_t
 	}
 
 	memcpy(fh, oldfh, sizeof(switch_file_handle_t));
+	fh->cache_fill = NULL;
 
 	if (!destroy_pool) {
 		switch_clear_flag(fh, SWITCH_FILE_FLAG_FREE_POOL);
@@ -1062,6 +1603,8 @@ SWITCH_DECLARE(switch_status_t) switch_core_file_close(switch_file_handle_t *fh)
 
 	fh->file_interface->file_close(fh);
 
+	file_cache_fill_destroy(fh);
+
 	if (fh->params) {
 		switch_event_destroy(&fh->params);
 	}
@@ -74,11 +74,11 @@ static void switch_core_media_bug_destroy(switch_media_bug_t **bug)
 	}
 
 	if (bp->raw_read_buffer) {
-		switch_buffer_destroy(&bp->raw_read_buffer);
+		switch_spsc_buffer_destroy(&bp->raw_read_buffer);
 	}
 
 	if (bp->raw_write_buffer) {
-		switch_buffer_destroy(&bp->raw_write_buffer);
+		switch_spsc_buffer_destroy(&bp->raw_write_buffer);
 	}
 
 	if (switch_event_create(&event, SWITCH_EVENT_MEDIA_BUG_STOP) == SWITCH_STATUS_SUCCESS) {
@@ -189,13 +189,13 @@ SWITCH_DECLARE(void) switch_core_media_bug_flush(switch_media_bug_t *bug)
 
 	if (bug->raw_read_buffer) {
 		switch_mutex_lock(bug->read_mutex);
-		switch_buffer_zero(bug->raw_read_buffer);
+		switch_spsc_buffer_zero(bug->raw_read_buffer);
 		switch_mutex_unlock(bug->read_mutex);
 	}
 
 	if (bug->raw_write_buffer) {
 		switch_mutex_lock(bug->write_mutex);
-		switch_buffer_zero(bug->raw_write_buffer);
+		switch_spsc_buffer_zero(bug->raw_write_buffer);
 		switch_mutex_unlock(bug->write_mutex);
 	}
 
@@ -207,7 +207,7 @@ SWITCH_DECLARE(void) switch_core_media_bug_inuse(switch_media_bug_t *bug, switch
 {
 	if (switch_test_flag(bug, SMBF_READ_STREAM)) {
 		switch_mutex_lock(bug->read_mutex);
-		*readp = bug->raw_read_buffer ? switch_buffer_inuse(bug->raw_read_buffer) : 0;
+		*readp = bug->raw_read_buffer ? switch_spsc_buffer_inuse(bug->raw_read_buffer) : 0;
 		switch_mutex_unlock(bug->read_mutex);
 	} else {
 		*readp = 0;
@@ -215,7 +215,7 @@ SWITCH_DECLARE(void) switch_core_media_bug_inuse(switch_media_bug_t *bug, switch
 
 	if (switch_test_flag(bug, SMBF_WRITE_STREAM)) {
 		switch_mutex_lock(bug->write_mutex);
-		*writep = bug->raw_write_buffer ? switch_buffer_inuse(bug->raw_write_buffer) : 0;
+		*writep = bug->raw_write_buffer ? switch_spsc_buffer_inuse(bug->raw_write_buffer) : 0;
 		switch_mutex_unlock(bug->write_mutex);
 	} else {
 		*writep = 0;
@@ -267,14 +267,14 @@ SWITCH_DECLARE(switch_status_t) switch_core_media_bug_read(switch_media_bug_t *b
 	if (switch_test_flag(bug, SMBF_READ_STREAM)) {
 		has_read = 1;
 		switch_mutex_lock(bug->read_mutex);
-		do_read = switch_buffer_inuse(bug->raw_read_buffer);
+		do_read = switch_spsc_buffer_inuse(bug->raw_read_buffer);
 		switch_mutex_unlock(bug->read_mutex);
 	}
 
 	if (switch_test_flag(bug, SMBF_WRITE_STREAM)) {
 		has_write = 1;
 		switch_mutex_lock(bug->write_mutex);
-		do_write = switch_buffer_inuse(bug->raw_write_buffer);
+		do_write = switch_spsc_buffer_inuse(bug->raw_write_buffer);
 		switch_mutex_unlock(bug->write_mutex);
 	}
 
@@ -293,8 +293,8 @@ SWITCH_DECLARE(switch_status_t) switch_core_media_bug_read(switch_media_bug_t *b
 
 	if (bug->record_frame_size && do_write > do_read && do_write > (bug->record_frame_size * 2)) {
 		switch_mutex_lock(bug->write_mutex);
-		switch_buffer_toss(bug->raw_write_buffer, bug->record_frame_size);
-		do_write = switch_buffer_inuse(bug->raw_write_buffer);
+		switch_spsc_buffer_toss(bug->raw_write_buffer, bug->record_frame_size);
+		do_write = switch_spsc_buffer_inuse(bug->raw_write_buffer);
 		switch_mutex_unlock(bug->write_mutex);
 	}
 
@@ -337,7 +337,7 @@ SWITCH_DECLARE(switch_status_t) switch_core_media_bug_read(switch_media_bug_t *b
 
 	if (do_read) {
 		switch_mutex_lock(bug->read_mutex);
-		frame->datalen = (uint32_t) switch_buffer_read(bug->raw_read_buffer, frame->data, do_read);
+		frame->datalen = (uint32_t) switch_spsc_buffer_read(bug->raw_read_buffer, frame->data, do_read);
 		if (frame->datalen != do_read) {
 			switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(switch_core_media_bug_get_session(bug)), SWITCH_LOG_ERROR, "Framing Error Reading!\n");
 			switch_core_media_bug_flush(bug);
@@ -353,7 +353,7 @@ SWITCH_DECLARE(switch_status_t) switch_core_media_bug_read(switch_media_bug_t *b
 	if (do_write) {
 		switch_assert(bug->raw_write_buffer);
 		switch_mutex_lock(bug->write_mutex);
-		datalen = (uint32_t) switch_buffer_read(bug->raw_write_buffer, bug->data, do_write);
+		datalen = (uint32_t) switch_spsc_buffer_read(bug->raw_write_buffer, bug->data, do_write);
 		if (datalen != do_write) {
 			switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(switch_core_media_bug_get_session(bug)), SWITCH_LOG_ERROR, "Framing Error Writing!\n");
 			switch_core_media_bug_flush(bug);
@@ -791,6 +791,8 @@ SWITCH_DECLARE(switch_status_t) switch_core_media_bug_push_spy_frame(switch_medi
 }
 
 #define MAX_BUG_BUFFER 1024 * 512
+/* the raw streams are fixed size rings with about two seconds of slack for a slow reader */
+#define BUG_BUFFER_LEN(_bytes) ((_bytes) * SWITCH_BUFFER_START_FRAMES * 2 < MAX_BUG_BUFFER ? (_bytes) * SWITCH_BUFFER_START_FRAMES * 2 : MAX_BUG_BUFFER)
 SWITCH_DECLARE(switch_status_t) switch_core_media_bug_add(switch_core_session_t *session,
 														  const char *function,
 														  const char *target,
@@ -899,14 +901,16 @@ SWITCH_DECLARE(switch_status_t) switch_core_media_bug_add(switch_core_session_t
 	}
 
 	if (switch_test_flag(bug, SMBF_READ_STREAM) || switch_test_flag(bug, SMBF_READ_PING)) {
-		switch_buffer_create_dynamic(&bug->raw_read_buffer, bytes * SWITCH_BUFFER_BLOCK_FRAMES, bytes * SWITCH_BUFFER_START_FRAMES, MAX_BUG_BUFFER);
+		switch_spsc_buffer_create(&bug->raw_read_buffer, BUG_BUFFER_LEN(bytes));
 		switch_mutex_init(&bug->read_mutex, SWITCH_MUTEX_NESTED, session->pool);
 	}
 
-	bytes = bug->write_impl.decoded_bytes_per_packet;
+	if (!(bytes = bug->write_impl.decoded_bytes_per_packet)) {
+		bytes = 320;
+	}
 
 	if (switch_test_flag(bug, SMBF_WRITE_STREAM)) {
-		switch_buffer_create_dynamic(&bug->raw_write_buffer, bytes * SWITCH_BUFFER_BLOCK_FRAMES, bytes * SWITCH_BUFFER_START_FRAMES, MAX_BUG_BUFFER);
+		switch_spsc_buffer_create(&bug->raw_write_buffer, BUG_BUFFER_LEN(bytes));
 		switch_mutex_init(&bug->write_mutex, SWITCH_MUTEX_NESTED, session->pool);
 	}
 
@@ -36,6 +36,619 @@
 #include <switch.h>
 #include "private/switch_core_pvt.h"
 
+/* Synthesized speech cache
+ *
+ * IVRs speak the same strings over and over.  When enabled, the audio a speech handle hands back
+ * for a text is kept under a key made of the engine, voice, rate, channels, parameters and text,
+ * and the next handle fed the same text is served from memory, or from the cache directory when
+ * one is configured, without touching the engine.  While a text is synthesized for the first time
+ * other handles fed the same text follow that synthesis instead of starting their own.
+ */
+
+#define SPEECH_CACHE_MAGIC "FSTTS1\n"
+/* a follower gives up on a synthesis that made no progress for this long */
+#define SPEECH_CACHE_STALL_USEC 5000000
+
+typedef struct speech_cache_entry_s {
+	char *key;
+	uint8_t *data;
+	switch_size_t bytes;
+	switch_size_t alloced;
+	uint32_t refs;
+	uint8_t done;
+	uint8_t failed;
+	uint8_t dead;
+	uint64_t hits;
+	struct speech_cache_entry_s *prev;
+	struct speech_cache_entry_s *next;
+} speech_cache_entry_t;
+
+struct switch_speech_cache_s {
+	char *voice;
+	switch_event_t *params;
+	char *text;
+	speech_cache_entry_t *entry;
+	switch_size_t pos;
+	switch_size_t skip;
+	uint8_t filling;
+	/* what the engine returned when it stopped, speech_read_tts turns every stop into a BREAK */
+	switch_status_t engine_status;
+};
+
+static struct {
+	switch_memory_pool_t *pool;
+	switch_mutex_t *mutex;
+	switch_thread_cond_t *cond;
+	switch_hash_t *hash;
+	switch_hash_t *fills;
+	speech_cache_entry_t *head;
+	speech_cache_entry_t *tail;
+	char *dir;
+	switch_size_t max_bytes;
+	switch_size_t bytes;
+	uint32_t entries;
+	uint64_t hits;
+	uint64_t disk_hits;
+	uint64_t misses;
+	uint64_t coalesced;
+	uint64_t inserts;
+	uint64_t evictions;
+	uint64_t rejects;
+} speech_cache;
+
+static void speech_cache_entry_free(speech_cache_entry_t *entry)
+{
+	switch_safe_free(entry->data);
+	switch_safe_free(entry->key);
+	free(entry);
+}
+
+/* must be called with speech_cache.mutex held */
+static void speech_cache_unlink(speech_cache_entry_t *entry)
+{
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	} else {
+		speech_cache.head = entry->next;
+	}
+
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	} else {
+		speech_cache.tail = entry->prev;
+	}
+
+	entry->prev = entry->next = NULL;
+	switch_core_hash_delete(speech_cache.hash, entry->key);
+	speech_cache.bytes -= entry->bytes;
+	speech_cache.entries--;
+	entry->dead = 1;
+}
+
+/* must be called with speech_cache.mutex held */
+static void speech_cache_evict(switch_size_t need)
+{
+	speech_cache_entry_t *entry = speech_cache.tail, *prev;
+
+	while (entry && speech_cache.bytes + need > speech_cache.max_bytes) {
+		prev = entry->prev;
+
+		if (!entry->refs) {
+			speech_cache_unlink(entry);
+			speech_cache_entry_free(entry);
+			speech_cache.evictions++;
+		}
+
+		entry = prev;
+	}
+}
+
+/* must be called with speech_cache.mutex held, returns 0 when the entry could not be stored */
+static int speech_cache_insert(speech_cache_entry_t *entry)
+{
+	if (entry->bytes > speech_cache.max_bytes || switch_core_hash_find(speech_cache.hash, entry->key)) {
+		return 0;
+	}
+
+	speech_cache_evict(entry->bytes);
+
+	if (speech_cache.bytes + entry->bytes > speech_cache.max_bytes) {
+		/* everything left is in use */
+		speech_cache.rejects++;
+		return 0;
+	}
+
+	switch_core_hash_insert(speech_cache.hash, entry->key, entry);
+	entry->next = speech_cache.head;
+	if (speech_cache.head) {
+		speech_cache.head->prev = entry;
+	} else {
+		speech_cache.tail = entry;
+	}
+	speech_cache.head = entry;
+	speech_cache.bytes += entry->bytes;
+	speech_cache.entries++;
+	speech_cache.inserts++;
+
+	return 1;
+}
+
+/* must be called with speech_cache.mutex held */
+static void speech_cache_touch(speech_cache_entry_t *entry)
+{
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+
+		if (entry->next) {
+			entry->next->prev = entry->prev;
+		} else {
+			speech_cache.tail = entry->prev;
+		}
+
+		entry->prev = NULL;
+		entry->next = speech_cache.head;
+		speech_cache.head->prev = entry;
+		speech_cache.head = entry;
+	}
+}
+
+static void speech_cache_release(speech_cache_entry_t *entry)
+{
+	uint8_t destroy = 0;
+
+	switch_mutex_lock(speech_cache.mutex);
+	if (!--entry->refs && entry->dead) {
+		destroy = 1;
+	}
+	switch_mutex_unlock(speech_cache.mutex);
+
+	if (destroy) {
+		speech_cache_entry_free(entry);
+	}
+}
+
+static char *speech_cache_key(switch_speech_handle_t *sh, const char *text)
+{
+	switch_stream_handle_t stream = { 0 };
+	switch_event_header_t *hp;
+
+	SWITCH_STANDARD_STREAM(stream);
+
+	stream.write_function(&stream, "%s|%s|%s|%u|%u|", sh->engine, switch_str_nil(sh->cache->voice), switch_str_nil(sh->param), sh->samplerate, sh->channels);
+
+	for (hp = sh->cache->params->headers; hp; hp = hp->next) {
+		stream.write_function(&stream, "%s=%s;", hp->name, hp->value);
+	}
+
+	stream.write_function(&stream, "|%s", text);
+
+	return (char *) stream.data;
+}
+
+static char *speech_cache_path(const char *dir, const char *key)
+{
+	char digest[SWITCH_MD5_DIGEST_STRING_SIZE] = "";
+
+	switch_md5_string(digest, key, strlen(key));
+
+	return switch_mprintf("%s%s%s.tts", dir, SWITCH_PATH_SEPARATOR, digest);
+}
+
+/* files start with the magic line, the key length, the key and then the audio */
+static switch_bool_t speech_cache_load(const char *dir, const char *want_key, uint8_t **data, switch_size_t *bytes)
+{
+	char *path = speech_cache_path(dir, want_key);
+	char magic[sizeof(SPEECH_CACHE_MAGIC) - 1];
+	uint32_t keylen = 0, len = (uint32_t) strlen(want_key);
+	char *key = NULL;
+	switch_bool_t r = SWITCH_FALSE;
+	long size;
+	FILE *fp;
+
+	if (!(fp = fopen(path, "rb"))) {
+		goto end;
+	}
+
+	if (fread(magic, sizeof(magic), 1, fp) != 1 || memcmp(magic, SPEECH_CACHE_MAGIC, sizeof(magic)) ||
+		fread(&keylen, sizeof(keylen), 1, fp) != 1 || keylen != len) {
+		goto end;
+	}
+
+	switch_zmalloc(key, len + 1);
+
+	if (fread(key, len, 1, fp) != 1 || strcmp(key, want_key)) {
+		goto end;
+	}
+
+	if (fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 0 || (switch_size_t) size <= sizeof(magic) + sizeof(keylen) + len) {
+		goto end;
+	}
+
+	*bytes = (switch_size_t) size - sizeof(magic) - sizeof(keylen) - len;
+
+	if (*bytes > speech_cache.max_bytes) {
+		goto end;
+	}
+
+	switch_malloc(*data, *bytes);
+
+	if (fseek(fp, (long) (sizeof(magic) + sizeof(keylen) + len), SEEK_SET) || fread(*data, *bytes, 1, fp) != 1) {
+		switch_safe_free(*data);
+		goto end;
+	}
+
+	r = SWITCH_TRUE;
+
+  end:
+
+	if (fp) {
+		fclose(fp);
+	}
+
+	switch_safe_free(key);
+	switch_safe_free(path);
+
+	return r;
+}
+
+static void speech_cache_save(const char *dir, speech_cache_entry_t *entry)
+{
+	char *path = speech_cache_path(dir, entry->key);
+	char *tmp = switch_mprintf("%s.%u.tmp", path, (uint32_t) switch_micro_time_now());
+	uint32_t keylen = (uint32_t) strlen(entry->key);
+	FILE *fp;
+
+	/* written aside and renamed so a reader never sees half a file */
+	if ((fp = fopen(tmp, "wb"))) {
+		int ok = fwrite(SPEECH_CACHE_MAGIC, sizeof(SPEECH_CACHE_MAGIC) - 1, 1, fp) == 1 &&
+			fwrite(&keylen, sizeof(keylen), 1, fp) == 1 &&
+			fwrite(entry->key, keylen, 1, fp) == 1 &&
+			fwrite(entry->data, entry->bytes, 1, fp) == 1;
+
+		if (fclose(fp) || !ok || rename(tmp, path)) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Unable to write speech cache file %s\n", path);
+			unlink(tmp);
+		}
+	}
+
+	switch_safe_free(tmp);
+	switch_safe_free(path);
+}
+
+/* the audio of entry is complete, hand it to the followers and keep it */
+static void speech_cache_finish(speech_cache_entry_t *entry, switch_bool_t save)
+{
+	char *dir = NULL;
+
+	switch_mutex_lock(speech_cache.mutex);
+	switch_core_hash_delete(speech_cache.fills, entry->key);
+	entry->done = 1;
+
+	if (!speech_cache.max_bytes || !speech_cache_insert(entry)) {
+		entry->dead = 1;
+	}
+
+	if (save && speech_cache.dir) {
+		dir = strdup(speech_cache.dir);
+	}
+
+	switch_thread_cond_broadcast(speech_cache.cond);
+	switch_mutex_unlock(speech_cache.mutex);
+
+	if (dir) {
+		speech_cache_save(dir, entry);
+		free(dir);
+	}
+}
+
+/* the synthesis of entry was abandoned, followers go back to their engine */
+static void speech_cache_fail(speech_cache_entry_t *entry)
+{
+	switch_mutex_lock(speech_cache.mutex);
+	switch_core_hash_delete(speech_cache.fills, entry->key);
+	entry->failed = 1;
+	entry->dead = 1;
+	switch_thread_cond_broadcast(speech_cache.cond);
+	switch_mutex_unlock(speech_cache.mutex);
+}
+
+static void speech_cache_detach(switch_speech_handle_t *sh, switch_bool_t complete)
+{
+	struct switch_speech_cache_s *cache = sh->cache;
+	speech_cache_entry_t *entry;
+
+	if (!cache || !(entry = cache->entry)) {
+		return;
+	}
+
+	cache->entry = NULL;
+
+	if (cache->filling) {
+		cache->filling = 0;
+
+		if (complete && entry->bytes) {
+			speech_cache_finish(entry, SWITCH_TRUE);
+		} else {
+			speech_cache_fail(entry);
+		}
+	}
+
+	speech_cache_release(entry);
+}
+
+/* returns SWITCH_TRUE when the text is served from the cache and the engine must not be fed */
+static switch_bool_t speech_cache_feed(switch_speech_handle_t *sh, const char *text)
+{
+	struct switch_speech_cache_s *cache = sh->cache;
+	speech_cache_entry_t *entry;
+	char *key, *dir = NULL;
+	switch_bool_t fill = SWITCH_FALSE;
+
+	speech_cache_detach(sh, SWITCH_FALSE);
+	cache->skip = 0;
+	switch_safe_free(cache->text);
+
+	if (!speech_cache.max_bytes || !(key = speech_cache_key(sh, text))) {
+		return SWITCH_FALSE;
+	}
+
+	switch_mutex_lock(speech_cache.mutex);
+
+	if ((entry = switch_core_hash_find(speech_cache.hash, key))) {
+		speech_cache_touch(entry);
+		entry->hits++;
+		speech_cache.hits++;
+	} else if ((entry = switch_core_hash_find(speech_cache.fills, key))) {
+		speech_cache.coalesced++;
+	} else {
+		switch_zmalloc(entry, sizeof(*entry));
+		entry->key = key;
+		key = NULL;
+		switch_core_hash_insert(speech_cache.fills, entry->key, entry);
+		speech_cache.misses++;
+		fill = SWITCH_TRUE;
+
+		if (speech_cache.dir) {
+			dir = strdup(speech_cache.dir);
+		}
+	}
+
+	entry->refs++;
+	switch_mutex_unlock(speech_cache.mutex);
+
+	switch_safe_free(key);
+
+	cache->entry = entry;
+	cache->pos = 0;
+	cache->text = strdup(text);
+
+	if (fill) {
+		uint8_t *data = NULL;
+		switch_size_t bytes = 0;
+
+		if (dir && speech_cache_load(dir, entry->key, &data, &bytes)) {
+			/* handles may already follow the entry, they only look at it under the mutex */
+			switch_mutex_lock(speech_cache.mutex);
+			entry->data = data;
+			entry->bytes = entry->alloced = bytes;
+			speech_cache.disk_hits++;
+			switch_mutex_unlock(speech_cache.mutex);
+			speech_cache_finish(entry, SWITCH_FALSE);
+		} else {
+			cache->filling = 1;
+			cache->engine_status = SWITCH_STATUS_SUCCESS;
+		}
+	}
+
+	switch_safe_free(dir);
+
+	return cache->filling ? SWITCH_FALSE : SWITCH_TRUE;
+}
+
+static void speech_cache_append(switch_speech_handle_t *sh, const void *data, switch_size_t len)
+{
+	speech_cache_entry_t *entry = sh->cache->entry;
+	switch_bool_t reject = SWITCH_FALSE;
+
+	if (!len) {
+		return;
+	}
+
+	switch_mutex_lock(speech_cache.mutex);
+
+	if (entry->bytes + len > speech_cache.max_bytes) {
+		speech_cache.rejects++;
+		reject = SWITCH_TRUE;
+	} else {
+		if (entry->bytes + len > entry->alloced) {
+			switch_size_t alloced = entry->alloced ? entry->alloced : len * 64;
+			void *mem;
+
+			while (alloced < entry->bytes + len) {
+				alloced *= 2;
+			}
+
+			if ((mem = realloc(entry->data, alloced))) {
+				entry->data = mem;
+				entry->alloced = alloced;
+			} else {
+				reject = SWITCH_TRUE;
+			}
+		}
+
+		if (!reject) {
+			memcpy(entry->data + entry->bytes, data, len);
+			entry->bytes += len;
+			switch_thread_cond_broadcast(speech_cache.cond);
+		}
+	}
+
+	switch_mutex_unlock(speech_cache.mutex);
+
+	if (reject) {
+		speech_cache_detach(sh, SWITCH_FALSE);
+	}
+}
+
+/* read from the entry attached to a handle that is not synthesizing it, SWITCH_STATUS_RESTART when it was abandoned */
+static switch_status_t speech_cache_read(switch_speech_handle_t *sh, void *data, switch_size_t *datalen)
+{
+	struct switch_speech_cache_s *cache = sh->cache;
+	speech_cache_entry_t *entry = cache->entry;
+	switch_size_t want = *datalen, seen;
+	switch_time_t since = switch_micro_time_now();
+	switch_status_t status;
+
+	switch_mutex_lock(speech_cache.mutex);
+	seen = entry->bytes;
+
+	for (;;) {
+		/* whole frames only until the text is complete */
+		if (entry->bytes - cache->pos >= want || (entry->done && entry->bytes > cache->pos)) {
+			*datalen = entry->bytes - cache->pos;
+
+			if (*datalen > want) {
+				*datalen = want;
+			}
+
+			memcpy(data, entry->data + cache->pos, *datalen);
+			cache->pos += *datalen;
+			status = SWITCH_STATUS_SUCCESS;
+			break;
+		}
+
+		if (entry->done) {
+			*datalen = 0;
+			status = SWITCH_STATUS_BREAK;
+			break;
+		}
+
+		if (entry->failed) {
+			status = SWITCH_STATUS_RESTART;
+			break;
+		}
+
+		if (entry->bytes != seen) {
+			seen = entry->bytes;
+			since = switch_micro_time_now();
+		} else if (switch_micro_time_now() - since > SPEECH_CACHE_STALL_USEC) {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "Speech cache synthesis stalled, synthesizing it again\n");
+			status = SWITCH_STATUS_RESTART;
+			break;
+		}
+
+		switch_thread_cond_timedwait(speech_cache.cond, speech_cache.mutex, 100000);
+	}
+
+	switch_mutex_unlock(speech_cache.mutex);
+
+	if (status != SWITCH_STATUS_SUCCESS) {
+		cache->skip = status == SWITCH_STATUS_RESTART ? cache->pos : 0;
+		speech_cache_detach(sh, SWITCH_FALSE);
+	}
+
+	return status;
+}
+
+static void speech_cache_param(switch_speech_handle_t *sh, const char *param, const char *val)
+{
+	if (sh->cache) {
+		switch_event_del_header(sh->cache->params, param);
+		switch_event_add_header_string(sh->cache->params, SWITCH_STACK_BOTTOM, param, val);
+	}
+}
+
+void switch_core_speech_cache_init(switch_memory_pool_t *pool)
+{
+	memset(&speech_cache, 0, sizeof(speech_cache));
+	speech_cache.pool = pool;
+	switch_mutex_init(&speech_cache.mutex, SWITCH_MUTEX_NESTED, pool);
+	switch_thread_cond_create(&speech_cache.cond, pool);
+	switch_core_hash_init(&speech_cache.hash);
+	switch_core_hash_init(&speech_cache.fills);
+}
+
+void switch_core_speech_cache_destroy(void)
+{
+	if (!speech_cache.mutex) {
+		return;
+	}
+
+	switch_core_speech_cache_flush();
+	switch_core_hash_destroy(&speech_cache.hash);
+	switch_core_hash_destroy(&speech_cache.fills);
+	switch_safe_free(speech_cache.dir);
+	speech_cache.mutex = NULL;
+}
+
+SWITCH_DECLARE(void) switch_core_speech_cache_configure(switch_size_t max_bytes, const char *dir)
+{
+	if (!speech_cache.mutex) {
+		return;
+	}
+
+	switch_mutex_lock(speech_cache.mutex);
+	speech_cache.max_bytes = max_bytes;
+	switch_safe_free(speech_cache.dir);
+
+	if (!zstr(dir)) {
+		if (switch_dir_make_recursive(dir, SWITCH_DEFAULT_DIR_PERMS, speech_cache.pool) == SWITCH_STATUS_SUCCESS) {
+			speech_cache.dir = strdup(dir);
+		} else {
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "Unable to create speech cache directory %s\n", dir);
+		}
+	}
+
+	speech_cache_evict(0);
+	switch_mutex_unlock(speech_cache.mutex);
+}
+
+SWITCH_DECLARE(void) switch_core_speech_cache_flush(void)
+{
+	speech_cache_entry_t *entry, *next;
+
+	if (!speech_cache.mutex) {
+		return;
+	}
+
+	switch_mutex_lock(speech_cache.mutex);
+
+	for (entry = speech_cache.head; entry; entry = next) {
+		next = entry->next;
+		speech_cache_unlink(entry);
+
+		/* entries still being played are freed by their last reader */
+		if (!entry->refs) {
+			speech_cache_entry_free(entry);
+		}
+	}
+
+	switch_mutex_unlock(speech_cache.mutex);
+}
+
+SWITCH_DECLARE(void) switch_core_speech_cache_status(switch_stream_handle_t *stream)
+{
+	if (!speech_cache.mutex) {
+		stream->write_function(stream, "speech cache not initialized\n");
+		return;
+	}
+
+	switch_mutex_lock(speech_cache.mutex);
+	stream->write_function(stream, "enabled: %s\n", speech_cache.max_bytes ? "true" : "false");
+	stream->write_function(stream, "max-bytes: %" SWITCH_SIZE_T_FMT "\n", speech_cache.max_bytes);
+	stream->write_function(stream, "dir: %s\n", switch_str_nil(speech_cache.dir));
+	stream->write_function(stream, "bytes: %" SWITCH_SIZE_T_FMT "\n", speech_cache.bytes);
+	stream->write_function(stream, "entries: %u\n", speech_cache.entries);
+	stream->write_function(stream, "hits: %" SWITCH_UINT64_T_FMT "\n", speech_cache.hits);
+	stream->write_function(stream, "disk-hits: %" SWITCH_UINT64_T_FMT "\n", speech_cache.disk_hits);
+	stream->write_function(stream, "misses: %" SWITCH_UINT64_T_FMT "\n", speech_cache.misses);
+	stream->write_function(stream, "coalesced: %" SWITCH_UINT64_T_FMT "\n", speech_cache.coalesced);
+	stream->write_function(stream, "inserts: %" SWITCH_UINT64_T_FMT "\n", speech_cache.inserts);
+	stream->write_function(stream, "evictions: %" SWITCH_UINT64_T_FMT "\n", speech_cache.evictions);
+	stream->write_function(stream, "rejects: %" SWITCH_UINT64_T_FMT "\n", speech_cache.rejects);
+	switch_mutex_unlock(speech_cache.mutex);
+}
+
 SWITCH_DECLARE(switch_status_t) switch_core_speech_open(switch_speech_handle_t *sh,
 														const char *module_name,
 														const char *voice_name,
@@ -86,10 +699,21 @@ SWITCH_DECLARE(switch_status_t) switch_core_speech_open(switch_speech_handle_t *
 	sh->native_rate = rate;
 	sh->channels = channels;
 	sh->real_channels = 1;
+	sh->cache = NULL;
+
+	if (speech_cache.mutex && speech_cache.max_bytes) {
+		sh->cache = switch_core_alloc(sh->memory_pool, sizeof(*sh->cache));
+		sh->cache->voice = switch_core_strdup(sh->memory_pool, switch_str_nil(voice_name));
+		switch_event_create_plain(&sh->cache->params, SWITCH_EVENT_CHANNEL_DATA);
+	}
 
 	if ((status = sh->speech_interface->speech_open(sh, voice_name, rate, channels, flags)) == SWITCH_STATUS_SUCCESS) {
 		switch_set_flag(sh, SWITCH_SPEECH_FLAG_OPEN);
 	} else {
+		if (sh->cache) {
+			switch_event_destroy(&sh->cache->params);
+			sh->cache = NULL;
+		}
 		UNPROTECT_INTERFACE(sh->speech_interface);
 	}
 
@@ -151,6 +775,10 @@ SWITCH_DECLARE(switch_status_t) switch_core_speech_feed_tts(switch_speech_handle
 		}
 	}
 
+	if (sh->cache && speech_cache_feed(sh, data)) {
+		goto done;
+	}
+
 	status = sh->speech_interface->speech_feed_tts(sh, data, flags);
 
   done:
@@ -163,6 +791,11 @@ SWITCH_DECLARE(void) switch_core_speech_flush_tts(switch_speech_handle_t *sh)
 {
 	switch_assert(sh != NULL);
 
+	if (sh->cache) {
+		speech_cache_detach(sh, SWITCH_FALSE);
+		sh->cache->skip = 0;
+	}
+
 	if (sh->speech_interface->speech_flush_tts) {
 		sh->speech_interface->speech_flush_tts(sh);
 	}
@@ -172,6 +805,8 @@ SWITCH_DECLARE(void) switch_core_speech_text_param_tts(switch_speech_handle_t *s
 {
 	switch_assert(sh != NULL);
 
+	speech_cache_param(sh, param, val);
+
 	if (sh->speech_interface->speech_text_param_tts) {
 		sh->speech_interface->speech_text_param_tts(sh, param, val);
 	}
@@ -181,6 +816,13 @@ SWITCH_DECLARE(void) switch_core_speech_numeric_param_tts(switch_speech_handle_t
 {
 	switch_assert(sh != NULL);
 
+	if (sh->cache) {
+		char buf[32];
+
+		switch_snprintf(buf, sizeof(buf), "%d", val);
+		speech_cache_param(sh, param, buf);
+	}
+
 	if (sh->speech_interface->speech_numeric_param_tts) {
 		sh->speech_interface->speech_numeric_param_tts(sh, param, val);
 	}
@@ -190,12 +832,19 @@ SWITCH_DECLARE(void) switch_core_speech_float_param_tts(switch_speech_handle_t *
 {
 	switch_assert(sh != NULL);
 
+	if (sh->cache) {
+		char buf[64];
+
+		switch_snprintf(buf, sizeof(buf), "%f", val);
+		speech_cache_param(sh, param, buf);
+	}
+
 	if (sh->speech_interface->speech_float_param_tts) {
 		sh->speech_interface->speech_float_param_tts(sh, param, val);
 	}
 }
 
-SWITCH_DECLARE(switch_status_t) switch_core_speech_read_tts(switch_speech_handle_t *sh, void *data, switch_size_t *datalen, switch_speech_flag_t *flags)
+static switch_status_t speech_read_tts(switch_speech_handle_t *sh, void *data, switch_size_t *datalen, switch_speech_flag_t *flags)
 {
 	switch_status_t status;
 	switch_size_t want, orig_len = *datalen;
@@ -224,6 +873,9 @@ SWITCH_DECLARE(switch_status_t) switch_core_speech_read_tts(switch_speech_handle
 	*datalen = orig_len / sh->channels;
 
 	if ((status = sh->speech_interface->speech_read_tts(sh, data, datalen, flags)) != SWITCH_STATUS_SUCCESS) {
+		if (sh->cache) {
+			sh->cache->engine_status = status;
+		}
 		switch_set_flag(sh, SWITCH_SPEECH_FLAG_DONE);
 		goto top;
 	}
@@ -279,6 +931,64 @@ SWITCH_DECLARE(switch_status_t) switch_core_speech_read_tts(switch_speech_handle
 
 }
 
+SWITCH_DECLARE(switch_status_t) switch_core_speech_read_tts(switch_speech_handle_t *sh, void *data, switch_size_t *datalen, switch_speech_flag_t *flags)
+{
+	struct switch_speech_cache_s *cache;
+	switch_size_t want;
+	switch_status_t status;
+
+	switch_assert(sh != NULL);
+
+	cache = sh->cache;
+	want = *datalen;
+
+	if (cache && cache->entry && !cache->filling) {
+		if ((status = speech_cache_read(sh, data, datalen)) != SWITCH_STATUS_RESTART) {
+			return status;
+		}
+
+		/* the synthesis this handle followed was abandoned, run the engine and drop what was already played */
+		if (sh->speech_interface->speech_feed_tts(sh, cache->text, flags) != SWITCH_STATUS_SUCCESS) {
+			*datalen = 0;
+			return SWITCH_STATUS_BREAK;
+		}
+	}
+
+	for (;;) {
+		*datalen = want;
+		status = speech_read_tts(sh, data, datalen, flags);
+
+		if (!cache) {
+			break;
+		}
+
+		if (cache->filling) {
+			if (status == SWITCH_STATUS_SUCCESS) {
+				speech_cache_append(sh, data, *datalen);
+			} else {
+				/* engines end a text with FALSE or BREAK, anything else is an error and the audio may be cut short */
+				speech_cache_detach(sh, status == SWITCH_STATUS_BREAK &&
+									(cache->engine_status == SWITCH_STATUS_FALSE || cache->engine_status == SWITCH_STATUS_BREAK));
+			}
+		}
+
+		if (status != SWITCH_STATUS_SUCCESS || !cache->skip) {
+			break;
+		}
+
+		if (*datalen > cache->skip) {
+			memmove(data, (uint8_t *) data + cache->skip, *datalen - cache->skip);
+			*datalen -= cache->skip;
+			cache->skip = 0;
+			break;
+		}
+
+		cache->skip -= *datalen;
+	}
+
+	return status;
+}
+
 
 SWITCH_DECLARE(switch_status_t) switch_core_speech_close(switch_speech_handle_t *sh, switch_speech_flag_t *flags)
 {
@@ -292,6 +1002,13 @@ SWITCH_DECLARE(switch_status_t) switch_core_speech_close(switch_speech_handle_t
 		switch_buffer_destroy(&sh->buffer);
 	}
 
+	if (sh->cache) {
+		speech_cache_detach(sh, SWITCH_FALSE);
+		switch_safe_free(sh->cache->text);
+		switch_event_destroy(&sh->cache->params);
+		sh->cache = NULL;
+	}
+
 	switch_resample_destroy(&sh->resampler);
 
 	UNPROTECT_INTERFACE(sh->speech_interface);
@@ -38,6 +38,8 @@
 
 #include <switch.h>
 #include <switch_utf8.h>
+#include <switch_simd.h>
+#include "private/switch_core_pvt.h"
 
 #ifdef SWITCH_HAVE_YUV
 #include <libyuv.h>
@@ -322,48 +324,427 @@ SWITCH_DECLARE(void) switch_img_free(switch_image_t **img)
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #endif
 
+/* Row band workers
+ *
+ * Kernels that treat every row of a large image the same way hand all but the first band of
+ * rows to a small shared pool and run the first band themselves.  The pool is started on first
+ * use and grows up to the configured size, see switch_img_set_band_threads().
+ */
+
+#define IMG_BAND_MAX_THREADS 8
+#define IMG_BAND_MIN_PIXELS (640 * 360)
+#define IMG_BAND_MIN_ROWS 32
+
+typedef void (*img_band_func_t)(void *obj, int start, int end);
+
+typedef struct img_band_job_s {
+	img_band_func_t func;
+	void *obj;
+	int start;
+	int end;
+	int *pending;
+} img_band_job_t;
+
+static struct {
+	switch_memory_pool_t *pool;
+	switch_mutex_t *mutex;
+	switch_thread_cond_t *cond;
+	switch_queue_t *queue;
+	switch_thread_t *threads[IMG_BAND_MAX_THREADS];
+	int thread_count;
+	int wanted;
+} img_band;
+
+static void *SWITCH_THREAD_FUNC img_band_worker_run(switch_thread_t *thread, void *obj)
+{
+	void *pop = NULL;
+
+	while (switch_queue_pop(img_band.queue, &pop) == SWITCH_STATUS_SUCCESS && pop) {
+		img_band_job_t *job = (img_band_job_t *) pop;
+
+		job->func(job->obj, job->start, job->end);
+
+		switch_mutex_lock(img_band.mutex);
+		(*job->pending)--;
+		switch_thread_cond_broadcast(img_band.cond);
+		switch_mutex_unlock(img_band.mutex);
+	}
+
+	return NULL;
+}
+
+/* returns how many workers are available for one job */
+static int img_band_workers(void)
+{
+	int wanted = img_band.wanted;
+
+	if (!img_band.mutex || !wanted) {
+		return 0;
+	}
+
+	if (wanted < 0) {
+		wanted = (int) switch_core_cpu_count() - 1;
+	}
+
+	if (wanted > IMG_BAND_MAX_THREADS) {
+		wanted = IMG_BAND_MAX_THREADS;
+	}
+
+	if (wanted > img_band.thread_count) {
+		switch_mutex_lock(img_band.mutex);
+
+		if (!img_band.queue) {
+			switch_queue_create(&img_band.queue, IMG_BAND_MAX_THREADS * 16, img_band.pool);
+		}
+
+		while (img_band.thread_count < wanted) {
+			switch_threadattr_t *thd_attr = NULL;
+
+			switch_threadattr_create(&thd_attr, img_band.pool);
+			switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+
+			if (switch_thread_create(&img_band.threads[img_band.thread_count], thd_attr, img_band_worker_run, NULL, img_band.pool) != SWITCH_STATUS_SUCCESS) {
+				break;
+			}
+
+			img_band.thread_count++;
+		}
+
+		switch_mutex_unlock(img_band.mutex);
+	}
+
+	return MIN(wanted, img_band.thread_count);
+}
+
+static void img_band_run(img_band_func_t func, void *obj, int rows, int width)
+{
+	img_band_job_t jobs[IMG_BAND_MAX_THREADS];
+	int bands = 1, pending = 0, i;
+
+	if (rows * width >= IMG_BAND_MIN_PIXELS) {
+		bands = MIN(img_band_workers() + 1, rows / IMG_BAND_MIN_ROWS);
+	}
+
+	if (bands <= 1) {
+		func(obj, 0, rows);
+		return;
+	}
+
+	for (i = 1; i < bands; i++) {
+		img_band_job_t *job = &jobs[i - 1];
+
+		job->func = func;
+		job->obj = obj;
+		job->start = rows * i / bands;
+		job->end = rows * (i + 1) / bands;
+		job->pending = &pending;
+
+		switch_mutex_lock(img_band.mutex);
+		pending++;
+		switch_mutex_unlock(img_band.mutex);
+
+		if (switch_queue_trypush(img_band.queue, job) != SWITCH_STATUS_SUCCESS) {
+			switch_mutex_lock(img_band.mutex);
+			pending--;
+			switch_mutex_unlock(img_band.mutex);
+			func(obj, job->start, job->end);
+		}
+	}
+
+	func(obj, 0, rows / bands);
+
+	switch_mutex_lock(img_band.mutex);
+	while (pending) {
+		switch_thread_cond_wait(img_band.cond, img_band.mutex);
+	}
+	switch_mutex_unlock(img_band.mutex);
+}
+
+void switch_core_video_band_init(void)
+{
+	memset(&img_band, 0, sizeof(img_band));
+	switch_core_new_memory_pool(&img_band.pool);
+	switch_mutex_init(&img_band.mutex, SWITCH_MUTEX_NESTED, img_band.pool);
+	switch_thread_cond_create(&img_band.cond, img_band.pool);
+	img_band.wanted = -1;
+}
+
+void switch_core_video_band_destroy(void)
+{
+	switch_status_t st;
+	int i;
+
+	if (!img_band.mutex) {
+		return;
+	}
+
+	for (i = 0; i < img_band.thread_count; i++) {
+		switch_queue_push(img_band.queue, NULL);
+	}
+
+	for (i = 0; i < img_band.thread_count; i++) {
+		switch_thread_join(&st, img_band.threads[i]);
+	}
+
+	img_band.mutex = NULL;
+	switch_core_destroy_memory_pool(&img_band.pool);
+}
+
+SWITCH_DECLARE(void) switch_img_set_band_threads(int threads)
+{
+	img_band.wanted = threads < 0 ? -1 : MIN(threads, IMG_BAND_MAX_THREADS);
+}
+
 #ifdef SWITCH_HAVE_YUV
-static void switch_img_patch_rgb_noalpha(switch_image_t *IMG, switch_image_t *img, int x, int y)
+/* ARGB over ARGB without premultiplied alpha (switch_img_patch_rgb noalpha).  Each destination
+ * pixel is replaced when it is fully transparent or the source is opaque, otherwise both colors
+ * are averaged weighted by their alpha.  The vector kernels divide in single precision, which
+ * -ffast-math may turn into an approximate reciprocal, and then correct the truncated quotient by
+ * one using the remainder.  Numerators stay below 2^17 and denominators below 512, so every
+ * product and remainder is exact in float and the result is the integer division of the scalar code.
+ */
+static inline void patch_rgb_noalpha_pixel(switch_rgb_color_t *RGB, const switch_rgb_color_t *rgb)
 {
+	uint8_t alpha = rgb->a;
+
+	if (RGB->a == 0 || alpha == 255) {
+		*RGB = *rgb;
+	} else if (alpha > 0) {
+		uint8_t delta1, delta2, delta;
+
+		delta1 = 255 - RGB->a;
+		delta2 = 255 - rgb->a;
+		delta = (delta1 * delta2) >> 8;
+		RGB->r = ((RGB->r * RGB->a) + (rgb->r * rgb->a)) / (RGB->a + rgb->a);
+		RGB->g = ((RGB->g * RGB->a) + (rgb->g * rgb->a)) / (RGB->a + rgb->a);
+		RGB->b = ((RGB->b * RGB->a) + (rgb->b * rgb->a)) / (RGB->a + rgb->a);
+		RGB->a = 255 - delta;
+	}
+}
+
+#ifdef SWITCH_HAVE_SSE2
+static inline __m128i img_select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/* num / den truncated, exact for the non negative integer operands above */
+static inline __m128i img_div_sse2(__m128 num, __m128 den)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	__m128 q = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(num, den)));
+	__m128 r = _mm_sub_ps(num, _mm_mul_ps(q, den));
+
+	q = _mm_sub_ps(q, _mm_and_ps(_mm_cmplt_ps(r, _mm_setzero_ps()), one));
+	q = _mm_add_ps(q, _mm_and_ps(_mm_cmpge_ps(r, den), one));
+
+	return _mm_cvttps_epi32(q);
+}
+
+static int patch_rgb_noalpha_row_sse2(uint8_t *dst, const uint8_t *src, int n)
+{
+	const __m128i ff = _mm_set1_epi32(0xFF), zero = _mm_setzero_si128();
+	const __m128 one = _mm_set1_ps(1.0f);
+	int i, shift;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		__m128i d = _mm_loadu_si128((const __m128i *) (dst + i * 4));
+		__m128i s = _mm_loadu_si128((const __m128i *) (src + i * 4));
+		__m128i A = _mm_srli_epi32(d, 24), a = _mm_srli_epi32(s, 24);
+		__m128i copy = _mm_or_si128(_mm_cmpeq_epi32(A, zero), _mm_cmpeq_epi32(a, ff));
+		__m128i keep = _mm_or_si128(copy, _mm_cmpeq_epi32(a, zero));
+		__m128i out, delta;
+		__m128 fA, fa, den;
+
+		if (_mm_movemask_epi8(keep) == 0xFFFF) {
+			_mm_storeu_si128((__m128i *) (dst + i * 4), img_select_sse2(copy, s, d));
+			continue;
+		}
+
+		fA = _mm_cvtepi32_ps(A);
+		fa = _mm_cvtepi32_ps(a);
+		den = _mm_max_ps(_mm_add_ps(fA, fa), one);
+
+		/* both factors are below 256 so the 16 bit product is the whole product */
+		delta = _mm_srli_epi32(_mm_mullo_epi16(_mm_sub_epi32(ff, A), _mm_sub_epi32(ff, a)), 8);
+		out = _mm_slli_epi32(_mm_sub_epi32(ff, delta), 24);
+
+		for (shift = 0; shift < 24; shift += 8) {
+			__m128 dc = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(d, shift), ff));
+			__m128 sc = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(s, shift), ff));
+			__m128i q = img_div_sse2(_mm_add_ps(_mm_mul_ps(dc, fA), _mm_mul_ps(sc, fa)), den);
+
+			out = _mm_or_si128(out, _mm_slli_epi32(q, shift));
+		}
+
+		_mm_storeu_si128((__m128i *) (dst + i * 4), img_select_sse2(copy, s, img_select_sse2(keep, d, out)));
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_AVX2
+static SWITCH_TARGET_AVX2 inline __m256i img_div_avx2(__m256 num, __m256 den)
+{
+	const __m256 one = _mm256_set1_ps(1.0f);
+	__m256 q = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_div_ps(num, den)));
+	__m256 r = _mm256_sub_ps(num, _mm256_mul_ps(q, den));
+
+	q = _mm256_sub_ps(q, _mm256_and_ps(_mm256_cmp_ps(r, _mm256_setzero_ps(), _CMP_LT_OQ), one));
+	q = _mm256_add_ps(q, _mm256_and_ps(_mm256_cmp_ps(r, den, _CMP_GE_OQ), one));
+
+	return _mm256_cvttps_epi32(q);
+}
+
+static SWITCH_TARGET_AVX2 int patch_rgb_noalpha_row_avx2(uint8_t *dst, const uint8_t *src, int n)
+{
+	const __m256i ff = _mm256_set1_epi32(0xFF), zero = _mm256_setzero_si256();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	int i, shift;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		__m256i d = _mm256_loadu_si256((const __m256i *) (dst + i * 4));
+		__m256i s = _mm256_loadu_si256((const __m256i *) (src + i * 4));
+		__m256i A = _mm256_srli_epi32(d, 24), a = _mm256_srli_epi32(s, 24);
+		__m256i copy = _mm256_or_si256(_mm256_cmpeq_epi32(A, zero), _mm256_cmpeq_epi32(a, ff));
+		__m256i keep = _mm256_or_si256(copy, _mm256_cmpeq_epi32(a, zero));
+		__m256i out, delta;
+		__m256 fA, fa, den;
+
+		if (_mm256_movemask_epi8(keep) == -1) {
+			_mm256_storeu_si256((__m256i *) (dst + i * 4), _mm256_blendv_epi8(d, s, copy));
+			continue;
+		}
+
+		fA = _mm256_cvtepi32_ps(A);
+		fa = _mm256_cvtepi32_ps(a);
+		den = _mm256_max_ps(_mm256_add_ps(fA, fa), one);
+
+		delta = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(ff, A), _mm256_sub_epi32(ff, a)), 8);
+		out = _mm256_slli_epi32(_mm256_sub_epi32(ff, delta), 24);
+
+		for (shift = 0; shift < 24; shift += 8) {
+			__m256 dc = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(d, shift), ff));
+			__m256 sc = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(s, shift), ff));
+			__m256i q = img_div_avx2(_mm256_add_ps(_mm256_mul_ps(dc, fA), _mm256_mul_ps(sc, fa)), den);
+
+			out = _mm256_or_si256(out, _mm256_slli_epi32(q, shift));
+		}
+
+		_mm256_storeu_si256((__m256i *) (dst + i * 4), _mm256_blendv_epi8(_mm256_blendv_epi8(out, d, keep), s, copy));
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_NEON
+static inline uint32x4_t img_div_neon(float32x4_t num, float32x4_t den)
+{
+	const uint32x4_t one = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+	float32x4_t q = vcvtq_f32_u32(vcvtq_u32_f32(vdivq_f32(num, den)));
+	float32x4_t r = vsubq_f32(num, vmulq_f32(q, den));
+
+	q = vsubq_f32(q, vreinterpretq_f32_u32(vandq_u32(vcltq_f32(r, vdupq_n_f32(0.0f)), one)));
+	q = vaddq_f32(q, vreinterpretq_f32_u32(vandq_u32(vcgeq_f32(r, den), one)));
+
+	return vcvtq_u32_f32(q);
+}
+
+static int patch_rgb_noalpha_row_neon(uint8_t *dst, const uint8_t *src, int n)
+{
+	const uint32x4_t ff = vdupq_n_u32(0xFF);
+	const float32x4_t one = vdupq_n_f32(1.0f);
 	int i;
 
-	if (img->fmt == SWITCH_IMG_FMT_ARGB && IMG->fmt == SWITCH_IMG_FMT_ARGB) {
-		int max_w = MIN(img->d_w, IMG->d_w - abs(x));
-		int max_h = MIN(img->d_h, IMG->d_h - abs(y));
-		int j;
-		uint8_t alpha;
-		switch_rgb_color_t *rgb, *RGB; 
+	for (i = 0; i + 4 <= n; i += 4) {
+		uint32x4_t d = vld1q_u32((const uint32_t *) (dst + i * 4));
+		uint32x4_t s = vld1q_u32((const uint32_t *) (src + i * 4));
+		uint32x4_t A = vshrq_n_u32(d, 24), a = vshrq_n_u32(s, 24);
+		uint32x4_t copy = vorrq_u32(vceqq_u32(A, vdupq_n_u32(0)), vceqq_u32(a, ff));
+		uint32x4_t keep = vorrq_u32(copy, vceqq_u32(a, vdupq_n_u32(0)));
+		float32x4_t fA = vcvtq_f32_u32(A), fa = vcvtq_f32_u32(a);
+		float32x4_t den = vmaxq_f32(vaddq_f32(fA, fa), one);
+		uint32x4_t delta = vshrq_n_u32(vmulq_u32(vsubq_u32(ff, A), vsubq_u32(ff, a)), 8);
+		uint32x4_t out = vshlq_n_u32(vsubq_u32(ff, delta), 24);
+		float32x4_t dc, sc;
+
+		dc = vcvtq_f32_u32(vandq_u32(d, ff));
+		sc = vcvtq_f32_u32(vandq_u32(s, ff));
+		out = vorrq_u32(out, img_div_neon(vmlaq_f32(vmulq_f32(dc, fA), sc, fa), den));
+		dc = vcvtq_f32_u32(vandq_u32(vshrq_n_u32(d, 8), ff));
+		sc = vcvtq_f32_u32(vandq_u32(vshrq_n_u32(s, 8), ff));
+		out = vorrq_u32(out, vshlq_n_u32(img_div_neon(vmlaq_f32(vmulq_f32(dc, fA), sc, fa), den), 8));
+		dc = vcvtq_f32_u32(vandq_u32(vshrq_n_u32(d, 16), ff));
+		sc = vcvtq_f32_u32(vandq_u32(vshrq_n_u32(s, 16), ff));
+		out = vorrq_u32(out, vshlq_n_u32(img_div_neon(vmlaq_f32(vmulq_f32(dc, fA), sc, fa), den), 16));
+
+		vst1q_u32((uint32_t *) (dst + i * 4), vbslq_u32(copy, s, vbslq_u32(keep, d, out)));
+	}
+
+	return i;
+}
+#endif
 
-		for (i = 0; i < max_h; i++) {		
-			for (j = 0; j < max_w; j++) {
-				rgb = (switch_rgb_color_t *)(img->planes[SWITCH_PLANE_PACKED] + i * img->stride[SWITCH_PLANE_PACKED] + j * 4);
-				RGB = (switch_rgb_color_t *)(IMG->planes[SWITCH_PLANE_PACKED] + (y + i) * IMG->stride[SWITCH_PLANE_PACKED] + (x + j) * 4);
-				
-				alpha = rgb->a;
+static inline int patch_rgb_noalpha_row_simd(uint8_t *dst, const uint8_t *src, int n)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
 
-				if (RGB->a == 0) {
-					*RGB = *rgb;
-					continue;
-				}
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return patch_rgb_noalpha_row_avx2(dst, src, n);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return patch_rgb_noalpha_row_sse2(dst, src, n);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return patch_rgb_noalpha_row_neon(dst, src, n);
+#endif
 
-				if (alpha == 255) {
-					*RGB = *rgb;
-					continue;
-				}
+	(void) simd;
+	return 0;
+}
 
-				if (alpha > 0) {
-					uint8_t delta1, delta2, delta;
+static void patch_rgb_noalpha_row(uint8_t *dst, const uint8_t *src, int n)
+{
+	int j;
 
-					delta1 = 255 - RGB->a;
-					delta2 = 255 - rgb->a;
-					delta = (delta1 * delta2) >> 8;
-					RGB->r = ((RGB->r * RGB->a) + (rgb->r * rgb->a)) / (RGB->a + rgb->a);
-					RGB->g = ((RGB->g * RGB->a) + (rgb->g * rgb->a)) / (RGB->a + rgb->a);
-					RGB->b = ((RGB->b * RGB->a) + (rgb->b * rgb->a)) / (RGB->a + rgb->a);
-					RGB->a = 255 - delta;
-				}
-			}
+	for (j = patch_rgb_noalpha_row_simd(dst, src, n); j < n; j++) {
+		patch_rgb_noalpha_pixel((switch_rgb_color_t *) (dst + j * 4), (const switch_rgb_color_t *) (src + j * 4));
+	}
+}
+
+typedef struct patch_rgb_band_s {
+	switch_image_t *IMG;
+	switch_image_t *img;
+	int x;
+	int y;
+	int w;
+} patch_rgb_band_t;
+
+static void patch_rgb_noalpha_band(void *obj, int start, int end)
+{
+	patch_rgb_band_t *band = (patch_rgb_band_t *) obj;
+	switch_image_t *IMG = band->IMG, *img = band->img;
+	int i;
+
+	for (i = start; i < end; i++) {
+		patch_rgb_noalpha_row(IMG->planes[SWITCH_PLANE_PACKED] + (band->y + i) * IMG->stride[SWITCH_PLANE_PACKED] + band->x * 4,
+							  img->planes[SWITCH_PLANE_PACKED] + i * img->stride[SWITCH_PLANE_PACKED], band->w);
+	}
+}
+
+static void switch_img_patch_rgb_noalpha(switch_image_t *IMG, switch_image_t *img, int x, int y)
+{
+	if (img->fmt == SWITCH_IMG_FMT_ARGB && IMG->fmt == SWITCH_IMG_FMT_ARGB) {
+		patch_rgb_band_t band = { IMG, img, x, y, MIN(img->d_w, IMG->d_w - abs(x)) };
+		int max_h = MIN(img->d_h, IMG->d_h - abs(y));
+
+		if (band.w <= 0 || max_h <= 0) {
+			return;
 		}
+
+		img_band_run(patch_rgb_noalpha_band, &band, max_h, band.w);
 	}
 }
 #endif
@@ -718,6 +1099,247 @@ SWITCH_DECLARE(switch_image_t *) switch_img_copy_rect(switch_image_t *img, uint3
 #endif
 }
 
+/* Rendered image cache
+ *
+ * Banners, member name tags and logos are rasterized with freetype or decoded from png
+ * every time a layout is applied or a member (re)joins.  The finished images are kept here
+ * keyed by everything that went into producing them, callers always get their own copy.
+ */
+
+typedef struct img_cache_entry_s {
+	char *key;
+	switch_image_t *img;
+	switch_size_t bytes;
+	struct img_cache_entry_s *prev;
+	struct img_cache_entry_s *next;
+} img_cache_entry_t;
+
+static struct {
+	switch_mutex_t *mutex;
+	switch_hash_t *hash;
+	img_cache_entry_t *head;
+	img_cache_entry_t *tail;
+	switch_size_t max_bytes;
+	switch_size_t bytes;
+	uint32_t entries;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t inserts;
+	uint64_t evictions;
+} img_cache;
+
+static switch_size_t img_cache_bytes(switch_image_t *img)
+{
+	if (img->fmt == SWITCH_IMG_FMT_ARGB) {
+		return (switch_size_t) img->stride[SWITCH_PLANE_PACKED] * img->d_h;
+	}
+
+	return (switch_size_t) img->stride[SWITCH_PLANE_Y] * img->d_h + (switch_size_t) img->stride[SWITCH_PLANE_U] * ((img->d_h + 1) / 2) * 2;
+}
+
+static void img_cache_entry_free(img_cache_entry_t *entry)
+{
+	switch_img_free(&entry->img);
+	switch_safe_free(entry->key);
+	free(entry);
+}
+
+/* must be called with img_cache.mutex held */
+static void img_cache_unlink(img_cache_entry_t *entry)
+{
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	} else {
+		img_cache.head = entry->next;
+	}
+
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	} else {
+		img_cache.tail = entry->prev;
+	}
+
+	entry->prev = entry->next = NULL;
+	switch_core_hash_delete(img_cache.hash, entry->key);
+	img_cache.bytes -= entry->bytes;
+	img_cache.entries--;
+}
+
+/* must be called with img_cache.mutex held */
+static void img_cache_evict(switch_size_t need)
+{
+	while (img_cache.tail && img_cache.bytes + need > img_cache.max_bytes) {
+		img_cache_entry_t *entry = img_cache.tail;
+
+		img_cache_unlink(entry);
+		img_cache_entry_free(entry);
+		img_cache.evictions++;
+	}
+}
+
+void switch_core_image_cache_init(switch_memory_pool_t *pool)
+{
+	memset(&img_cache, 0, sizeof(img_cache));
+	switch_mutex_init(&img_cache.mutex, SWITCH_MUTEX_NESTED, pool);
+	switch_core_hash_init(&img_cache.hash);
+	img_cache.max_bytes = SWITCH_IMG_CACHE_DEFAULT_SIZE;
+}
+
+void switch_core_image_cache_destroy(void)
+{
+	if (!img_cache.mutex) {
+		return;
+	}
+
+	switch_img_cache_flush();
+	switch_core_hash_destroy(&img_cache.hash);
+	img_cache.mutex = NULL;
+}
+
+SWITCH_DECLARE(void) switch_img_cache_configure(switch_size_t max_bytes)
+{
+	if (!img_cache.mutex) {
+		return;
+	}
+
+	switch_mutex_lock(img_cache.mutex);
+	img_cache.max_bytes = max_bytes;
+	img_cache_evict(0);
+	switch_mutex_unlock(img_cache.mutex);
+}
+
+SWITCH_DECLARE(switch_image_t *) switch_img_cache_get(const char *key)
+{
+	img_cache_entry_t *entry;
+	switch_image_t *img = NULL;
+
+	if (!img_cache.mutex || !img_cache.max_bytes || zstr(key)) {
+		return NULL;
+	}
+
+	switch_mutex_lock(img_cache.mutex);
+
+	if ((entry = switch_core_hash_find(img_cache.hash, key))) {
+		/* move to the front of the LRU list */
+		if (entry->prev) {
+			entry->prev->next = entry->next;
+
+			if (entry->next) {
+				entry->next->prev = entry->prev;
+			} else {
+				img_cache.tail = entry->prev;
+			}
+
+			entry->prev = NULL;
+			entry->next = img_cache.head;
+			img_cache.head->prev = entry;
+			img_cache.head = entry;
+		}
+
+		switch_img_copy(entry->img, &img);
+		img_cache.hits++;
+	} else {
+		img_cache.misses++;
+	}
+
+	switch_mutex_unlock(img_cache.mutex);
+
+	return img;
+}
+
+SWITCH_DECLARE(void) switch_img_cache_put(const char *key, switch_image_t *img)
+{
+	img_cache_entry_t *entry;
+	switch_size_t bytes;
+
+	if (!img_cache.mutex || !img_cache.max_bytes || zstr(key) || !img) {
+		return;
+	}
+
+	bytes = img_cache_bytes(img) + strlen(key) + sizeof(*entry);
+
+	if (bytes > img_cache.max_bytes / 4) {
+		/* one huge image should not wipe out everything else */
+		return;
+	}
+
+	switch_zmalloc(entry, sizeof(*entry));
+	switch_img_copy(img, &entry->img);
+
+	if (!entry->img) {
+		free(entry);
+		return;
+	}
+
+	entry->key = strdup(key);
+	entry->bytes = bytes;
+
+	switch_mutex_lock(img_cache.mutex);
+
+	if (switch_core_hash_find(img_cache.hash, key)) {
+		/* somebody else rendered the same thing at the same time */
+		switch_mutex_unlock(img_cache.mutex);
+		img_cache_entry_free(entry);
+		return;
+	}
+
+	img_cache_evict(bytes);
+
+	switch_core_hash_insert(img_cache.hash, entry->key, entry);
+	entry->next = img_cache.head;
+
+	if (img_cache.head) {
+		img_cache.head->prev = entry;
+	} else {
+		img_cache.tail = entry;
+	}
+
+	img_cache.head = entry;
+	img_cache.bytes += bytes;
+	img_cache.entries++;
+	img_cache.inserts++;
+
+	switch_mutex_unlock(img_cache.mutex);
+}
+
+SWITCH_DECLARE(void) switch_img_cache_flush(void)
+{
+	img_cache_entry_t *entry, *next;
+
+	if (!img_cache.mutex) {
+		return;
+	}
+
+	switch_mutex_lock(img_cache.mutex);
+
+	for (entry = img_cache.head; entry; entry = next) {
+		next = entry->next;
+		img_cache_unlink(entry);
+		img_cache_entry_free(entry);
+	}
+
+	switch_mutex_unlock(img_cache.mutex);
+}
+
+SWITCH_DECLARE(void) switch_img_cache_status(switch_stream_handle_t *stream)
+{
+	if (!img_cache.mutex) {
+		stream->write_function(stream, "image cache not initialized\n");
+		return;
+	}
+
+	switch_mutex_lock(img_cache.mutex);
+	stream->write_function(stream, "enabled: %s\n", img_cache.max_bytes ? "true" : "false");
+	stream->write_function(stream, "max-bytes: %" SWITCH_SIZE_T_FMT "\n", img_cache.max_bytes);
+	stream->write_function(stream, "bytes: %" SWITCH_SIZE_T_FMT "\n", img_cache.bytes);
+	stream->write_function(stream, "entries: %u\n", img_cache.entries);
+	stream->write_function(stream, "hits: %" SWITCH_UINT64_T_FMT "\n", img_cache.hits);
+	stream->write_function(stream, "misses: %" SWITCH_UINT64_T_FMT "\n", img_cache.misses);
+	stream->write_function(stream, "inserts: %" SWITCH_UINT64_T_FMT "\n", img_cache.inserts);
+	stream->write_function(stream, "evictions: %" SWITCH_UINT64_T_FMT "\n", img_cache.evictions);
+	switch_mutex_unlock(img_cache.mutex);
+}
+
 #if 0
 static inline void switch_core_rgb2xyz(switch_rgb_color_t *rgb, switch_xyz_color_t *xyz)
 {
@@ -974,6 +1596,226 @@ static inline int switch_color_distance_multi(switch_rgb_color_t *c1, switch_rgb
 	return hits;
 }
 
+/* Mask color matching for switch_chromakey_process.  switch_color_distance() boils down to
+ * n / 900 with n = 2r² + 4g² + 3b² + 100 * (2r'² + 4g'² + 3b'²) where r' g' b' are the
+ * differences of the halved channels, so a pixel matches a mask color when n is at most
+ * 900 * threshold + 899.  The kernels compute n for a run of pixels against every mask color
+ * and store one byte per pixel, 1 when any color matched.  Read as a 32 bit word an ARGB pixel
+ * is 0xAARRGGBB on either byte order.
+ */
+#define CHROMAKEY_BLOCK 16
+
+static inline int32_t chromakey_limit(uint32_t threshold)
+{
+	/* n never exceeds 15101325, 16779 * 900 */
+	return threshold >= 16779 ? INT32_MAX : (int32_t) (threshold * 900 + 899);
+}
+
+#ifdef SWITCH_HAVE_SSE2
+static inline __m128i chromakey_sq_sse2(__m128i x)
+{
+	__m128i s = _mm_srai_epi32(x, 31);
+
+	/* |x| < 256 leaves the upper 16 bits clear so madd gives x * x */
+	x = _mm_sub_epi32(_mm_xor_si128(x, s), s);
+
+	return _mm_madd_epi16(x, x);
+}
+
+static inline __m128i chromakey_weigh_sse2(__m128i r, __m128i g, __m128i b)
+{
+	r = chromakey_sq_sse2(r);
+	g = chromakey_sq_sse2(g);
+	b = chromakey_sq_sse2(b);
+
+	return _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(r, 1), _mm_slli_epi32(g, 2)), _mm_add_epi32(b, _mm_slli_epi32(b, 1)));
+}
+
+static int chromakey_hits_sse2(const uint8_t *argb, int n, const switch_rgb_color_t *mask, const int32_t *limits, int mask_len, uint8_t *hits)
+{
+	const __m128i ff = _mm_set1_epi32(0xFF);
+	int i, k, m;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		__m128i p = _mm_loadu_si128((const __m128i *) (argb + i * 4));
+		__m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), ff);
+		__m128i g = _mm_and_si128(_mm_srli_epi32(p, 8), ff);
+		__m128i b = _mm_and_si128(p, ff);
+		__m128i r2 = _mm_srli_epi32(r, 1), g2 = _mm_srli_epi32(g, 1), b2 = _mm_srli_epi32(b, 1);
+		__m128i any = _mm_setzero_si128();
+
+		for (k = 0; k < mask_len; k++) {
+			__m128i near = chromakey_weigh_sse2(_mm_sub_epi32(r, _mm_set1_epi32(mask[k].r)),
+												_mm_sub_epi32(g, _mm_set1_epi32(mask[k].g)),
+												_mm_sub_epi32(b, _mm_set1_epi32(mask[k].b)));
+			__m128i half = chromakey_weigh_sse2(_mm_sub_epi32(r2, _mm_set1_epi32(mask[k].r >> 1)),
+												_mm_sub_epi32(g2, _mm_set1_epi32(mask[k].g >> 1)),
+												_mm_sub_epi32(b2, _mm_set1_epi32(mask[k].b >> 1)));
+			__m128i sum = _mm_add_epi32(near, _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(half, 6), _mm_slli_epi32(half, 5)), _mm_slli_epi32(half, 2)));
+
+			any = _mm_or_si128(any, _mm_cmpgt_epi32(_mm_set1_epi32(limits[k]), _mm_sub_epi32(sum, _mm_set1_epi32(1))));
+
+			if (_mm_movemask_ps(_mm_castsi128_ps(any)) == 0xF) {
+				break;
+			}
+		}
+
+		m = _mm_movemask_ps(_mm_castsi128_ps(any));
+		hits[i] = m & 1;
+		hits[i + 1] = (m >> 1) & 1;
+		hits[i + 2] = (m >> 2) & 1;
+		hits[i + 3] = (m >> 3) & 1;
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_AVX2
+static inline SWITCH_TARGET_AVX2 __m256i chromakey_weigh_avx2(__m256i r, __m256i g, __m256i b)
+{
+	r = _mm256_mullo_epi32(r, r);
+	g = _mm256_mullo_epi32(g, g);
+	b = _mm256_mullo_epi32(b, b);
+
+	return _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(r, 1), _mm256_slli_epi32(g, 2)), _mm256_add_epi32(b, _mm256_slli_epi32(b, 1)));
+}
+
+static SWITCH_TARGET_AVX2 int chromakey_hits_avx2(const uint8_t *argb, int n, const switch_rgb_color_t *mask, const int32_t *limits, int mask_len, uint8_t *hits)
+{
+	const __m256i ff = _mm256_set1_epi32(0xFF), hundred = _mm256_set1_epi32(100);
+	int i, j, k, m;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		__m256i p = _mm256_loadu_si256((const __m256i *) (argb + i * 4));
+		__m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 16), ff);
+		__m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 8), ff);
+		__m256i b = _mm256_and_si256(p, ff);
+		__m256i r2 = _mm256_srli_epi32(r, 1), g2 = _mm256_srli_epi32(g, 1), b2 = _mm256_srli_epi32(b, 1);
+		__m256i any = _mm256_setzero_si256();
+
+		for (k = 0; k < mask_len; k++) {
+			__m256i near = chromakey_weigh_avx2(_mm256_sub_epi32(r, _mm256_set1_epi32(mask[k].r)),
+												_mm256_sub_epi32(g, _mm256_set1_epi32(mask[k].g)),
+												_mm256_sub_epi32(b, _mm256_set1_epi32(mask[k].b)));
+			__m256i half = chromakey_weigh_avx2(_mm256_sub_epi32(r2, _mm256_set1_epi32(mask[k].r >> 1)),
+												_mm256_sub_epi32(g2, _mm256_set1_epi32(mask[k].g >> 1)),
+												_mm256_sub_epi32(b2, _mm256_set1_epi32(mask[k].b >> 1)));
+			__m256i sum = _mm256_add_epi32(near, _mm256_mullo_epi32(half, hundred));
+
+			any = _mm256_or_si256(any, _mm256_cmpgt_epi32(_mm256_set1_epi32(limits[k]), _mm256_sub_epi32(sum, _mm256_set1_epi32(1))));
+
+			if (_mm256_movemask_ps(_mm256_castsi256_ps(any)) == 0xFF) {
+				break;
+			}
+		}
+
+		m = _mm256_movemask_ps(_mm256_castsi256_ps(any));
+
+		for (j = 0; j < 8; j++) {
+			hits[i + j] = (m >> j) & 1;
+		}
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_NEON
+static inline int32x4_t chromakey_weigh_neon(int32x4_t r, int32x4_t g, int32x4_t b)
+{
+	int32x4_t sum = vmulq_n_s32(vmulq_s32(r, r), 2);
+
+	sum = vmlaq_n_s32(sum, vmulq_s32(g, g), 4);
+
+	return vmlaq_n_s32(sum, vmulq_s32(b, b), 3);
+}
+
+static int chromakey_hits_neon(const uint8_t *argb, int n, const switch_rgb_color_t *mask, const int32_t *limits, int mask_len, uint8_t *hits)
+{
+	const uint32x4_t ff = vdupq_n_u32(0xFF);
+	uint32_t lanes[4];
+	int i, k;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		uint32x4_t p = vld1q_u32((const uint32_t *) (argb + i * 4));
+		int32x4_t r = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(p, 16), ff));
+		int32x4_t g = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(p, 8), ff));
+		int32x4_t b = vreinterpretq_s32_u32(vandq_u32(p, ff));
+		int32x4_t r2 = vshrq_n_s32(r, 1), g2 = vshrq_n_s32(g, 1), b2 = vshrq_n_s32(b, 1);
+		uint32x4_t any = vdupq_n_u32(0);
+
+		for (k = 0; k < mask_len; k++) {
+			int32x4_t near = chromakey_weigh_neon(vsubq_s32(r, vdupq_n_s32(mask[k].r)),
+												  vsubq_s32(g, vdupq_n_s32(mask[k].g)),
+												  vsubq_s32(b, vdupq_n_s32(mask[k].b)));
+			int32x4_t half = chromakey_weigh_neon(vsubq_s32(r2, vdupq_n_s32(mask[k].r >> 1)),
+												  vsubq_s32(g2, vdupq_n_s32(mask[k].g >> 1)),
+												  vsubq_s32(b2, vdupq_n_s32(mask[k].b >> 1)));
+
+			any = vorrq_u32(any, vcleq_s32(vmlaq_n_s32(near, half, 100), vdupq_n_s32(limits[k])));
+
+			if (vminvq_u32(any)) {
+				break;
+			}
+		}
+
+		vst1q_u32(lanes, any);
+		hits[i] = lanes[0] & 1;
+		hits[i + 1] = lanes[1] & 1;
+		hits[i + 2] = lanes[2] & 1;
+		hits[i + 3] = lanes[3] & 1;
+	}
+
+	return i;
+}
+#endif
+
+static inline int chromakey_hits_simd(const uint8_t *argb, int n, const switch_rgb_color_t *mask, const int32_t *limits, int mask_len, uint8_t *hits)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return chromakey_hits_avx2(argb, n, mask, limits, mask_len, hits);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return chromakey_hits_sse2(argb, n, mask, limits, mask_len, hits);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return chromakey_hits_neon(argb, n, mask, limits, mask_len, hits);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static void chromakey_hits(const uint8_t *argb, int n, const switch_rgb_color_t *mask, const uint32_t *thresholds, const int32_t *limits, int mask_len, uint8_t *hits)
+{
+	int i;
+
+	for (i = chromakey_hits_simd(argb, n, mask, limits, mask_len, hits); i < n; i++) {
+		hits[i] = (uint8_t) switch_color_distance_multi((switch_rgb_color_t *) (argb + i * 4), (switch_rgb_color_t *) mask, mask_len, (uint32_t *) thresholds);
+	}
+}
+
+typedef struct chromakey_band_s {
+	const uint8_t *argb;
+	int width;
+	const switch_rgb_color_t *mask;
+	const uint32_t *thresholds;
+	const int32_t *limits;
+	int mask_len;
+	uint8_t *hits;
+} chromakey_band_t;
+
+static void chromakey_hits_band(void *obj, int start, int end)
+{
+	chromakey_band_t *band = (chromakey_band_t *) obj;
+
+	chromakey_hits(band->argb + start * band->width * 4, (end - start) * band->width,
+				   band->mask, band->thresholds, band->limits, band->mask_len, band->hits + start * band->width);
+}
+
 
 struct switch_chromakey_s {
 	switch_image_t *cache_img;
@@ -992,6 +1834,9 @@ struct switch_chromakey_s {
 	switch_rgb_color_t auto_color;
 	int no_cache;
 	int frames_read;
+
+	uint8_t *hits;
+	switch_size_t hits_len;
 };
 
 SWITCH_DECLARE(switch_shade_t) switch_chromakey_str2shade(switch_chromakey_t *ck, const char *shade_name)
@@ -1080,6 +1925,7 @@ SWITCH_DECLARE(switch_status_t) switch_chromakey_destroy(switch_chromakey_t **ck
 
 	if (ck) {
 		switch_img_free(&ck->cache_img);
+		switch_safe_free(ck->hits);
 		free(ck);
 	}
 
@@ -1198,6 +2044,10 @@ SWITCH_DECLARE(void) switch_chromakey_process(switch_chromakey_t *ck, switch_ima
 	switch_image_t *cache_img;
 	int same = 0;
 	int same_same = 0;
+	int32_t limits[CHROMAKEY_MAX_MASK];
+	uint8_t block_hits[CHROMAKEY_BLOCK];
+	const uint8_t *hit_map = NULL;
+	int hit_block = -1, npixels, i;
 
 #ifdef DEBUG_CHROMA
 	int other_img_cached = 0, color_cached = 0, checked = 0, hit_total = 0, total_pixel = 0, delta_hits = 0;
@@ -1234,6 +2084,28 @@ SWITCH_DECLARE(void) switch_chromakey_process(switch_chromakey_t *ck, switch_ima
 		ck->rr = ck->gg = ck->bb = 0;
 	}
 
+	npixels = img->d_w * img->d_h;
+
+	for (i = 0; i < ck->mask_len; i++) {
+		limits[i] = chromakey_limit(ck->thresholds[i]);
+	}
+
+	/* without a usable previous frame nearly every pixel is matched, do the whole image up front */
+	if (ck->mask_len && (ck->no_cache || !cache_img)) {
+		chromakey_band_t band = { img->planes[SWITCH_PLANE_PACKED], img->d_w, ck->mask, ck->thresholds, limits, ck->mask_len, NULL };
+
+		if (ck->hits_len < (switch_size_t) npixels) {
+			switch_safe_free(ck->hits);
+			ck->hits = malloc(npixels);
+			ck->hits_len = ck->hits ? npixels : 0;
+		}
+
+		if ((band.hits = ck->hits)) {
+			img_band_run(chromakey_hits_band, &band, img->d_h, img->d_w);
+			hit_map = ck->hits;
+		}
+	}
+
 	for (; pixel < end_pixel; pixel += 4) {
 		switch_rgb_color_t *color = (switch_rgb_color_t *)pixel;
 		switch_rgb_color_t *last_color = (switch_rgb_color_t *)last_pixel;
@@ -1295,7 +2167,21 @@ SWITCH_DECLARE(void) switch_chromakey_process(switch_chromakey_t *ck, switch_ima
 			}
 
 			if (!hits && ck->mask_len) {
-				hits = switch_color_distance_multi(color, ck->mask, ck->mask_len, ck->thresholds);
+				int idx = (int) ((pixel - img->planes[SWITCH_PLANE_PACKED]) / 4);
+
+				if (hit_map) {
+					hits = hit_map[idx];
+				} else {
+					/* only the pixels that changed since the last frame get here, match them a few at a time */
+					if (idx / CHROMAKEY_BLOCK != hit_block) {
+						hit_block = idx / CHROMAKEY_BLOCK;
+						chromakey_hits(img->planes[SWITCH_PLANE_PACKED] + hit_block * CHROMAKEY_BLOCK * 4,
+									   MIN(CHROMAKEY_BLOCK, npixels - hit_block * CHROMAKEY_BLOCK),
+									   ck->mask, ck->thresholds, limits, ck->mask_len, block_hits);
+					}
+
+					hits = block_hits[idx % CHROMAKEY_BLOCK];
+				}
 			}
 
 
@@ -1604,14 +2490,10 @@ SWITCH_DECLARE(void) switch_img_fill(switch_image_t *img, int x, int y, int w, i
 			memset(img->planes[SWITCH_PLANE_V] + img->stride[SWITCH_PLANE_V] * (i / 2) + x / 2, yuv_color.v, len);
 		}
 	} else if (img->fmt == SWITCH_IMG_FMT_ARGB) {
-		for (i = 0; i < img->d_w; i++) {
-			*((switch_rgb_color_t *)img->planes[SWITCH_PLANE_PACKED] + i) = *color;
-		}
+		uint32_t value;
 
-		for (i = 1; i < img->d_h; i++) {
-			memcpy( img->planes[SWITCH_PLANE_PACKED] + i * img->d_w * 4,
-					img->planes[SWITCH_PLANE_PACKED], img->d_w * 4);
-		}
+		memcpy(&value, color, sizeof(value));
+		ARGBRect(img->planes[SWITCH_PLANE_PACKED], img->stride[SWITCH_PLANE_PACKED], x, y, MIN(w, img->d_w - x), MIN(h, img->d_h - y), value);
 	}
 #endif
 }
@@ -2148,7 +3030,7 @@ SWITCH_DECLARE(uint32_t) switch_img_txt_handle_render(switch_img_txt_handle_t *h
 #endif
 }
 
-SWITCH_DECLARE(switch_image_t *) switch_img_write_text_img(int w, int h, switch_bool_t full, const char *text)
+static switch_image_t *write_text_img(int w, int h, switch_bool_t full, const char *text)
 {
 	const char *fg ="#cccccc";
 	const char *bg = "#142e55";
@@ -2266,6 +3148,26 @@ SWITCH_DECLARE(switch_image_t *) switch_img_write_text_img(int w, int h, switch_
 	return txtimg;
 }
 
+SWITCH_DECLARE(switch_image_t *) switch_img_write_text_img(int w, int h, switch_bool_t full, const char *text)
+{
+	switch_image_t *img;
+	char *key;
+
+	if (zstr(text)) {
+		return write_text_img(w, h, full, text);
+	}
+
+	key = switch_mprintf("txt|%d|%d|%d|%s", w, h, full, text);
+
+	if (!(img = switch_img_cache_get(key)) && (img = write_text_img(w, h, full, text))) {
+		switch_img_cache_put(key, img);
+	}
+
+	switch_safe_free(key);
+
+	return img;
+}
+
 /* WARNING:
    patch a big IMG with a rect hole, note this function is WIP ......
    It ONLY works when the hole is INSIDE the big IMG and the place the small img will patch to,
@@ -2488,7 +3390,7 @@ err:
 	return img;
 }
 
-SWITCH_DECLARE(switch_image_t *) switch_img_read_png(const char* file_name, switch_img_fmt_t img_fmt)
+static switch_image_t *png_read_file(const char* file_name, switch_img_fmt_t img_fmt)
 {
 	png_image png = { 0 };
 
@@ -2525,7 +3427,7 @@ SWITCH_DECLARE(switch_image_t *) switch_img_read_png_from_memory(void *mem, size
 // http://www.libpng.org/pub/png/libpng-1.2.5-manual.html
 // ftp://ftp.oreilly.com/examples/9781565920583/CDROM/SOFTWARE/SOURCE/LIBPNG/EXAMPLE.C
 
-SWITCH_DECLARE(switch_image_t *) switch_img_read_png(const char* file_name, switch_img_fmt_t img_fmt)
+static switch_image_t *png_read_file(const char* file_name, switch_img_fmt_t img_fmt)
 {
 	png_byte header[8];    // 8 is the maximum size that can be checked
 	png_bytep *row_pointers = NULL;
@@ -3086,6 +3988,32 @@ end:
 
 #endif
 
+SWITCH_DECLARE(switch_image_t *) switch_img_read_png(const char* file_name, switch_img_fmt_t img_fmt)
+{
+	switch_image_t *img = NULL;
+	char *key = NULL;
+	struct stat st;
+
+	/* the key carries mtime and size so a replaced file is decoded again */
+	if (!stat(file_name, &st) && (st.st_mode & S_IFMT) == S_IFREG) {
+		key = switch_mprintf("png|%s|%" SWITCH_INT64_T_FMT "|%" SWITCH_INT64_T_FMT "|%d",
+							 file_name, (int64_t) st.st_mtime, (int64_t) st.st_size, img_fmt);
+
+		if ((img = switch_img_cache_get(key))) {
+			free(key);
+			return img;
+		}
+	}
+
+	if ((img = png_read_file(file_name, img_fmt)) && key) {
+		switch_img_cache_put(key, img);
+	}
+
+	switch_safe_free(key);
+
+	return img;
+}
+
 #else
 
 SWITCH_DECLARE(switch_status_t) switch_img_patch_png(switch_image_t *img, int x, int y, const char *file_name)
@@ -1150,9 +1150,12 @@ struct record_helper {
 	switch_bool_t hangup_on_error;
 	switch_codec_implementation_t read_impl;
 	switch_bool_t speech_detected;
-	switch_buffer_t *thread_buffer;
+	switch_spsc_buffer_t *thread_buffer;
+	switch_size_t thread_buffer_len;
+	switch_size_t thread_queue_max;
+	uint32_t thread_bytes_per_ms;
+	uint32_t thread_dropped;
 	switch_thread_t *thread;
-	switch_mutex_t *buffer_mutex;
 	int thread_ready;
 	uint8_t thread_needs_transfer;
 	uint32_t writes;
@@ -1237,6 +1240,13 @@ static void send_record_stop_event(switch_channel_t *channel, switch_codec_imple
 		switch_channel_set_variable_printf(channel, "record_completion_cause", "%s", rh->completion_cause);
 	}
 
+	if (rh->thread_buffer_len) {
+		switch_channel_set_variable_printf(channel, "record_dropped_frames", "%u", rh->thread_dropped);
+		if (rh->thread_bytes_per_ms) {
+			switch_channel_set_variable_printf(channel, "record_queue_max_ms", "%u", (uint32_t) (rh->thread_queue_max / rh->thread_bytes_per_ms));
+		}
+	}
+
 	if (switch_event_create(&event, SWITCH_EVENT_RECORD_STOP) == SWITCH_STATUS_SUCCESS) {
 		switch_channel_event_set_data(channel, event);
 		switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Record-File-Path", rh->file);
@@ -1244,6 +1254,9 @@ static void send_record_stop_event(switch_channel_t *channel, switch_codec_imple
 		if (!zstr(rh->completion_cause)) {
 			switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Record-Completion-Cause", rh->completion_cause);
 		}
+		if (rh->thread_buffer_len) {
+			switch_event_add_header(event, SWITCH_STACK_BOTTOM, "Record-Dropped-Frames", "%u", rh->thread_dropped);
+		}
 		switch_event_fire(&event);
 	}
 
@@ -1278,7 +1291,12 @@ static void *SWITCH_THREAD_FUNC recording_thread(switch_thread_t *thread, void *
 	}
 
 	rh = switch_core_media_bug_get_user_data(bug);
-	switch_buffer_create_dynamic(&rh->thread_buffer, SWITCH_RECOMMENDED_BUFFER_SIZE, SWITCH_RECOMMENDED_BUFFER_SIZE, 0);
+
+	if (switch_spsc_buffer_create(&rh->thread_buffer, rh->thread_buffer_len) != SWITCH_STATUS_SUCCESS) {
+		switch_core_session_rwunlock(session);
+		return NULL;
+	}
+
 	rh->thread_ready = 1;
 
 	channels = switch_core_media_bug_test_flag(bug, SMBF_STEREO) ? 2 : rh->read_impl.number_of_channels;
@@ -1316,24 +1334,21 @@ static void *SWITCH_THREAD_FUNC recording_thread(switch_thread_t *thread, void *
 			}
 		}
 
-		switch_mutex_lock(rh->buffer_mutex);
-		inuse = switch_buffer_inuse(rh->thread_buffer);
+		/* the media thread is the only writer and we are the only reader, no lock needed */
+		inuse = switch_spsc_buffer_inuse(rh->thread_buffer);
 
 		if ((!rh->thread_ready || switch_channel_down_nosig(channel)) && !inuse) {
-			switch_mutex_unlock(rh->buffer_mutex);
 			break;
 		}
 
 		if (!inuse) {
-			switch_mutex_unlock(rh->buffer_mutex);
 			if (rh->thread_ready) {
 				switch_thread_cond_wait(rh->cond, rh->cond_mutex);
 			}
 			continue;
 		}
 
-		samples = switch_buffer_read(rh->thread_buffer, data, bsize) / 2 / channels;
-		switch_mutex_unlock(rh->buffer_mutex);
+		samples = switch_spsc_buffer_read(rh->thread_buffer, data, bsize - bsize % (2 * channels)) / 2 / channels;
 
 		if (switch_core_file_write(rh->fh, data, &samples) != SWITCH_STATUS_SUCCESS) {
 			switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(session), SWITCH_LOG_ERROR, "Error writing %s\n", rh->file);
@@ -1461,9 +1476,21 @@ static switch_bool_t record_callback(switch_media_bug_t *bug, void *user_data, s
 			
 			if (!rh->native && rh->fh && (zstr(var) || switch_true(var))) {
 				switch_threadattr_t *thd_attr = NULL;
-				int sanity = 200;
+				int sanity = 200, ms;
+
+				/* what the writer may fall behind before frames are dropped, 5 seconds unless told otherwise */
+				var = get_recording_var(channel, rh->variables, "RECORD_THREAD_BUFFER_MS");
+				ms = zstr(var) ? 0 : atoi(var);
+				if (ms <= 0) {
+					ms = 5000;
+				}
+				rh->thread_bytes_per_ms = rh->read_impl.actual_samples_per_second / 1000 * 2 *
+					(switch_core_media_bug_test_flag(bug, SMBF_STEREO) ? 2 : rh->read_impl.number_of_channels);
+				rh->thread_buffer_len = (switch_size_t) rh->thread_bytes_per_ms * ms;
+				if (rh->thread_buffer_len < SWITCH_RECOMMENDED_BUFFER_SIZE) {
+					rh->thread_buffer_len = SWITCH_RECOMMENDED_BUFFER_SIZE;
+				}
 
-				switch_mutex_init(&rh->buffer_mutex, SWITCH_MUTEX_NESTED, rh->helper_pool);
 				switch_mutex_init(&rh->cond_mutex, SWITCH_MUTEX_NESTED, rh->helper_pool);
 				switch_thread_cond_create(&rh->cond, rh->helper_pool);
 				switch_threadattr_create(&thd_attr, rh->helper_pool);
@@ -1621,7 +1648,7 @@ static switch_bool_t record_callback(switch_media_bug_t *bug, void *user_data, s
 				}
 
 				if (rh->thread_buffer) {
-					switch_buffer_destroy(&rh->thread_buffer);
+					switch_spsc_buffer_destroy(&rh->thread_buffer);
 				}
 
 				frame.data = data;
@@ -1717,9 +1744,19 @@ static switch_bool_t record_callback(switch_media_bug_t *bug, void *user_data, s
 					len = (switch_size_t) frame.datalen / 2 / frame.channels;
 
 					if (rh->thread_buffer) {
-						switch_mutex_lock(rh->buffer_mutex);
-						switch_buffer_write(rh->thread_buffer, mask ? null_data : data, frame.datalen);
-						switch_mutex_unlock(rh->buffer_mutex);
+						switch_size_t queued;
+
+						/* never wait for the writer, a full queue drops the frame */
+						if (!switch_spsc_buffer_write(rh->thread_buffer, mask ? null_data : data, frame.datalen)) {
+							if (!rh->thread_dropped++) {
+								switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(session), SWITCH_LOG_WARNING, "Recording thread for %s is falling behind, dropping audio\n", rh->file);
+							}
+						}
+
+						if ((queued = switch_spsc_buffer_inuse(rh->thread_buffer)) > rh->thread_queue_max) {
+							rh->thread_queue_max = queued;
+						}
+
 						if (switch_mutex_trylock(rh->cond_mutex) == SWITCH_STATUS_SUCCESS) {
 							switch_thread_cond_signal(rh->cond);
 							switch_mutex_unlock(rh->cond_mutex);
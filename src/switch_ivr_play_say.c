@@ -1241,6 +1241,158 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_release_file_handle(switch_core_sessi
 #define FILE_BLOCKSIZE 1024 * 8
 #define FILE_BUFSIZE 1024 * 64
 
+/* expands a playlist entry to the path to open, adding the sound prefix and the codec extension */
+static const char *play_file_path(switch_core_session_t *session, switch_codec_implementation_t *read_impl, const char *prefix, const char *file, char **backup_file)
+{
+	switch_channel_t *channel = switch_core_session_get_channel(session);
+	const char *backup_ext;
+	char *ext;
+
+	if (!strstr(file, SWITCH_URL_SEPARATOR)) {
+		if (!switch_is_file_path(file)) {
+			char *tfile = NULL;
+			char *e;
+
+			if (*file == '{') {
+				tfile = switch_core_session_strdup(session, file);
+
+				while (*file == '{') {
+					if ((e = switch_find_end_paren(tfile, '{', '}'))) {
+						*e = '\0';
+						file = e + 1;
+						while(*file == ' ') file++;
+					} else {
+						tfile = NULL;
+						break;
+					}
+				}
+			}
+
+			file = switch_core_session_sprintf(session, "%s%s%s%s%s", switch_str_nil(tfile), tfile ? "}" : "", prefix, SWITCH_PATH_SEPARATOR, file);
+		}
+		if ((ext = strrchr(file, '.'))) {
+			ext++;
+
+			/* with playback_native_prompts set, a copy of the prompt already encoded in the codec of the call
+			   (prompt.PCMU next to prompt.wav, see native_file_convert) is played as is and the original is the backup */
+			if (*file != '{' && read_impl->encoded_bytes_per_packet && !strchr(ext, '/') && strcasecmp(ext, read_impl->iananame) &&
+				switch_true(switch_channel_get_variable(channel, "playback_native_prompts"))) {
+				char *native = switch_core_session_sprintf(session, "%.*s.%s", (int) (ext - file - 1), file, read_impl->iananame);
+
+				if (switch_file_exists(native, switch_core_session_get_pool(session)) == SWITCH_STATUS_SUCCESS) {
+					*backup_file = switch_core_session_strdup(session, file);
+					file = native;
+				}
+			}
+		} else {
+
+			if (!(backup_ext = switch_channel_get_variable(channel, "native_backup_extension"))) {
+				backup_ext = "wav";
+			}
+
+			ext = read_impl->iananame;
+			*backup_file = switch_core_session_sprintf(session, "%s.%s", file, backup_ext);
+			file = switch_core_session_sprintf(session, "%s.%s", file, ext);
+		}
+	}
+
+	return file;
+}
+
+/* Playlist prefetch
+ *
+ * With playback_prefetch set to N, the next N entries of a delimited playlist are opened on
+ * their own thread while the current one plays and their read buffer is filled, the playback
+ * loop then takes over the ready handle instead of opening the file itself.  Only speed and
+ * volume move from one handle to the next, so a caller that passes its own file handle to
+ * control the playback (pause, seek, samplerate, params) does not get prefetch.
+ */
+#define PLAY_PREFETCH_MAX 8
+
+typedef struct play_prefetch_s {
+	switch_file_handle_t fh;
+	const char *file;
+	const char *backup_file;
+	uint32_t channels;
+	uint32_t rate;
+	int flags;
+	switch_status_t status;
+	switch_time_t open_usec;
+	switch_thread_t *thread;
+} play_prefetch_t;
+
+static void *SWITCH_THREAD_FUNC play_prefetch_run(switch_thread_t *thread, void *obj)
+{
+	play_prefetch_t *pf = (play_prefetch_t *) obj;
+	switch_time_t start = switch_micro_time_now();
+
+	for(;;) {
+		if ((pf->status = switch_core_file_open(&pf->fh, pf->file, pf->channels, pf->rate, pf->flags, NULL)) == SWITCH_STATUS_SUCCESS) {
+			break;
+		}
+
+		if (pf->backup_file) {
+			pf->file = pf->backup_file;
+			pf->backup_file = NULL;
+		} else {
+			break;
+		}
+	}
+
+	if (pf->status == SWITCH_STATUS_SUCCESS) {
+		switch_core_file_read_ahead(&pf->fh);
+	}
+
+	pf->open_usec = switch_micro_time_now() - start;
+
+	return NULL;
+}
+
+/* phrases, tts and live streams are not files we can open early */
+static switch_bool_t play_prefetch_ok(const char *file)
+{
+	return !(!strncasecmp(file, "phrase:", 7) || !strncasecmp(file, "say:", 4) || !strncasecmp(file, "local_stream:", 13));
+}
+
+static play_prefetch_t *play_prefetch_launch(switch_core_session_t *session, switch_file_handle_t *fh, const char *file, const char *backup_file,
+											 uint32_t channels, uint32_t rate, int flags)
+{
+	switch_memory_pool_t *pool = switch_core_session_get_pool(session);
+	play_prefetch_t *pf = switch_core_session_alloc(session, sizeof(*pf));
+	switch_threadattr_t *thd_attr = NULL;
+
+	pf->file = file;
+	pf->backup_file = backup_file;
+	pf->channels = channels;
+	pf->rate = rate;
+	pf->flags = flags;
+	pf->status = SWITCH_STATUS_FALSE;
+	pf->fh.prefix = fh->prefix;
+	pf->fh.prebuf = fh->prebuf;
+	pf->fh.pre_buffer_datalen = SWITCH_DEFAULT_FILE_BUFFER_LEN;
+
+	switch_threadattr_create(&thd_attr, pool);
+	switch_threadattr_stacksize_set(thd_attr, SWITCH_THREAD_STACKSIZE);
+
+	if (switch_thread_create(&pf->thread, thd_attr, play_prefetch_run, pf, pool) != SWITCH_STATUS_SUCCESS) {
+		return NULL;
+	}
+
+	return pf;
+}
+
+static switch_status_t play_prefetch_wait(play_prefetch_t *pf)
+{
+	switch_status_t st;
+
+	if (pf->thread) {
+		switch_thread_join(&st, pf->thread);
+		pf->thread = NULL;
+	}
+
+	return pf->status;
+}
+
 SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *session, switch_file_handle_t *fh, const char *file, switch_input_args_t *args)
 {
 	switch_channel_t *channel = switch_core_session_get_channel(session);
@@ -1258,9 +1410,7 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *sess
 	switch_file_handle_t lfh;
 	const char *p;
 	//char *title = "", *copyright = "", *software = "", *artist = "", *comment = "", *date = "";
-	char *ext;
 	char *backup_file = NULL;
-	const char *backup_ext;
 	const char *prefix;
 	const char *timer_name;
 	const char *prebuf;
@@ -1288,6 +1438,10 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *sess
 	int flags;
 	int cumulative = 0;
 	int last_speed = -1;
+	play_prefetch_t *prefetch[128] = { 0 };
+	int prefetch_n = 0, next_prefetch = 1, prefetched, caller_fh = !!fh;
+	switch_file_handle_t *fh_base;
+	switch_time_t open_start, open_usec, open_wait;
 
 	if (switch_channel_pre_answer(channel) != SWITCH_STATUS_SUCCESS) {
 		return SWITCH_STATUS_FALSE;
@@ -1356,12 +1510,49 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *sess
 		fh->samples = 0;
 	}
 
+	fh_base = fh;
+
+	if (!prefix) {
+		prefix = SWITCH_GLOBAL_dirs.base_dir;
+	}
+
+	if ((prebuf = switch_channel_get_variable(channel, "stream_prebuffer"))) {
+		int maybe = atoi(prebuf);
+		if (maybe > 0) {
+			fh->prebuf = maybe;
+		}
+	}
 
+	if (!fh->prefix) {
+		fh->prefix = prefix;
+	}
 
+	if (argc > 1 && !caller_fh && (var = switch_channel_get_variable(channel, "playback_prefetch"))) {
+		prefetch_n = atoi(var);
+		if (prefetch_n > PLAY_PREFETCH_MAX) {
+			prefetch_n = PLAY_PREFETCH_MAX;
+		}
+	}
 
 	for (cur = 0; switch_channel_ready(channel) && !done && cur < argc; cur++) {
 		file = argv[cur];
 		eof = 0;
+		fh = fh_base;
+		prefetched = 0;
+
+		/* keep the next entries opening while this one plays */
+		for (; prefetch_n > 0 && next_prefetch < argc && next_prefetch <= cur + prefetch_n; next_prefetch++) {
+			char *pf_backup = NULL;
+			const char *pf_file;
+
+			if (!play_prefetch_ok(argv[next_prefetch])) {
+				continue;
+			}
+
+			pf_file = play_file_path(session, &read_impl, prefix, argv[next_prefetch], &pf_backup);
+			prefetch[next_prefetch] = play_prefetch_launch(session, fh_base, pf_file, pf_backup, read_impl.number_of_channels, read_impl.actual_samples_per_second,
+														   SWITCH_FILE_FLAG_READ | SWITCH_FILE_DATA_SHORT | (switch_channel_test_flag(channel, CF_VIDEO) ? SWITCH_FILE_FLAG_VIDEO : 0));
+		}
 
 		if (cur) {
 			fh->samples = sample_start = 0;
@@ -1417,57 +1608,7 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *sess
 
 		}
 
-		if (!prefix) {
-			prefix = SWITCH_GLOBAL_dirs.base_dir;
-		}
-
-		if (!strstr(file, SWITCH_URL_SEPARATOR)) {
-			if (!switch_is_file_path(file)) {
-				char *tfile = NULL;
-				char *e;
-
-				if (*file == '{') {
-					tfile = switch_core_session_strdup(session, file);
-
-					while (*file == '{') {
-						if ((e = switch_find_end_paren(tfile, '{', '}'))) {
-							*e = '\0';
-							file = e + 1;
-							while(*file == ' ') file++;
-						} else {
-							tfile = NULL;
-							break;
-						}
-					}
-				}
-
-				file = switch_core_session_sprintf(session, "%s%s%s%s%s", switch_str_nil(tfile), tfile ? "}" : "", prefix, SWITCH_PATH_SEPARATOR, file);
-			}
-			if ((ext = strrchr(file, '.'))) {
-				ext++;
-			} else {
-
-				if (!(backup_ext = switch_channel_get_variable(channel, "native_backup_extension"))) {
-					backup_ext = "wav";
-				}
-
-				ext = read_impl.iananame;
-				backup_file = switch_core_session_sprintf(session, "%s.%s", file, backup_ext);
-				file = switch_core_session_sprintf(session, "%s.%s", file, ext);
-			}
-		}
-
-		if ((prebuf = switch_channel_get_variable(channel, "stream_prebuffer"))) {
-			int maybe = atoi(prebuf);
-			if (maybe > 0) {
-				fh->prebuf = maybe;
-			}
-		}
-
-
-		if (!fh->prefix) {
-			fh->prefix = prefix;
-		}
+		file = play_file_path(session, &read_impl, prefix, file, &backup_file);
 
 		flags = SWITCH_FILE_FLAG_READ | SWITCH_FILE_DATA_SHORT;
 
@@ -1477,20 +1618,37 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *sess
 		}
 
 
-		for(;;) {
-			if (switch_core_file_open(fh,
-									  file,
-									  read_impl.number_of_channels,
-									  read_impl.actual_samples_per_second, flags, NULL) == SWITCH_STATUS_SUCCESS) {
-				break;
-			}
+		open_start = switch_micro_time_now();
 
-			if (backup_file) {
-				file = backup_file;
-				backup_file = NULL;
-			} else {
-				break;
+		if (prefetch[cur] && play_prefetch_wait(prefetch[cur]) == SWITCH_STATUS_SUCCESS) {
+			play_prefetch_t *pf = prefetch[cur];
+
+			/* play from the prefetched handle, with whatever was adjusted on ours so far */
+			pf->fh.speed = fh_base->speed;
+			pf->fh.vol = fh_base->vol;
+			pf->fh.volgranular = fh_base->volgranular;
+			fh = &pf->fh;
+			file = pf->file;
+			open_usec = pf->open_usec;
+			prefetched = 1;
+		} else {
+			for(;;) {
+				if (switch_core_file_open(fh,
+										  file,
+										  read_impl.number_of_channels,
+										  read_impl.actual_samples_per_second, flags, NULL) == SWITCH_STATUS_SUCCESS) {
+					break;
+				}
+
+				if (backup_file) {
+					file = backup_file;
+					backup_file = NULL;
+				} else {
+					break;
+				}
 			}
+
+			open_usec = switch_micro_time_now() - open_start;
 		}
 
 		if (!switch_test_flag(fh, SWITCH_FILE_OPEN)) {
@@ -1499,6 +1657,10 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *sess
 			continue;
 		}
 
+		open_wait = switch_micro_time_now() - open_start;
+		switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(session), SWITCH_LOG_DEBUG, "Opened %s in %" SWITCH_TIME_T_FMT "ms, waited %" SWITCH_TIME_T_FMT "ms%s\n",
+						  file, open_usec / 1000, open_wait / 1000, prefetched ? " (prefetched)" : "");
+
 		switch_channel_audio_sync(channel);
 		switch_core_session_io_write_lock(session);
 		switch_channel_set_private(channel, "__fh", fh);
@@ -1657,6 +1819,8 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *sess
 				switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Playback-File-Type", "tone_stream");
 			}
 			switch_event_add_header_string(event, SWITCH_STACK_BOTTOM, "Playback-File-Path", file);
+			switch_event_add_header(event, SWITCH_STACK_BOTTOM, "Playback-Open-Usec", "%" SWITCH_TIME_T_FMT, open_usec);
+			switch_event_add_header(event, SWITCH_STACK_BOTTOM, "Playback-Open-Wait-Usec", "%" SWITCH_TIME_T_FMT, open_wait);
 			if (fh->params) {
 				switch_event_merge(event, fh->params);
 			}
@@ -2056,6 +2220,25 @@ SWITCH_DECLARE(switch_status_t) switch_ivr_play_file(switch_core_session_t *sess
 		if (fh->sp_audio_buffer) {
 			switch_buffer_destroy(&fh->sp_audio_buffer);
 		}
+
+		if (fh != fh_base) {
+			fh_base->speed = fh->speed;
+			fh_base->vol = fh->vol;
+			fh_base->volgranular = fh->volgranular;
+			fh = fh_base;
+		}
+	}
+
+	fh = fh_base;
+
+	/* entries we never got to */
+	for (cur = 1; cur < argc; cur++) {
+		if (prefetch[cur]) {
+			play_prefetch_wait(prefetch[cur]);
+			if (switch_test_flag(&prefetch[cur]->fh, SWITCH_FILE_OPEN)) {
+				switch_core_file_close(&prefetch[cur]->fh);
+			}
+		}
 	}
 
 	if (switch_core_codec_ready((&codec))) {
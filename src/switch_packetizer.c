@@ -30,6 +30,7 @@
  */
 
 #include <switch.h>
+#include <switch_simd.h>
 #define MAX_NALUS 256
 
 typedef struct our_h264_nalu_s {
@@ -43,6 +44,8 @@ typedef struct h264_packetizer_s {
 	uint32_t slice_size;
 	int nalu_current_index;
 	our_h264_nalu_t nalus[MAX_NALUS];
+	int nalu_count;
+	uint8_t fu_hdr[2];
 	uint8_t *extradata;
 	uint32_t extradata_size;
 	uint8_t *sps;
@@ -63,9 +66,112 @@ typedef struct h264_packetizer_s {
 
 const uint8_t *ff_avc_find_startcode(const uint8_t *p, const uint8_t *end);
 
+/* The kernels look for 0 0 1 a block at a time and return how many bytes they went through, or
+ * the offset of the first start code with *found set.  They stop 2 bytes short of the end so the
+ * last bytes of a block can still be matched against the 2 bytes after it.
+ */
+#ifdef SWITCH_HAVE_SSE2
+static int startcode_scan_sse2(const uint8_t *p, int n, int *found)
+{
+	const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+	int i, j, m;
+
+	for (i = 0; i + 18 <= n; i += 16) {
+		__m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (p + i)), zero);
+		__m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (p + i + 1)), zero);
+		__m128i c = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (p + i + 2)), one);
+
+		if ((m = _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(a, b), c)))) {
+			for (j = 0; !(m & (1 << j)); j++);
+			*found = 1;
+			return i + j;
+		}
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_AVX2
+static SWITCH_TARGET_AVX2 int startcode_scan_avx2(const uint8_t *p, int n, int *found)
+{
+	const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi8(1);
+	int i, j;
+	uint32_t m;
+
+	for (i = 0; i + 34 <= n; i += 32) {
+		__m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (p + i)), zero);
+		__m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (p + i + 1)), zero);
+		__m256i c = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (p + i + 2)), one);
+
+		if ((m = (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(a, b), c)))) {
+			for (j = 0; !(m & (1u << j)); j++);
+			*found = 1;
+			return i + j;
+		}
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_NEON
+static int startcode_scan_neon(const uint8_t *p, int n, int *found)
+{
+	const uint8x16_t zero = vdupq_n_u8(0), one = vdupq_n_u8(1);
+	int i, j;
+
+	for (i = 0; i + 18 <= n; i += 16) {
+		uint8x16_t a = vceqq_u8(vld1q_u8(p + i), zero);
+		uint8x16_t b = vceqq_u8(vld1q_u8(p + i + 1), zero);
+		uint8x16_t c = vceqq_u8(vld1q_u8(p + i + 2), one);
+
+		if (vmaxvq_u8(vandq_u8(vandq_u8(a, b), c))) {
+			for (j = 0; !(p[i + j] == 0 && p[i + j + 1] == 0 && p[i + j + 2] == 1); j++);
+			*found = 1;
+			return i + j;
+		}
+	}
+
+	return i;
+}
+#endif
+
+static inline int startcode_scan_simd(const uint8_t *p, int n, int *found)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return startcode_scan_avx2(p, n, found);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return startcode_scan_sse2(p, n, found);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return startcode_scan_neon(p, n, found);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
 static const uint8_t *fs_avc_find_startcode_internal(const uint8_t *p, const uint8_t *end)
 {
-	const uint8_t *a = p + 4 - ((intptr_t)p & 3);
+	const uint8_t *a;
+	int found = 0, i;
+
+	if (p >= end) {
+		return end;
+	}
+
+	i = startcode_scan_simd(p, (int) (end - p), &found);
+
+	if (found) {
+		return p + i;
+	}
+
+	p += i;
+	a = p + 4 - ((intptr_t)p & 3);
 
 	for (end -= 3; p < a && p < end; p++) {
 		if (p[0] == 0 && p[1] == 0 && p[2] == 1)
@@ -220,9 +326,10 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_feed(switch_packetizer_t *pack
 	const uint8_t *end = p + size;
 	int i = 0;
 
-	// reset everytime
-	memset(context->nalus, 0, MAX_NALUS * sizeof(our_h264_nalu_t));
+	// reset everytime, only what the last feed used
+	memset(context->nalus, 0, context->nalu_count * sizeof(our_h264_nalu_t));
 	context->nalu_current_index = 0;
+	context->nalu_count = 0;
 
 	// switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "size = %u %x %x %x %x %x\n", size, *p, *(p+1), *(p+2), *(p+3), *(p+4));
 
@@ -231,6 +338,11 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_feed(switch_packetizer_t *pack
 		uint32_t len;
 
 		while (left > 0) {
+			if (i >= MAX_NALUS - 1) {
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_WARNING, "TOO MANY SLICES!\n");
+				break;
+			}
+
 			if (left < sizeof(uint32_t)) return SWITCH_STATUS_MORE_DATA;
 			len = htonl(*(uint32_t *)p);
 			left -= sizeof(uint32_t);
@@ -241,6 +353,7 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_feed(switch_packetizer_t *pack
 			context->nalus[i].start = p;
 			context->nalus[i].eat = p;
 			context->nalus[i].len = len;
+			context->nalu_count = i + 1;
 
 			p += len;
 
@@ -255,6 +368,7 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_feed(switch_packetizer_t *pack
 		context->nalus[0].start = data;
 		context->nalus[0].eat = data;
 		context->nalus[0].len = size;
+		context->nalu_count = 1;
 
 		return SWITCH_STATUS_SUCCESS;
 	}
@@ -267,7 +381,6 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_feed(switch_packetizer_t *pack
 			context->nalus[i].eat = p;
 		} else {
 			context->nalus[i].len = p - context->nalus[i].start;
-			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "#%d %x len=%u\n", i, *context->nalus[i].start, context->nalus[i].len);
 			while (!(*p++)) ; /* eat the sync bytes, what ever 0 0 1 or 0 0 0 1 */
 			i++;
 			context->nalus[i].start = p;
@@ -281,11 +394,12 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_feed(switch_packetizer_t *pack
 	}
 
 	context->nalus[i].len = p - context->nalus[i].start;
+	context->nalu_count = i + 1;
 
 	return SWITCH_STATUS_SUCCESS;
 }
 
-SWITCH_DECLARE(switch_status_t) switch_packetizer_read(switch_packetizer_t *packetizer, switch_frame_t *frame)
+SWITCH_DECLARE(switch_status_t) switch_packetizer_read_iov(switch_packetizer_t *packetizer, switch_packetizer_iov_t *iov, int *iovcnt, switch_bool_t *m)
 {
 	h264_packetizer_t *context = (h264_packetizer_t *)packetizer;
 	uint32_t slice_size = context->slice_size;
@@ -294,11 +408,13 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_read(switch_packetizer_t *pack
 	uint8_t nalu_type = 0;
 	uint8_t nri = 0;
 	int left = nalu->len - (nalu->eat - nalu->start);
-	uint8_t *p = frame->data;
 	uint8_t start = nalu->start == nalu->eat ? 0x80 : 0;
 	int n = nalu->len / slice_size + 1;
 	int real_slice_size = nalu->len / n + 1 + 2;
 
+	*iovcnt = 0;
+	*m = SWITCH_FALSE;
+
 	if (nalu->start == NULL) {
 		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "INVALID BITSTREAM\n");
 		return SWITCH_STATUS_FALSE;
@@ -309,24 +425,20 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_read(switch_packetizer_t *pack
 	nri = nalu_hdr & 0x60;
 
 	if (real_slice_size > slice_size) real_slice_size = slice_size;
-	if (frame->buflen < slice_size) {
-		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "frame buffer too small %u < %u\n", frame->buflen, slice_size);
-		return SWITCH_STATUS_FALSE;
-	}
 
 	if (context->type == SPT_H264_BITSTREAM || SPT_H264_SIZED_BITSTREAM) {
 		if (nalu_type == 0x05) {
 			// insert SPS/PPS before
 			if (context->sps && !context->sps_sent) {
-				memcpy(frame->data, context->sps, context->sps_len);
-				frame->datalen = context->sps_len;
-				frame->m = 0;
+				iov[0].base = context->sps;
+				iov[0].len = context->sps_len;
+				*iovcnt = 1;
 				context->sps_sent = 1;
 				return SWITCH_STATUS_MORE_DATA;
 			} else if (context->pps && !context->pps_sent) {
-				memcpy(frame->data, context->pps, context->pps_len);
-				frame->datalen = context->pps_len;
-				frame->m = 0;
+				iov[0].base = context->pps;
+				iov[0].len = context->pps_len;
+				*iovcnt = 1;
 				context->pps_sent = 1;
 				return SWITCH_STATUS_MORE_DATA;
 			}
@@ -338,18 +450,16 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_read(switch_packetizer_t *pack
 	}
 
 	if (nalu->len <= slice_size) {
-		memcpy(frame->data, nalu->start, nalu->len);
-		frame->datalen = nalu->len;
+		iov[0].base = nalu->start;
+		iov[0].len = nalu->len;
+		*iovcnt = 1;
 		context->nalu_current_index++;
 
-		switch_clear_flag(frame, SFF_CNG);
-
 		if (context->nalus[context->nalu_current_index].len) {
-			frame->m = 0;
 			return SWITCH_STATUS_MORE_DATA;
 		}
 
-		frame->m = 1;
+		*m = SWITCH_TRUE;
 
 		if (nalu_type == 0x05) {
 			context->sps_sent = 0;
@@ -359,32 +469,70 @@ SWITCH_DECLARE(switch_status_t) switch_packetizer_read(switch_packetizer_t *pack
 		return SWITCH_STATUS_SUCCESS;
 	}
 
+	/* the FU-A header lives in the context until the next read */
+	iov[0].base = context->fu_hdr;
+	iov[0].len = 2;
+	*iovcnt = 2;
+
 	if (left <= (real_slice_size - 2)) {
-		p[0] = nri | 28; // FU-A
-		p[1] = 0x40 | nalu_type;
-		memcpy(p+2, nalu->eat, left);
+		context->fu_hdr[0] = nri | 28; // FU-A
+		context->fu_hdr[1] = 0x40 | nalu_type;
+		iov[1].base = nalu->eat;
+		iov[1].len = left;
 		nalu->eat += left;
-		frame->datalen = left + 2;
 		context->nalu_current_index++;
 
 		if (!context->nalus[context->nalu_current_index].len) {
-			frame->m = 1;
+			*m = SWITCH_TRUE;
 			return SWITCH_STATUS_SUCCESS;
 		}
 
 		return SWITCH_STATUS_MORE_DATA;
 	}
 
-	p[0] = nri | 28; // FU-A
-	p[1] = start | nalu_type;
+	context->fu_hdr[0] = nri | 28; // FU-A
+	context->fu_hdr[1] = start | nalu_type;
 	if (start) nalu->eat++;
-	memcpy(p+2, nalu->eat, real_slice_size - 2);
+	iov[1].base = nalu->eat;
+	iov[1].len = real_slice_size - 2;
 	nalu->eat += (real_slice_size - 2);
-	frame->datalen = real_slice_size;
-	frame->m = 0;
 	return SWITCH_STATUS_MORE_DATA;
 }
 
+SWITCH_DECLARE(switch_status_t) switch_packetizer_read(switch_packetizer_t *packetizer, switch_frame_t *frame)
+{
+	h264_packetizer_t *context = (h264_packetizer_t *)packetizer;
+	switch_packetizer_iov_t iov[SWITCH_PACKETIZER_MAX_IOV];
+	switch_status_t status;
+	switch_bool_t m;
+	uint8_t *p = frame->data;
+	int iovcnt, i;
+
+	if (frame->buflen < context->slice_size) {
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "frame buffer too small %u < %u\n", frame->buflen, context->slice_size);
+		return SWITCH_STATUS_FALSE;
+	}
+
+	status = switch_packetizer_read_iov(packetizer, iov, &iovcnt, &m);
+
+	if (status != SWITCH_STATUS_SUCCESS && status != SWITCH_STATUS_MORE_DATA) {
+		return status;
+	}
+
+	frame->datalen = 0;
+
+	for (i = 0; i < iovcnt; i++) {
+		memcpy(p, iov[i].base, iov[i].len);
+		p += iov[i].len;
+		frame->datalen += iov[i].len;
+	}
+
+	frame->m = m;
+	switch_clear_flag(frame, SFF_CNG);
+
+	return status;
+}
+
 SWITCH_DECLARE(void) switch_packetizer_close(switch_packetizer_t **packetizer)
 {
 	h264_packetizer_t *context = (h264_packetizer_t *)(*packetizer);
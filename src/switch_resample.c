@@ -36,6 +36,8 @@
 #include <switch_private.h>
 #endif
 #include <speex/speex_resampler.h>
+#include <switch_simd.h>
+#include "private/switch_core_pvt.h"
 
 #define NORMFACT (float)0x8000
 #define MAXSAMPLE (float)0x7FFF
@@ -52,6 +54,1301 @@
 
 #define resample_buffer(a, b, c) a > b ? ((a / 1000) / 2) * c : ((b / 1000) / 2) * c
 
+/* Vector kernels for the PCM helpers below.
+ *
+ * Each one handles as much of the buffer as fits its vector width and returns the number of
+ * elements done, the caller finishes the tail with the scalar loop.  Results are bit exact with
+ * the scalar code, including its saturation and truncation.
+ */
+
+#ifdef SWITCH_HAVE_SSE2
+static uint32_t merge_sln_sse2(int16_t *data, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *) (data + i));
+		__m128i b = _mm_loadu_si128((const __m128i *) (other_data + i));
+		_mm_storeu_si128((__m128i *) (data + i), _mm_adds_epi16(a, b));
+	}
+
+	return i;
+}
+
+static uint32_t unmerge_sln_sse2(int16_t *data, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *) (data + i));
+		__m128i b = _mm_loadu_si128((const __m128i *) (other_data + i));
+		_mm_storeu_si128((__m128i *) (data + i), _mm_sub_epi16(a, b));
+	}
+
+	return i;
+}
+
+static uint32_t mux_stereo_to_mono_sse2(int16_t *data, uint32_t samples)
+{
+	const __m128i one = _mm_set1_epi16(1);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= samples; i += 8) {
+		__m128i a = _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (data + i * 2)), one);
+		__m128i b = _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (data + i * 2 + 8)), one);
+		_mm_storeu_si128((__m128i *) (data + i), _mm_packs_epi32(a, b));
+	}
+
+	return i;
+}
+
+/* works from the end of the buffer so the output never overwrites unread input */
+static uint32_t mux_mono_to_stereo_sse2(int16_t *data, uint32_t samples)
+{
+	uint32_t i = samples & ~7U, done = i;
+
+	while (i) {
+		__m128i v;
+
+		i -= 8;
+		v = _mm_loadu_si128((const __m128i *) (data + i));
+		_mm_storeu_si128((__m128i *) (data + i * 2 + 8), _mm_unpackhi_epi16(v, v));
+		_mm_storeu_si128((__m128i *) (data + i * 2), _mm_unpacklo_epi16(v, v));
+	}
+
+	return done;
+}
+
+static uint32_t change_sln_volume_sse2(int16_t *data, uint32_t samples, double rate)
+{
+	const __m128d vrate = _mm_set1_pd(rate);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= samples; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (data + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		__m128i r0 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(lo), vrate));
+		__m128i r1 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(lo, 8)), vrate));
+		__m128i r2 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(hi), vrate));
+		__m128i r3 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(hi, 8)), vrate));
+
+		_mm_storeu_si128((__m128i *) (data + i), _mm_packs_epi32(_mm_unpacklo_epi64(r0, r1), _mm_unpacklo_epi64(r2, r3)));
+	}
+
+	return i;
+}
+
+static uint32_t short_to_float_sse2(const short *s, float *f, uint32_t len)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / NORMFACT);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(f + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(f + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+
+	return i;
+}
+
+/* round half away from zero without the inexact float add, see switch_float_to_short */
+static inline __m128i float_to_int_round_sse2(__m128 ft)
+{
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128i r = _mm_cvttps_epi32(ft);
+	__m128 frac = _mm_and_ps(_mm_sub_ps(ft, _mm_cvtepi32_ps(r)), abs_mask);
+	__m128i up = _mm_castps_si128(_mm_cmpge_ps(frac, _mm_set1_ps(0.5f)));
+	__m128i sign = _mm_or_si128(_mm_castps_si128(_mm_cmplt_ps(ft, _mm_setzero_ps())), _mm_set1_epi32(1));
+
+	r = _mm_add_epi32(r, _mm_and_si128(up, sign));
+
+	/* keep the low 16 bits like the scalar cast does */
+	return _mm_srai_epi32(_mm_slli_epi32(r, 16), 16);
+}
+
+static uint32_t float_to_short_sse2(const float *f, short *s, uint32_t len)
+{
+	const __m128 norm = _mm_set1_ps(NORMFACT);
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 limit = _mm_set1_ps(4194304.0f);
+	const __m128i smin = _mm_set1_epi16(-32768);
+	const __m128i sclip = _mm_set1_epi16((short) -MAXSAMPLE / 2);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		__m128 a = _mm_mul_ps(_mm_loadu_ps(f + i), norm);
+		__m128 b = _mm_mul_ps(_mm_loadu_ps(f + i + 4), norm);
+		__m128i v, clip;
+
+		/* far out of range input is left to the scalar code */
+		if (_mm_movemask_ps(_mm_or_ps(_mm_cmpge_ps(_mm_and_ps(a, abs_mask), limit), _mm_cmpge_ps(_mm_and_ps(b, abs_mask), limit)))) {
+			break;
+		}
+
+		v = _mm_packs_epi32(float_to_int_round_sse2(a), float_to_int_round_sse2(b));
+		clip = _mm_cmpeq_epi16(v, smin);
+		v = _mm_or_si128(_mm_andnot_si128(clip, v), _mm_and_si128(clip, sclip));
+		_mm_storeu_si128((__m128i *) (s + i), v);
+	}
+
+	return i;
+}
+
+/* exact truncating x / d for |x| <= 32768 and 1 <= d <= 32768. The quotient estimate from the
+ * reciprocal is within one of the true value, the remainder (exact in float at these magnitudes)
+ * tells which way to correct it. No float division is left for -ffast-math to approximate. */
+static inline __m128i div_trunc_sse2(__m128i x, __m128 vd, __m128 vrcp)
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	__m128 xf = _mm_cvtepi32_ps(x);
+	__m128 qf = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(xf, vrcp)));
+	__m128 rf = _mm_sub_ps(xf, _mm_mul_ps(qf, vd));
+	__m128 pos = _mm_cmpge_ps(xf, zero);
+	__m128 dec = _mm_or_ps(_mm_and_ps(pos, _mm_cmplt_ps(rf, zero)), _mm_andnot_ps(pos, _mm_cmple_ps(rf, _mm_sub_ps(zero, vd))));
+	__m128 inc = _mm_or_ps(_mm_and_ps(pos, _mm_cmpge_ps(rf, vd)), _mm_andnot_ps(pos, _mm_cmpgt_ps(rf, zero)));
+
+	qf = _mm_add_ps(_mm_sub_ps(qf, _mm_and_ps(dec, one)), _mm_and_ps(inc, one));
+
+	return _mm_cvttps_epi32(qf);
+}
+
+static uint32_t generate_sln_silence_sse2(int16_t *data, uint32_t samples, uint32_t channels, uint32_t divisor, int16_t *rnd)
+{
+	uint16_t x = (uint16_t) *rnd, a43 = 1, c43 = 0;
+	int16_t lanes[8];
+	__m128i v, last, va, vc, va43, vc43;
+	__m128 vdiv, vrcp;
+	uint32_t i, j, k;
+
+	if (samples < 8 || (channels != 1 && channels != 2) || divisor > 32768) {
+		return 0;
+	}
+
+	/* lane k starts at the first generator step of sample k, every sample takes six steps */
+	for (k = 0; k < 8; k++) {
+		x = (uint16_t) (x * 31821U + 13849U);
+		lanes[k] = (int16_t) x;
+
+		for (j = 0; j < 5; j++) {
+			x = (uint16_t) (x * 31821U + 13849U);
+		}
+	}
+
+	/* from the last step of one sample to the first step of the sample 8 further on */
+	for (k = 0; k < 43; k++) {
+		c43 = (uint16_t) (31821U * c43 + 13849U);
+		a43 = (uint16_t) (31821U * a43);
+	}
+
+	va = _mm_set1_epi16((short) 31821);
+	vc = _mm_set1_epi16((short) 13849);
+	va43 = _mm_set1_epi16((short) a43);
+	vc43 = _mm_set1_epi16((short) c43);
+	vdiv = _mm_set1_ps((float) divisor);
+	vrcp = _mm_set1_ps((float) (1.0 / divisor));
+	v = _mm_loadu_si128((const __m128i *) lanes);
+	last = v;
+
+	for (i = 0; i + 8 <= samples; i += 8) {
+		__m128i sum = v, lo, hi, out;
+
+		for (j = 0; j < 5; j++) {
+			v = _mm_add_epi16(_mm_mullo_epi16(v, va), vc);
+			sum = _mm_add_epi16(sum, v);
+		}
+
+		lo = div_trunc_sse2(_mm_srai_epi32(_mm_unpacklo_epi16(sum, sum), 16), vdiv, vrcp);
+		hi = div_trunc_sse2(_mm_srai_epi32(_mm_unpackhi_epi16(sum, sum), 16), vdiv, vrcp);
+		out = _mm_packs_epi32(lo, hi);
+
+		if (channels == 1) {
+			_mm_storeu_si128((__m128i *) (data + i), out);
+		} else {
+			_mm_storeu_si128((__m128i *) (data + i * 2), _mm_unpacklo_epi16(out, out));
+			_mm_storeu_si128((__m128i *) (data + i * 2 + 8), _mm_unpackhi_epi16(out, out));
+		}
+
+		last = v;
+		v = _mm_add_epi16(_mm_mullo_epi16(v, va43), vc43);
+	}
+
+	*rnd = (int16_t) _mm_extract_epi16(last, 7);
+
+	return i;
+}
+
+static uint32_t accumulate_sln_sse2(int32_t *acc, const int16_t *data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (data + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_si128((__m128i *) (acc + i), _mm_add_epi32(_mm_loadu_si128((const __m128i *) (acc + i)), lo));
+		_mm_storeu_si128((__m128i *) (acc + i + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i *) (acc + i + 4)), hi));
+	}
+
+	return i;
+}
+
+static uint32_t mix_minus_sln_sse2(int16_t *data, const int32_t *acc, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		__m128i lo = _mm_loadu_si128((const __m128i *) (acc + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *) (acc + i + 4));
+
+		if (other_data) {
+			__m128i v = _mm_loadu_si128((const __m128i *) (other_data + i));
+			lo = _mm_sub_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+			hi = _mm_sub_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+		}
+
+		_mm_storeu_si128((__m128i *) (data + i), _mm_packs_epi32(lo, hi));
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_AVX2
+SWITCH_TARGET_AVX2 static uint32_t merge_sln_avx2(int16_t *data, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (data + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (other_data + i));
+		_mm256_storeu_si256((__m256i *) (data + i), _mm256_adds_epi16(a, b));
+	}
+
+	return i;
+}
+
+SWITCH_TARGET_AVX2 static uint32_t unmerge_sln_avx2(int16_t *data, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (data + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (other_data + i));
+		_mm256_storeu_si256((__m256i *) (data + i), _mm256_sub_epi16(a, b));
+	}
+
+	return i;
+}
+
+SWITCH_TARGET_AVX2 static uint32_t mux_stereo_to_mono_avx2(int16_t *data, uint32_t samples)
+{
+	const __m256i one = _mm256_set1_epi16(1);
+	uint32_t i;
+
+	for (i = 0; i + 16 <= samples; i += 16) {
+		__m256i a = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *) (data + i * 2)), one);
+		__m256i b = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *) (data + i * 2 + 16)), one);
+		/* packs works per 128 bit lane, put the quadwords back in order */
+		_mm256_storeu_si256((__m256i *) (data + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8));
+	}
+
+	return i;
+}
+
+SWITCH_TARGET_AVX2 static uint32_t change_sln_volume_avx2(int16_t *data, uint32_t samples, double rate)
+{
+	const __m256d vrate = _mm256_set1_pd(rate);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= samples; i += 8) {
+		__m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (data + i)));
+		__m128i r0 = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), vrate));
+		__m128i r1 = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), vrate));
+
+		_mm_storeu_si128((__m128i *) (data + i), _mm_packs_epi32(r0, r1));
+	}
+
+	return i;
+}
+
+SWITCH_TARGET_AVX2 static uint32_t short_to_float_avx2(const short *s, float *f, uint32_t len)
+{
+	const __m256 scale = _mm256_set1_ps(1.0f / NORMFACT);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		__m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (s + i)));
+		_mm256_storeu_ps(f + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+	}
+
+	return i;
+}
+
+SWITCH_TARGET_AVX2 static uint32_t float_to_short_avx2(const float *f, short *s, uint32_t len)
+{
+	const __m256 norm = _mm256_set1_ps(NORMFACT);
+	const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	const __m256 limit = _mm256_set1_ps(4194304.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i smin = _mm256_set1_epi16(-32768);
+	const __m256i sclip = _mm256_set1_epi16((short) -MAXSAMPLE / 2);
+	uint32_t i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m256 ft[2];
+		__m256i r[2], v, clip;
+		int n;
+
+		ft[0] = _mm256_mul_ps(_mm256_loadu_ps(f + i), norm);
+		ft[1] = _mm256_mul_ps(_mm256_loadu_ps(f + i + 8), norm);
+
+		if (_mm256_movemask_ps(_mm256_or_ps(_mm256_cmp_ps(_mm256_and_ps(ft[0], abs_mask), limit, _CMP_GE_OQ),
+											_mm256_cmp_ps(_mm256_and_ps(ft[1], abs_mask), limit, _CMP_GE_OQ)))) {
+			break;
+		}
+
+		for (n = 0; n < 2; n++) {
+			__m256 frac;
+			__m256i up, sign;
+
+			r[n] = _mm256_cvttps_epi32(ft[n]);
+			frac = _mm256_and_ps(_mm256_sub_ps(ft[n], _mm256_cvtepi32_ps(r[n])), abs_mask);
+			up = _mm256_castps_si256(_mm256_cmp_ps(frac, half, _CMP_GE_OQ));
+			sign = _mm256_or_si256(_mm256_castps_si256(_mm256_cmp_ps(ft[n], _mm256_setzero_ps(), _CMP_LT_OQ)), one);
+			r[n] = _mm256_add_epi32(r[n], _mm256_and_si256(up, sign));
+			r[n] = _mm256_srai_epi32(_mm256_slli_epi32(r[n], 16), 16);
+		}
+
+		v = _mm256_permute4x64_epi64(_mm256_packs_epi32(r[0], r[1]), 0xd8);
+		clip = _mm256_cmpeq_epi16(v, smin);
+		v = _mm256_blendv_epi8(v, sclip, clip);
+		_mm256_storeu_si256((__m256i *) (s + i), v);
+	}
+
+	return i;
+}
+
+SWITCH_TARGET_AVX2 static uint32_t accumulate_sln_avx2(int32_t *acc, const int16_t *data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (data + i)));
+		__m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (data + i + 8)));
+		_mm256_storeu_si256((__m256i *) (acc + i), _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (acc + i)), lo));
+		_mm256_storeu_si256((__m256i *) (acc + i + 8), _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (acc + i + 8)), hi));
+	}
+
+	return i;
+}
+
+SWITCH_TARGET_AVX2 static uint32_t mix_minus_sln_avx2(int16_t *data, const int32_t *acc, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m256i lo = _mm256_loadu_si256((const __m256i *) (acc + i));
+		__m256i hi = _mm256_loadu_si256((const __m256i *) (acc + i + 8));
+
+		if (other_data) {
+			lo = _mm256_sub_epi32(lo, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (other_data + i))));
+			hi = _mm256_sub_epi32(hi, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (other_data + i + 8))));
+		}
+
+		/* packs works per 128 bit lane, put the quadwords back in order */
+		_mm256_storeu_si256((__m256i *) (data + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8));
+	}
+
+	return i;
+}
+#endif
+
+#ifdef SWITCH_HAVE_NEON
+static uint32_t merge_sln_neon(int16_t *data, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		vst1q_s16(data + i, vqaddq_s16(vld1q_s16(data + i), vld1q_s16(other_data + i)));
+	}
+
+	return i;
+}
+
+static uint32_t unmerge_sln_neon(int16_t *data, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		vst1q_s16(data + i, vsubq_s16(vld1q_s16(data + i), vld1q_s16(other_data + i)));
+	}
+
+	return i;
+}
+
+static uint32_t mux_stereo_to_mono_neon(int16_t *data, uint32_t samples)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= samples; i += 8) {
+		int16x8x2_t v = vld2q_s16(data + i * 2);
+		vst1q_s16(data + i, vqaddq_s16(v.val[0], v.val[1]));
+	}
+
+	return i;
+}
+
+static uint32_t mux_mono_to_stereo_neon(int16_t *data, uint32_t samples)
+{
+	uint32_t i = samples & ~7U, done = i;
+
+	while (i) {
+		int16x8x2_t out;
+
+		i -= 8;
+		out.val[0] = out.val[1] = vld1q_s16(data + i);
+		vst2q_s16(data + i * 2, out);
+	}
+
+	return done;
+}
+
+static inline int16x4_t change_sln_volume_neon4(int16x4_t v, float64x2_t vrate)
+{
+	int32x4_t w = vmovl_s16(v);
+	int64x2_t lo = vcvtq_s64_f64(vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(w))), vrate));
+	int64x2_t hi = vcvtq_s64_f64(vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(w))), vrate));
+
+	return vqmovn_s32(vcombine_s32(vqmovn_s64(lo), vqmovn_s64(hi)));
+}
+
+static uint32_t change_sln_volume_neon(int16_t *data, uint32_t samples, double rate)
+{
+	const float64x2_t vrate = vdupq_n_f64(rate);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= samples; i += 8) {
+		int16x8_t v = vld1q_s16(data + i);
+		vst1q_s16(data + i, vcombine_s16(change_sln_volume_neon4(vget_low_s16(v), vrate), change_sln_volume_neon4(vget_high_s16(v), vrate)));
+	}
+
+	return i;
+}
+
+static uint32_t short_to_float_neon(const short *s, float *f, uint32_t len)
+{
+	const float32x4_t scale = vdupq_n_f32(1.0f / NORMFACT);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		int16x8_t v = vld1q_s16(s + i);
+		vst1q_f32(f + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+		vst1q_f32(f + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+	}
+
+	return i;
+}
+
+static inline int16x4_t float_to_short_neon4(float32x4_t ft)
+{
+	int32x4_t r = vcvtq_s32_f32(ft);
+	float32x4_t frac = vabsq_f32(vsubq_f32(ft, vcvtq_f32_s32(r)));
+	int32x4_t up = vreinterpretq_s32_u32(vcgeq_f32(frac, vdupq_n_f32(0.5f)));
+	int32x4_t sign = vorrq_s32(vreinterpretq_s32_u32(vcltq_f32(ft, vdupq_n_f32(0.0f))), vdupq_n_s32(1));
+
+	/* vmovn keeps the low 16 bits like the scalar cast does */
+	return vmovn_s32(vaddq_s32(r, vandq_s32(up, sign)));
+}
+
+static uint32_t float_to_short_neon(const float *f, short *s, uint32_t len)
+{
+	const float32x4_t limit = vdupq_n_f32(4194304.0f);
+	const int16x8_t smin = vdupq_n_s16(-32768);
+	const int16x8_t sclip = vdupq_n_s16((short) -MAXSAMPLE / 2);
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		float32x4_t a = vmulq_n_f32(vld1q_f32(f + i), NORMFACT);
+		float32x4_t b = vmulq_n_f32(vld1q_f32(f + i + 4), NORMFACT);
+		int16x8_t v;
+
+		if (vmaxvq_u32(vorrq_u32(vcageq_f32(a, limit), vcageq_f32(b, limit)))) {
+			break;
+		}
+
+		v = vcombine_s16(float_to_short_neon4(a), float_to_short_neon4(b));
+		vst1q_s16(s + i, vbslq_s16(vceqq_s16(v, smin), sclip, v));
+	}
+
+	return i;
+}
+
+/* exact truncating x / d, see div_trunc_sse2 */
+static inline int32x4_t div_trunc_neon(int32x4_t x, float32x4_t vd, float32x4_t vrcp)
+{
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const uint32x4_t one = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+	float32x4_t xf = vcvtq_f32_s32(x);
+	float32x4_t qf = vcvtq_f32_s32(vcvtq_s32_f32(vmulq_f32(xf, vrcp)));
+	float32x4_t rf = vsubq_f32(xf, vmulq_f32(qf, vd));
+	uint32x4_t pos = vcgeq_f32(xf, zero);
+	uint32x4_t dec = vbslq_u32(pos, vcltq_f32(rf, zero), vcleq_f32(rf, vnegq_f32(vd)));
+	uint32x4_t inc = vbslq_u32(pos, vcgeq_f32(rf, vd), vcgtq_f32(rf, zero));
+
+	qf = vsubq_f32(qf, vreinterpretq_f32_u32(vandq_u32(dec, one)));
+	qf = vaddq_f32(qf, vreinterpretq_f32_u32(vandq_u32(inc, one)));
+
+	return vcvtq_s32_f32(qf);
+}
+
+static uint32_t generate_sln_silence_neon(int16_t *data, uint32_t samples, uint32_t channels, uint32_t divisor, int16_t *rnd)
+{
+	uint16_t x = (uint16_t) *rnd, a43 = 1, c43 = 0;
+	int16_t lanes[8];
+	int16x8_t v, last, va, vc, va43, vc43;
+	float32x4_t vdiv, vrcp;
+	uint32_t i, j, k;
+
+	if (samples < 8 || (channels != 1 && channels != 2) || divisor > 32768) {
+		return 0;
+	}
+
+	for (k = 0; k < 8; k++) {
+		x = (uint16_t) (x * 31821U + 13849U);
+		lanes[k] = (int16_t) x;
+
+		for (j = 0; j < 5; j++) {
+			x = (uint16_t) (x * 31821U + 13849U);
+		}
+	}
+
+	for (k = 0; k < 43; k++) {
+		c43 = (uint16_t) (31821U * c43 + 13849U);
+		a43 = (uint16_t) (31821U * a43);
+	}
+
+	va = vdupq_n_s16((int16_t) 31821);
+	vc = vdupq_n_s16((int16_t) 13849);
+	va43 = vdupq_n_s16((int16_t) a43);
+	vc43 = vdupq_n_s16((int16_t) c43);
+	vdiv = vdupq_n_f32((float) divisor);
+	vrcp = vdupq_n_f32((float) (1.0 / divisor));
+	v = vld1q_s16(lanes);
+	last = v;
+
+	for (i = 0; i + 8 <= samples; i += 8) {
+		int16x8_t sum = v, out;
+		int32x4_t lo, hi;
+
+		for (j = 0; j < 5; j++) {
+			v = vmlaq_s16(vc, v, va);
+			sum = vaddq_s16(sum, v);
+		}
+
+		lo = div_trunc_neon(vmovl_s16(vget_low_s16(sum)), vdiv, vrcp);
+		hi = div_trunc_neon(vmovl_s16(vget_high_s16(sum)), vdiv, vrcp);
+		out = vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+
+		if (channels == 1) {
+			vst1q_s16(data + i, out);
+		} else {
+			int16x8x2_t st;
+			st.val[0] = st.val[1] = out;
+			vst2q_s16(data + i * 2, st);
+		}
+
+		last = v;
+		v = vmlaq_s16(vc43, v, va43);
+	}
+
+	*rnd = vgetq_lane_s16(last, 7);
+
+	return i;
+}
+
+static uint32_t accumulate_sln_neon(int32_t *acc, const int16_t *data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		int16x8_t v = vld1q_s16(data + i);
+		vst1q_s32(acc + i, vaddw_s16(vld1q_s32(acc + i), vget_low_s16(v)));
+		vst1q_s32(acc + i + 4, vaddw_s16(vld1q_s32(acc + i + 4), vget_high_s16(v)));
+	}
+
+	return i;
+}
+
+static uint32_t mix_minus_sln_neon(int16_t *data, const int32_t *acc, const int16_t *other_data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		int32x4_t lo = vld1q_s32(acc + i);
+		int32x4_t hi = vld1q_s32(acc + i + 4);
+
+		if (other_data) {
+			int16x8_t v = vld1q_s16(other_data + i);
+			lo = vsubw_s16(lo, vget_low_s16(v));
+			hi = vsubw_s16(hi, vget_high_s16(v));
+		}
+
+		vst1q_s16(data + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+	}
+
+	return i;
+}
+#endif
+
+static inline uint32_t merge_sln_simd(int16_t *data, const int16_t *other_data, uint32_t len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return merge_sln_avx2(data, other_data, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return merge_sln_sse2(data, other_data, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return merge_sln_neon(data, other_data, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline uint32_t unmerge_sln_simd(int16_t *data, const int16_t *other_data, uint32_t len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return unmerge_sln_avx2(data, other_data, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return unmerge_sln_sse2(data, other_data, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return unmerge_sln_neon(data, other_data, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline uint32_t accumulate_sln_simd(int32_t *acc, const int16_t *data, uint32_t len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return accumulate_sln_avx2(acc, data, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return accumulate_sln_sse2(acc, data, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return accumulate_sln_neon(acc, data, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline uint32_t mix_minus_sln_simd(int16_t *data, const int32_t *acc, const int16_t *other_data, uint32_t len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return mix_minus_sln_avx2(data, acc, other_data, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return mix_minus_sln_sse2(data, acc, other_data, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return mix_minus_sln_neon(data, acc, other_data, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline uint32_t mux_stereo_to_mono_simd(int16_t *data, uint32_t samples)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return mux_stereo_to_mono_avx2(data, samples);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return mux_stereo_to_mono_sse2(data, samples);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return mux_stereo_to_mono_neon(data, samples);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline uint32_t mux_mono_to_stereo_simd(int16_t *data, uint32_t samples)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+	uint32_t i, done = samples & ~7U;
+
+	if (!(simd & (SWITCH_SIMD_SSE2 | SWITCH_SIMD_NEON))) {
+		return 0;
+	}
+
+	/* the tail goes first, the vector part writes over where it lives */
+	for (i = samples; i > done; i--) {
+		data[(i - 1) * 2] = data[(i - 1) * 2 + 1] = data[i - 1];
+	}
+
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) {
+		mux_mono_to_stereo_sse2(data, done);
+		return samples;
+	}
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) {
+		mux_mono_to_stereo_neon(data, done);
+		return samples;
+	}
+#endif
+
+	return 0;
+}
+
+static inline uint32_t change_sln_volume_simd(int16_t *data, uint32_t samples, double rate)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return change_sln_volume_avx2(data, samples, rate);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return change_sln_volume_sse2(data, samples, rate);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return change_sln_volume_neon(data, samples, rate);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline uint32_t short_to_float_simd(const short *s, float *f, uint32_t len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return short_to_float_avx2(s, f, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return short_to_float_sse2(s, f, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return short_to_float_neon(s, f, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline uint32_t float_to_short_simd(const float *f, short *s, uint32_t len)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_AVX2
+	if ((simd & SWITCH_SIMD_AVX2)) return float_to_short_avx2(f, s, len);
+#endif
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return float_to_short_sse2(f, s, len);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return float_to_short_neon(f, s, len);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+static inline uint32_t generate_sln_silence_simd(int16_t *data, uint32_t samples, uint32_t channels, uint32_t divisor, int16_t *rnd)
+{
+	switch_simd_flag_t simd = switch_simd_flags();
+
+#ifdef SWITCH_HAVE_SSE2
+	if ((simd & SWITCH_SIMD_SSE2)) return generate_sln_silence_sse2(data, samples, channels, divisor, rnd);
+#endif
+#ifdef SWITCH_HAVE_NEON
+	if ((simd & SWITCH_SIMD_NEON)) return generate_sln_silence_neon(data, samples, channels, divisor, rnd);
+#endif
+
+	(void) simd;
+	return 0;
+}
+
+/* Integer ratio filters.
+ *
+ * 8k, 16k, 24k, 32k and 48k are related by small integer factors, for those the generic speex
+ * filter is replaced by a windowed sinc FIR run in polyphase form: interpolating by L computes
+ * each output phase from taps input samples, decimating by M only computes every M-th output.
+ * Coefficients are Q14 so a dot product fits in 32 bits, the vector dot products are bit exact
+ * with the scalar one.
+ */
+struct switch_resample_fir_s {
+	/* interpolation factor, 1 when decimating */
+	uint32_t up;
+	/* decimation factor, 1 when interpolating */
+	uint32_t down;
+	/* length of each dot product, a multiple of 16 */
+	uint32_t taps;
+	/* decimation: input samples to consume before the next output */
+	uint32_t skip;
+	/* up phases of taps coefficients each, time reversed */
+	int16_t *coef;
+	/* taps - 1 samples of history per channel */
+	int16_t *hist;
+	/* history plus the current input of one channel */
+	int16_t *work;
+	uint32_t work_len;
+};
+
+static double resample_bessel_i0(double x)
+{
+	double sum = 1, term = 1;
+	int k;
+
+	for (k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+
+	return sum;
+}
+
+/* the integer ratio between the rates when the filters here can do it, 0 otherwise */
+static uint32_t resample_fir_ratio(uint32_t from_rate, uint32_t to_rate)
+{
+	uint32_t hi = MAX(from_rate, to_rate), lo = MIN(from_rate, to_rate);
+
+	if (!lo || hi == lo || hi % lo) {
+		return 0;
+	}
+
+	switch (hi / lo) {
+	case 2:
+	case 3:
+	case 4:
+	case 6:
+		return hi / lo;
+	default:
+		return 0;
+	}
+}
+
+static struct switch_resample_fir_s *resample_fir_create(uint32_t from_rate, uint32_t to_rate, int quality, uint32_t channels)
+{
+	struct switch_resample_fir_s *fir;
+	uint32_t ratio = resample_fir_ratio(from_rate, to_rate), phases, plen, p, j;
+	uint32_t per_phase = quality > 5 ? 32 : 16;
+	double beta = quality > 5 ? 8.0 : 6.0;
+	double fc, c, *proto;
+
+	if (!ratio) {
+		return NULL;
+	}
+
+	switch_zmalloc(fir, sizeof(*fir));
+
+	if (to_rate > from_rate) {
+		fir->up = ratio;
+		fir->down = 1;
+		fir->taps = per_phase;
+		phases = ratio;
+	} else {
+		fir->up = 1;
+		fir->down = ratio;
+		fir->taps = per_phase * ratio;
+		fir->skip = ratio - 1;
+		phases = 1;
+	}
+
+	/* cut off a little below the lower nyquist, the prototype runs at the higher rate */
+	plen = per_phase * ratio;
+	fc = 0.5 / ratio * 0.9;
+	c = (plen - 1) / 2.0;
+	switch_malloc(proto, plen * sizeof(double));
+
+	for (j = 0; j < plen; j++) {
+		double t = j - c, r = 2.0 * j / (plen - 1) - 1.0;
+		double sinc = fabs(t) < 1e-9 ? 2 * fc : sin(2 * M_PI * fc * t) / (M_PI * t);
+
+		proto[j] = sinc * resample_bessel_i0(beta * sqrt(1.0 - r * r)) / resample_bessel_i0(beta);
+	}
+
+	fir->coef = malloc(phases * fir->taps * sizeof(int16_t));
+	switch_assert(fir->coef);
+
+	/* every phase gets unity gain at DC */
+	for (p = 0; p < phases; p++) {
+		double sum = 0;
+
+		for (j = 0; j < fir->taps; j++) {
+			sum += proto[(fir->taps - 1 - j) * phases + p];
+		}
+
+		for (j = 0; j < fir->taps; j++) {
+			fir->coef[p * fir->taps + j] = (int16_t) floor(proto[(fir->taps - 1 - j) * phases + p] / sum * 16384.0 + 0.5);
+		}
+	}
+
+	free(proto);
+
+	fir->hist = calloc(channels * (fir->taps - 1), sizeof(int16_t));
+	switch_assert(fir->hist);
+
+	return fir;
+}
+
+static void resample_fir_reset(struct switch_resample_fir_s *fir, uint32_t channels)
+{
+	memset(fir->hist, 0, channels * (fir->taps - 1) * sizeof(int16_t));
+	fir->skip = fir->down - 1;
+}
+
+static void resample_fir_destroy(struct switch_resample_fir_s **fir)
+{
+	if (fir && *fir) {
+		free((*fir)->coef);
+		free((*fir)->hist);
+		free((*fir)->work);
+		free(*fir);
+		*fir = NULL;
+	}
+}
+
+static inline int16_t resample_fir_round(int32_t acc)
+{
+	acc = (acc + (1 << 13)) >> 14;
+	switch_normalize_to_16bit(acc);
+	return (int16_t) acc;
+}
+
+static inline int32_t resample_fir_dot(const int16_t *x, const int16_t *c, uint32_t n)
+{
+	int32_t acc = 0;
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		acc += x[i] * c[i];
+	}
+
+	return acc;
+}
+
+static void resample_fir_interp(int16_t *out, uint32_t stride, const int16_t *w, uint32_t n, const int16_t *coef, uint32_t up, uint32_t taps)
+{
+	uint32_t i, p;
+
+	for (i = 0; i < n; i++) {
+		for (p = 0; p < up; p++, out += stride) {
+			*out = resample_fir_round(resample_fir_dot(w + i, coef + p * taps, taps));
+		}
+	}
+}
+
+static void resample_fir_decim(int16_t *out, uint32_t stride, const int16_t *w, uint32_t count, uint32_t first, const int16_t *coef, uint32_t down, uint32_t taps)
+{
+	uint32_t j;
+
+	for (j = 0; j < count; j++, out += stride) {
+		*out = resample_fir_round(resample_fir_dot(w + first + j * down, coef, taps));
+	}
+}
+
+#ifdef SWITCH_HAVE_SSE2
+static inline int32_t resample_fir_dot_sse2(const int16_t *x, const int16_t *c, uint32_t n)
+{
+	__m128i acc = _mm_setzero_si128();
+	uint32_t i;
+
+	for (i = 0; i < n; i += 8) {
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (x + i)), _mm_loadu_si128((const __m128i *) (c + i))));
+	}
+
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+	return _mm_cvtsi128_si32(acc);
+}
+
+static void resample_fir_interp_sse2(int16_t *out, uint32_t stride, const int16_t *w, uint32_t n, const int16_t *coef, uint32_t up, uint32_t taps)
+{
+	uint32_t i, p;
+
+	for (i = 0; i < n; i++) {
+		for (p = 0; p < up; p++, out += stride) {
+			*out = resample_fir_round(resample_fir_dot_sse2(w + i, coef + p * taps, taps));
+		}
+	}
+}
+
+static void resample_fir_decim_sse2(int16_t *out, uint32_t stride, const int16_t *w, uint32_t count, uint32_t first, const int16_t *coef, uint32_t down, uint32_t taps)
+{
+	uint32_t j;
+
+	for (j = 0; j < count; j++, out += stride) {
+		*out = resample_fir_round(resample_fir_dot_sse2(w + first + j * down, coef, taps));
+	}
+}
+#endif
+
+#ifdef SWITCH_HAVE_AVX2
+static inline SWITCH_TARGET_AVX2 int32_t resample_fir_dot_avx2(const int16_t *x, const int16_t *c, uint32_t n)
+{
+	__m256i acc = _mm256_setzero_si256();
+	__m128i sum;
+	uint32_t i;
+
+	for (i = 0; i < n; i += 16) {
+		acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *) (x + i)), _mm256_loadu_si256((const __m256i *) (c + i))));
+	}
+
+	sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+	return _mm_cvtsi128_si32(sum);
+}
+
+static SWITCH_TARGET_AVX2 void resample_fir_interp_avx2(int16_t *out, uint32_t stride, const int16_t *w, uint32_t n, const int16_t *coef, uint32_t up, uint32_t taps)
+{
+	uint32_t i, p;
+
+	for (i = 0; i < n; i++) {
+		for (p = 0; p < up; p++, out += stride) {
+			*out = resample_fir_round(resample_fir_dot_avx2(w + i, coef + p * taps, taps));
+		}
+	}
+}
+
+static SWITCH_TARGET_AVX2 void resample_fir_decim_avx2(int16_t *out, uint32_t stride, const int16_t *w, uint32_t count, uint32_t first, const int16_t *coef, uint32_t down, uint32_t taps)
+{
+	uint32_t j;
+
+	for (j = 0; j < count; j++, out += stride) {
+		*out = resample_fir_round(resample_fir_dot_avx2(w + first + j * down, coef, taps));
+	}
+}
+#endif
+
+#ifdef SWITCH_HAVE_NEON
+static inline int32_t resample_fir_dot_neon(const int16_t *x, const int16_t *c, uint32_t n)
+{
+	int32x4_t acc = vdupq_n_s32(0);
+	uint32_t i;
+
+	for (i = 0; i < n; i += 8) {
+		int16x8_t a = vld1q_s16(x + i), b = vld1q_s16(c + i);
+		acc = vmlal_s16(acc, vget_low_s16(a), vget_low_s16(b));
+		acc = vmlal_s16(acc, vget_high_s16(a), vget_high_s16(b));
+	}
+
+	return vaddvq_s32(acc);
+}
+
+static void resample_fir_interp_neon(int16_t *out, uint32_t stride, const int16_t *w, uint32_t n, const int16_t *coef, uint32_t up, uint32_t taps)
+{
+	uint32_t i, p;
+
+	for (i = 0; i < n; i++) {
+		for (p = 0; p < up; p++, out += stride) {
+			*out = resample_fir_round(resample_fir_dot_neon(w + i, coef + p * taps, taps));
+		}
+	}
+}
+
+static void resample_fir_decim_neon(int16_t *out, uint32_t stride, const int16_t *w, uint32_t count, uint32_t first, const int16_t *coef, uint32_t down, uint32_t taps)
+{
+	uint32_t j;
+
+	for (j = 0; j < count; j++, out += stride) {
+		*out = resample_fir_round(resample_fir_dot_neon(w + first + j * down, coef, taps));
+	}
+}
+#endif
+
+static uint32_t resample_fir_process(switch_audio_resampler_t *resampler, const int16_t *src, uint32_t srclen)
+{
+	struct switch_resample_fir_s *fir = resampler->fir;
+	uint32_t channels = resampler->channels, hlen = fir->taps - 1;
+	uint32_t ch, i, count = 0;
+	switch_simd_flag_t simd = switch_simd_flags();
+
+	if (fir->work_len < hlen + srclen) {
+		fir->work_len = hlen + srclen;
+		fir->work = realloc(fir->work, fir->work_len * sizeof(int16_t));
+		switch_assert(fir->work);
+	}
+
+	if (fir->down > 1) {
+		count = fir->skip < srclen ? (srclen - 1 - fir->skip) / fir->down + 1 : 0;
+	}
+
+	for (ch = 0; ch < channels; ch++) {
+		int16_t *hist = fir->hist + ch * hlen;
+		int16_t *out = resampler->to + ch;
+
+		memcpy(fir->work, hist, hlen * sizeof(int16_t));
+		for (i = 0; i < srclen; i++) {
+			fir->work[hlen + i] = src[i * channels + ch];
+		}
+
+		if (fir->up > 1) {
+#ifdef SWITCH_HAVE_AVX2
+			if ((simd & SWITCH_SIMD_AVX2)) resample_fir_interp_avx2(out, channels, fir->work, srclen, fir->coef, fir->up, fir->taps);
+			else
+#endif
+#ifdef SWITCH_HAVE_SSE2
+			if ((simd & SWITCH_SIMD_SSE2)) resample_fir_interp_sse2(out, channels, fir->work, srclen, fir->coef, fir->up, fir->taps);
+			else
+#endif
+#ifdef SWITCH_HAVE_NEON
+			if ((simd & SWITCH_SIMD_NEON)) resample_fir_interp_neon(out, channels, fir->work, srclen, fir->coef, fir->up, fir->taps);
+			else
+#endif
+			resample_fir_interp(out, channels, fir->work, srclen, fir->coef, fir->up, fir->taps);
+		} else {
+#ifdef SWITCH_HAVE_AVX2
+			if ((simd & SWITCH_SIMD_AVX2)) resample_fir_decim_avx2(out, channels, fir->work, count, fir->skip, fir->coef, fir->down, fir->taps);
+			else
+#endif
+#ifdef SWITCH_HAVE_SSE2
+			if ((simd & SWITCH_SIMD_SSE2)) resample_fir_decim_sse2(out, channels, fir->work, count, fir->skip, fir->coef, fir->down, fir->taps);
+			else
+#endif
+#ifdef SWITCH_HAVE_NEON
+			if ((simd & SWITCH_SIMD_NEON)) resample_fir_decim_neon(out, channels, fir->work, count, fir->skip, fir->coef, fir->down, fir->taps);
+			else
+#endif
+			resample_fir_decim(out, channels, fir->work, count, fir->skip, fir->coef, fir->down, fir->taps);
+		}
+
+		memcpy(hist, fir->work + srclen, hlen * sizeof(int16_t));
+	}
+
+	(void) simd;
+
+	if (fir->up > 1) {
+		return srclen * fir->up;
+	}
+
+	fir->skip = fir->skip + count * fir->down - srclen;
+	return count;
+}
+
+/* Resampler pool.
+ *
+ * Handles are created and destroyed with every session, media bug and file handle that changes
+ * rate, and there are only a handful of distinct (from, to, channels, quality) combinations in
+ * use.  Destroyed handles are reset and parked here so the next create can skip the filter setup
+ * and the buffer allocations.
+ */
+#define RESAMPLE_POOL_MAX 64
+
+static struct {
+	switch_mutex_t *mutex;
+	switch_audio_resampler_t *idle[RESAMPLE_POOL_MAX];
+	int idle_count;
+	switch_bool_t fast_ratios;
+} resample_pool = { NULL, { 0 }, 0, SWITCH_TRUE };
+
+static void resample_free(switch_audio_resampler_t *resampler)
+{
+	if (resampler->resampler) {
+		speex_resampler_destroy(resampler->resampler);
+	}
+	resample_fir_destroy(&resampler->fir);
+	free(resampler->to);
+	free(resampler);
+}
+
+static switch_audio_resampler_t *resample_pool_get(uint32_t from_rate, uint32_t to_rate, int quality, uint32_t channels)
+{
+	switch_audio_resampler_t *resampler = NULL;
+	int i;
+
+	if (!resample_pool.mutex) {
+		return NULL;
+	}
+
+	switch_mutex_lock(resample_pool.mutex);
+	for (i = resample_pool.idle_count - 1; i >= 0; i--) {
+		switch_audio_resampler_t *r = resample_pool.idle[i];
+
+		if ((uint32_t) r->from_rate == from_rate && (uint32_t) r->to_rate == to_rate && r->quality == quality &&
+			(uint32_t) r->channels == channels && (r->fir != NULL) == (resample_pool.fast_ratios && !!resample_fir_ratio(from_rate, to_rate))) {
+			resampler = r;
+			resample_pool.idle[i] = resample_pool.idle[--resample_pool.idle_count];
+			break;
+		}
+	}
+	switch_mutex_unlock(resample_pool.mutex);
+
+	return resampler;
+}
+
+static switch_bool_t resample_pool_put(switch_audio_resampler_t *resampler)
+{
+	switch_bool_t parked = SWITCH_FALSE;
+
+	if (!resample_pool.mutex) {
+		return SWITCH_FALSE;
+	}
+
+	switch_mutex_lock(resample_pool.mutex);
+	if (resample_pool.idle_count < RESAMPLE_POOL_MAX) {
+		resample_pool.idle[resample_pool.idle_count++] = resampler;
+		parked = SWITCH_TRUE;
+	}
+	switch_mutex_unlock(resample_pool.mutex);
+
+	return parked;
+}
+
+void switch_resample_pool_init(switch_memory_pool_t *pool)
+{
+	switch_mutex_init(&resample_pool.mutex, SWITCH_MUTEX_NESTED, pool);
+}
+
+void switch_resample_pool_destroy(void)
+{
+	switch_mutex_t *mutex = resample_pool.mutex;
+	int i;
+
+	if (!mutex) {
+		return;
+	}
+
+	switch_mutex_lock(mutex);
+	for (i = 0; i < resample_pool.idle_count; i++) {
+		resample_free(resample_pool.idle[i]);
+	}
+	resample_pool.idle_count = 0;
+	resample_pool.mutex = NULL;
+	switch_mutex_unlock(mutex);
+}
+
+SWITCH_DECLARE(void) switch_resample_set_fast_ratios(switch_bool_t enabled)
+{
+	resample_pool.fast_ratios = enabled;
+}
+
 SWITCH_DECLARE(switch_status_t) switch_resample_perform_create(switch_audio_resampler_t **new_resampler,
 															   uint32_t from_rate, uint32_t to_rate,
 															   uint32_t to_size,
@@ -60,16 +1357,42 @@ SWITCH_DECLARE(switch_status_t) switch_resample_perform_create(switch_audio_resa
 	int err = 0;
 	switch_audio_resampler_t *resampler;
 	double lto_rate, lfrom_rate;
+	uint32_t new_size;
+
+	if (!channels) channels = 1;
+
+	new_size = switch_resample_calc_buffer_size(to_rate, from_rate, to_size) / 2;
+
+	if ((resampler = resample_pool_get(from_rate, to_rate, quality, channels))) {
+		if (resampler->fir) {
+			resample_fir_reset(resampler->fir, channels);
+		} else {
+			speex_resampler_reset_mem(resampler->resampler);
+		}
+
+		if (new_size > resampler->to_size) {
+			resampler->to_size = new_size;
+			resampler->to = realloc(resampler->to, resampler->to_size * sizeof(int16_t) * resampler->channels);
+			switch_assert(resampler->to);
+		}
+
+		*new_resampler = resampler;
+		return SWITCH_STATUS_SUCCESS;
+	}
 
 	switch_zmalloc(resampler, sizeof(*resampler));
 
-	if (!channels) channels = 1;
+	if (resample_pool.fast_ratios) {
+		resampler->fir = resample_fir_create(from_rate, to_rate, quality, channels);
+	}
 
-	resampler->resampler = speex_resampler_init(channels, from_rate, to_rate, quality, &err);
+	if (!resampler->fir) {
+		resampler->resampler = speex_resampler_init(channels, from_rate, to_rate, quality, &err);
 
-	if (!resampler->resampler) {
-		free(resampler);
-		return SWITCH_STATUS_GENERR;
+		if (!resampler->resampler) {
+			free(resampler);
+			return SWITCH_STATUS_GENERR;
+		}
 	}
 
 	*new_resampler = resampler;
@@ -80,10 +1403,11 @@ SWITCH_DECLARE(switch_status_t) switch_resample_perform_create(switch_audio_resa
 	resampler->factor = (lto_rate / lfrom_rate);
 	resampler->rfactor = (lfrom_rate / lto_rate);
 	resampler->channels = channels;
+	resampler->quality = quality;
 
 	//resampler->to_size = resample_buffer(to_rate, from_rate, (uint32_t) to_size);
 
-	resampler->to_size = switch_resample_calc_buffer_size(resampler->to_rate, resampler->from_rate, to_size) / 2;
+	resampler->to_size = new_size;
 	resampler->to = malloc(resampler->to_size * sizeof(int16_t) * resampler->channels);
 	switch_assert(resampler->to);
 
@@ -94,12 +1418,22 @@ SWITCH_DECLARE(uint32_t) switch_resample_process(switch_audio_resampler_t *resam
 {
 	int to_size = switch_resample_calc_buffer_size(resampler->to_rate, resampler->from_rate, srclen) / 2;
 
+	if (resampler->fir) {
+		/* decimating can produce one more sample than the rounded down ratio */
+		to_size = srclen * resampler->fir->up / resampler->fir->down + 1;
+	}
+
 	if (to_size > resampler->to_size) {
 		resampler->to_size = to_size;
 		resampler->to = realloc(resampler->to, resampler->to_size * sizeof(int16_t) * resampler->channels);
 		switch_assert(resampler->to);
 	}
 
+	if (resampler->fir) {
+		resampler->to_len = resample_fir_process(resampler, src, srclen);
+		return resampler->to_len;
+	}
+
 	resampler->to_len = resampler->to_size;
 	speex_resampler_process_interleaved_int(resampler->resampler, src, &srclen, resampler->to, &resampler->to_len);
 	return resampler->to_len;
@@ -109,11 +1443,9 @@ SWITCH_DECLARE(void) switch_resample_destroy(switch_audio_resampler_t **resample
 {
 
 	if (resampler && *resampler) {
-		if ((*resampler)->resampler) {
-			speex_resampler_destroy((*resampler)->resampler);
+		if (!resample_pool_put(*resampler)) {
+			resample_free(*resampler);
 		}
-		free((*resampler)->to);
-		free(*resampler);
 		*resampler = NULL;
 	}
 }
@@ -122,7 +1454,10 @@ SWITCH_DECLARE(switch_size_t) switch_float_to_short(float *f, short *s, switch_s
 {
 	switch_size_t i;
 	float ft;
-	for (i = 0; i < len; i++) {
+
+	i = float_to_short_simd(f, s, (uint32_t) len);
+
+	for (; i < len; i++) {
 		ft = f[i] * NORMFACT;
 		if (ft >= 0) {
 			s[i] = (short) (ft + 0.5);
@@ -178,7 +1513,9 @@ SWITCH_DECLARE(int) switch_short_to_float(short *s, float *f, int len)
 {
 	int i;
 
-	for (i = 0; i < len; i++) {
+	i = len > 0 ? (int) short_to_float_simd(s, f, (uint32_t) len) : 0;
+
+	for (; i < len; i++) {
 		f[i] = (float) (s[i]) / NORMFACT;
 		/* f[i] = (float) s[i]; */
 	}
@@ -211,7 +1548,10 @@ SWITCH_DECLARE(void) switch_generate_sln_silence(int16_t *data, uint32_t samples
 		return;
 	}
 
-	for (i = 0; i < samples; i++, sum_rnd = 0) {
+	i = generate_sln_silence_simd(data, samples, channels, divisor, &rnd2);
+	data += i * channels;
+
+	for (; i < samples; i++, sum_rnd = 0) {
 		for (x = 0; x < 6; x++) {
 			rnd2 = rnd2 * 31821U + 13849U;
 			sum_rnd += rnd2;
@@ -241,7 +1581,9 @@ SWITCH_DECLARE(uint32_t) switch_merge_sln(int16_t *data, uint32_t samples, int16
 		x = samples;
 	}
 
-	for (i = 0; i < x * channels; i++) {
+	i = (int) merge_sln_simd(data, other_data, x * channels);
+
+	for (; i < x * channels; i++) {
 		z = data[i] + other_data[i];
 		switch_normalize_to_16bit(z);
 		data[i] = (int16_t) z;
@@ -264,13 +1606,41 @@ SWITCH_DECLARE(uint32_t) switch_unmerge_sln(int16_t *data, uint32_t samples, int
 		x = samples;
 	}
 
-	for (i = 0; i < x * channels; i++) {
+	i = (int) unmerge_sln_simd(data, other_data, x * channels);
+
+	for (; i < x * channels; i++) {
 		data[i] -= other_data[i];
 	}
 
 	return x;
 }
 
+SWITCH_DECLARE(void) switch_accumulate_sln(int32_t *acc, const int16_t *data, uint32_t samples)
+{
+	uint32_t i = accumulate_sln_simd(acc, data, samples);
+
+	for (; i < samples; i++) {
+		acc[i] += data[i];
+	}
+}
+
+SWITCH_DECLARE(void) switch_mix_minus_sln(int16_t *data, const int32_t *acc, const int16_t *other_data, uint32_t samples)
+{
+	uint32_t i = mix_minus_sln_simd(data, acc, other_data, samples);
+	int32_t z;
+
+	for (; i < samples; i++) {
+		z = acc[i];
+
+		if (other_data) {
+			z -= other_data[i];
+		}
+
+		switch_normalize_to_16bit(z);
+		data[i] = (int16_t) z;
+	}
+}
+
 SWITCH_DECLARE(void) switch_mux_channels(int16_t *data, switch_size_t samples, uint32_t orig_channels, uint32_t channels)
 {
 	switch_size_t i = 0;
@@ -280,7 +1650,11 @@ SWITCH_DECLARE(void) switch_mux_channels(int16_t *data, switch_size_t samples, u
 
 	if (orig_channels > channels) {
 		if (channels == 1) {
-			for (i = 0; i < samples; i++) {
+			if (orig_channels == 2) {
+				i = mux_stereo_to_mono_simd(data, (uint32_t) samples);
+			}
+
+			for (; i < samples; i++) {
 				int32_t z = 0;
 				for (j = 0; j < orig_channels; j++) {
 					z += (int16_t) data[i * orig_channels + j];
@@ -313,6 +1687,10 @@ SWITCH_DECLARE(void) switch_mux_channels(int16_t *data, switch_size_t samples, u
 #if 1
 		uint32_t k = 0, len = samples * orig_channels;
 
+		if (orig_channels == 1 && channels == 2 && mux_mono_to_stereo_simd(data, (uint32_t) samples) == samples) {
+			return;
+		}
+
 		for (i = 0; i < len; i++) {
 			data[i+len] = data[i];
 		}
@@ -385,7 +1763,9 @@ SWITCH_DECLARE(void) switch_change_sln_volume_granular(int16_t *data, uint32_t s
 		uint32_t x;
 		int16_t *fp = data;
 
-		for (x = 0; x < samples; x++) {
+		x = change_sln_volume_simd(data, samples, newrate);
+
+		for (; x < samples; x++) {
 			tmp = (int32_t) (fp[x] * newrate);
 			switch_normalize_to_16bit(tmp);
 			fp[x] = (int16_t) tmp;
@@ -424,7 +1804,9 @@ SWITCH_DECLARE(void) switch_change_sln_volume(int16_t *data, uint32_t samples, i
 		uint32_t x;
 		int16_t *fp = data;
 
-		for (x = 0; x < samples; x++) {
+		x = change_sln_volume_simd(data, samples, newrate);
+
+		for (; x < samples; x++) {
 			tmp = (int32_t) (fp[x] * newrate);
 			switch_normalize_to_16bit(tmp);
 			fp[x] = (int16_t) tmp;
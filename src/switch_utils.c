@@ -48,6 +48,10 @@
 #include <process.h>
 #endif
 #include "private/switch_core_pvt.h"
+#include <switch_simd.h>
+#if defined(_MSC_VER) && defined(SWITCH_HAVE_AVX2)
+#include <intrin.h>
+#endif
 #define ESCAPE_META '\\'
 #ifdef SWITCH_HAVE_GUMBO
 #include "gumbo.h"
@@ -4791,6 +4795,92 @@ done:
 	return status;
 }
 
+static switch_simd_flag_t simd_cpu_flags = SWITCH_SIMD_NONE;
+static switch_simd_flag_t simd_active_flags = SWITCH_SIMD_NONE;
+static int simd_detected = 0;
+
+static void simd_detect(void)
+{
+	switch_simd_flag_t flags = SWITCH_SIMD_NONE;
+
+	if (simd_detected) {
+		return;
+	}
+
+#ifdef SWITCH_HAVE_SSE2
+	flags |= SWITCH_SIMD_SSE2;
+#endif
+
+#ifdef SWITCH_HAVE_AVX2
+#ifdef _MSC_VER
+	{
+		int info[4] = { 0 };
+
+		__cpuid(info, 0);
+
+		if (info[0] >= 7) {
+			__cpuid(info, 1);
+
+			/* AVX and OSXSAVE, then make sure the OS actually saves the ymm state */
+			if ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6) {
+				__cpuidex(info, 7, 0);
+
+				if (info[1] & (1 << 5)) {
+					flags |= SWITCH_SIMD_AVX2;
+				}
+			}
+		}
+	}
+#else
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2")) {
+		flags |= SWITCH_SIMD_AVX2;
+	}
+#endif
+#endif
+
+#ifdef SWITCH_HAVE_NEON
+	flags |= SWITCH_SIMD_NEON;
+#endif
+
+	simd_cpu_flags = flags;
+	simd_active_flags = flags;
+	simd_detected = 1;
+}
+
+SWITCH_DECLARE(switch_simd_flag_t) switch_simd_cpu_flags(void)
+{
+	simd_detect();
+	return simd_cpu_flags;
+}
+
+SWITCH_DECLARE(switch_simd_flag_t) switch_simd_flags(void)
+{
+	if (!simd_detected) {
+		simd_detect();
+	}
+
+	return simd_active_flags;
+}
+
+SWITCH_DECLARE(switch_simd_flag_t) switch_simd_set_flags(switch_simd_flag_t flags)
+{
+	simd_detect();
+	simd_active_flags = flags & simd_cpu_flags;
+
+	return simd_active_flags;
+}
+
+SWITCH_DECLARE(const char *) switch_simd_flags2str(switch_simd_flag_t flags)
+{
+	static const char *names[] = {
+		"none", "sse2", "avx2", "sse2,avx2", "neon", "sse2,neon", "avx2,neon", "sse2,avx2,neon"
+	};
+
+	return names[flags & (SWITCH_SIMD_SSE2 | SWITCH_SIMD_AVX2 | SWITCH_SIMD_NEON)];
+}
+
 /* For Emacs:
  * Local Variables:
  * mode:c
@@ -50,6 +50,8 @@
 
 #define SLICE_SIZE SWITCH_DEFAULT_VIDEO_SIZE
 #define KEY_FRAME_MIN_FREQ 250000
+#define SPEED_WINDOW_FRAMES 30
+#define ENCODE_HIST_BUCKETS 8
 
 #define CODEC_TYPE_ANY 0
 #define CODEC_TYPE_VP8 8
@@ -64,6 +66,10 @@ typedef struct my_vpx_cfg_s {
 	int noise_sensitivity;
 	int max_intra_bitrate_pct;
 	vp9e_tune_content tune_content;
+	int auto_threads;
+	int row_mt;
+	int speed_budget_pct;
+	int cpuused_max;
 
 	vpx_codec_enc_cfg_t enc_cfg;
 	vpx_codec_dec_cfg_t dec_cfg;
@@ -84,6 +90,10 @@ static void show_config(my_vpx_cfg_t *my_cfg, vpx_codec_enc_cfg_t *cfg)
 	SHOW(my_cfg, noise_sensitivity);
 	SHOW(my_cfg, max_intra_bitrate_pct);
 	SHOW(my_cfg, tune_content);
+	SHOW(my_cfg, auto_threads);
+	SHOW(my_cfg, row_mt);
+	SHOW(my_cfg, speed_budget_pct);
+	SHOW(my_cfg, cpuused_max);
 
 	SHOW(cfg, g_usage);
 	SHOW(cfg, g_threads);
@@ -419,9 +429,32 @@ struct vpx_context {
 	switch_time_t start_time;
 	switch_image_t *patch_img;
 	int16_t picture_id;
+
+	/* speed control and encode time accounting, see encode_time_update() */
+	int cpuused;
+	int cpuused_min;
+	int cpuused_max;
+	int speed_budget_pct;
+	switch_time_t window_start;
+	switch_time_t window_encode_time;
+	int window_frames;
+	uint64_t encoded_frames;
+	switch_time_t encode_time_total;
+	switch_time_t encode_time_max;
+	uint32_t encode_hist[ENCODE_HIST_BUCKETS];
+	struct vpx_context *next_encoder;
 };
 typedef struct vpx_context vpx_context_t;
 
+/* upper bounds in ms of the encode time histogram buckets, the last one takes the rest */
+static const int encode_hist_ms[ENCODE_HIST_BUCKETS - 1] = { 1, 2, 5, 10, 20, 40, 80 };
+
+/* live encoders for "vpx encoders", kept apart from vpx_globals which is cleared on reload */
+static struct {
+	switch_mutex_t *mutex;
+	vpx_context_t *head;
+} vpx_encoders;
+
 #define MAX_PROFILES 100
 
 struct vpx_globals {
@@ -539,6 +572,39 @@ static void parse_codec_specific_profile(my_vpx_cfg_t *my_cfg, const char *codec
 	if (xml) switch_xml_free(xml);
 }
 
+/* encoder threads for auto-threads, more for bigger pictures but always leave a core for the rest */
+static int auto_encoder_threads(unsigned int width, unsigned int height)
+{
+	unsigned int pixels = width * height;
+	int threads = 1, cpus = (int) switch_core_cpu_count() - 1;
+
+	if (pixels >= 1920 * 1080) {
+		threads = 8;
+	} else if (pixels >= 1280 * 720) {
+		threads = 4;
+	} else if (pixels >= 640 * 360) {
+		threads = 2;
+	}
+
+	if (threads > cpus) {
+		threads = cpus > 1 ? cpus : 1;
+	}
+
+	return threads;
+}
+
+static int log2_floor(unsigned int n)
+{
+	int l = 0;
+
+	while (n > 1) {
+		n >>= 1;
+		l++;
+	}
+
+	return l;
+}
+
 static switch_status_t init_encoder(switch_codec_t *codec)
 {
 	vpx_context_t *context = (vpx_context_t *)codec->private_info;
@@ -546,6 +612,7 @@ static switch_status_t init_encoder(switch_codec_t *codec)
 	my_vpx_cfg_t *my_cfg = NULL;
 	vpx_codec_err_t err;
 	char *codec_name = "vp8";
+	int token_parts, tile_columns = 0, row_mt;
 
 	if (context->is_vp9) {
 		codec_name = "vp9";
@@ -610,6 +677,36 @@ static switch_status_t init_encoder(switch_codec_t *codec)
 	config->g_h = context->codec_settings.video.height;
 	config->rc_target_bitrate = context->bandwidth;
 
+	token_parts = my_cfg->token_parts;
+	row_mt = my_cfg->row_mt;
+
+	if (my_cfg->auto_threads) {
+		int threads = auto_encoder_threads(config->g_w, config->g_h);
+
+		config->g_threads = threads;
+
+		/* vp8 splits the tokens one partition per thread, vp9 wants tiles of at least 256 columns */
+		token_parts = log2_floor(threads);
+		if (token_parts > VP8_EIGHT_TOKENPARTITION) token_parts = VP8_EIGHT_TOKENPARTITION;
+
+		tile_columns = log2_floor(threads);
+		if (tile_columns > log2_floor(config->g_w / 256)) tile_columns = log2_floor(config->g_w / 256);
+
+		row_mt = threads > 1;
+	}
+
+	if (!context->cpuused || !my_cfg->speed_budget_pct) {
+		context->cpuused = my_cfg->cpuused;
+	}
+
+	context->cpuused_min = abs(my_cfg->cpuused);
+	context->cpuused_max = my_cfg->cpuused_max ? my_cfg->cpuused_max : context->is_vp9 ? 8 : 16;
+
+	if (context->cpuused_max < context->cpuused_min) {
+		context->cpuused_max = context->cpuused_min;
+	}
+	context->speed_budget_pct = my_cfg->speed_budget_pct;
+
 	if (context->is_vp9) {
 		if (my_cfg->lossless) {
 			config->rc_min_quantizer = 0;
@@ -641,8 +738,8 @@ static switch_status_t init_encoder(switch_codec_t *codec)
 
 		context->encoder_init = 1;
 
-		vpx_codec_control(&context->encoder, VP8E_SET_TOKEN_PARTITIONS, my_cfg->token_parts);
-		vpx_codec_control(&context->encoder, VP8E_SET_CPUUSED, my_cfg->cpuused);
+		vpx_codec_control(&context->encoder, VP8E_SET_TOKEN_PARTITIONS, token_parts);
+		vpx_codec_control(&context->encoder, VP8E_SET_CPUUSED, context->cpuused);
 		vpx_codec_control(&context->encoder, VP8E_SET_STATIC_THRESHOLD, my_cfg->static_thresh);
 
 		if (context->is_vp9) {
@@ -650,6 +747,18 @@ static switch_status_t init_encoder(switch_codec_t *codec)
 				vpx_codec_control(&context->encoder, VP9E_SET_LOSSLESS, 1);
 			}
 
+			if (tile_columns) {
+				vpx_codec_control(&context->encoder, VP9E_SET_TILE_COLUMNS, tile_columns);
+			}
+
+#ifdef VPX_CTRL_VP9E_SET_ROW_MT
+			if (row_mt) {
+				vpx_codec_control(&context->encoder, VP9E_SET_ROW_MT, 1);
+			}
+#else
+			(void) row_mt;
+#endif
+
 			vpx_codec_control(&context->encoder, VP9E_SET_TUNE_CONTENT, my_cfg->tune_content);
 		} else {
 			vpx_codec_control(&context->encoder, VP8E_SET_NOISE_SENSITIVITY, my_cfg->noise_sensitivity);
@@ -697,6 +806,13 @@ static switch_status_t switch_vpx_init(switch_codec_t *codec, switch_codec_flag_
 		codec->fmtp_out = switch_core_strdup(codec->memory_pool, codec->fmtp_in);
 	}
 
+	if (encoding && vpx_encoders.mutex) {
+		switch_mutex_lock(vpx_encoders.mutex);
+		context->next_encoder = vpx_encoders.head;
+		vpx_encoders.head = context;
+		switch_mutex_unlock(vpx_encoders.mutex);
+	}
+
 	context->codec_settings.video.width = 320;
 	context->codec_settings.video.height = 240;
 
@@ -745,6 +861,12 @@ static switch_status_t consume_partition(vpx_context_t *context, switch_frame_t
 
 	key = (context->pkt->data.frame.flags & VPX_FRAME_IS_KEY);
 
+	if (key) {
+		switch_set_flag(frame, SFF_IS_KEYFRAME);
+	} else {
+		switch_clear_flag(frame, SFF_IS_KEYFRAME);
+	}
+
 #if 0
 	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_ERROR, "flags: %x pts: %lld duration:%lu partition_id: %d\n",
 		context->pkt->data.frame.flags, context->pkt->data.frame.pts, context->pkt->data.frame.duration, context->pkt->data.frame.partition_id);
@@ -897,6 +1019,67 @@ static switch_status_t reset_codec_encoder(switch_codec_t *codec)
 	return init_encoder(codec);
 }
 
+/*
+ * Account one encode call and, with speed-budget-pct, steer cpuused so the time spent encoding stays
+ * under that share of the wall clock.  Every SPEED_WINDOW_FRAMES frames the encoder gets one step
+ * faster when it went over budget and one step slower, down to the configured cpuused, when it used
+ * less than half of it.
+ */
+static void encode_time_update(switch_codec_t *codec, switch_time_t start, switch_time_t end)
+{
+	vpx_context_t *context = (vpx_context_t *)codec->private_info;
+	switch_time_t took = end - start, elapsed;
+	int i, load, speed;
+
+	for (i = 0; i < ENCODE_HIST_BUCKETS - 1 && took >= encode_hist_ms[i] * 1000; i++);
+	context->encode_hist[i]++;
+
+	context->encoded_frames++;
+	context->encode_time_total += took;
+
+	if (took > context->encode_time_max) {
+		context->encode_time_max = took;
+	}
+
+	if (!context->speed_budget_pct) {
+		return;
+	}
+
+	if (!context->window_frames++) {
+		context->window_start = start;
+		context->window_encode_time = 0;
+	}
+
+	context->window_encode_time += took;
+
+	if (context->window_frames < SPEED_WINDOW_FRAMES) {
+		return;
+	}
+
+	context->window_frames = 0;
+
+	if ((elapsed = end - context->window_start) <= 0) {
+		return;
+	}
+
+	load = (int) (context->window_encode_time * 100 / elapsed);
+	speed = abs(context->cpuused);
+
+	if (load > context->speed_budget_pct && speed < context->cpuused_max) {
+		speed++;
+	} else if (load < context->speed_budget_pct / 2 && speed > context->cpuused_min) {
+		speed--;
+	} else {
+		return;
+	}
+
+	context->cpuused = context->cpuused < 0 ? -speed : speed;
+	vpx_codec_control(&context->encoder, VP8E_SET_CPUUSED, context->cpuused);
+
+	switch_log_printf(SWITCH_CHANNEL_SESSION_LOG(codec->session), SWITCH_LOG_DEBUG,
+					  "VPX encoder took %d%% of the time, cpuused now %d\n", load, context->cpuused);
+}
+
 static switch_status_t switch_vpx_encode(switch_codec_t *codec, switch_frame_t *frame)
 {
 	vpx_context_t *context = (vpx_context_t *)codec->private_info;
@@ -981,6 +1164,8 @@ static switch_status_t switch_vpx_encode(switch_codec_t *codec, switch_frame_t *
 		return SWITCH_STATUS_FALSE;
 	}
 
+	encode_time_update(codec, now, switch_time_now());
+
 	context->enc_iter = NULL;
 	context->last_ts = frame->timestamp;
 	context->last_ms = now;
@@ -1460,6 +1645,7 @@ static switch_status_t switch_vpx_control(switch_codec_t *codec,
 			if (ctype == SCCT_INT) {
 			} else if (ctype == SCCT_STRING && !zstr(command)) {
 				if (!strcasecmp(command, "VP8E_SET_CPUUSED")) {
+					context->cpuused = *(int *)cmd_arg;
 					vpx_codec_control(&context->encoder, VP8E_SET_CPUUSED, *(int *)cmd_arg);
 				} else if (!strcasecmp(command, "VP8E_SET_TOKEN_PARTITIONS")) {
 					vpx_codec_control(&context->encoder, VP8E_SET_TOKEN_PARTITIONS, *(int *)cmd_arg);
@@ -1490,6 +1676,18 @@ static switch_status_t switch_vpx_destroy(switch_codec_t *codec)
 	vpx_context_t *context = (vpx_context_t *)codec->private_info;
 
 	if (context) {
+		vpx_context_t **cp;
+
+		if (vpx_encoders.mutex) {
+			switch_mutex_lock(vpx_encoders.mutex);
+			for (cp = &vpx_encoders.head; *cp; cp = &(*cp)->next_encoder) {
+				if (*cp == context) {
+					*cp = context->next_encoder;
+					break;
+				}
+			}
+			switch_mutex_unlock(vpx_encoders.mutex);
+		}
 
 		switch_img_free(&context->patch_img);
 
@@ -1792,6 +1990,22 @@ static void parse_profile(my_vpx_cfg_t *my_cfg, switch_xml_t profile, int codec_
 			} else {
 				_VPX_CHECK_MIN_MAX(my_cfg->cpuused, val, -8, 8);
 			}
+		} else if (!strcmp(name, "cpuused-max")) {
+			if (codec_type == CODEC_TYPE_VP8) {
+				_VPX_CHECK_MIN_MAX(my_cfg->cpuused_max, val, 1, 16);
+			} else {
+				_VPX_CHECK_MIN_MAX(my_cfg->cpuused_max, val, 1, 8);
+			}
+		} else if (!strcmp(name, "speed-budget-pct")) {
+			_VPX_CHECK_MIN_MAX(my_cfg->speed_budget_pct, val, 0, 100);
+		} else if (!strcmp(name, "auto-threads")) {
+			my_cfg->auto_threads = switch_true(value);
+		} else if (!strcmp(name, "row-mt")) {
+			if (codec_type == CODEC_TYPE_VP9) {
+				_VPX_CHECK_MIN_MAX(my_cfg->row_mt, val, 0, 1);
+			} else {
+				_VPX_CHECK_ERRDEF_NOTAPPL(my_cfg->row_mt);
+			}
 		} else if (!strcmp(name, "token-parts")) {
 			_VPX_CHECK_MIN_MAX(my_cfg->token_parts, switch_parse_cpu_string(value), VP8_ONE_TOKENPARTITION, VP8_EIGHT_TOKENPARTITION);
 		} else if (!strcmp(name, "static-thresh")) {
@@ -1947,7 +2161,7 @@ static void load_config()
 	}
 }
 
-#define VPX_API_SYNTAX "<reload|debug <on|off>>"
+#define VPX_API_SYNTAX "<reload|debug <on|off>|encoders>"
 SWITCH_STANDARD_API(vpx_api_function)
 {
 	if (session) {
@@ -1996,6 +2210,26 @@ SWITCH_STANDARD_API(vpx_api_function)
 	} else if (!strcasecmp(cmd, "debug off")) {
 		vpx_globals.debug = 0;
 		stream->write_function(stream, "+OK debug off\n");
+	} else if (!strcasecmp(cmd, "encoders")) {
+		vpx_context_t *context;
+		int i;
+
+		switch_mutex_lock(vpx_encoders.mutex);
+		for (context = vpx_encoders.head; context; context = context->next_encoder) {
+			if (!context->encoder_init) continue;
+
+			stream->write_function(stream, "%s %dx%d threads: %d cpuused: %d frames: %" SWITCH_UINT64_T_FMT " avg: %" SWITCH_TIME_T_FMT "us max: %" SWITCH_TIME_T_FMT "us",
+								   context->is_vp9 ? "VP9" : "VP8", context->config.g_w, context->config.g_h, context->config.g_threads, context->cpuused,
+								   context->encoded_frames, context->encoded_frames ? context->encode_time_total / (switch_time_t) context->encoded_frames : 0,
+								   context->encode_time_max);
+
+			for (i = 0; i < ENCODE_HIST_BUCKETS - 1; i++) {
+				stream->write_function(stream, " <%dms: %u", encode_hist_ms[i], context->encode_hist[i]);
+			}
+
+			stream->write_function(stream, " >=%dms: %u\n", encode_hist_ms[ENCODE_HIST_BUCKETS - 2], context->encode_hist[ENCODE_HIST_BUCKETS - 1]);
+		}
+		switch_mutex_unlock(vpx_encoders.mutex);
 	}
 
 	return SWITCH_STATUS_SUCCESS;
@@ -2013,6 +2247,9 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_vpx_load)
 	memset(&vpx_globals, 0, sizeof(struct vpx_globals));
 	load_config();
 
+	memset(&vpx_encoders, 0, sizeof(vpx_encoders));
+	switch_mutex_init(&vpx_encoders.mutex, SWITCH_MUTEX_NESTED, pool);
+
 	/* connect my internal structure to the blank pointer passed to me */
 	*module_interface = switch_loadable_module_create_module_interface(pool, modname);
 
@@ -2030,6 +2267,7 @@ SWITCH_MODULE_LOAD_FUNCTION(mod_vpx_load)
 	switch_console_set_complete("add vpx debug");
 	switch_console_set_complete("add vpx debug on");
 	switch_console_set_complete("add vpx debug off");
+	switch_console_set_complete("add vpx encoders");
 
 	/* indicate that the module should continue to be loaded */
 	return SWITCH_STATUS_SUCCESS;
@@ -0,0 +1,218 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * switch_buffer.c -- tests the single producer single consumer ring
+ *
+ */
+
+#include <switch.h>
+#include <test/switch_test.h>
+
+#define SPSC_FRAME 320
+
+typedef struct {
+	switch_spsc_buffer_t *buffer;
+	uint32_t frames;
+} spsc_job_t;
+
+/* byte `i` of frame `n`, every frame is different and so is every byte within it */
+static uint8_t spsc_byte(uint32_t n, uint32_t i)
+{
+	return (uint8_t) (n * 13 + i * 7);
+}
+
+static void *SWITCH_THREAD_FUNC spsc_producer(switch_thread_t *thread, void *obj)
+{
+	spsc_job_t *job = (spsc_job_t *) obj;
+	uint8_t frame[SPSC_FRAME];
+	uint32_t n, i;
+
+	for (n = 0; n < job->frames; n++) {
+		for (i = 0; i < SPSC_FRAME; i++) {
+			frame[i] = spsc_byte(n, i);
+		}
+
+		while (!switch_spsc_buffer_write(job->buffer, frame, SPSC_FRAME)) {
+			switch_cond_next();
+		}
+	}
+
+	return NULL;
+}
+
+FST_MINCORE_BEGIN("./conf")
+
+FST_SUITE_BEGIN(switch_buffer)
+
+FST_SETUP_BEGIN()
+{
+}
+FST_SETUP_END()
+
+FST_TEARDOWN_BEGIN()
+{
+}
+FST_TEARDOWN_END()
+
+FST_TEST_BEGIN(test_spsc_buffer_wrap)
+{
+	switch_spsc_buffer_t *buffer = NULL;
+	uint8_t in[700], out[700];
+	uint32_t n, i;
+
+	fst_requires(switch_spsc_buffer_create(&buffer, 1000) == SWITCH_STATUS_SUCCESS);
+	fst_check(switch_spsc_buffer_len(buffer) == 1024);
+	fst_check(switch_spsc_buffer_inuse(buffer) == 0);
+	fst_check(switch_spsc_buffer_freespace(buffer) == 1024);
+
+	/* 700 does not divide 1024 so the copies land on every offset of the ring */
+	for (n = 0; n < 100; n++) {
+		for (i = 0; i < sizeof(in); i++) {
+			in[i] = spsc_byte(n, i);
+		}
+
+		fst_requires(switch_spsc_buffer_write(buffer, in, sizeof(in)) == sizeof(in));
+		fst_check(switch_spsc_buffer_inuse(buffer) == sizeof(in));
+
+		/* all or nothing */
+		fst_check(switch_spsc_buffer_write(buffer, in, sizeof(in)) == 0);
+
+		fst_requires(switch_spsc_buffer_read(buffer, out, sizeof(out)) == sizeof(out));
+		fst_xcheck(!memcmp(in, out, sizeof(in)), "read back what was written");
+	}
+
+	fst_check(switch_spsc_buffer_read(buffer, out, sizeof(out)) == 0);
+
+	fst_requires(switch_spsc_buffer_write(buffer, in, 600) == 600);
+	fst_check(switch_spsc_buffer_toss(buffer, 700) == 0);
+	fst_check(switch_spsc_buffer_toss(buffer, 200) == 400);
+	fst_requires(switch_spsc_buffer_read(buffer, out, sizeof(out)) == 400);
+	fst_check(!memcmp(in + 200, out, 400));
+
+	fst_requires(switch_spsc_buffer_write(buffer, NULL, 424) == 424);
+	fst_check(switch_spsc_buffer_freespace(buffer) == 600);
+	switch_spsc_buffer_zero(buffer);
+	fst_check(switch_spsc_buffer_inuse(buffer) == 0);
+	fst_check(switch_spsc_buffer_freespace(buffer) == 1024);
+
+	switch_spsc_buffer_destroy(&buffer);
+	fst_check(buffer == NULL);
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(test_spsc_buffer_threads)
+{
+	spsc_job_t job = { 0 };
+	switch_thread_t *thread;
+	switch_threadattr_t *thd_attr = NULL;
+	switch_status_t st;
+	uint8_t frame[SPSC_FRAME];
+	uint32_t n, i, bad = 0;
+
+	job.frames = 20000;
+	fst_requires(switch_spsc_buffer_create(&job.buffer, SPSC_FRAME * 32) == SWITCH_STATUS_SUCCESS);
+
+	switch_threadattr_create(&thd_attr, fst_pool);
+	fst_requires(switch_thread_create(&thread, thd_attr, spsc_producer, &job, fst_pool) == SWITCH_STATUS_SUCCESS);
+
+	for (n = 0; n < job.frames; n++) {
+		while (switch_spsc_buffer_inuse(job.buffer) < SPSC_FRAME) {
+			switch_cond_next();
+		}
+
+		fst_requires(switch_spsc_buffer_read(job.buffer, frame, SPSC_FRAME) == SPSC_FRAME);
+
+		for (i = 0; i < SPSC_FRAME; i++) {
+			bad += frame[i] != spsc_byte(n, i);
+		}
+	}
+
+	switch_thread_join(&st, thread);
+
+	fst_check(bad == 0);
+	fst_check(switch_spsc_buffer_inuse(job.buffer) == 0);
+
+	switch_spsc_buffer_destroy(&job.buffer);
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(benchmark)
+{
+#ifdef BENCHMARK
+	uint32_t frames = 10000000;
+#else
+	uint32_t frames = 100000;
+#endif
+	switch_buffer_t *buffer = NULL;
+	switch_spsc_buffer_t *ring = NULL;
+	switch_mutex_t *mutex = NULL;
+	uint8_t frame[SPSC_FRAME] = { 0 };
+	switch_time_t start;
+	uint32_t n;
+
+	/* what a media bug did per frame before, and what it does now */
+	switch_mutex_init(&mutex, SWITCH_MUTEX_NESTED, fst_pool);
+	switch_buffer_create_dynamic(&buffer, SPSC_FRAME * 25, SPSC_FRAME * 50, 1024 * 512);
+
+	start = switch_time_now();
+	for (n = 0; n < frames; n++) {
+		switch_mutex_lock(mutex);
+		switch_buffer_write(buffer, frame, SPSC_FRAME);
+		switch_mutex_unlock(mutex);
+
+		/* readers usually lag a frame behind */
+		if (n & 1) {
+			switch_mutex_lock(mutex);
+			switch_buffer_read(buffer, frame, SPSC_FRAME);
+			switch_buffer_read(buffer, frame, SPSC_FRAME);
+			switch_mutex_unlock(mutex);
+		}
+	}
+	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[locked buffer] %u frames: %" SWITCH_TIME_T_FMT "ns per frame\n",
+					  frames, (switch_time_now() - start) * 1000 / frames);
+
+	fst_requires(switch_spsc_buffer_create(&ring, SPSC_FRAME * 100) == SWITCH_STATUS_SUCCESS);
+
+	start = switch_time_now();
+	for (n = 0; n < frames; n++) {
+		switch_spsc_buffer_write(ring, frame, SPSC_FRAME);
+
+		if (n & 1) {
+			switch_spsc_buffer_read(ring, frame, SPSC_FRAME);
+			switch_spsc_buffer_read(ring, frame, SPSC_FRAME);
+		}
+	}
+	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[spsc ring] %u frames: %" SWITCH_TIME_T_FMT "ns per frame\n",
+					  frames, (switch_time_now() - start) * 1000 / frames);
+
+	switch_buffer_destroy(&buffer);
+	switch_spsc_buffer_destroy(&ring);
+}
+FST_TEST_END()
+
+FST_SUITE_END()
+
+FST_MINCORE_END()
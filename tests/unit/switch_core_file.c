@@ -223,6 +223,128 @@ FST_CORE_BEGIN("./conf")
 			unlink(filename);
 		}
 		FST_TEST_END()
+		FST_TEST_BEGIN(test_switch_core_file_cache)
+		{
+			switch_status_t status = SWITCH_STATUS_FALSE;
+			switch_file_handle_t fhw = { 0 };
+			switch_file_handle_t fh = { 0 };
+			static char filename[] = "/tmp/fs_cache_unit_test.wav";
+			int16_t buf[160], first[480], second[480];
+			switch_size_t len, total;
+			int i, pass;
+
+			status = switch_core_file_open(&fhw, filename, 1, 8000, SWITCH_FILE_FLAG_WRITE | SWITCH_FILE_DATA_SHORT, NULL);
+			fst_requires(status == SWITCH_STATUS_SUCCESS);
+
+			for (i = 0; i < 3; i++) {
+				int j;
+
+				for (j = 0; j < 160; j++) {
+					buf[j] = (int16_t) (i * 160 + j);
+				}
+
+				len = 160;
+				switch_core_file_write(&fhw, buf, &len);
+			}
+
+			status = switch_core_file_close(&fhw);
+			fst_check(status == SWITCH_STATUS_SUCCESS);
+
+			switch_core_file_cache_configure(1024 * 1024, 0);
+
+			for (pass = 0; pass < 2; pass++) {
+				int16_t *out = pass ? second : first;
+
+				memset(&fh, 0, sizeof(fh));
+				status = switch_core_file_open(&fh, filename, 1, 8000, SWITCH_FILE_FLAG_READ | SWITCH_FILE_DATA_SHORT, NULL);
+				fst_requires(status == SWITCH_STATUS_SUCCESS);
+
+				if (pass) {
+					fst_check_string_equals(fh.file_interface->interface_name, "core_file_cache");
+				}
+
+				total = 0;
+				len = 160;
+
+				while (total + len <= 480 && switch_core_file_read(&fh, out + total, &len) == SWITCH_STATUS_SUCCESS && len) {
+					total += len;
+					len = 160;
+				}
+
+				/* read to the end so the first pass is stored */
+				len = 160;
+				switch_core_file_read(&fh, buf, &len);
+
+				fst_check(total == 480);
+
+				status = switch_core_file_close(&fh);
+				fst_check(status == SWITCH_STATUS_SUCCESS);
+			}
+
+			fst_check(!memcmp(first, second, sizeof(first)));
+
+			switch_core_file_cache_flush();
+			switch_core_file_cache_configure(0, 0);
+
+			unlink(filename);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(test_switch_core_file_read_ahead)
+		{
+			switch_status_t status = SWITCH_STATUS_FALSE;
+			switch_file_handle_t fhw = { 0 };
+			switch_file_handle_t fh = { 0 };
+			static char filename[] = "/tmp/fs_read_ahead_unit_test.wav";
+			int16_t buf[160];
+			switch_size_t len, total = 0;
+			int i, j, bad = 0;
+
+			status = switch_core_file_open(&fhw, filename, 1, 8000, SWITCH_FILE_FLAG_WRITE | SWITCH_FILE_DATA_SHORT, NULL);
+			fst_requires(status == SWITCH_STATUS_SUCCESS);
+
+			for (i = 0; i < 50; i++) {
+				for (j = 0; j < 160; j++) {
+					buf[j] = (int16_t) (i * 160 + j);
+				}
+
+				len = 160;
+				switch_core_file_write(&fhw, buf, &len);
+			}
+
+			status = switch_core_file_close(&fhw);
+			fst_check(status == SWITCH_STATUS_SUCCESS);
+
+			/* no buffer, nothing to read ahead into */
+			status = switch_core_file_open(&fh, filename, 1, 8000, SWITCH_FILE_FLAG_READ | SWITCH_FILE_DATA_SHORT, NULL);
+			fst_requires(status == SWITCH_STATUS_SUCCESS);
+			fst_check(switch_core_file_read_ahead(&fh) == SWITCH_STATUS_FALSE);
+			switch_core_file_close(&fh);
+
+			memset(&fh, 0, sizeof(fh));
+			fh.pre_buffer_datalen = 4096;
+			status = switch_core_file_open(&fh, filename, 1, 8000, SWITCH_FILE_FLAG_READ | SWITCH_FILE_DATA_SHORT, NULL);
+			fst_requires(status == SWITCH_STATUS_SUCCESS);
+			fst_check(switch_core_file_read_ahead(&fh) == SWITCH_STATUS_SUCCESS);
+			fst_check(fh.samples_in == 0);
+
+			/* reading ahead hands out nothing, the reads that follow still start at the top */
+			len = 160;
+			while (switch_core_file_read(&fh, buf, &len) == SWITCH_STATUS_SUCCESS && len) {
+				for (j = 0; j < (int) len; j++) {
+					bad += buf[j] != (int16_t) (total + j);
+				}
+				total += len;
+				len = 160;
+			}
+
+			fst_check(total == 50 * 160);
+			fst_check(bad == 0);
+
+			switch_core_file_close(&fh);
+			unlink(filename);
+		}
+		FST_TEST_END()
 
 	}
 	FST_SUITE_END()
@@ -0,0 +1,274 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * switch_core_speech.c -- tests the synthesized speech cache
+ *
+ */
+#include <switch.h>
+#include <stdlib.h>
+
+#include <test/switch_test.h>
+
+static switch_status_t tts_open(switch_speech_handle_t *sh, const char *text)
+{
+	switch_speech_flag_t flags = SWITCH_SPEECH_FLAG_NONE;
+	switch_status_t status;
+
+	memset(sh, 0, sizeof(*sh));
+
+	if ((status = switch_core_speech_open(sh, "test", "default", 8000, 20, 1, &flags, NULL)) != SWITCH_STATUS_SUCCESS) {
+		return status;
+	}
+
+	return switch_core_speech_feed_tts(sh, text, &flags);
+}
+
+/* reads one 20ms frame, 0 once the text is over */
+static switch_size_t tts_read_frame(switch_speech_handle_t *sh)
+{
+	switch_speech_flag_t flags = SWITCH_SPEECH_FLAG_BLOCKING;
+	uint8_t buf[320];
+	switch_size_t len = sizeof(buf);
+
+	if (switch_core_speech_read_tts(sh, buf, &len, &flags) != SWITCH_STATUS_SUCCESS) {
+		return 0;
+	}
+
+	return len;
+}
+
+static void tts_close(switch_speech_handle_t *sh)
+{
+	switch_speech_flag_t flags = SWITCH_SPEECH_FLAG_NONE;
+
+	switch_core_speech_close(sh, &flags);
+}
+
+/* speaks text on a new handle of the test engine and returns how many bytes came out */
+static switch_size_t speak(const char *text)
+{
+	switch_speech_handle_t sh;
+	switch_size_t total = 0, len;
+
+	if (tts_open(&sh, text) != SWITCH_STATUS_SUCCESS) {
+		return 0;
+	}
+
+	while ((len = tts_read_frame(&sh))) {
+		total += len;
+	}
+
+	tts_close(&sh);
+
+	return total;
+}
+
+/* one of the counters of the cache status */
+static uint64_t cache_counter(const char *name)
+{
+	switch_stream_handle_t stream = { 0 };
+	size_t len = strlen(name);
+	uint64_t val = 0;
+	char *line;
+
+	SWITCH_STANDARD_STREAM(stream);
+	switch_core_speech_cache_status(&stream);
+
+	for (line = (char *) stream.data; line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+		if (!strncmp(line, name, len) && line[len] == ':') {
+			val = strtoull(line + len + 1, NULL, 10);
+			break;
+		}
+	}
+
+	switch_safe_free(stream.data);
+
+	return val;
+}
+
+FST_CORE_BEGIN("./conf")
+{
+	FST_SUITE_BEGIN(switch_core_speech)
+	{
+		FST_SETUP_BEGIN()
+		{
+			fst_requires_module("mod_test");
+		}
+		FST_SETUP_END()
+
+		FST_TEARDOWN_BEGIN()
+		{
+		}
+		FST_TEARDOWN_END()
+
+		FST_TEST_BEGIN(speech_cache)
+		{
+			switch_stream_handle_t stream = { 0 };
+
+			switch_core_speech_cache_configure(1024 * 1024, NULL);
+
+			fst_check(speak("silence://100") == 1600);
+			fst_check(speak("silence://100") == 1600);
+			fst_check(speak("silence://200") == 3200);
+
+			SWITCH_STANDARD_STREAM(stream);
+			switch_core_speech_cache_status(&stream);
+			fst_check(strstr((char *) stream.data, "hits: 1\n") != NULL);
+			fst_check(strstr((char *) stream.data, "misses: 2\n") != NULL);
+			fst_check(strstr((char *) stream.data, "entries: 2\n") != NULL);
+			switch_safe_free(stream.data);
+
+			switch_core_speech_cache_flush();
+			switch_core_speech_cache_configure(0, NULL);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(speech_cache_followers)
+		{
+			switch_speech_handle_t leader, follower;
+			switch_size_t leader_bytes = 0, follower_bytes = 0, len;
+			uint64_t misses = cache_counter("misses"), coalesced = cache_counter("coalesced");
+
+			switch_core_speech_cache_configure(1024 * 1024, NULL);
+
+			fst_requires(tts_open(&leader, "silence://300") == SWITCH_STATUS_SUCCESS);
+			leader_bytes += tts_read_frame(&leader);
+
+			/* the same text while the first synthesis runs follows it instead of starting another one */
+			fst_requires(tts_open(&follower, "silence://300") == SWITCH_STATUS_SUCCESS);
+
+			while ((len = tts_read_frame(&leader))) {
+				leader_bytes += len;
+				follower_bytes += tts_read_frame(&follower);
+			}
+
+			while ((len = tts_read_frame(&follower))) {
+				follower_bytes += len;
+			}
+
+			fst_check(leader_bytes == 4800);
+			fst_check(follower_bytes == 4800);
+			fst_check(cache_counter("misses") == misses + 1);
+			fst_check(cache_counter("coalesced") == coalesced + 1);
+
+			tts_close(&leader);
+			tts_close(&follower);
+
+			switch_core_speech_cache_flush();
+			switch_core_speech_cache_configure(0, NULL);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(speech_cache_flushed_leader)
+		{
+			switch_speech_handle_t leader, follower;
+			switch_size_t follower_bytes = 0, len;
+			uint64_t hits;
+
+			switch_core_speech_cache_configure(1024 * 1024, NULL);
+
+			fst_requires(tts_open(&leader, "silence://400") == SWITCH_STATUS_SUCCESS);
+			fst_check(tts_read_frame(&leader) == 320);
+			fst_check(tts_read_frame(&leader) == 320);
+
+			fst_requires(tts_open(&follower, "silence://400") == SWITCH_STATUS_SUCCESS);
+			follower_bytes += tts_read_frame(&follower);
+
+			/* the leader gives up, the follower synthesizes on its own and skips what it already played */
+			switch_core_speech_flush_tts(&leader);
+
+			while ((len = tts_read_frame(&follower))) {
+				follower_bytes += len;
+			}
+
+			fst_check(follower_bytes == 6400);
+
+			tts_close(&leader);
+			tts_close(&follower);
+
+			/* nothing of the abandoned synthesis was kept */
+			hits = cache_counter("hits");
+			fst_check(speak("silence://400") == 6400);
+			fst_check(cache_counter("hits") == hits);
+
+			switch_core_speech_cache_flush();
+			switch_core_speech_cache_configure(0, NULL);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(speech_cache_engine_error)
+		{
+			uint64_t hits = cache_counter("hits"), misses = cache_counter("misses");
+
+			switch_core_speech_cache_configure(1024 * 1024, NULL);
+
+			/* the handle still plays what came out, but a text cut short by an error is not cached */
+			fst_check(speak("silence://100 error://") == 1600);
+			fst_check(speak("silence://100 error://") == 1600);
+			fst_check(cache_counter("hits") == hits);
+			fst_check(cache_counter("misses") == misses + 2);
+
+			switch_core_speech_cache_flush();
+			switch_core_speech_cache_configure(0, NULL);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(speech_cache_disk)
+		{
+			const char *dir = switch_core_sprintf(fst_pool, "%s%sspeech_cache_test", SWITCH_GLOBAL_dirs.temp_dir, SWITCH_PATH_SEPARATOR);
+			uint64_t disk_hits = cache_counter("disk-hits");
+			switch_dir_t *dirh;
+
+			switch_core_speech_cache_configure(1024 * 1024, dir);
+
+			fst_check(speak("silence://500") == 8000);
+
+			/* only the copy on disk is left */
+			switch_core_speech_cache_flush();
+			fst_check(speak("silence://500") == 8000);
+			fst_check(cache_counter("disk-hits") == disk_hits + 1);
+
+			switch_core_speech_cache_flush();
+			switch_core_speech_cache_configure(0, NULL);
+
+			if (switch_dir_open(&dirh, dir, fst_pool) == SWITCH_STATUS_SUCCESS) {
+				char buf[256];
+				const char *fname;
+
+				while ((fname = switch_dir_next_file(dirh, buf, sizeof(buf)))) {
+					if (switch_stristr(".tts", fname)) {
+						switch_file_remove(switch_core_sprintf(fst_pool, "%s%s%s", dir, SWITCH_PATH_SEPARATOR, fname), fst_pool);
+					}
+				}
+
+				switch_dir_close(dirh);
+			}
+		}
+		FST_TEST_END()
+	}
+	FST_SUITE_END()
+}
+FST_CORE_END()
@@ -30,10 +30,112 @@
  *
  */
 #include <switch.h>
+#include <switch_simd.h>
 #include <stdlib.h>
 
 #include <test/switch_test.h>
 
+/* deterministic ARGB noise, a_mod picks how often alpha is fully transparent or opaque */
+static switch_image_t *noise_img(int w, int h, uint32_t seed, int a_mod)
+{
+	switch_image_t *img = switch_img_alloc(NULL, SWITCH_IMG_FMT_ARGB, w, h, 1);
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x++) {
+			switch_rgb_color_t *c = (switch_rgb_color_t *) (img->planes[SWITCH_PLANE_PACKED] + y * img->stride[SWITCH_PLANE_PACKED] + x * 4);
+
+			seed = seed * 1103515245 + 12345;
+			c->r = (uint8_t) (seed >> 8);
+			c->g = (uint8_t) (seed >> 16);
+			c->b = (uint8_t) (seed >> 24);
+			seed = seed * 1103515245 + 12345;
+			c->a = (uint8_t) (seed >> 16);
+
+			if (a_mod && (seed >> 24) % a_mod == 0) {
+				c->a = (seed & 0x100) ? 255 : 0;
+			}
+
+			/* runs of a green screen like color so the chromakey has something to find */
+			if ((x / 37 + y / 23) % 3 == 0) {
+				c->r = 20 + (x & 3);
+				c->g = 200 + (y & 7);
+				c->b = 30;
+			}
+		}
+	}
+
+	return img;
+}
+
+/* alpha from the column (destination) or the row (source) so a patch at 0,0 meets every alpha pair,
+ * with white on every fourth diagonal where the weighted average divides exactly */
+static void alpha_grid(switch_image_t *img, int src)
+{
+	int x, y;
+
+	for (y = 0; y < img->d_h; y++) {
+		for (x = 0; x < img->d_w; x++) {
+			switch_rgb_color_t *c = (switch_rgb_color_t *) (img->planes[SWITCH_PLANE_PACKED] + y * img->stride[SWITCH_PLANE_PACKED] + x * 4);
+
+			c->a = (uint8_t) (src ? y : x);
+
+			if ((x + y) % 4 == 0) {
+				c->r = c->g = c->b = 255;
+			}
+		}
+	}
+}
+
+static switch_image_t *dup_img(switch_image_t *src)
+{
+	switch_image_t *img = switch_img_alloc(NULL, src->fmt, src->d_w, src->d_h, 1);
+	int y;
+
+	for (y = 0; y < src->d_h; y++) {
+		memcpy(img->planes[SWITCH_PLANE_PACKED] + y * img->stride[SWITCH_PLANE_PACKED],
+			   src->planes[SWITCH_PLANE_PACKED] + y * src->stride[SWITCH_PLANE_PACKED], src->d_w * 4);
+	}
+
+	return img;
+}
+
+static int same_img(switch_image_t *a, switch_image_t *b)
+{
+	int y;
+
+	for (y = 0; y < a->d_h; y++) {
+		if (memcmp(a->planes[SWITCH_PLANE_PACKED] + y * a->stride[SWITCH_PLANE_PACKED],
+				   b->planes[SWITCH_PLANE_PACKED] + y * b->stride[SWITCH_PLANE_PACKED], a->d_w * 4)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/* runs frames through a new chromakey, the first one without and the later ones with its frame cache */
+static void chromakey_frames(switch_image_t **frames, int count)
+{
+	switch_chromakey_t *ck = NULL;
+	switch_rgb_color_t color = { 0 };
+	int i;
+
+	switch_chromakey_create(&ck);
+	color.r = 22; color.g = 204; color.b = 30;
+	switch_chromakey_add_color(ck, &color, 12);
+	color.r = 200; color.g = 40; color.b = 90;
+	switch_chromakey_add_color(ck, &color, 30);
+	color.r = 128; color.g = 128; color.b = 128;
+	switch_chromakey_add_color(ck, &color, 45);
+
+	for (i = 0; i < count; i++) {
+		switch_chromakey_process(ck, frames[i]);
+	}
+
+	switch_chromakey_destroy(&ck);
+}
+
 FST_CORE_BEGIN("./conf")
 {
 	FST_SUITE_BEGIN(switch_core_video)
@@ -324,6 +426,211 @@ FST_CORE_BEGIN("./conf")
 			unlink(jpg_write_filename);
 		}
 		FST_TEST_END()
+
+		FST_TEST_BEGIN(image_cache)
+		{
+			switch_image_t *img, *copy;
+			switch_stream_handle_t stream = { 0 };
+			uint32_t y;
+
+			switch_img_cache_configure(SWITCH_IMG_CACHE_DEFAULT_SIZE);
+			switch_img_cache_flush();
+
+			img = switch_img_read_png("images/banner.png", SWITCH_IMG_FMT_ARGB);
+			fst_requires(img);
+
+			/* second read is served from the cache, as a copy with the same pixels */
+			copy = switch_img_read_png("images/banner.png", SWITCH_IMG_FMT_ARGB);
+			fst_requires(copy);
+			fst_check(copy != img);
+			fst_check(copy->d_w == img->d_w && copy->d_h == img->d_h);
+
+			for (y = 0; y < img->d_h; y++) {
+				fst_check(!memcmp(copy->planes[SWITCH_PLANE_PACKED] + y * copy->stride[SWITCH_PLANE_PACKED],
+								  img->planes[SWITCH_PLANE_PACKED] + y * img->stride[SWITCH_PLANE_PACKED], img->d_w * 4));
+			}
+
+			switch_img_free(&copy);
+
+			SWITCH_STANDARD_STREAM(stream);
+			switch_img_cache_status(&stream);
+			fst_check(strstr((char *) stream.data, "hits: 1\n") != NULL);
+			fst_check(strstr((char *) stream.data, "entries: 1\n") != NULL);
+			switch_safe_free(stream.data);
+
+			/* callers own their copy */
+			switch_img_cache_put("unit-test", img);
+			switch_img_free(&img);
+			img = switch_img_cache_get("unit-test");
+			fst_requires(img);
+			switch_img_free(&img);
+
+			switch_img_cache_configure(0);
+			fst_check(switch_img_cache_get("unit-test") == NULL);
+			switch_img_cache_configure(SWITCH_IMG_CACHE_DEFAULT_SIZE);
+			switch_img_cache_flush();
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(argb_fill_rect)
+		{
+			switch_image_t *img = switch_img_alloc(NULL, SWITCH_IMG_FMT_ARGB, 64, 48, 1);
+			switch_rgb_color_t color = { 0 }, zero = { 0 }, *px;
+			int x, y, bad = 0;
+
+			fst_requires(img);
+			switch_img_fill(img, 0, 0, img->d_w, img->d_h, &zero);
+			color.r = 10; color.g = 20; color.b = 30; color.a = 255;
+			switch_img_fill(img, 8, 4, 16, 100, &color);
+
+			for (y = 0; y < img->d_h; y++) {
+				for (x = 0; x < img->d_w; x++) {
+					int inside = x >= 8 && x < 24 && y >= 4;
+
+					px = (switch_rgb_color_t *) (img->planes[SWITCH_PLANE_PACKED] + y * img->stride[SWITCH_PLANE_PACKED] + x * 4);
+					bad += memcmp(px, inside ? &color : &zero, sizeof(*px)) != 0;
+				}
+			}
+
+			fst_check(bad == 0);
+			switch_img_free(&img);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(simd_matches_scalar)
+		{
+			static const switch_simd_flag_t levels[] = { SWITCH_SIMD_SSE2, SWITCH_SIMD_SSE2 | SWITCH_SIMD_AVX2, SWITCH_SIMD_NEON };
+			switch_image_t *canvas = noise_img(1280, 720, 1, 0), *overlay = noise_img(1000, 700, 2, 4);
+			switch_image_t *grid = noise_img(256, 256, 5, 0), *grid_overlay = noise_img(256, 256, 6, 0);
+			switch_image_t *want_patch, *want_grid, *got, *frames[4], *want_ck[4];
+			int l, i, threads;
+
+			/* the golden output is the scalar code on a single thread */
+			switch_simd_set_flags(SWITCH_SIMD_NONE);
+			switch_img_set_band_threads(0);
+
+			want_patch = dup_img(canvas);
+			switch_img_patch_rgb(want_patch, overlay, 100, 10, SWITCH_TRUE);
+
+			alpha_grid(grid, 0);
+			alpha_grid(grid_overlay, 1);
+			want_grid = dup_img(grid);
+			switch_img_patch_rgb(want_grid, grid_overlay, 0, 0, SWITCH_TRUE);
+
+			for (i = 0; i < 4; i++) {
+				want_ck[i] = noise_img(1280, 720, 10 + (i > 1), 0);
+			}
+			chromakey_frames(want_ck, 4);
+
+			for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+				if (switch_simd_set_flags(levels[l]) != levels[l]) {
+					continue;
+				}
+
+				for (threads = 0; threads <= 3; threads += 3) {
+					switch_img_set_band_threads(threads);
+
+					got = dup_img(canvas);
+					switch_img_patch_rgb(got, overlay, 100, 10, SWITCH_TRUE);
+					fst_xcheck(same_img(got, want_patch), "alpha patch differs from the scalar patch");
+					switch_img_free(&got);
+
+					got = dup_img(grid);
+					switch_img_patch_rgb(got, grid_overlay, 0, 0, SWITCH_TRUE);
+					fst_xcheck(same_img(got, want_grid), "alpha patch differs from the scalar patch for some alpha pair");
+					switch_img_free(&got);
+
+					for (i = 0; i < 4; i++) {
+						frames[i] = noise_img(1280, 720, 10 + (i > 1), 0);
+					}
+					chromakey_frames(frames, 4);
+
+					for (i = 0; i < 4; i++) {
+						fst_xcheck(same_img(frames[i], want_ck[i]), "chromakey differs from the scalar chromakey");
+						switch_img_free(&frames[i]);
+					}
+				}
+			}
+
+			for (i = 0; i < 4; i++) {
+				switch_img_free(&want_ck[i]);
+			}
+
+			switch_img_free(&want_patch);
+			switch_img_free(&want_grid);
+			switch_img_free(&canvas);
+			switch_img_free(&overlay);
+			switch_img_free(&grid);
+			switch_img_free(&grid_overlay);
+			switch_simd_set_flags(switch_simd_cpu_flags());
+			switch_img_set_band_threads(-1);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(benchmark)
+		{
+			struct {
+				const char *name;
+				switch_simd_flag_t simd;
+				int threads;
+			} modes[] = {
+				{ "scalar", SWITCH_SIMD_NONE, 0 },
+				{ "simd", 0, 0 },
+				{ "simd+bands", 0, -1 }
+			};
+#ifdef BENCHMARK
+			int loops = 200;
+#else
+			int loops = 5;
+#endif
+			switch_image_t *canvas = noise_img(1920, 1080, 1, 0), *overlay = noise_img(1920, 1080, 2, 4), *frame;
+			switch_time_t start, patch_usec, ck_usec;
+			int m, i;
+
+			modes[1].simd = modes[2].simd = switch_simd_cpu_flags();
+
+			for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+				switch_chromakey_t *ck = NULL;
+				switch_rgb_color_t color = { 0 };
+
+				switch_simd_set_flags(modes[m].simd);
+				switch_img_set_band_threads(modes[m].threads);
+
+				start = switch_time_now();
+				for (i = 0; i < loops; i++) {
+					switch_img_patch_rgb(canvas, overlay, 0, 0, SWITCH_TRUE);
+				}
+				patch_usec = (switch_time_now() - start) / loops;
+
+				switch_chromakey_create(&ck);
+				color.g = 200;
+				switch_chromakey_add_color(ck, &color, 20);
+				color.r = 200;
+				switch_chromakey_add_color(ck, &color, 20);
+				frame = dup_img(overlay);
+
+				start = switch_time_now();
+				for (i = 0; i < loops; i++) {
+					/* keep the frame cache cold, that is the expensive case */
+					switch_chromakey_clear_colors(ck);
+					switch_chromakey_add_color(ck, &color, 20);
+					switch_chromakey_process(ck, frame);
+				}
+				ck_usec = (switch_time_now() - start) / loops;
+
+				switch_img_free(&frame);
+				switch_chromakey_destroy(&ck);
+
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] 1080p alpha patch: %" SWITCH_TIME_T_FMT "us, chromakey: %" SWITCH_TIME_T_FMT "us\n",
+								  modes[m].name, patch_usec, ck_usec);
+			}
+
+			switch_img_free(&canvas);
+			switch_img_free(&overlay);
+			switch_simd_set_flags(switch_simd_cpu_flags());
+			switch_img_set_band_threads(-1);
+		}
+		FST_TEST_END()
 #endif /* SWITCH_HAVE_YUV */
 	}
 	FST_SUITE_END()
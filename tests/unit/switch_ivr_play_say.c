@@ -73,6 +73,22 @@ static void on_record_stop(switch_event_t *event)
 	}
 }
 
+static void on_playback_start(switch_event_t *event)
+{
+	const char *uuid = switch_event_get_header(event, "Unique-ID");
+
+	if (uuid && switch_event_get_header(event, "Playback-Open-Usec")) {
+		switch_core_session_t *session = switch_core_session_locate(uuid);
+		if (session) {
+			switch_channel_t *channel = switch_core_session_get_channel(session);
+			int count = atoi(switch_str_nil(switch_channel_get_variable(channel, "playback_start_event_count")));
+
+			switch_channel_set_variable_printf(channel, "playback_start_event_count", "%d", count + 1);
+			switch_core_session_rwunlock(session);
+		}
+	}
+}
+
 static switch_status_t partial_play_and_collect_input_callback(switch_core_session_t *session, void *input, switch_input_type_t input_type, void *data, __attribute__((unused))unsigned int len)
 {
 	switch_status_t status = SWITCH_STATUS_SUCCESS;
@@ -471,6 +487,48 @@ FST_CORE_BEGIN("./conf_playsay")
 			unlink(record_filename);
 		}
 		FST_SESSION_END()
+
+		FST_SESSION_BEGIN(play_file_prefetch)
+		{
+			const char *files[3];
+			char *playlist;
+			int16_t buf[160] = { 0 };
+			switch_status_t status;
+			int i, j;
+
+			for (i = 0; i < 3; i++) {
+				switch_file_handle_t fh = { 0 };
+
+				files[i] = switch_core_session_sprintf(fst_session, "%s" SWITCH_PATH_SEPARATOR "play_file_prefetch-tmp-%s-%d.wav", SWITCH_GLOBAL_dirs.temp_dir, switch_core_session_get_uuid(fst_session), i);
+				fst_requires(switch_core_file_open(&fh, files[i], 1, 8000, SWITCH_FILE_FLAG_WRITE | SWITCH_FILE_DATA_SHORT, NULL) == SWITCH_STATUS_SUCCESS);
+
+				for (j = 0; j < 10; j++) {
+					switch_size_t len = 160;
+					switch_core_file_write(&fh, buf, &len);
+				}
+
+				switch_core_file_close(&fh);
+			}
+
+			playlist = switch_core_session_sprintf(fst_session, "%s!%s!%s", files[0], files[1], files[2]);
+
+			switch_event_bind("play_file_prefetch", SWITCH_EVENT_PLAYBACK_START, SWITCH_EVENT_SUBCLASS_ANY, on_playback_start, NULL);
+			switch_channel_set_variable(fst_channel, "playback_delimiter", "!");
+			switch_channel_set_variable(fst_channel, "playback_sleep_val", "0");
+			switch_channel_set_variable(fst_channel, "playback_prefetch", "2");
+
+			status = switch_ivr_play_file(fst_session, NULL, playlist, NULL);
+			fst_check(status == SWITCH_STATUS_SUCCESS);
+
+			switch_sleep(1000 * 1000);
+			fst_check_string_equals(switch_channel_get_variable(fst_channel, "playback_start_event_count"), "3");
+			switch_event_unbind_callback(on_playback_start);
+
+			for (i = 0; i < 3; i++) {
+				unlink(files[i]);
+			}
+		}
+		FST_SESSION_END()
 	}
 	FST_SUITE_END()
 }
@@ -30,6 +30,7 @@
 
 #include <test/switch_test.h>
 #include <switch_packetizer.h>
+#include <switch_simd.h>
 
 #define SLICE_SIZE 4
 
@@ -221,8 +222,123 @@ FST_CORE_BEGIN("conf")
 		}
 		FST_TEST_END()
 
+		FST_TEST_BEGIN(test_packetizer_read_iov)
+		{
+			switch_packetizer_t *packetizer = switch_packetizer_create(SPT_H264_BITSTREAM, SLICE_SIZE);
+			switch_packetizer_iov_t iov[SWITCH_PACKETIZER_MAX_IOV];
+			switch_status_t status;
+			switch_bool_t m;
+			int iovcnt;
+			uint8_t h264data[] = {0, 0, 0, 1, 0x67, 1, 2, 0, 0, 0, 1, 0x68, 1, 2, 0, 0, 0, 1, 0x65, 1, 2, 3, 4, 5, 6};
+			uint8_t fu[] = {0x7c, 0x85, 1, 2};
+
+			status = switch_packetizer_feed(packetizer, h264data, sizeof(h264data));
+			fst_requires(status == SWITCH_STATUS_SUCCESS);
+
+			/* whole NALs point into the fed data */
+			status = switch_packetizer_read_iov(packetizer, iov, &iovcnt, &m);
+			fst_requires(status == SWITCH_STATUS_MORE_DATA);
+			fst_requires(iovcnt == 1);
+			fst_check(iov[0].base == h264data + 4);
+			fst_check(iov[0].len == 3);
+			fst_check(!m);
+
+			status = switch_packetizer_read_iov(packetizer, iov, &iovcnt, &m);
+			fst_requires(status == SWITCH_STATUS_MORE_DATA);
+			fst_check(iov[0].base == h264data + 11);
+
+			/* fragments are a FU-A header followed by a piece of the NAL */
+			status = switch_packetizer_read_iov(packetizer, iov, &iovcnt, &m);
+			fst_requires(status == SWITCH_STATUS_MORE_DATA);
+			fst_requires(iovcnt == 2);
+			fst_check(iov[0].len == 2);
+			fst_check(!memcmp(iov[0].base, fu, 2));
+			fst_check(iov[1].base == h264data + 19);
+			fst_check(iov[1].len == 2);
+
+			status = switch_packetizer_read_iov(packetizer, iov, &iovcnt, &m);
+			fst_requires(status == SWITCH_STATUS_MORE_DATA);
+			fst_check(iov[1].base == h264data + 21);
+
+			status = switch_packetizer_read_iov(packetizer, iov, &iovcnt, &m);
+			fst_requires(status == SWITCH_STATUS_SUCCESS);
+			fst_requires(iovcnt == 2);
+			fst_check(*((uint8_t *)iov[0].base + 1) == 0x45);
+			fst_check(iov[1].base == h264data + 23);
+			fst_check(iov[1].len == 2);
+			fst_check(m);
+			switch_packetizer_close(&packetizer);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(test_packetizer_simd_matches_scalar)
+		{
+			static const switch_simd_flag_t levels[] = { SWITCH_SIMD_SSE2, SWITCH_SIMD_SSE2 | SWITCH_SIMD_AVX2, SWITCH_SIMD_NEON };
+			uint32_t len = 64 * 1024, i, l, got_count;
+			uint8_t *h264data = switch_core_alloc(fst_pool, len);
+			uint32_t *want = switch_core_alloc(fst_pool, 256 * sizeof(uint32_t));
+			uint32_t *got = switch_core_alloc(fst_pool, 256 * sizeof(uint32_t));
+			uint32_t want_count = 0;
+			uint8_t data[SWITCH_RECOMMENDED_BUFFER_SIZE];
+			switch_frame_t frame = {0};
+
+			/* noise with plenty of zeros, start codes on both sides of the 16 and 32 byte block edges */
+			srand(42);
+			for (i = 0; i < len; i++) {
+				h264data[i] = (rand() % 3) ? (rand() & 0xff) | 2 : 0;
+			}
+			for (i = 0; i + 40 < len; i += 997 + rand() % 64) {
+				h264data[i] = 0;
+				h264data[i + 1] = 0;
+				h264data[i + 2] = 1;
+				h264data[i + 3] = 0x41;
+			}
+			memcpy(h264data + 30, "\0\0\1\x41", 4);
+			memcpy(h264data + 46, "\0\0\0\1\x41", 5);
+			memcpy(h264data + len - 5, "\0\0\1\x41\x01", 5);
+
+			frame.data = data;
+			frame.buflen = SWITCH_RECOMMENDED_BUFFER_SIZE;
+
+			for (l = 0; l <= sizeof(levels) / sizeof(levels[0]); l++) {
+				switch_packetizer_t *packetizer;
+				switch_status_t status;
+				uint32_t *lens = l ? got : want;
+				uint32_t count = 0;
+
+				if (!l) {
+					switch_simd_set_flags(SWITCH_SIMD_NONE);
+				} else if (switch_simd_set_flags(levels[l - 1]) != levels[l - 1]) {
+					continue;
+				}
+
+				packetizer = switch_packetizer_create(SPT_H264_BITSTREAM, SWITCH_RECOMMENDED_BUFFER_SIZE);
+				fst_requires(switch_packetizer_feed(packetizer, h264data, len) == SWITCH_STATUS_SUCCESS);
+
+				do {
+					status = switch_packetizer_read(packetizer, &frame);
+					if (count < 256) lens[count] = frame.datalen;
+					count++;
+				} while (status == SWITCH_STATUS_MORE_DATA);
+
+				fst_check(status == SWITCH_STATUS_SUCCESS);
+				switch_packetizer_close(&packetizer);
+
+				if (!l) {
+					want_count = count;
+					fst_check(want_count > 60);
+				} else {
+					got_count = count;
+					fst_check(got_count == want_count);
+					fst_xcheck(!memcmp(got, want, (count > 256 ? 256 : count) * sizeof(uint32_t)), "NAL sizes differ from the scalar scan");
+				}
+			}
+		}
+		FST_TEST_END()
+
 		FST_TEARDOWN_BEGIN()
 		{
+			switch_simd_set_flags(switch_simd_cpu_flags());
 		}
 		FST_TEARDOWN_END()
 	}
@@ -0,0 +1,190 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * switch_pcm.c -- tests the G.711 block conversion against the per sample reference
+ *
+ */
+
+#include <switch.h>
+#include <switch_simd.h>
+#include <g711.h>
+#include <test/switch_test.h>
+
+static const switch_simd_flag_t levels[] = {
+	SWITCH_SIMD_NONE,
+	SWITCH_SIMD_SSE2,
+	SWITCH_SIMD_SSE2 | SWITCH_SIMD_AVX2,
+	SWITCH_SIMD_NEON
+};
+
+FST_MINCORE_BEGIN("./conf")
+
+FST_SUITE_BEGIN(switch_pcm)
+
+FST_SETUP_BEGIN()
+{
+}
+FST_SETUP_END()
+
+FST_TEARDOWN_BEGIN()
+{
+	switch_simd_set_flags(switch_simd_cpu_flags());
+}
+FST_TEARDOWN_END()
+
+FST_TEST_BEGIN(test_g711_block_matches_reference)
+{
+	static int16_t amp[65536 + 1], dec[256 + 1];
+	static uint8_t enc[65536 + 1], law[256 + 1];
+	uint32_t l;
+	int i, off, bad;
+
+	for (i = 0; i < 65536; i++) {
+		amp[i] = (int16_t) (i - 32768);
+	}
+
+	for (i = 0; i < 256; i++) {
+		law[i] = (uint8_t) i;
+	}
+
+	for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+		if (switch_simd_set_flags(levels[l]) != levels[l]) {
+			continue;
+		}
+
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "checking g711 with [%s]\n", switch_simd_flags2str(levels[l]));
+
+		/* every input value, once from an aligned start and once shifted so the scalar tail is used too */
+		for (off = 0; off < 2; off++) {
+			g711_ulaw_encode_block(enc, amp + off, 65536 - off);
+			for (bad = 0, i = 0; i < 65536 - off; i++) {
+				if (enc[i] != linear_to_ulaw(amp[i + off])) bad++;
+			}
+			fst_check(bad == 0);
+
+			g711_alaw_encode_block(enc, amp + off, 65536 - off);
+			for (bad = 0, i = 0; i < 65536 - off; i++) {
+				if (enc[i] != linear_to_alaw(amp[i + off])) bad++;
+			}
+			fst_check(bad == 0);
+
+			g711_ulaw_decode_block(dec, law + off, 256 - off);
+			for (bad = 0, i = 0; i < 256 - off; i++) {
+				if (dec[i] != ulaw_to_linear(law[i + off])) bad++;
+			}
+			fst_check(bad == 0);
+
+			g711_alaw_decode_block(dec, law + off, 256 - off);
+			for (bad = 0, i = 0; i < 256 - off; i++) {
+				if (dec[i] != alaw_to_linear(law[i + off])) bad++;
+			}
+			fst_check(bad == 0);
+		}
+
+		/* nothing is written past len */
+		enc[5] = 0xAA;
+		g711_ulaw_encode_block(enc, amp, 5);
+		fst_check(enc[5] == 0xAA);
+		dec[17] = 0x1234;
+		g711_alaw_decode_block(dec, law, 17);
+		fst_check(dec[17] == 0x1234);
+	}
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(benchmark)
+{
+	int16_t amp[160];
+	uint8_t enc[160];
+	switch_time_t start;
+	switch_simd_flag_t best = switch_simd_cpu_flags(), modes[2];
+	int m, x;
+#ifdef BENCHMARK
+	int loops = 10000000;
+#else
+	int loops = 10000;
+#endif
+
+	modes[0] = SWITCH_SIMD_NONE;
+	modes[1] = best;
+
+	for (x = 0; x < 160; x++) {
+		amp[x] = (int16_t) (rand() - RAND_MAX / 2);
+	}
+
+	/* one 20ms frame at 8kHz per call, like the codec callbacks */
+	for (m = 0; m < 2; m++) {
+		switch_simd_set_flags(modes[m]);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			g711_ulaw_encode_block(enc, amp, 160);
+			g711_ulaw_decode_block(amp, enc, 160);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] ulaw encode+decode: %" SWITCH_TIME_T_FMT "us for %d frames\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			g711_alaw_encode_block(enc, amp, 160);
+			g711_alaw_decode_block(amp, enc, 160);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] alaw encode+decode: %" SWITCH_TIME_T_FMT "us for %d frames\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+	}
+
+	start = switch_time_now();
+	for (x = 0; x < loops; x++) {
+		int i;
+
+		for (i = 0; i < 160; i++) {
+			enc[i] = linear_to_ulaw(amp[i]);
+		}
+		for (i = 0; i < 160; i++) {
+			amp[i] = ulaw_to_linear(enc[i]);
+		}
+	}
+	switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[per sample] ulaw encode+decode: %" SWITCH_TIME_T_FMT "us for %d frames\n",
+					  switch_time_now() - start, loops);
+
+	fst_check(switch_simd_set_flags(best) == best);
+}
+FST_TEST_END()
+
+FST_SUITE_END()
+
+FST_MINCORE_END()
+
+/* For Emacs:
+ * Local Variables:
+ * mode:c
+ * indent-tabs-mode:t
+ * tab-width:4
+ * c-basic-offset:4
+ * End:
+ * For VIM:
+ * vim:set softtabstop=4 shiftwidth=4 tabstop=4 noet:
+ */
@@ -0,0 +1,669 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * switch_resample.c -- tests the PCM helpers against their scalar reference and the resampler handles
+ *
+ */
+
+#include <switch.h>
+#include <switch_simd.h>
+#include <test/switch_test.h>
+
+#define MAX_LEN 1024
+
+static const switch_simd_flag_t levels[] = {
+	SWITCH_SIMD_NONE,
+	SWITCH_SIMD_SSE2,
+	SWITCH_SIMD_SSE2 | SWITCH_SIMD_AVX2,
+	SWITCH_SIMD_NEON
+};
+
+static const uint32_t lens[] = { 0, 1, 7, 8, 9, 15, 16, 17, 31, 33, 63, 160, 321, 960, MAX_LEN };
+
+/* the reference implementations are the scalar code as it was before the vector paths */
+
+static void ref_merge(int16_t *data, const int16_t *other, uint32_t len)
+{
+	uint32_t i;
+	int32_t z;
+
+	for (i = 0; i < len; i++) {
+		z = data[i] + other[i];
+		switch_normalize_to_16bit(z);
+		data[i] = (int16_t) z;
+	}
+}
+
+static void ref_unmerge(int16_t *data, const int16_t *other, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		data[i] -= other[i];
+	}
+}
+
+static void ref_volume(int16_t *data, uint32_t samples, double rate)
+{
+	uint32_t x;
+	int32_t tmp;
+
+	for (x = 0; x < samples; x++) {
+		tmp = (int32_t) (data[x] * rate);
+		switch_normalize_to_16bit(tmp);
+		data[x] = (int16_t) tmp;
+	}
+}
+
+static void ref_short_to_float(const short *s, float *f, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		f[i] = (float) (s[i]) / (float) 0x8000;
+	}
+}
+
+static void ref_float_to_short(const float *f, short *s, uint32_t len)
+{
+	uint32_t i;
+	float ft;
+
+	for (i = 0; i < len; i++) {
+		ft = f[i] * (float) 0x8000;
+		if (ft >= 0) {
+			s[i] = (short) (ft + 0.5);
+		} else {
+			s[i] = (short) (ft - 0.5);
+		}
+		if ((float) s[i] > (float) 0x7FFF)
+			s[i] = (short) (float) 0x7FFF / 2;
+		if (s[i] < (short) -(float) 0x7FFF)
+			s[i] = (short) -(float) 0x7FFF / 2;
+	}
+}
+
+/* compares against the scalar generator run from seed rnd2, giving up at the first differing sample */
+static int ref_silence_matches(const int16_t *data, uint32_t samples, uint32_t channels, uint32_t divisor, int16_t rnd2)
+{
+	int16_t s;
+	uint32_t x, i, j;
+	int sum_rnd = 0;
+
+	for (i = 0; i < samples; i++, sum_rnd = 0) {
+		for (x = 0; x < 6; x++) {
+			rnd2 = rnd2 * 31821U + 13849U;
+			sum_rnd += rnd2;
+		}
+
+		s = (int16_t) ((int16_t) sum_rnd / (int) divisor);
+
+		for (j = 0; j < channels; j++) {
+			if (*data++ != s) {
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+/* the seed is time based, look for one that produced the output */
+static int silence_matches_scalar(const int16_t *data, uint32_t samples, uint32_t channels, uint32_t divisor)
+{
+	uint32_t seed;
+
+	for (seed = 0; seed < 65536; seed++) {
+		if (ref_silence_matches(data, samples, channels, divisor, (int16_t) seed)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void fill_random(int16_t *data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		switch (rand() % 8) {
+		case 0:
+			data[i] = 32767;
+			break;
+		case 1:
+			data[i] = -32768;
+			break;
+		default:
+			data[i] = (int16_t) (rand() & 0xffff);
+			break;
+		}
+	}
+}
+
+static const uint32_t fir_rates[][2] = {
+	{ 8000, 16000 }, { 16000, 8000 }, { 16000, 48000 }, { 48000, 16000 },
+	{ 8000, 48000 }, { 48000, 8000 }, { 8000, 32000 }, { 32000, 8000 }
+};
+
+#define FIR_SECONDS 1
+#define FIR_MAX_OUT (48000 * FIR_SECONDS * 2 + 16)
+
+/* 1kHz, ch 0 as is and ch 1 inverted */
+static void fill_tone(int16_t *data, uint32_t rate, uint32_t channels, uint32_t samples)
+{
+	uint32_t i, c;
+
+	for (i = 0; i < samples; i++) {
+		int16_t v = (int16_t) (8000 * sin(2 * M_PI * 1000 * i / rate));
+
+		for (c = 0; c < channels; c++) {
+			data[i * channels + c] = c ? -v : v;
+		}
+	}
+}
+
+/* feed samples through a fresh handle chunk samples at a time, returns the number of output samples */
+static uint32_t run_resampler(uint32_t from, uint32_t to, uint32_t channels, uint32_t chunk, int16_t *in, uint32_t samples, int16_t *out)
+{
+	switch_audio_resampler_t *resampler = NULL;
+	uint32_t i, n, got = 0;
+
+	if (switch_resample_create(&resampler, from, to, chunk * 2, SWITCH_RESAMPLE_QUALITY, channels) != SWITCH_STATUS_SUCCESS) {
+		return 0;
+	}
+
+	for (i = 0; i < samples; i += n) {
+		n = samples - i < chunk ? samples - i : chunk;
+		switch_resample_process(resampler, in + i * channels, n);
+		memcpy(out + got * channels, resampler->to, resampler->to_len * channels * sizeof(int16_t));
+		got += resampler->to_len;
+	}
+
+	switch_resample_destroy(&resampler);
+
+	return got;
+}
+
+FST_MINCORE_BEGIN("./conf")
+
+FST_SUITE_BEGIN(switch_resample)
+
+FST_SETUP_BEGIN()
+{
+	srand(1234);
+}
+FST_SETUP_END()
+
+FST_TEARDOWN_BEGIN()
+{
+	switch_simd_set_flags(switch_simd_cpu_flags());
+}
+FST_TEARDOWN_END()
+
+FST_TEST_BEGIN(test_pcm_kernels_match_scalar)
+{
+	int16_t a[MAX_LEN * 2], b[MAX_LEN * 2], got[MAX_LEN * 2], want[MAX_LEN * 2];
+	float fa[MAX_LEN], fgot[MAX_LEN], fwant[MAX_LEN];
+	short sgot[MAX_LEN], swant[MAX_LEN];
+	uint32_t l, n, i;
+	int vol;
+
+	for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+		if (switch_simd_set_flags(levels[l]) != levels[l]) {
+			continue;
+		}
+
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "checking kernels with [%s]\n", switch_simd_flags2str(levels[l]));
+
+		for (n = 0; n < sizeof(lens) / sizeof(lens[0]); n++) {
+			uint32_t len = lens[n];
+
+			fill_random(a, len * 2);
+			fill_random(b, len * 2);
+
+			memcpy(got, a, len * 2 * sizeof(int16_t));
+			memcpy(want, a, len * 2 * sizeof(int16_t));
+			fst_check(switch_merge_sln(got, len, b, len, 2) == len);
+			ref_merge(want, b, len * 2);
+			fst_check(!memcmp(got, want, len * 2 * sizeof(int16_t)));
+
+			memcpy(got, a, len * 2 * sizeof(int16_t));
+			memcpy(want, a, len * 2 * sizeof(int16_t));
+			fst_check(switch_unmerge_sln(got, len, b, len, 2) == len);
+			ref_unmerge(want, b, len * 2);
+			fst_check(!memcmp(got, want, len * 2 * sizeof(int16_t)));
+
+			/* stereo down to mono */
+			memcpy(got, a, len * 2 * sizeof(int16_t));
+			for (i = 0; i < len; i++) {
+				int32_t z = a[i * 2] + a[i * 2 + 1];
+				switch_normalize_to_16bit(z);
+				want[i] = (int16_t) z;
+			}
+			switch_mux_channels(got, len, 2, 1);
+			fst_check(!memcmp(got, want, len * sizeof(int16_t)));
+
+			/* mono up to stereo, in place */
+			memcpy(got, a, len * sizeof(int16_t));
+			for (i = 0; i < len; i++) {
+				want[i * 2] = want[i * 2 + 1] = a[i];
+			}
+			switch_mux_channels(got, len, 1, 2);
+			fst_check(!memcmp(got, want, len * 2 * sizeof(int16_t)));
+
+			for (vol = -4; vol <= 4; vol++) {
+				static const double pos[4] = {1.3, 2.3, 3.3, 4.3};
+				static const double neg[4] = {.80, .60, .40, .20};
+
+				if (!vol) continue;
+
+				memcpy(got, a, len * sizeof(int16_t));
+				memcpy(want, a, len * sizeof(int16_t));
+				switch_change_sln_volume(got, len, vol);
+				ref_volume(want, len, vol > 0 ? pos[vol - 1] : neg[-vol - 1]);
+				fst_check(!memcmp(got, want, len * sizeof(int16_t)));
+			}
+
+			for (vol = -SWITCH_GRANULAR_VOLUME_MAX + 1; vol <= SWITCH_GRANULAR_VOLUME_MAX; vol += 7) {
+				int16_t scalar[MAX_LEN];
+				switch_simd_flag_t cur = switch_simd_flags();
+
+				if (!vol) continue;
+
+				/* the dB table lives in the core, compare against the core with vectors off */
+				memcpy(got, a, len * sizeof(int16_t));
+				memcpy(scalar, a, len * sizeof(int16_t));
+				switch_change_sln_volume_granular(got, len, vol);
+				switch_simd_set_flags(SWITCH_SIMD_NONE);
+				switch_change_sln_volume_granular(scalar, len, vol);
+				switch_simd_set_flags(cur);
+				fst_check(!memcmp(got, scalar, len * sizeof(int16_t)));
+			}
+
+			switch_short_to_float(a, fgot, len);
+			ref_short_to_float(a, fwant, len);
+			fst_check(!memcmp(fgot, fwant, len * sizeof(float)));
+
+			for (i = 0; i < len; i++) {
+				switch (i % 6) {
+				case 0:
+					/* exact ties between two output values */
+					fa[i] = ((float) (a[i] / 2) + 0.5f) / 32768.0f;
+					break;
+				case 1:
+					fa[i] = -1.0f;
+					break;
+				case 2:
+					fa[i] = (i & 8) ? 0.49999997f / 32768.0f : -0.49999997f / 32768.0f;
+					break;
+				default:
+					fa[i] = (float) a[i] / 32768.0f;
+					break;
+				}
+			}
+
+			switch_float_to_short(fa, sgot, len);
+			ref_float_to_short(fa, swant, len);
+			fst_check(!memcmp(sgot, swant, len * sizeof(short)));
+		}
+	}
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(test_sln_silence_matches_scalar)
+{
+	static const uint32_t divisors[] = { 1, 7, 400, 32768 };
+	int16_t got[MAX_LEN * 2];
+	uint32_t l, d, channels;
+
+	for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+		if (switch_simd_set_flags(levels[l]) != levels[l]) {
+			continue;
+		}
+
+		for (d = 0; d < sizeof(divisors) / sizeof(divisors[0]); d++) {
+			for (channels = 1; channels <= 3; channels++) {
+				uint32_t samples = 163;
+
+				switch_generate_sln_silence(got, samples, channels, divisors[d]);
+				fst_xcheck(silence_matches_scalar(got, samples, channels, divisors[d]), "silence does not match the scalar generator");
+			}
+		}
+	}
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(test_sln_silence_divisor_sweep)
+{
+	int16_t got[MAX_LEN];
+	uint32_t l, d;
+
+	for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+		if (switch_simd_set_flags(levels[l]) != levels[l]) {
+			continue;
+		}
+
+		/* every small divisor, then a geometric sweep up to the largest one; quotients that land on
+		   an exact integer are where an approximate reciprocal truncates one too low */
+		for (d = 1; d <= 32768; d = d < 256 ? d + 1 : d + d / 37 + 1) {
+			switch_generate_sln_silence(got, MAX_LEN, 1, d);
+			fst_xcheck(silence_matches_scalar(got, MAX_LEN, 1, d), "silence does not match the scalar generator");
+		}
+
+		switch_generate_sln_silence(got, MAX_LEN, 1, 949);
+		fst_check(silence_matches_scalar(got, MAX_LEN, 1, 949));
+
+		switch_generate_sln_silence(got, MAX_LEN, 1, 32768);
+		fst_check(silence_matches_scalar(got, MAX_LEN, 1, 32768));
+	}
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(test_mix_kernels_match_scalar)
+{
+	int16_t a[MAX_LEN], b[MAX_LEN], got[MAX_LEN + 1], want[MAX_LEN];
+	int32_t acc[MAX_LEN], acc_want[MAX_LEN];
+	uint32_t l, n, i, k;
+
+	for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+		if (switch_simd_set_flags(levels[l]) != levels[l]) {
+			continue;
+		}
+
+		for (n = 0; n < sizeof(lens) / sizeof(lens[0]); n++) {
+			uint32_t len = lens[n];
+
+			memset(acc, 0, sizeof(acc));
+			memset(acc_want, 0, sizeof(acc_want));
+
+			/* enough talkers to go well past the 16 bit range */
+			for (k = 0; k < 5; k++) {
+				fill_random(a, len);
+				switch_accumulate_sln(acc, a, len);
+
+				for (i = 0; i < len; i++) {
+					acc_want[i] += a[i];
+				}
+			}
+
+			fst_check(!memcmp(acc, acc_want, len * sizeof(int32_t)));
+
+			fill_random(b, len);
+
+			for (i = 0; i < len; i++) {
+				int32_t z = acc_want[i] - b[i];
+				switch_normalize_to_16bit(z);
+				want[i] = (int16_t) z;
+			}
+
+			got[len] = 0x5a5a;
+			switch_mix_minus_sln(got, acc, b, len);
+			fst_check(!memcmp(got, want, len * sizeof(int16_t)));
+			fst_check(got[len] == 0x5a5a);
+
+			for (i = 0; i < len; i++) {
+				int32_t z = acc_want[i];
+				switch_normalize_to_16bit(z);
+				want[i] = (int16_t) z;
+			}
+
+			switch_mix_minus_sln(got, acc, NULL, len);
+			fst_check(!memcmp(got, want, len * sizeof(int16_t)));
+		}
+	}
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(test_resample_fast_ratios)
+{
+	static int16_t in[48000 * FIR_SECONDS * 2], want[FIR_MAX_OUT], got[FIR_MAX_OUT];
+	uint32_t r, l, c, i, from, to, samples, nwant, ngot, peak;
+	int diff;
+
+	for (r = 0; r < sizeof(fir_rates) / sizeof(fir_rates[0]); r++) {
+		from = fir_rates[r][0];
+		to = fir_rates[r][1];
+		samples = from * FIR_SECONDS;
+
+		for (c = 1; c <= 2; c++) {
+			fill_tone(in, from, c, samples);
+
+			switch_simd_set_flags(SWITCH_SIMD_NONE);
+			nwant = run_resampler(from, to, c, from / 50, in, samples, want);
+			fst_check(nwant == to * FIR_SECONDS);
+
+			/* every vector level and an odd chunk size give the same samples */
+			for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+				if (switch_simd_set_flags(levels[l]) != levels[l]) {
+					continue;
+				}
+
+				ngot = run_resampler(from, to, c, from / 50, in, samples, got);
+				fst_check(ngot == nwant);
+				fst_check(!memcmp(got, want, nwant * c * sizeof(int16_t)));
+
+				ngot = run_resampler(from, to, c, 7, in, samples, got);
+				fst_check(ngot == nwant);
+				fst_check(!memcmp(got, want, nwant * c * sizeof(int16_t)));
+			}
+
+			/* the tone is in the pass band, level is kept once the filter has filled */
+			for (peak = 0, diff = 0, i = to / 10; i < nwant; i++) {
+				if ((uint32_t) abs(want[i * c]) > peak) peak = abs(want[i * c]);
+				if (c == 2 && abs(want[i * c] + want[i * c + 1]) > diff) diff = abs(want[i * c] + want[i * c + 1]);
+			}
+
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "%u -> %u x%u: peak %u\n", from, to, c, peak);
+			fst_check(peak > 7600 && peak < 8400);
+			fst_check(diff <= 1);
+		}
+	}
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(test_resample_pool)
+{
+	switch_audio_resampler_t *a = NULL, *b = NULL, *c = NULL, *parked;
+	int16_t zero[320] = { 0 };
+
+	fst_requires(switch_resample_create(&a, 8000, 16000, 320, SWITCH_RESAMPLE_QUALITY, 1) == SWITCH_STATUS_SUCCESS);
+	fst_check(a->fir != NULL);
+	fill_tone(a->to, 16000, 1, 320);
+	switch_resample_process(a, a->to, 160);
+	parked = a;
+	switch_resample_destroy(&a);
+	fst_check(a == NULL);
+
+	/* the same key comes back from the pool with its history cleared */
+	fst_requires(switch_resample_create(&b, 8000, 16000, 320, SWITCH_RESAMPLE_QUALITY, 1) == SWITCH_STATUS_SUCCESS);
+	fst_check(b == parked);
+	fst_check(switch_resample_process(b, zero, 160) == 320);
+	fst_check(!memcmp(b->to, zero, sizeof(zero)));
+
+	fst_requires(switch_resample_create(&c, 8000, 16000, 320, SWITCH_RESAMPLE_QUALITY, 2) == SWITCH_STATUS_SUCCESS);
+	fst_check(c != parked);
+	fst_check(c->channels == 2);
+	switch_resample_destroy(&b);
+	switch_resample_destroy(&c);
+
+	/* no integer ratio, or the filters turned off, is left to speex */
+	if (switch_resample_create(&a, 44100, 8000, 320, SWITCH_RESAMPLE_QUALITY, 1) == SWITCH_STATUS_SUCCESS) {
+		fst_check(a->fir == NULL);
+		switch_resample_destroy(&a);
+	}
+
+	switch_resample_set_fast_ratios(SWITCH_FALSE);
+	if (switch_resample_create(&a, 8000, 16000, 320, SWITCH_RESAMPLE_QUALITY, 1) == SWITCH_STATUS_SUCCESS) {
+		fst_check(a != parked);
+		fst_check(a->fir == NULL);
+		switch_resample_destroy(&a);
+	}
+	switch_resample_set_fast_ratios(SWITCH_TRUE);
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(benchmark)
+{
+	int16_t a[960 * 2], b[960 * 2];
+	int32_t acc[960] = { 0 };
+	float f[960];
+	switch_time_t start;
+	switch_simd_flag_t best = switch_simd_cpu_flags(), modes[2];
+	int m, x;
+#ifdef BENCHMARK
+	int loops = 1000000;
+#else
+	int loops = 1000;
+#endif
+
+	modes[0] = SWITCH_SIMD_NONE;
+	modes[1] = best;
+	fill_random(a, 960 * 2);
+	fill_random(b, 960 * 2);
+
+	for (m = 0; m < 2; m++) {
+		switch_simd_set_flags(modes[m]);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			switch_merge_sln(a, 960, b, 960, 2);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] merge_sln: %" SWITCH_TIME_T_FMT "us for %d loops\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			switch_unmerge_sln(a, 960, b, 960, 2);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] unmerge_sln: %" SWITCH_TIME_T_FMT "us for %d loops\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			switch_mux_channels(a, 960, 2, 1);
+			switch_mux_channels(a, 960, 1, 2);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] mux_channels: %" SWITCH_TIME_T_FMT "us for %d loops\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			switch_change_sln_volume(a, 960, (x & 1) ? 1 : -1);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] change_sln_volume: %" SWITCH_TIME_T_FMT "us for %d loops\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			switch_short_to_float(a, f, 960);
+			switch_float_to_short(f, a, 960);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] short/float: %" SWITCH_TIME_T_FMT "us for %d loops\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			switch_generate_sln_silence(a, 960, 1, 400);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] generate_sln_silence: %" SWITCH_TIME_T_FMT "us for %d loops\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+
+		start = switch_time_now();
+		for (x = 0; x < loops; x++) {
+			memset(acc, 0, sizeof(acc));
+			switch_accumulate_sln(acc, a, 960);
+			switch_mix_minus_sln(b, acc, a, 960);
+		}
+		switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "[%s] accumulate/mix_minus_sln: %" SWITCH_TIME_T_FMT "us for %d loops\n",
+						  switch_simd_flags2str(modes[m]), switch_time_now() - start, loops);
+	}
+
+	fst_check(switch_simd_set_flags(best) == best);
+}
+FST_TEST_END()
+
+FST_TEST_BEGIN(benchmark_resampler)
+{
+	static int16_t in[48000 * 2], out[48000 * 2 + 16];
+	switch_audio_resampler_t *resampler = NULL;
+	switch_time_t start, elapsed;
+	uint32_t r, m, i, from, to, frame;
+	int x;
+#ifdef BENCHMARK
+	int seconds = 600;
+#else
+	int seconds = 5;
+#endif
+
+	/* cpu time per channel per second of audio, 20ms frames, speex against the integer ratio filters */
+	for (r = 0; r < sizeof(fir_rates) / sizeof(fir_rates[0]); r++) {
+		from = fir_rates[r][0];
+		to = fir_rates[r][1];
+		frame = from / 50;
+		fill_tone(in, from, 1, from);
+
+		for (m = 0; m < 2; m++) {
+			switch_resample_set_fast_ratios(m ? SWITCH_TRUE : SWITCH_FALSE);
+
+			if (switch_resample_create(&resampler, from, to, frame * 2, SWITCH_RESAMPLE_QUALITY, 1) != SWITCH_STATUS_SUCCESS) {
+				continue;
+			}
+
+			start = switch_time_now();
+			for (x = 0; x < seconds; x++) {
+				for (i = 0; i < from; i += frame) {
+					switch_resample_process(resampler, in + i, frame);
+					memcpy(out, resampler->to, resampler->to_len * sizeof(int16_t));
+				}
+			}
+			elapsed = switch_time_now() - start;
+
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "%u -> %u [%s]: %" SWITCH_TIME_T_FMT "us per channel second\n",
+							  from, to, resampler->fir ? "fir" : "speex", elapsed / seconds);
+
+			switch_resample_destroy(&resampler);
+		}
+	}
+
+	switch_resample_set_fast_ratios(SWITCH_TRUE);
+}
+FST_TEST_END()
+
+FST_SUITE_END()
+
+FST_MINCORE_END()
+
+/* For Emacs:
+ * Local Variables:
+ * mode:c
+ * indent-tabs-mode:t
+ * tab-width:4
+ * c-basic-offset:4
+ * End:
+ * For VIM:
+ * vim:set softtabstop=4 shiftwidth=4 tabstop=4 noet:
+ */
@@ -0,0 +1,249 @@
+/*
+ * FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ * Copyright (C) 2005-2021, Anthony Minessale II <anthm@freeswitch.org>
+ *
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is FreeSWITCH Modular Media Switching Software Library / Soft-Switch Application
+ *
+ * The Initial Developer of the Original Code is
+ * Anthony Minessale II <anthm@freeswitch.org>
+ * Portions created by the Initial Developer are Copyright (C)
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ *
+ * switch_teletone.c -- runs the libteletone detectors over generated tones
+ *
+ */
+
+#include <switch.h>
+#include <test/switch_test.h>
+
+#define TT_RATE 8000
+#define TT_FRAME 160
+
+static int tt_handler(teletone_generation_session_t *ts, teletone_tone_map_t *map)
+{
+	switch_buffer_t *audio_buffer = ts->user_data;
+	int wrote;
+
+	wrote = teletone_mux_tones(ts, map);
+	switch_buffer_write(audio_buffer, ts->buffer, wrote * 2);
+
+	return 0;
+}
+
+/* renders a teletone script with a little noise on top, returns the number of samples */
+static int tt_render(switch_memory_pool_t *pool, const char *script, int duration_ms, int wait_ms, int16_t **out)
+{
+	teletone_generation_session_t ts;
+	switch_buffer_t *audio_buffer;
+	int16_t *data;
+	int samples, i;
+
+	switch_buffer_create_dynamic(&audio_buffer, 1024, 1024, 0);
+	teletone_init_session(&ts, 0, tt_handler, audio_buffer);
+	ts.rate = TT_RATE;
+	ts.channels = 1;
+	ts.duration = duration_ms * (TT_RATE / 1000);
+	ts.wait = wait_ms * (TT_RATE / 1000);
+	teletone_run(&ts, script);
+	teletone_destroy_session(&ts);
+
+	/* one second of silence after the script and whole frames only */
+	samples = (int) (switch_buffer_inuse(audio_buffer) / 2) + TT_RATE;
+	samples -= samples % TT_FRAME;
+	data = switch_core_alloc(pool, samples * 2);
+	switch_buffer_read(audio_buffer, data, samples * 2);
+	switch_buffer_destroy(&audio_buffer);
+
+	srand(7);
+	for (i = 0; i < samples; i++) {
+		data[i] += (int16_t) (rand() % 64 - 32);
+	}
+
+	*out = data;
+
+	return samples;
+}
+
+static void tt_detect_digits(int16_t *data, int samples, char *digits, int len)
+{
+	teletone_dtmf_detect_state_t dtmf_detect = { 0 };
+	int i, n = 0;
+
+	teletone_dtmf_detect_init(&dtmf_detect, TT_RATE);
+
+	for (i = 0; i + TT_FRAME <= samples; i += TT_FRAME) {
+		if (teletone_dtmf_detect(&dtmf_detect, data + i, TT_FRAME) == TT_HIT_END) {
+			unsigned int duration;
+			char digit;
+
+			if (teletone_dtmf_get(&dtmf_detect, &digit, &duration) && n < len - 1) {
+				digits[n++] = digit;
+			}
+		}
+	}
+
+	digits[n] = '\0';
+}
+
+FST_CORE_BEGIN("./conf")
+{
+	FST_SUITE_BEGIN(switch_teletone)
+	{
+		FST_SETUP_BEGIN()
+		{
+		}
+		FST_SETUP_END()
+
+		FST_TEARDOWN_BEGIN()
+		{
+		}
+		FST_TEARDOWN_END()
+
+		FST_TEST_BEGIN(dtmf_digits)
+		{
+			const char *script = "0123456789*#ABCD";
+			char digits[64];
+			int16_t *data;
+			int samples;
+
+			samples = tt_render(fst_pool, script, 100, 100, &data);
+			tt_detect_digits(data, samples, digits, sizeof(digits));
+			fst_check_string_equals(digits, script);
+
+			/* short digits with short gaps */
+			samples = tt_render(fst_pool, "159#", 60, 60, &data);
+			tt_detect_digits(data, samples, digits, sizeof(digits));
+			fst_check_string_equals(digits, "159#");
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(dtmf_no_talkoff)
+		{
+			char digits[64];
+			int16_t *data;
+			int samples;
+
+			/* single frequencies and a dial tone are not digits */
+			samples = tt_render(fst_pool, "%(500,0,697);%(500,0,1000);%(1000,0,350,440)", 0, 0, &data);
+			tt_detect_digits(data, samples, digits, sizeof(digits));
+			fst_check_string_equals(digits, "");
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(multi_tone)
+		{
+			teletone_multi_tone_t mt = { 0 };
+			teletone_tone_map_t map = { { 0 } };
+			int16_t *data;
+			int samples, i, hit = -1;
+
+			samples = tt_render(fst_pool, "%(1000,0,350,440)", 0, 0, &data);
+
+			mt.sample_rate = TT_RATE;
+			map.freqs[0] = 350;
+			map.freqs[1] = 440;
+			teletone_multi_tone_init(&mt, &map);
+
+			for (i = 0; i + TT_FRAME <= samples; i += TT_FRAME) {
+				if (teletone_multi_tone_detect(&mt, data + i, TT_FRAME)) {
+					hit = i;
+					break;
+				}
+			}
+
+			fst_check(hit >= 0 && hit < TT_RATE);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(benchmark)
+		{
+#ifdef BENCHMARK
+			int seconds = 600;
+#else
+			int seconds = 20;
+#endif
+			teletone_dtmf_detect_state_t dtmf_detect = { 0 };
+			int16_t *data;
+			int samples, i, s;
+			switch_time_t start, used;
+
+			samples = tt_render(fst_pool, "0123456789*#ABCD", 100, 100, &data);
+			teletone_dtmf_detect_init(&dtmf_detect, TT_RATE);
+
+			start = switch_time_now();
+			for (s = 0; s < seconds * TT_RATE; s += samples) {
+				for (i = 0; i + TT_FRAME <= samples; i += TT_FRAME) {
+					if (teletone_dtmf_detect(&dtmf_detect, data + i, TT_FRAME) == TT_HIT_END) {
+						unsigned int duration;
+						char digit;
+
+						teletone_dtmf_get(&dtmf_detect, &digit, &duration);
+					}
+				}
+			}
+			used = switch_time_now() - start;
+
+			/* every channel needs one second of detection per second of audio */
+			switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "inband DTMF: %ds of audio in %" SWITCH_TIME_T_FMT "us, %" SWITCH_TIME_T_FMT " channels per core\n",
+							  seconds, used, used ? (switch_time_t) seconds * 1000000 / used : 0);
+		}
+		FST_TEST_END()
+
+		FST_TEST_BEGIN(benchmark_multi_tone)
+		{
+#ifdef BENCHMARK
+			int seconds = 600;
+#else
+			int seconds = 20;
+#endif
+			/* a lone tone runs the plain loop, more tones share the filter bank */
+			static const int tone_counts[] = { 1, 2, 4, 8, TELETONE_MAX_TONES };
+			int16_t *data;
+			int samples, i, s, t, n;
+			switch_time_t start, used;
+
+			samples = tt_render(fst_pool, "%(1000,0,350,440)", 0, 0, &data);
+
+			for (t = 0; t < sizeof(tone_counts) / sizeof(tone_counts[0]); t++) {
+				teletone_multi_tone_t mt = { 0 };
+				teletone_tone_map_t map = { { 0 } };
+
+				for (n = 0; n < tone_counts[t]; n++) {
+					map.freqs[n] = (teletone_process_t) (350 + 90 * n);
+				}
+
+				mt.sample_rate = TT_RATE;
+				teletone_multi_tone_init(&mt, &map);
+
+				start = switch_time_now();
+				for (s = 0; s < seconds * TT_RATE; s += samples) {
+					for (i = 0; i + TT_FRAME <= samples; i += TT_FRAME) {
+						teletone_multi_tone_detect(&mt, data + i, TT_FRAME);
+					}
+				}
+				used = switch_time_now() - start;
+
+				switch_log_printf(SWITCH_CHANNEL_LOG, SWITCH_LOG_INFO, "multi tone, %d tones: %ds of audio in %" SWITCH_TIME_T_FMT "us, %" SWITCH_TIME_T_FMT " channels per core\n",
+								  tone_counts[t], seconds, used, used ? (switch_time_t) seconds * 1000000 / used : 0);
+			}
+		}
+		FST_TEST_END()
+	}
+	FST_SUITE_END()
+}
+FST_CORE_END()
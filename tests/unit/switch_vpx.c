@@ -86,6 +86,54 @@ FST_CORE_BEGIN("./conf")
 		}
 		FST_TEST_END()
 
+		FST_TEST_BEGIN(vp8_encoder_stats)
+		{
+			switch_image_t *img;
+			uint8_t buf[SWITCH_DEFAULT_VIDEO_SIZE + 12];
+			switch_codec_t codec = { 0 };
+			switch_frame_t frame = { 0 };
+			switch_codec_settings_t codec_settings = {{ 0 }};
+			switch_stream_handle_t stream = { 0 };
+			switch_status_t encode_status;
+			int i, keyframes = 0;
+
+			codec_settings.video.width = 640;
+			codec_settings.video.height = 360;
+
+			fst_requires(switch_core_codec_init(&codec, "VP8", NULL, NULL, 0, 0, 1, SWITCH_CODEC_FLAG_ENCODE, &codec_settings, fst_pool) == SWITCH_STATUS_SUCCESS);
+
+			img = switch_img_alloc(NULL, SWITCH_IMG_FMT_I420, 640, 360, 1);
+			fst_requires(img);
+
+			for (i = 0; i < 5; i++) {
+				frame.img = img;
+				frame.packet = buf;
+				frame.data = buf + 12;
+
+				do {
+					frame.datalen = SWITCH_DEFAULT_VIDEO_SIZE;
+					encode_status = switch_core_codec_encode_video(&codec, &frame);
+
+					if (frame.datalen && frame.m && switch_test_flag(&frame, SFF_IS_KEYFRAME)) {
+						keyframes++;
+					}
+				} while (encode_status == SWITCH_STATUS_MORE_DATA);
+			}
+
+			/* only the first picture is a keyframe */
+			fst_check(keyframes == 1);
+
+			SWITCH_STANDARD_STREAM(stream);
+			switch_api_execute("vpx", "encoders", NULL, &stream);
+			fst_check_string_has((char *) stream.data, "VP8 640x360");
+			fst_check_string_has((char *) stream.data, "frames: 5");
+			switch_safe_free(stream.data);
+
+			switch_img_free(&img);
+			switch_core_codec_destroy(&codec);
+		}
+		FST_TEST_END()
+
 		FST_TEARDOWN_BEGIN()
 		{
 			switch_sleep(1000000);